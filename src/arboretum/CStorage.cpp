@@ -55,6 +55,7 @@
 
 #include <arboretum/CStorage.h>
 #include <stdexcept>
+#include <sys/uio.h>
 
 //------------------------------------------------------------------------------
 // Constructor. Do nothing. Just initialize members.
@@ -126,7 +127,7 @@ void CStorage::Close(){
 * @warning This object CAN'T have another file opened.
 */
 void CStorage::Create(const char *fName, int pageSize, int userHeaderSize,
-                     int cacheNPages){
+                     int cacheNPages, bool checksum){
    assert(fd < 0); // check if no other file is opened.
 
    strcpy(fileName, fName);
@@ -141,6 +142,8 @@ void CStorage::Create(const char *fName, int pageSize, int userHeaderSize,
 
    fileHeader.pageSize = pageSize;
    fileHeader.cacheTotalPages = cacheNPages;
+   this->checksum = checksum;
+   slotSize = pageSize + (checksum ? CSTORAGE_CHECKSUMSIZE : 0);
    fileHeader.totalPagesInUse = 0;
    fileHeader.disposeList = 0; // the disposeList is buid with disk address, not
                               // pageId. Since the header is located at
@@ -172,17 +175,19 @@ void CStorage::Create(const char *fName, int pageSize, int userHeaderSize,
 void CStorage::Drop(){
 
    tFileHeader auxHeader;
+   bool auxChecksum;
    char fName[CSTORAGE_MAX_FNAME_LENGTH];
 
    assert(fd >= 0); // check if a file is opened.
 
    auxHeader = fileHeader;
+   auxChecksum = checksum;
    strcpy(fName, fileName);
 
    Close();
 
    Create(fName, auxHeader.pageSize, auxHeader.userHeaderSize,
-          auxHeader.cacheTotalPages);
+          auxHeader.cacheTotalPages, auxChecksum);
 }//end CStorage::Drop
 
 //------------------------------------------------------------------------------
@@ -370,13 +375,42 @@ void CStorage::DiskReadPage(long pageId, void *page){
    assert((pageId >= 0) && (pageId < GetTotalPagesIncludingDisposed()));
 
    lseek(fd, ToFileCursor(pageId), SEEK_SET);
-   read(fd, page, fileHeader.pageSize);
+   if (checksum){
+      struct iovec parts[2];
+      u_int32_t crc;
+
+      // The checksum follows the page.
+      parts[0].iov_base = page;
+      parts[0].iov_len = fileHeader.pageSize;
+      parts[1].iov_base = &crc;
+      parts[1].iov_len = CSTORAGE_CHECKSUMSIZE;
+      if (readv(fd, parts, 2) != (ssize_t) (fileHeader.pageSize + CSTORAGE_CHECKSUMSIZE)){
+         throw std::logic_error("Unable to read page.");
+      }//end if
+      if (crc != PageChecksum(pageId, page)){
+         throw std::logic_error("Page checksum mismatch.");
+      }//end if
+   }else{
+      read(fd, page, fileHeader.pageSize);
+   }//end if
 
    #ifdef CSTORAGE_STATISTICS
    counters.diskRead = (counters.diskRead + 1) % CSTORAGE_STATISTICS_MAXVALUE;
    #endif
 }//end CStorage::DiskReadPage
 
+//------------------------------------------------------------------------------
+// Only a hint. Nothing is read now.
+//------------------------------------------------------------------------------
+void CStorage::Prefetch(long pageId){
+   #ifdef POSIX_FADV_WILLNEED
+   if ((pageId >= 0) && (pageId < GetTotalPagesIncludingDisposed())){
+      posix_fadvise(fd, ToFileCursor(pageId), fileHeader.pageSize,
+            POSIX_FADV_WILLNEED);
+   }//end if
+   #endif //POSIX_FADV_WILLNEED
+}//end CStorage::Prefetch
+
 //------------------------------------------------------------------------------
 // Used by the cache to write a page to disk.
 //------------------------------------------------------------------------------
@@ -385,7 +419,19 @@ void CStorage::DiskWritePage(long pageId, void *page){
    assert((pageId >= 0) && (pageId < GetTotalPagesIncludingDisposed()));
 
    lseek(fd, ToFileCursor(pageId), SEEK_SET);
-   write(fd, page, fileHeader.pageSize);
+   if (checksum){
+      struct iovec parts[2];
+      u_int32_t crc = PageChecksum(pageId, page);
+
+      // Page and checksum in a single write.
+      parts[0].iov_base = page;
+      parts[0].iov_len = fileHeader.pageSize;
+      parts[1].iov_base = &crc;
+      parts[1].iov_len = CSTORAGE_CHECKSUMSIZE;
+      writev(fd, parts, 2);
+   }else{
+      write(fd, page, fileHeader.pageSize);
+   }//end if
 
    #ifdef CSTORAGE_STATISTICS
    counters.diskWrite = (counters.diskWrite + 1) %
@@ -409,6 +455,8 @@ void CStorage::Reset(){
    fd = -1; // fd is integer. Zero and NULL doesn't work. -1 is the invalid value
 
    firstPageDiskAddress = CSTORAGE_HEADERSIZE;
+   checksum = false;
+   slotSize = 0;
 
    #ifdef CSTORAGE_STATISTICS
    ResetStatistics();
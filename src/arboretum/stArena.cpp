@@ -0,0 +1,62 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**
+* @file
+*
+* This file implements the class stArena.
+*
+* @version 1.0
+*/
+#include <arboretum/stArena.h>
+
+#include <string.h>
+
+//==============================================================================
+// Class stArena
+//------------------------------------------------------------------------------
+stArena::stArena(){
+   Chunks = NULL;
+   Next = NULL;
+   Free = 0;
+   ChunkSize = 0;
+   LastChunk = 0;
+   memset(FreeBlocks, 0, sizeof(FreeBlocks));
+}//end stArena::stArena
+
+//------------------------------------------------------------------------------
+stArena::~stArena(){
+   tChunk * chunk;
+
+   while (Chunks != NULL){
+      chunk = Chunks;
+      Chunks = chunk->NextChunk;
+      ::operator delete(chunk);
+   }//end while
+}//end stArena::~stArena
+
+//------------------------------------------------------------------------------
+void stArena::NewChunk(){
+   tChunk * chunk;
+
+   if (LastChunk == 0){
+      LastChunk = STARENA_FIRSTCHUNK;
+   }else if (LastChunk < STARENA_MAXCHUNK){
+      LastChunk *= 2;
+   }//end if
+   chunk = (tChunk *) ::operator new(sizeof(tChunk) + LastChunk);
+   chunk->NextChunk = Chunks;
+   Chunks = chunk;
+   Next = (unsigned char *)(chunk + 1);
+   Free = LastChunk;
+   ChunkSize += LastChunk;
+}//end stArena::NewChunk
@@ -0,0 +1,356 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**
+* @file
+*
+* This file implements the class stBufferPool and its replacement policies.
+*
+* @version 1.0
+*/
+#include <arboretum/stBufferPool.h>
+
+//==============================================================================
+// class stFrameList
+//------------------------------------------------------------------------------
+stFrameList::stFrameList(){
+
+   head = STBUFFERPOOL_NOFRAME;
+   tail = STBUFFERPOOL_NOFRAME;
+   size = 0;
+}//end stFrameList::stFrameList
+
+//------------------------------------------------------------------------------
+void stFrameList::PushFront(u_int32_t frame){
+
+   if (frame >= prev.size()){
+      prev.resize(frame + 1, STBUFFERPOOL_NOFRAME);
+      next.resize(frame + 1, STBUFFERPOOL_NOFRAME);
+   }//end if
+   prev[frame] = STBUFFERPOOL_NOFRAME;
+   next[frame] = head;
+   if (head != STBUFFERPOOL_NOFRAME){
+      prev[head] = frame;
+   }else{
+      tail = frame;
+   }//end if
+   head = frame;
+   size++;
+}//end stFrameList::PushFront
+
+//------------------------------------------------------------------------------
+void stFrameList::Remove(u_int32_t frame){
+
+   if (prev[frame] != STBUFFERPOOL_NOFRAME){
+      next[prev[frame]] = next[frame];
+   }else{
+      head = next[frame];
+   }//end if
+   if (next[frame] != STBUFFERPOOL_NOFRAME){
+      prev[next[frame]] = prev[frame];
+   }else{
+      tail = prev[frame];
+   }//end if
+   prev[frame] = STBUFFERPOOL_NOFRAME;
+   next[frame] = STBUFFERPOOL_NOFRAME;
+   size--;
+}//end stFrameList::Remove
+
+//------------------------------------------------------------------------------
+u_int32_t stFrameList::FindUnpinned(const u_int32_t * pins){
+   u_int32_t frame;
+
+   frame = tail;
+   while ((frame != STBUFFERPOOL_NOFRAME) && (pins[frame] != 0)){
+      frame = prev[frame];
+   }//end while
+   return frame;
+}//end stFrameList::FindUnpinned
+
+//==============================================================================
+// class stClockPolicy
+//------------------------------------------------------------------------------
+stClockPolicy::stClockPolicy(){
+
+   hand = 0;
+}//end stClockPolicy::stClockPolicy
+
+//------------------------------------------------------------------------------
+u_int32_t stClockPolicy::Victim(const u_int32_t * pins){
+   u_int32_t frame;
+   u_int32_t i;
+   u_int32_t n = used.size();
+
+   if (n == 0){
+      return STBUFFERPOOL_NOFRAME;
+   }//end if
+   // Two turns are enough to clear all reference bits.
+   for (i = 0; i < 2 * n; i++){
+      frame = hand;
+      hand = (hand + 1) % n;
+      if ((used[frame]) && (pins[frame] == 0)){
+         if (referenced[frame]){
+            referenced[frame] = false;
+         }else{
+            return frame;
+         }//end if
+      }//end if
+   }//end for
+   return STBUFFERPOOL_NOFRAME;
+}//end stClockPolicy::Victim
+
+//==============================================================================
+// class st2QPolicy
+//------------------------------------------------------------------------------
+st2QPolicy::st2QPolicy(u_int32_t capacity){
+
+   kin = capacity / 4;
+   if (kin == 0){
+      kin = 1;
+   }//end if
+   kout = capacity / 2;
+   if (kout == 0){
+      kout = 1;
+   }//end if
+}//end st2QPolicy::st2QPolicy
+
+//------------------------------------------------------------------------------
+void st2QPolicy::Insert(u_int32_t frame, u_int32_t pageID){
+   std::unordered_map<u_int32_t, std::list<u_int32_t>::iterator>::iterator i;
+
+   if (frame >= pages.size()){
+      inAm.resize(frame + 1, false);
+      pages.resize(frame + 1, 0);
+   }//end if
+   pages[frame] = pageID;
+   i = a1outIndex.find(pageID);
+   if (i != a1outIndex.end()){
+      // Referenced again after leaving A1in. It is a hot page.
+      a1out.erase(i->second);
+      a1outIndex.erase(i);
+      inAm[frame] = true;
+      am.PushFront(frame);
+   }else{
+      inAm[frame] = false;
+      a1in.PushFront(frame);
+   }//end if
+}//end st2QPolicy::Insert
+
+//------------------------------------------------------------------------------
+void st2QPolicy::Access(u_int32_t frame){
+
+   // Hits in A1in are correlated references and do not count.
+   if (inAm[frame]){
+      am.Remove(frame);
+      am.PushFront(frame);
+   }//end if
+}//end st2QPolicy::Access
+
+//------------------------------------------------------------------------------
+void st2QPolicy::Remove(u_int32_t frame, bool evicted){
+
+   if (inAm[frame]){
+      am.Remove(frame);
+   }else{
+      a1in.Remove(frame);
+      if (evicted){
+         // Remember it.
+         a1out.push_front(pages[frame]);
+         a1outIndex[pages[frame]] = a1out.begin();
+         if (a1out.size() > kout){
+            a1outIndex.erase(a1out.back());
+            a1out.pop_back();
+         }//end if
+      }//end if
+   }//end if
+}//end st2QPolicy::Remove
+
+//------------------------------------------------------------------------------
+u_int32_t st2QPolicy::Victim(const u_int32_t * pins){
+   u_int32_t frame = STBUFFERPOOL_NOFRAME;
+
+   if (a1in.GetSize() > kin){
+      frame = a1in.FindUnpinned(pins);
+   }//end if
+   if (frame == STBUFFERPOOL_NOFRAME){
+      frame = am.FindUnpinned(pins);
+   }//end if
+   if (frame == STBUFFERPOOL_NOFRAME){
+      frame = a1in.FindUnpinned(pins);
+   }//end if
+   return frame;
+}//end st2QPolicy::Victim
+
+//==============================================================================
+// class stBufferPool
+//------------------------------------------------------------------------------
+stBufferPool::stBufferPool(CStorage * storage, u_int32_t pageSize,
+      u_int64_t budget, tReplacementPolicy policy){
+
+   this->storage = storage;
+   this->pageSize = pageSize;
+   if (budget / pageSize < STBUFFERPOOL_MINFRAMES){
+      this->capacity = STBUFFERPOOL_MINFRAMES;
+   }else if (budget / pageSize >= STBUFFERPOOL_NOFRAME){
+      this->capacity = STBUFFERPOOL_NOFRAME - 1;
+   }else{
+      this->capacity = (u_int32_t)(budget / pageSize);
+   }//end if
+
+   switch (policy){
+      case rpCLOCK:
+         this->policy = new stClockPolicy();
+         break;
+      case rp2Q:
+         this->policy = new st2QPolicy(capacity);
+         break;
+      default:
+         this->policy = new stLRUPolicy();
+   }//end switch
+
+   // Frames are created on demand.
+   frames.reserve(capacity < 1024 ? capacity : 1024);
+   ResetStatistics();
+}//end stBufferPool::stBufferPool
+
+//------------------------------------------------------------------------------
+stBufferPool::~stBufferPool(){
+   u_int32_t i;
+
+   for (i = 0; i < frames.size(); i++){
+      delete frames[i];
+   }//end for
+   delete policy;
+}//end stBufferPool::~stBufferPool
+
+//------------------------------------------------------------------------------
+stPage * stBufferPool::Get(u_int32_t pageID){
+   u_int32_t frame;
+
+   frame = Find(pageID);
+   if (frame != STBUFFERPOOL_NOFRAME){
+      hits++;
+      pins[frame]++;
+      policy->Access(frame);
+   }else{
+      misses++;
+      frame = GetEmptyFrame();
+      storage->ReadPage(pageID - 1, frames[frame]->GetData());
+      Register(frame, pageID);
+   }//end if
+   return frames[frame];
+}//end stBufferPool::Get
+
+//------------------------------------------------------------------------------
+stPage * stBufferPool::New(){
+   u_int32_t frame;
+
+   frame = GetEmptyFrame();
+   Register(frame, storage->InsertNewPage((void *) frames[frame]->GetData()) + 1);
+   return frames[frame];
+}//end stBufferPool::New
+
+//------------------------------------------------------------------------------
+bool stBufferPool::Release(stPage * page){
+   u_int32_t frame = FindFrame(page);
+
+   if (frame == STBUFFERPOOL_NOFRAME){
+      return false;
+   }//end if
+   if (pins[frame] > 0){
+      pins[frame]--;
+   }//end if
+   return true;
+}//end stBufferPool::Release
+
+//------------------------------------------------------------------------------
+void stBufferPool::Write(stPage * page){
+   u_int32_t frame = Find(page->GetPageID());
+
+   if (frame == STBUFFERPOOL_NOFRAME){
+      storage->WritePage(page->GetPageID() - 1, (void *) page->GetData());
+   }else{
+      if (frames[frame] != page){
+         frames[frame]->Copy(page);
+      }//end if
+      modified[frame] = true;
+   }//end if
+}//end stBufferPool::Write
+
+//------------------------------------------------------------------------------
+bool stBufferPool::Dispose(stPage * page){
+   u_int32_t frame = FindFrame(page);
+
+   if (frame == STBUFFERPOOL_NOFRAME){
+      return false;
+   }//end if
+   if (pins[frame] > 1){
+      throw std::logic_error("The page is still in use.");
+   }//end if
+
+   // Forget it. It will never be written.
+   pageTable.erase(page->GetPageID());
+   policy->Remove(frame, false);
+   pins[frame] = 0;
+   modified[frame] = false;
+   freeFrames.push_back(frame);
+   storage->FreePage(page->GetPageID() - 1);
+   return true;
+}//end stBufferPool::Dispose
+
+//------------------------------------------------------------------------------
+void stBufferPool::Flush(){
+   std::unordered_map<u_int32_t, u_int32_t>::iterator i;
+
+   for (i = pageTable.begin(); i != pageTable.end(); i++){
+      if (modified[i->second]){
+         WriteBack(i->second);
+      }//end if
+   }//end for
+}//end stBufferPool::Flush
+
+//------------------------------------------------------------------------------
+u_int32_t stBufferPool::GetEmptyFrame(){
+   u_int32_t frame;
+
+   if (!freeFrames.empty()){
+      frame = freeFrames.back();
+      freeFrames.pop_back();
+   }else if (frames.size() < capacity){
+      frame = frames.size();
+      frames.push_back(new stPage(pageSize));
+      pins.push_back(0);
+      modified.push_back(false);
+   }else{
+      frame = policy->Victim(pins.data());
+      if (frame == STBUFFERPOOL_NOFRAME){
+         throw std::logic_error("All buffer pool frames are pinned.");
+      }//end if
+      evictions++;
+      if (modified[frame]){
+         WriteBack(frame);
+      }//end if
+      policy->Remove(frame, true);
+      pageTable.erase(frames[frame]->GetPageID());
+   }//end if
+   return frame;
+}//end stBufferPool::GetEmptyFrame
+
+//------------------------------------------------------------------------------
+void stBufferPool::Register(u_int32_t frame, u_int32_t pageID){
+
+   frames[frame]->SetPageID(pageID);
+   pins[frame] = 1;
+   modified[frame] = false;
+   pageTable[pageID] = frame;
+   policy->Insert(frame, pageID);
+}//end stBufferPool::Register
@@ -0,0 +1,139 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**
+* @file
+*
+* This file implements the class stChecksum.
+*
+* @version 1.0
+*/
+#include <arboretum/stChecksum.h>
+
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+   #define STCHECKSUM_SSE42
+   #include <nmmintrin.h>
+#endif //__GNUC__
+
+/**
+* Reversed CRC32C polynomial.
+*/
+#define STCHECKSUM_POLY 0x82F63B78U
+
+//==============================================================================
+// Local helpers
+//------------------------------------------------------------------------------
+namespace{
+
+/**
+* Lookup table of the software implementation. It is built when the library
+* is loaded.
+*/
+struct tCRC32CTable{
+   u_int32_t Entry[256];
+
+   tCRC32CTable(){
+      u_int32_t i;
+      u_int32_t j;
+      u_int32_t c;
+
+      for (i = 0; i < 256; i++){
+         c = i;
+         for (j = 0; j < 8; j++){
+            c = (c & 1) ? (c >> 1) ^ STCHECKSUM_POLY : c >> 1;
+         }//end for
+         Entry[i] = c;
+      }//end for
+   }//end tCRC32CTable
+};//end tCRC32CTable
+
+tCRC32CTable crcTable;
+
+#ifdef STCHECKSUM_SSE42
+bool useHardware = __builtin_cpu_supports("sse4.2");
+#else
+bool useHardware = false;
+#endif //STCHECKSUM_SSE42
+
+}//end namespace
+
+//==============================================================================
+// stChecksum
+//------------------------------------------------------------------------------
+u_int32_t stChecksum::CRC32C(const void * data, u_int32_t size, u_int32_t crc){
+
+   if (useHardware){
+      return ~Hardware((const unsigned char *) data, size, ~crc);
+   }else{
+      return ~Software((const unsigned char *) data, size, ~crc);
+   }//end if
+}//end stChecksum::CRC32C
+
+//------------------------------------------------------------------------------
+bool stChecksum::IsAccelerated(){
+
+   return useHardware;
+}//end stChecksum::IsAccelerated
+
+//------------------------------------------------------------------------------
+u_int32_t stChecksum::Software(const unsigned char * data, u_int32_t size,
+      u_int32_t crc){
+
+   while (size > 0){
+      crc = crcTable.Entry[(crc ^ *data) & 0xFF] ^ (crc >> 8);
+      data++;
+      size--;
+   }//end while
+   return crc;
+}//end stChecksum::Software
+
+//------------------------------------------------------------------------------
+#ifdef STCHECKSUM_SSE42
+__attribute__((target("sse4.2")))
+#endif //STCHECKSUM_SSE42
+u_int32_t stChecksum::Hardware(const unsigned char * data, u_int32_t size,
+      u_int32_t crc){
+   #ifdef STCHECKSUM_SSE42
+   #ifdef __x86_64__
+   u_int64_t word;
+   u_int64_t crc64 = crc;
+
+   // 8 bytes at a time. memcpy() avoids unaligned loads.
+   while (size >= 8){
+      memcpy(&word, data, 8);
+      crc64 = _mm_crc32_u64(crc64, word);
+      data += 8;
+      size -= 8;
+   }//end while
+   crc = (u_int32_t) crc64;
+   #else
+   u_int32_t word;
+
+   while (size >= 4){
+      memcpy(&word, data, 4);
+      crc = _mm_crc32_u32(crc, word);
+      data += 4;
+      size -= 4;
+   }//end while
+   #endif //__x86_64__
+   while (size > 0){
+      crc = _mm_crc32_u8(crc, *data);
+      data++;
+      size--;
+   }//end while
+   return crc;
+   #else
+   return Software(data, size, crc);
+   #endif //STCHECKSUM_SSE42
+}//end stChecksum::Hardware
@@ -24,3 +24,181 @@
 * @todo Documentation!!!
 */
 #include <arboretum/stCompress.h>
+
+#include <cstring>
+
+//==============================================================================
+// class stCompressor
+//------------------------------------------------------------------------------
+stCompressor::stCompressor(u_int32_t increment){
+
+   this->buff = 0;
+   this->buffSize = 0;
+   this->bitOffset = 0;
+   this->increment = (increment == 0) ? 1 : increment;
+}//end stCompressor::stCompressor
+
+//------------------------------------------------------------------------------
+stCompressor::~stCompressor(){
+
+   delete[] buff;
+}//end stCompressor::~stCompressor
+
+//------------------------------------------------------------------------------
+void stCompressor::WriteUInt(u_int32_t value, u_int32_t bits){
+   unsigned char tmp[4];
+
+   tmp[0] = (unsigned char) value;
+   tmp[1] = (unsigned char)(value >> 8);
+   tmp[2] = (unsigned char)(value >> 16);
+   tmp[3] = (unsigned char)(value >> 24);
+   WriteBits(tmp, bits);
+}//end stCompressor::WriteUInt
+
+//------------------------------------------------------------------------------
+void stCompressor::WriteVarUInt(u_int32_t value){
+
+   // 7 bits and a continuation flag per group.
+   while (value >= 0x80){
+      WriteUInt((value & 0x7F) | 0x80, 8);
+      value >>= 7;
+   }//end while
+   WriteUInt(value, 8);
+}//end stCompressor::WriteVarUInt
+
+//------------------------------------------------------------------------------
+bool stCompressor::WillFit(u_int32_t size){
+
+   return bitOffset + size <= buffSize * 8;
+}//end stCompressor::WillFit
+
+//------------------------------------------------------------------------------
+void stCompressor::WriteBits(unsigned char * buff, u_int32_t size){
+   u_int32_t shift;
+   u_int32_t idx;
+   u_int32_t n;
+   u_int32_t v;
+
+   if (!WillFit(size)){
+      Resize(bitOffset + size);
+   }//end if
+
+   // Bits are stored from the least significant to the most significant one.
+   while (size > 0){
+      n = (size < 8) ? size : 8;
+      v = (*buff) & ((1 << n) - 1);
+      shift = bitOffset & 0x7;
+      idx = bitOffset >> 3;
+      if (shift == 0){
+         this->buff[idx] = (unsigned char) v;
+      }else{
+         this->buff[idx] |= (unsigned char)(v << shift);
+         if (shift + n > 8){
+            this->buff[idx + 1] = (unsigned char)(v >> (8 - shift));
+         }//end if
+      }//end if
+      bitOffset += n;
+      size -= n;
+      buff++;
+   }//end while
+}//end stCompressor::WriteBits
+
+//------------------------------------------------------------------------------
+void stCompressor::Resize(u_int32_t newSize){
+   unsigned char * newBuff;
+   u_int32_t newBuffSize;
+
+   // Round to the increment.
+   newBuffSize = (newSize >> 3) + ((newSize & 0x7) ? 1 : 0);
+   newBuffSize = ((newBuffSize + increment - 1) / increment) * increment;
+   if (newBuffSize > buffSize){
+      newBuff = new unsigned char[newBuffSize];
+      if (buff != 0){
+         memcpy(newBuff, buff, GetDataSize());
+         delete[] buff;
+      }//end if
+      buff = newBuff;
+      buffSize = newBuffSize;
+   }//end if
+}//end stCompressor::Resize
+
+//==============================================================================
+// class stDecompressor
+//------------------------------------------------------------------------------
+stDecompressor::stDecompressor(){
+
+   this->buff = 0;
+   this->buffSize = 0;
+   this->bitOffset = 0;
+   this->capacity = 0;
+}//end stDecompressor::stDecompressor
+
+//------------------------------------------------------------------------------
+stDecompressor::~stDecompressor(){
+
+   delete[] buff;
+}//end stDecompressor::~stDecompressor
+
+//------------------------------------------------------------------------------
+void stDecompressor::SetData(const unsigned char * buff, u_int32_t size){
+
+   if (size > capacity){
+      delete[] this->buff;
+      this->buff = new unsigned char[size];
+      capacity = size;
+   }//end if
+   memcpy(this->buff, buff, size);
+   buffSize = size;
+   bitOffset = 0;
+}//end stDecompressor::SetData
+
+//------------------------------------------------------------------------------
+u_int32_t stDecompressor::ReadUInt(u_int32_t bits){
+   unsigned char tmp[4] = {0, 0, 0, 0};
+
+   ReadBits(tmp, bits);
+   return ((u_int32_t) tmp[0]) | (((u_int32_t) tmp[1]) << 8) |
+         (((u_int32_t) tmp[2]) << 16) | (((u_int32_t) tmp[3]) << 24);
+}//end stDecompressor::ReadUInt
+
+//------------------------------------------------------------------------------
+u_int32_t stDecompressor::ReadVarUInt(){
+   u_int32_t value = 0;
+   u_int32_t shift = 0;
+   u_int32_t group;
+
+   do{
+      group = ReadUInt(8);
+      if (shift < 32){
+         value |= (group & 0x7F) << shift;
+      }//end if
+      shift += 7;
+   }while (group & 0x80);
+   return value;
+}//end stDecompressor::ReadVarUInt
+
+//------------------------------------------------------------------------------
+void stDecompressor::ReadBits(unsigned char * buff, u_int32_t size){
+   u_int32_t shift;
+   u_int32_t idx;
+   u_int32_t n;
+   u_int32_t v;
+
+   if (bitOffset + size > buffSize * 8){
+      throw std::logic_error("Unexpected end of the compressed data.");
+   }//end if
+
+   while (size > 0){
+      n = (size < 8) ? size : 8;
+      shift = bitOffset & 0x7;
+      idx = bitOffset >> 3;
+      v = this->buff[idx] >> shift;
+      if (shift + n > 8){
+         v |= this->buff[idx + 1] << (8 - shift);
+      }//end if
+      *buff = (unsigned char)(v & ((1 << n) - 1));
+      bitOffset += n;
+      size -= n;
+      buff++;
+   }//end while
+}//end stDecompressor::ReadBits
@@ -0,0 +1,144 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**
+* @file
+*
+* This file implements the class stCompressedPageManager.
+*
+* @version 1.0
+*/
+#include <arboretum/stCompressedPageManager.h>
+
+/**
+* Maximum number of released pages kept for reuse.
+*/
+#define STCOMPRESSEDPAGEMANAGER_FREEPAGES 16
+
+//==============================================================================
+// stCompressedPageManager
+//------------------------------------------------------------------------------
+stCompressedPageManager::stCompressedPageManager(stPageManager * base,
+      stPageCodec * codec, u_int32_t factor){
+
+   this->base = base;
+   this->codec = codec;
+   this->headerPage = NULL;
+   this->basePageSize = base->GetMinimumPageSize();
+   this->pageSize = basePageSize * ((factor == 0) ? 1 : factor);
+}//end stCompressedPageManager::stCompressedPageManager
+
+//------------------------------------------------------------------------------
+stCompressedPageManager::~stCompressedPageManager(){
+   u_int32_t i;
+
+   for (i = 0; i < freePages.size(); i++){
+      delete freePages[i];
+   }//end for
+}//end stCompressedPageManager::~stCompressedPageManager
+
+//------------------------------------------------------------------------------
+stPage * stCompressedPageManager::GetHeaderPage(){
+
+   UpdateReadCounter();
+   headerPage = base->GetHeaderPage();
+   return headerPage;
+}//end stCompressedPageManager::GetHeaderPage
+
+//------------------------------------------------------------------------------
+stPage * stCompressedPageManager::GetPage(u_int32_t pageid){
+   stCompressedPage * page;
+   stPage * basePage;
+
+   basePage = base->GetPage(pageid);
+   if (basePage == NULL){
+      return NULL;
+   }//end if
+   page = NewPage(basePage);
+   try{
+      codec->Decode(basePage->GetData(), basePage->GetPageSize(), page);
+   }catch (...){
+      FreePage(page);
+      base->ReleasePage(basePage);
+      throw;
+   }//end try
+   UpdateReadCounter();
+   return page;
+}//end stCompressedPageManager::GetPage
+
+//------------------------------------------------------------------------------
+void stCompressedPageManager::ReleasePage(stPage * page){
+   stCompressedPage * cPage;
+
+   if (page == headerPage){
+      base->ReleasePage(page);
+   }else{
+      cPage = (stCompressedPage *) page;
+      base->ReleasePage(cPage->BasePage);
+      FreePage(cPage);
+   }//end if
+}//end stCompressedPageManager::ReleasePage
+
+//------------------------------------------------------------------------------
+stPage * stCompressedPageManager::GetNewPage(){
+   stCompressedPage * page;
+
+   page = NewPage(base->GetNewPage());
+   page->Clear();
+   return page;
+}//end stCompressedPageManager::GetNewPage
+
+//------------------------------------------------------------------------------
+void stCompressedPageManager::WritePage(stPage * page){
+   stCompressedPage * cPage = (stCompressedPage *) page;
+
+   if (codec->Encode(page, cPage->BasePage->GetData(), basePageSize) == 0){
+      throw std::logic_error("The compressed page does not fit in the storage.");
+   }//end if
+   base->WritePage(cPage->BasePage);
+   UpdateWriteCounter();
+}//end stCompressedPageManager::WritePage
+
+//------------------------------------------------------------------------------
+void stCompressedPageManager::DisposePage(stPage * page){
+   stCompressedPage * cPage = (stCompressedPage *) page;
+
+   base->DisposePage(cPage->BasePage);
+   FreePage(cPage);
+}//end stCompressedPageManager::DisposePage
+
+//------------------------------------------------------------------------------
+stCompressedPageManager::stCompressedPage * stCompressedPageManager::NewPage(
+      stPage * basePage){
+   stCompressedPage * page;
+
+   if (freePages.empty()){
+      page = new stCompressedPage(pageSize, basePageSize - 1);
+   }else{
+      page = freePages.back();
+      freePages.pop_back();
+   }//end if
+   page->BasePage = basePage;
+   page->SetPageID(basePage->GetPageID());
+   return page;
+}//end stCompressedPageManager::NewPage
+
+//------------------------------------------------------------------------------
+void stCompressedPageManager::FreePage(stCompressedPage * page){
+
+   page->BasePage = NULL;
+   if (freePages.size() < STCOMPRESSEDPAGEMANAGER_FREEPAGES){
+      freePages.push_back(page);
+   }else{
+      delete page;
+   }//end if
+}//end stCompressedPageManager::FreePage
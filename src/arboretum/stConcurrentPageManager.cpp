@@ -0,0 +1,370 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**
+* @file
+*
+* This file implements the class stConcurrentPageManager.
+*
+* @version 1.0
+*/
+#include <arboretum/stConcurrentPageManager.h>
+
+#include <cstring>
+#include <thread>
+
+//==============================================================================
+// stConcurrentPageManager
+//------------------------------------------------------------------------------
+stConcurrentPageManager::stConcurrentPageManager(const char * fName,
+      u_int32_t pagesize, u_int64_t cacheSize){
+
+   // Open file
+   fd = open(fName, O_CREAT|O_TRUNC|O_RDWR|O_BINARY, S_IREAD|S_IWRITE); // New file with 0 bytes
+   if (fd < 0){
+      throw std::logic_error("Unable to create file.");
+   }//end if
+
+   // Header
+   this->headerPage = new stLockablePage(pagesize, sizeof(tHeader), 0);
+   this->header = (tHeader *)(this->headerPage->GetTrueData());
+   NewHeader(this->header, pagesize);
+   WriteHeaderPage(headerPage);
+
+   CreateCache(cacheSize);
+   ResetStatistics();
+}//end stConcurrentPageManager::stConcurrentPageManager
+
+//------------------------------------------------------------------------------
+stConcurrentPageManager::stConcurrentPageManager(const char * fName){
+   tHeader tmpHeader;
+
+   // Open file
+   fd = open(fName, O_RDWR|O_BINARY); // Open file
+   if (fd < 0){
+      throw std::logic_error("Unable to open file.");
+   }//end if
+
+   // Validate file
+   if ((pread(fd, &tmpHeader, sizeof(tmpHeader), 0) != sizeof(tmpHeader)) ||
+         (!IsValidHeader(&tmpHeader))){
+      close(fd);
+      throw std::logic_error("invalid file.");
+   }//end if
+
+   // Load the whole header page. It will never be read again.
+   this->headerPage = new stLockablePage(tmpHeader.PageSize, sizeof(tHeader), 0);
+   this->header = (tHeader *)(this->headerPage->GetTrueData());
+   if (pread(fd, (void *)this->headerPage->GetTrueData(), tmpHeader.PageSize, 0)
+         != (ssize_t) tmpHeader.PageSize){
+      delete headerPage;
+      close(fd);
+      throw std::logic_error("invalid file.");
+   }//end if
+
+   CreateCache(STCONCURRENTPAGEMANAGER_DEFAULTCACHE);
+   ResetStatistics();
+}//end stConcurrentPageManager::stConcurrentPageManager
+
+//------------------------------------------------------------------------------
+stConcurrentPageManager::~stConcurrentPageManager(){
+
+   // Save header page info.
+   WriteHeaderPage(headerPage);
+   delete this->headerPage;
+   delete[] slots;
+   delete[] slotData;
+   close(fd);
+}//end stConcurrentPageManager::~stConcurrentPageManager
+
+//------------------------------------------------------------------------------
+bool stConcurrentPageManager::IsEmpty(){
+
+   return header->UsedPages == 0;
+}//end stConcurrentPageManager::IsEmpty
+
+//------------------------------------------------------------------------------
+stPage * stConcurrentPageManager::GetHeaderPage(){
+
+   // The header page is always up to date in memory.
+   GetCounters().Reads.fetch_add(1, std::memory_order_relaxed);
+   return this->headerPage;
+}//end stConcurrentPageManager::GetHeaderPage
+
+//------------------------------------------------------------------------------
+stPage * stConcurrentPageManager::GetPage(u_int32_t pageid){
+   stPage * myPage;
+   tCounters & c = GetCounters();
+   u_int32_t seq;
+
+   // Do not allow users to load header page from this file.
+   if ((pageid != 0) && (pageid <= header->PageCount)){
+      myPage = new stPage(header->PageSize, pageid);
+      if (CacheRead(pageid, myPage->GetData())){
+         c.Hits.fetch_add(1, std::memory_order_relaxed);
+      }else{
+         seq = CacheSequence(pageid);
+         DiskRead(pageid, myPage->GetData());
+         CacheFill(pageid, myPage->GetData(), seq);
+      }//end if
+      c.Reads.fetch_add(1, std::memory_order_relaxed);
+      return myPage;
+   }else{
+      // Error!!!
+      #ifdef __stDEBUG__
+      throw invalid_argument("Invalid page ID.");
+      #else
+      return NULL;
+      #endif //__stDEBUG__
+   }//end if
+}//end stConcurrentPageManager::GetPage
+
+//------------------------------------------------------------------------------
+void stConcurrentPageManager::ReleasePage(stPage * page){
+
+   if (page != headerPage){
+      delete page;
+   }//end if
+}//end stConcurrentPageManager::ReleasePage
+
+//------------------------------------------------------------------------------
+stPage * stConcurrentPageManager::GetNewPage(){
+   std::lock_guard<std::mutex> lock(writeMutex);
+   stPage * page;
+
+   if (header->Available == 0){
+      // Creating the new page
+      header->PageCount++;
+      page = new stPage(header->PageSize, header->PageCount);
+   }else{
+      // Remove from free list
+      page = new stPage(header->PageSize, header->Available);
+      if (!CacheRead(header->Available, page->GetData())){
+         DiskRead(header->Available, page->GetData());
+      }//end if
+      header->Available = *((u_int32_t *)(page->GetData()));
+   }//end if
+
+   // Update header
+   header->UsedPages++;
+   return page;
+}//end stConcurrentPageManager::GetNewPage
+
+//------------------------------------------------------------------------------
+void stConcurrentPageManager::WritePage(stPage * page){
+   std::lock_guard<std::mutex> lock(writeMutex);
+
+   #ifdef __stDEBUG__
+   if (page->GetPageID() == 0){
+      throw invalid_argument("Do not use WritePage to write header pages.");
+   }//end if
+   #endif //__stDEBUG__
+
+   DiskWrite(page->GetPageID(), page->GetData());
+   // The cache must never keep an old version of the page.
+   CacheWrite(page->GetPageID(), page->GetData());
+   GetCounters().Writes.fetch_add(1, std::memory_order_relaxed);
+}//end stConcurrentPageManager::WritePage
+
+//------------------------------------------------------------------------------
+void stConcurrentPageManager::WriteHeaderPage(stPage * headerpage){
+
+   #ifdef __stDEBUG__
+   if (headerpage->GetPageID() != 0){
+      throw invalid_argument("Do not use WriteHeaderPage to write standard pages.");
+   }//end if
+   #endif //__stDEBUG__
+
+   std::lock_guard<std::mutex> lock(writeMutex);
+   pwrite(fd, this->headerPage->GetTrueData(), header->PageSize, 0);
+   GetCounters().Writes.fetch_add(1, std::memory_order_relaxed);
+}//end stConcurrentPageManager::WriteHeaderPage
+
+//------------------------------------------------------------------------------
+void stConcurrentPageManager::DisposePage(stPage * page){
+
+   // Append to free list
+   {
+      std::lock_guard<std::mutex> lock(writeMutex);
+      *((u_int32_t *) page->GetData()) = header->Available;
+      header->Available = page->GetPageID();
+      header->UsedPages--;
+   }
+   WritePage(page);
+
+   // Free resources
+   ReleasePage(page);
+}//end stConcurrentPageManager::DisposePage
+
+//------------------------------------------------------------------------------
+void stConcurrentPageManager::Flush(){
+
+   WriteHeaderPage(headerPage);
+   #ifdef __linux__
+   fdatasync(fd);
+   #else
+   fsync(fd);
+   #endif //__linux__
+}//end stConcurrentPageManager::Flush
+
+//------------------------------------------------------------------------------
+void stConcurrentPageManager::ResetStatistics(){
+   u_int32_t i;
+
+   for (i = 0; i < STCONCURRENTPAGEMANAGER_STRIPES; i++){
+      counters[i].Reads.store(0, std::memory_order_relaxed);
+      counters[i].Writes.store(0, std::memory_order_relaxed);
+      counters[i].Hits.store(0, std::memory_order_relaxed);
+   }//end for
+}//end stConcurrentPageManager::ResetStatistics
+
+//------------------------------------------------------------------------------
+long int stConcurrentPageManager::GetReadCount(){
+   long int sum = 0;
+   u_int32_t i;
+
+   for (i = 0; i < STCONCURRENTPAGEMANAGER_STRIPES; i++){
+      sum += counters[i].Reads.load(std::memory_order_relaxed);
+   }//end for
+   return sum;
+}//end stConcurrentPageManager::GetReadCount
+
+//------------------------------------------------------------------------------
+long int stConcurrentPageManager::GetWriteCount(){
+   long int sum = 0;
+   u_int32_t i;
+
+   for (i = 0; i < STCONCURRENTPAGEMANAGER_STRIPES; i++){
+      sum += counters[i].Writes.load(std::memory_order_relaxed);
+   }//end for
+   return sum;
+}//end stConcurrentPageManager::GetWriteCount
+
+//------------------------------------------------------------------------------
+long int stConcurrentPageManager::GetCacheHitCount(){
+   long int sum = 0;
+   u_int32_t i;
+
+   for (i = 0; i < STCONCURRENTPAGEMANAGER_STRIPES; i++){
+      sum += counters[i].Hits.load(std::memory_order_relaxed);
+   }//end for
+   return sum;
+}//end stConcurrentPageManager::GetCacheHitCount
+
+//------------------------------------------------------------------------------
+void stConcurrentPageManager::CreateCache(u_int64_t cacheSize){
+   u_int64_t n = cacheSize / header->PageSize;
+   u_int32_t i;
+
+   // Largest power of 2 that fits.
+   slotCount = STCONCURRENTPAGEMANAGER_MINSLOTS;
+   while ((((u_int64_t) slotCount) * 2 <= n) && (slotCount < (1u << 30))){
+      slotCount *= 2;
+   }//end while
+
+   slots = new tSlot[slotCount];
+   slotData = new unsigned char[((size_t) slotCount) * header->PageSize];
+   for (i = 0; i < slotCount; i++){
+      slots[i].Sequence.store(0, std::memory_order_relaxed);
+      slots[i].PageID.store(0, std::memory_order_relaxed);
+   }//end for
+}//end stConcurrentPageManager::CreateCache
+
+//------------------------------------------------------------------------------
+bool stConcurrentPageManager::CacheRead(u_int32_t pageid, unsigned char * data){
+   u_int32_t slot = GetSlot(pageid);
+   u_int32_t seq;
+
+   seq = slots[slot].Sequence.load(std::memory_order_acquire);
+   if ((seq & 1) || (slots[slot].PageID.load(std::memory_order_relaxed) != pageid)){
+      return false;
+   }//end if
+   memcpy(data, slotData + ((size_t) slot) * header->PageSize, header->PageSize);
+   // The copy is valid only if no writer touched the slot meanwhile.
+   std::atomic_thread_fence(std::memory_order_acquire);
+   return slots[slot].Sequence.load(std::memory_order_relaxed) == seq;
+}//end stConcurrentPageManager::CacheRead
+
+//------------------------------------------------------------------------------
+void stConcurrentPageManager::CacheWrite(u_int32_t pageid,
+      const unsigned char * data){
+   u_int32_t slot = GetSlot(pageid);
+   u_int32_t seq;
+
+   // Lock the slot by making its sequence odd.
+   seq = slots[slot].Sequence.load(std::memory_order_relaxed);
+   while ((seq & 1) || (!slots[slot].Sequence.compare_exchange_weak(seq,
+         seq + 1, std::memory_order_acquire, std::memory_order_relaxed))){
+      std::this_thread::yield();
+      seq = slots[slot].Sequence.load(std::memory_order_relaxed);
+   }//end while
+   std::atomic_thread_fence(std::memory_order_release);
+
+   slots[slot].PageID.store(pageid, std::memory_order_relaxed);
+   memcpy(slotData + ((size_t) slot) * header->PageSize, data, header->PageSize);
+   slots[slot].Sequence.store(seq + 2, std::memory_order_release);
+}//end stConcurrentPageManager::CacheWrite
+
+//------------------------------------------------------------------------------
+void stConcurrentPageManager::CacheFill(u_int32_t pageid,
+      const unsigned char * data, u_int32_t seq){
+   u_int32_t slot = GetSlot(pageid);
+
+   // Lock the slot only if nobody touched it since seq was read. A failed
+   // exchange means that the page may be older than the slot, so it is not
+   // cached.
+   if ((seq & 1) || (!slots[slot].Sequence.compare_exchange_strong(seq,
+         seq + 1, std::memory_order_acquire, std::memory_order_relaxed))){
+      return;
+   }//end if
+   std::atomic_thread_fence(std::memory_order_release);
+
+   slots[slot].PageID.store(pageid, std::memory_order_relaxed);
+   memcpy(slotData + ((size_t) slot) * header->PageSize, data, header->PageSize);
+   slots[slot].Sequence.store(seq + 2, std::memory_order_release);
+}//end stConcurrentPageManager::CacheFill
+
+//------------------------------------------------------------------------------
+stConcurrentPageManager::tCounters & stConcurrentPageManager::GetCounters(){
+   static std::atomic<u_int32_t> nextStripe(0);
+   thread_local u_int32_t stripe = nextStripe.fetch_add(1,
+         std::memory_order_relaxed) % STCONCURRENTPAGEMANAGER_STRIPES;
+
+   return counters[stripe];
+}//end stConcurrentPageManager::GetCounters
+
+//------------------------------------------------------------------------------
+void stConcurrentPageManager::NewHeader(tHeader * header, u_int32_t pagesize){
+
+   // Magic header
+   header->Magic[0] = 'D';
+   header->Magic[1] = 'P';
+   header->Magic[2] = 'M';
+   header->Magic[3] = '1';
+
+   // Organization
+   header->PageSize = pagesize;
+
+   // Page control
+   header->PageCount = 0;
+   header->UsedPages = 0;
+   header->Available = 0;
+}//end stConcurrentPageManager::NewHeader
+
+//------------------------------------------------------------------------------
+bool stConcurrentPageManager::IsValidHeader(tHeader * header){
+
+   return (header->Magic[0] == 'D') &&
+         (header->Magic[1] == 'P') &&
+         (header->Magic[2] == 'M') &&
+         (header->Magic[3] == '1');
+}//end stConcurrentPageManager::IsValidHeader
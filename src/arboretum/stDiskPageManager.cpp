@@ -34,11 +34,13 @@
 //------------------------------------------------------------------------------
 stDiskPageManager::stDiskPageManager(const std::string & fName, u_int32_t pagesize,
       u_int32_t userHeaderSize,
-      int cacheNPages):fileName(fName){
+      int cacheNPages, bool checksum):fileName(fName){
 
    myStorage = new CStorage;
    this->pageSize = pagesize;
-   myStorage->Create(fileName.c_str(), pageSize, userHeaderSize, cacheNPages);
+   myStorage->Create(fileName.c_str(), pageSize, userHeaderSize, cacheNPages,
+         checksum);
+   bufferPool = NULL;
 
    // Instance cache with
    pageInstanceCache = new stPageInstanceCache(STDISKPAGEMANAGER_INSTANCECACHESIZE,
@@ -51,6 +53,7 @@ stDiskPageManager::stDiskPageManager(const std::string & fName):fileName(fName){
     this->myStorage = new CStorage();
     this->myStorage->Open(fileName.c_str());
     this->pageSize =  myStorage->GetPageSize();
+    this->bufferPool = NULL;
     // Instance cache with
     pageInstanceCache = new stPageInstanceCache(
             STDISKPAGEMANAGER_INSTANCECACHESIZE, new stPageAllocator(pageSize));
@@ -61,11 +64,16 @@ stDiskPageManager::~stDiskPageManager(){
 
    if (myStorage != 0){
       if (myStorage->IsOpened()){
+         if (bufferPool != NULL){
+            bufferPool->Flush();
+         }//end if
          myStorage->FlushCache();
          myStorage->Close();
       }//end if
    }//end if
    
+   delete bufferPool;
+   bufferPool = 0;
    delete pageInstanceCache;
    pageInstanceCache = 0;
    delete myStorage;
@@ -96,11 +104,16 @@ stPage * stDiskPageManager::GetPage(u_int32_t pageid){
    stPage * myPage;
 
    if ((int)pageid <= myStorage->GetTotalPagesIncludingDisposed()){
-      // Get from cache
-      myPage = pageInstanceCache->Get();
-      
-      myStorage->ReadPage(pageid-1, myPage->GetData());
-      myPage->SetPageID(pageid);
+      if (bufferPool != NULL){
+         // The pinned frame itself.
+         myPage = bufferPool->Get(pageid);
+      }else{
+         // Get from cache
+         myPage = pageInstanceCache->Get();
+
+         myStorage->ReadPage(pageid-1, myPage->GetData());
+         myPage->SetPageID(pageid);
+      }//end if
    
       // Update Counters
       UpdateReadCounter();
@@ -114,6 +127,11 @@ stPage * stDiskPageManager::GetPage(u_int32_t pageid){
 //------------------------------------------------------------------------------
 void stDiskPageManager::ReleasePage(stPage * page){
 
+   // Frames go back to the pool.
+   if ((bufferPool != NULL) && (bufferPool->Release(page))){
+      return;
+   }//end if
+
    // Put it back
    if (page->GetPageSize() == this->pageSize){
       pageInstanceCache->Put(page);
@@ -126,12 +144,16 @@ void stDiskPageManager::ReleasePage(stPage * page){
 //------------------------------------------------------------------------------
 stPage * stDiskPageManager::GetNewPage(){
    stPage * currentPage;
-   
-   // Get from cache
-   currentPage = pageInstanceCache->Get();
-   
-   u_int32_t newID = myStorage->InsertNewPage((void *)currentPage->GetData())+1;
-   currentPage->SetPageID(newID);
+
+   if (bufferPool != NULL){
+      currentPage = bufferPool->New();
+   }else{
+      // Get from cache
+      currentPage = pageInstanceCache->Get();
+
+      u_int32_t newID = myStorage->InsertNewPage((void *)currentPage->GetData())+1;
+      currentPage->SetPageID(newID);
+   }//end if
 
    // Update Counters
    UpdateWriteCounter();
@@ -143,7 +165,11 @@ stPage * stDiskPageManager::GetNewPage(){
 void stDiskPageManager::WritePage(stPage * page){
 
    // Write it but do not delete. It is not equal to ReleasePage.
-   myStorage->WritePage(page->GetPageID()-1, (void *) page->GetData());
+   if (bufferPool != NULL){
+      bufferPool->Write(page);
+   }else{
+      myStorage->WritePage(page->GetPageID()-1, (void *) page->GetData());
+   }//end if
 
    // Update Counters
    UpdateWriteCounter();
@@ -161,17 +187,35 @@ void stDiskPageManager::WriteHeaderPage(stPage * headerpage){
 //------------------------------------------------------------------------------
 void stDiskPageManager::DisposePage(stPage * page){
 
+   // Frames are disposed by the pool.
+   if ((bufferPool != NULL) && (bufferPool->Dispose(page))){
+      return;
+   }//end if
+
    myStorage->FreePage(page->GetPageID()-1);
 
    // Put it back
    pageInstanceCache->Put(page);
 }//end stDiskPageManager::DisposePage()
 
+//------------------------------------------------------------------------------
+void stDiskPageManager::Prefetch(const u_int32_t * pageIDs, u_int32_t n){
+   u_int32_t i;
+
+   for (i = 0; i < n; i++){
+      if ((pageIDs[i] != 0) &&
+            ((bufferPool == NULL) || (!bufferPool->Contains(pageIDs[i])))){
+         myStorage->Prefetch(pageIDs[i] - 1);
+      }//end if
+   }//end for
+}//end stDiskPageManager::Prefetch
+
 //------------------------------------------------------------------------------
 void stDiskPageManager::Create(const char *fName, int pagesize, int userHeaderSize, int cacheNPages){
 
    this->pageSize = pagesize;
    this->myStorage = new CStorage;
+   this->bufferPool = NULL;
    myStorage->Create(fName, pageSize, userHeaderSize, cacheNPages);
    ResetStatistics();
 
@@ -209,6 +253,9 @@ long stDiskPageManager::GetHeaderPageSize(){
 //------------------------------------------------------------------------------
 void stDiskPageManager::Flush(){
 
+   if (bufferPool != NULL){
+      bufferPool->Flush();
+   }//end if
    myStorage->FlushCache();
 }//end stDiskPageManager::Flush
 
@@ -217,8 +264,25 @@ void stDiskPageManager::ResetStatistics(){
    stPageManager::ResetStatistics();
 
    myStorage->ResetStatistics();
+   if (bufferPool != NULL){
+      bufferPool->ResetStatistics();
+   }//end if
 }//end stDiskPageManager::ResetStatistics()
 
+//------------------------------------------------------------------------------
+void stDiskPageManager::SetBufferPool(u_int64_t budget,
+      stBufferPool::tReplacementPolicy policy){
+
+   if (bufferPool != NULL){
+      bufferPool->Flush();
+      delete bufferPool;
+      bufferPool = NULL;
+   }//end if
+   if (budget > 0){
+      bufferPool = new stBufferPool(myStorage, pageSize, budget, policy);
+   }//end if
+}//end stDiskPageManager::SetBufferPool
+
 //------------------------------------------------------------------------------
 inline u_int32_t stDiskPageManager::GetDiskReadCount(){
 
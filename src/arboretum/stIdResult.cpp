@@ -0,0 +1,116 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**
+* @file
+*
+* This file implements the class stIdResult.
+*
+* @version 1.0
+*/
+#include <arboretum/stIdResult.h>
+
+#include <algorithm>
+
+//------------------------------------------------------------------------------
+// Local helpers
+//------------------------------------------------------------------------------
+namespace{
+
+/**
+* Orders the pairs by distance.
+*/
+struct stLessIdPair{
+   bool operator()(const stIdPair & p1, const stIdPair & p2) const{
+      return p1.GetDistance() < p2.GetDistance();
+   }
+};
+
+}//end namespace
+
+//==============================================================================
+// Class stIdResult
+//------------------------------------------------------------------------------
+void stIdResult::AddPair(u_int32_t oid, double distance){
+   stIdPair pair;
+
+   MakeHeap();
+   pair.OID = oid;
+   pair.Distance = distance;
+   Pairs.push_back(pair);
+   std::push_heap(Pairs.begin(), Pairs.end(), stLessIdPair());
+}//end stIdResult::AddPair
+
+//------------------------------------------------------------------------------
+double stIdResult::GetMinimumDistance(){
+   if (Pairs.empty()){
+      return -1;
+   }//end if
+   Sort();
+   return Pairs.front().Distance;
+}//end stIdResult::GetMinimumDistance
+
+//------------------------------------------------------------------------------
+void stIdResult::RemoveLast(){
+   if (!Pairs.empty()){
+      MakeHeap();
+      std::pop_heap(Pairs.begin(), Pairs.end(), stLessIdPair());
+      Pairs.pop_back();
+   }//end if
+}//end stIdResult::RemoveLast
+
+//------------------------------------------------------------------------------
+void stIdResult::Cut(unsigned int limit){
+   unsigned int ties;
+   double max;
+
+   MakeHeap();
+   while (Pairs.size() > limit){
+      if (Tie){
+         // Move all pairs with the greatest distance to the end.
+         max = Pairs.front().Distance;
+         ties = 0;
+         while ((ties < Pairs.size()) && (Pairs.front().Distance == max)){
+            std::pop_heap(Pairs.begin(), Pairs.end() - ties, stLessIdPair());
+            ties++;
+         }//end while
+         if (Pairs.size() - ties < limit){
+            // They are ties of the last pair. Keep them.
+            for (; ties > 0; ties--){
+               std::push_heap(Pairs.begin(), Pairs.end() - ties + 1, stLessIdPair());
+            }//end for
+            return;
+         }//end if
+         Pairs.resize(Pairs.size() - ties);
+      }else{
+         std::pop_heap(Pairs.begin(), Pairs.end(), stLessIdPair());
+         Pairs.pop_back();
+      }//end if
+   }//end while
+}//end stIdResult::Cut
+
+//------------------------------------------------------------------------------
+void stIdResult::MakeHeap(){
+   if (Sorted){
+      // A sorted array is a min-heap. Rebuild it as a max-heap.
+      std::make_heap(Pairs.begin(), Pairs.end(), stLessIdPair());
+      Sorted = false;
+   }//end if
+}//end stIdResult::MakeHeap
+
+//------------------------------------------------------------------------------
+void stIdResult::Sort(){
+   if (!Sorted){
+      std::sort_heap(Pairs.begin(), Pairs.end(), stLessIdPair());
+      Sorted = true;
+   }//end if
+}//end stIdResult::Sort
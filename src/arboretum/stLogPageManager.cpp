@@ -0,0 +1,373 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**
+* @file
+*
+* This file implements the class stLogPageManager.
+*
+* @version 1.0
+*/
+#include <arboretum/stLogPageManager.h>
+
+#include <cstring>
+
+//==============================================================================
+// stLogPageManager
+//------------------------------------------------------------------------------
+stLogPageManager::stLogPageManager(stPageManager * base, const char * logName,
+      u_int32_t groupSize, u_int64_t checkpointSize){
+
+   logFd = open(logName, O_CREAT|O_RDWR|O_BINARY, S_IREAD|S_IWRITE);
+   if (logFd < 0){
+      throw std::logic_error("Unable to open log file.");
+   }//end if
+
+   this->base = base;
+   this->groupSize = (groupSize == 0) ? 1 : groupSize;
+   this->checkpointSize = checkpointSize;
+   logSize = 0;
+   unsynced = 0;
+   batchDisposed = 0;
+   batchHeader = false;
+   dirtyHeader = false;
+   batchAllocated = false;
+
+   // The tree works on a private copy of the header.
+   baseHeader = base->GetHeaderPage();
+   headerPage = new stPage(baseHeader->GetPageSize(), 0);
+   headerPage->Copy(baseHeader);
+
+   // Redo
+   recovered = Recover();
+   Apply();
+}//end stLogPageManager::stLogPageManager
+
+//------------------------------------------------------------------------------
+stLogPageManager::~stLogPageManager(){
+   std::unordered_set<stPage *>::iterator i;
+
+   Checkpoint();
+   for (i = ownPages.begin(); i != ownPages.end(); i++){
+      delete *i;
+   }//end for
+   base->ReleasePage(baseHeader);
+   delete headerPage;
+   close(logFd);
+}//end stLogPageManager::~stLogPageManager
+
+//------------------------------------------------------------------------------
+stPage * stLogPageManager::GetHeaderPage(){
+
+   UpdateReadCounter();
+   return headerPage;
+}//end stLogPageManager::GetHeaderPage
+
+//------------------------------------------------------------------------------
+stPage * stLogPageManager::GetPage(u_int32_t pageid){
+   std::unordered_map<u_int32_t, stPage *>::iterator i;
+   stPage * page;
+
+   i = pages.find(pageid);
+   if (i != pages.end()){
+      page = new stPage(i->second->GetPageSize(), pageid);
+      page->Copy(i->second);
+      ownPages.insert(page);
+   }else{
+      page = base->GetPage(pageid);
+   }//end if
+   UpdateReadCounter();
+   return page;
+}//end stLogPageManager::GetPage
+
+//------------------------------------------------------------------------------
+void stLogPageManager::ReleasePage(stPage * page){
+
+   if (page == headerPage){
+      // Do nothing because it is the header page.
+   }else if (ownPages.erase(page) != 0){
+      delete page;
+   }else{
+      base->ReleasePage(page);
+   }//end if
+}//end stLogPageManager::ReleasePage
+
+//------------------------------------------------------------------------------
+stPage * stLogPageManager::GetNewPage(){
+
+   batchAllocated = true;
+   return base->GetNewPage();
+}//end stLogPageManager::GetNewPage
+
+//------------------------------------------------------------------------------
+void stLogPageManager::WritePage(stPage * page){
+
+   #ifdef __stDEBUG__
+   if (page->GetPageID() == 0){
+      throw invalid_argument("Do not use WritePage to write header pages.");
+   }//end if
+   #endif //__stDEBUG__
+
+   StoreImage(page->GetPageID(), page->GetData(), page->GetPageSize());
+   batch.insert(page->GetPageID());
+   UpdateWriteCounter();
+}//end stLogPageManager::WritePage
+
+//------------------------------------------------------------------------------
+void stLogPageManager::WriteHeaderPage(stPage * headerpage){
+
+   if (headerpage != headerPage){
+      headerPage->Copy(headerpage);
+   }//end if
+   batchHeader = true;
+   UpdateWriteCounter();
+}//end stLogPageManager::WriteHeaderPage
+
+//------------------------------------------------------------------------------
+void stLogPageManager::DisposePage(stPage * page){
+   std::unordered_map<u_int32_t, stPage *>::iterator i;
+
+   // The base will see it only after the checkpoint.
+   i = pages.find(page->GetPageID());
+   if (i != pages.end()){
+      delete i->second;
+      pages.erase(i);
+   }//end if
+   batch.erase(page->GetPageID());
+   disposed.push_back(page->GetPageID());
+   batchDisposed++;
+   ReleasePage(page);
+}//end stLogPageManager::DisposePage
+
+//------------------------------------------------------------------------------
+void stLogPageManager::Commit(){
+   std::unordered_set<u_int32_t>::iterator i;
+   stPage * page;
+   u_int32_t j;
+
+   if ((batch.empty()) && (!batchHeader) && (batchDisposed == 0)){
+      return;
+   }//end if
+
+   // Allocations must be durable before the log refers to them.
+   if (batchAllocated){
+      base->Flush();
+      batchAllocated = false;
+   }//end if
+
+   buffer.clear();
+   for (i = batch.begin(); i != batch.end(); i++){
+      page = pages[*i];
+      AppendRecord(rtPAGE, *i, page->GetData(), page->GetPageSize());
+   }//end for
+   if (batchHeader){
+      AppendRecord(rtHEADER, 0, headerPage->GetData(), headerPage->GetPageSize());
+   }//end if
+   for (j = disposed.size() - batchDisposed; j < disposed.size(); j++){
+      AppendRecord(rtDISPOSE, disposed[j], NULL, 0);
+   }//end for
+   AppendRecord(rtCOMMIT, 0, NULL, 0);
+
+   if (pwrite(logFd, buffer.data(), buffer.size(), logSize) != (ssize_t) buffer.size()){
+      throw std::logic_error("Unable to write the log.");
+   }//end if
+   logSize += buffer.size();
+   dirtyHeader = dirtyHeader || batchHeader;
+   batch.clear();
+   batchHeader = false;
+   batchDisposed = 0;
+
+   // Group commit
+   unsynced++;
+   if (unsynced >= groupSize){
+      Sync();
+   }//end if
+   if (logSize >= checkpointSize){
+      Apply();
+   }//end if
+}//end stLogPageManager::Commit
+
+//------------------------------------------------------------------------------
+void stLogPageManager::Sync(){
+
+   if (unsynced > 0){
+      #ifdef __linux__
+      fdatasync(logFd);
+      #else
+      fsync(logFd);
+      #endif //__linux__
+      unsynced = 0;
+   }//end if
+}//end stLogPageManager::Sync
+
+//------------------------------------------------------------------------------
+void stLogPageManager::AppendRecord(u_int32_t type, u_int32_t pageid,
+      const void * data, u_int32_t size){
+   tRecord record;
+   size_t offset = buffer.size();
+
+   record.Type = type;
+   record.PageID = pageid;
+   record.Size = size;
+   record.Checksum = 0;
+   record.Checksum = stChecksum::CRC32C(data, size,
+         stChecksum::CRC32C(&record, sizeof(record)));
+   buffer.resize(offset + sizeof(record) + size);
+   memcpy(buffer.data() + offset, &record, sizeof(record));
+   if (size > 0){
+      memcpy(buffer.data() + offset + sizeof(record), data, size);
+   }//end if
+}//end stLogPageManager::AppendRecord
+
+//------------------------------------------------------------------------------
+void stLogPageManager::StoreImage(u_int32_t pageid, const unsigned char * data,
+      u_int32_t size){
+   std::unordered_map<u_int32_t, stPage *>::iterator i;
+
+   i = pages.find(pageid);
+   if ((i != pages.end()) && (i->second->GetPageSize() != size)){
+      delete i->second;
+      pages.erase(i);
+      i = pages.end();
+   }//end if
+   if (i == pages.end()){
+      i = pages.insert(std::make_pair(pageid, new stPage(size, pageid))).first;
+   }//end if
+   memcpy(i->second->GetData(), data, size);
+}//end stLogPageManager::StoreImage
+
+//------------------------------------------------------------------------------
+void stLogPageManager::Apply(){
+   std::unordered_map<u_int32_t, stPage *>::iterator i;
+   stPage * page;
+   u_int32_t j;
+
+   // Committed pages
+   for (i = pages.begin(); i != pages.end(); i++){
+      page = base->GetPage(i->first);
+      if (page != NULL){
+         memcpy(page->GetData(), i->second->GetData(),
+               (page->GetPageSize() < i->second->GetPageSize()) ?
+               page->GetPageSize() : i->second->GetPageSize());
+         base->WritePage(page);
+         base->ReleasePage(page);
+      }//end if
+   }//end for
+   if (dirtyHeader){
+      baseHeader->Copy(headerPage);
+      base->WriteHeaderPage(baseHeader);
+   }//end if
+   base->Flush();
+
+   // Now the log is useless.
+   if (logSize > 0){
+      ftruncate(logFd, 0);
+      #ifdef __linux__
+      fdatasync(logFd);
+      #else
+      fsync(logFd);
+      #endif //__linux__
+      logSize = 0;
+   }//end if
+   unsynced = 0;
+
+   for (i = pages.begin(); i != pages.end(); i++){
+      delete i->second;
+   }//end for
+   pages.clear();
+   dirtyHeader = false;
+
+   // A crash here leaks these pages but never reuses a live one.
+   for (j = 0; j < disposed.size(); j++){
+      page = base->GetPage(disposed[j]);
+      if (page != NULL){
+         base->DisposePage(page);
+      }//end if
+   }//end for
+   if (!disposed.empty()){
+      disposed.clear();
+      base->Flush();
+   }//end if
+}//end stLogPageManager::Apply
+
+//------------------------------------------------------------------------------
+u_int32_t stLogPageManager::Recover(){
+   std::unordered_map<u_int32_t, stPage *>::iterator i;
+   std::vector<unsigned char> log;
+   std::vector<tRecord *> records;
+   tRecord * record;
+   u_int32_t checksum;
+   u_int32_t count = 0;
+   u_int64_t offset = 0;
+   u_int32_t j;
+   off_t size;
+
+   size = lseek(logFd, 0, SEEK_END);
+   if (size <= 0){
+      return 0;
+   }//end if
+   log.resize(size);
+   if (pread(logFd, log.data(), size, 0) != size){
+      return 0;
+   }//end if
+
+   // Read until the end or the first broken record.
+   while (offset + sizeof(tRecord) <= (u_int64_t) size){
+      record = (tRecord *)(log.data() + offset);
+      if (offset + sizeof(tRecord) + record->Size > (u_int64_t) size){
+         break;
+      }//end if
+      checksum = record->Checksum;
+      record->Checksum = 0;
+      if (checksum != stChecksum::CRC32C(log.data() + offset + sizeof(tRecord),
+            record->Size, stChecksum::CRC32C(record, sizeof(tRecord)))){
+         break;
+      }//end if
+      offset += sizeof(tRecord) + record->Size;
+
+      if (record->Type != rtCOMMIT){
+         records.push_back(record);
+      }else{
+         // The transaction is complete. Redo it.
+         for (j = 0; j < records.size(); j++){
+            record = records[j];
+            switch (record->Type){
+               case rtPAGE:
+                  StoreImage(record->PageID,
+                        ((unsigned char *) record) + sizeof(tRecord),
+                        record->Size);
+                  break;
+               case rtHEADER:
+                  if (record->Size == headerPage->GetPageSize()){
+                     memcpy(headerPage->GetData(),
+                           ((unsigned char *) record) + sizeof(tRecord),
+                           record->Size);
+                     dirtyHeader = true;
+                  }//end if
+                  break;
+               case rtDISPOSE:
+                  i = pages.find(record->PageID);
+                  if (i != pages.end()){
+                     delete i->second;
+                     pages.erase(i);
+                  }//end if
+                  disposed.push_back(record->PageID);
+                  break;
+            }//end switch
+         }//end for
+         records.clear();
+         count++;
+      }//end if
+   }//end while
+   logSize = size;
+   return count;
+}//end stLogPageManager::Recover
@@ -0,0 +1,417 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**
+* @file
+*
+* This file implements the class stMMapPageManager.
+*
+* @version 1.0
+*/
+#include <arboretum/stMMapPageManager.h>
+
+#include <sys/mman.h>
+
+/**
+* Number of instances in the page cache.
+*/
+#define STMMAPPAGEMANAGER_INSTANCECACHESIZE 16
+
+//==============================================================================
+// stMMapPageManager
+//------------------------------------------------------------------------------
+stMMapPageManager::stMMapPageManager(const char * fName, u_int32_t pagesize,
+      u_int64_t reserve){
+   tHeader tmpHeader;
+
+   // Open file
+   fd = open(fName, O_CREAT|O_TRUNC|O_RDWR|O_BINARY, S_IREAD|S_IWRITE); // New file with 0 bytes
+   if (fd < 0){
+      throw std::logic_error("Unable to create file.");
+   }//end if
+   readOnly = false;
+
+   // Header
+   NewHeader(&tmpHeader, pagesize);
+   this->headerPage = new stLockablePage(pagesize, sizeof(tHeader), 0);
+   this->header = (tHeader *)(this->headerPage->GetTrueData());
+   memcpy(this->header, &tmpHeader, sizeof(tHeader));
+   memset(this->headerPage->GetData(), 0, this->headerPage->GetPageSize());
+
+   // Mapping with room for the header page
+   fileSize = 0;
+   base = NULL;
+   try{
+      Map(reserve);
+      Grow(pagesize);
+   }catch (...){
+      Abort();
+      throw;
+   }//end try
+   WriteHeaderPage(headerPage);
+
+   // Page cache
+   pageInstanceCache = new stPageInstanceCache(STMMAPPAGEMANAGER_INSTANCECACHESIZE,
+         new stMappedPageAllocator());
+}//end stMMapPageManager::stMMapPageManager
+
+//------------------------------------------------------------------------------
+stMMapPageManager::stMMapPageManager(const char * fName, tAccessMode mode){
+   u_int64_t reserve = STMMAPPAGEMANAGER_DEFAULTRESERVE;
+   u_int64_t size;
+   tHeader tmpHeader;
+   struct stat st;
+
+   // Open file
+   readOnly = (mode == amReadOnly);
+   fd = open(fName, (readOnly ? O_RDONLY : O_RDWR)|O_BINARY); // Open file
+   if (fd < 0){
+      throw std::logic_error("Unable to open file.");
+   }//end if
+
+   // Validate file
+   if ((read(fd, &tmpHeader, sizeof(tmpHeader)) != sizeof(tmpHeader)) ||
+         (!IsValidHeader(&tmpHeader)) || (fstat(fd, &st) != 0)){
+      close(fd);
+      throw std::logic_error("invalid file.");
+   }//end if
+   fileSize = st.st_size;
+   this->headerPage = NULL;
+   base = NULL;
+
+   // stPlainDiskPageManager does not write the pages that were allocated but
+   // never written, so the file may end before its last page.
+   size = ((u_int64_t) tmpHeader.PageCount + 1) * tmpHeader.PageSize;
+   if (size < fileSize){
+      size = fileSize;
+   }//end if
+
+   // Map everything
+   if ((readOnly) || (reserve < size)){
+      reserve = size;
+   }//end if
+   try{
+      Map(reserve);
+      if (!readOnly){
+         Grow(size);
+      }//end if
+   }catch (...){
+      Abort();
+      throw;
+   }//end try
+
+   // Load the header.
+   this->headerPage = new stLockablePage(tmpHeader.PageSize, sizeof(tHeader), 0);
+   this->header = (tHeader *)(this->headerPage->GetTrueData());
+   memcpy((void*)this->headerPage->GetTrueData(), base, tmpHeader.PageSize);
+
+   // Page cache
+   pageInstanceCache = new stPageInstanceCache(STMMAPPAGEMANAGER_INSTANCECACHESIZE,
+         new stMappedPageAllocator());
+}//end stMMapPageManager::stMMapPageManager
+
+//------------------------------------------------------------------------------
+stMMapPageManager::~stMMapPageManager(){
+
+   // Free resources
+   delete pageInstanceCache;
+   if (readOnly){
+      munmap(base, mapSize);
+   }else{
+      // Save header page info.
+      WriteHeaderPage(headerPage);
+      // Release the mapping and remove the unused part of the last extent.
+      munmap(base, mapSize);
+      ftruncate(fd, PageID2Offset(header->PageCount + 1));
+   }//end if
+   // Delete header page.
+   delete this->headerPage;
+   // Close file
+   close(fd);
+}//end stMMapPageManager::~stMMapPageManager
+
+//------------------------------------------------------------------------------
+bool stMMapPageManager::IsEmpty(){
+
+   return header->UsedPages == 0;
+}//end stMMapPageManager::IsEmpty
+
+//------------------------------------------------------------------------------
+stPage * stMMapPageManager::GetHeaderPage(){
+
+   // Update read count
+   UpdateReadCounter();
+
+   return this->headerPage;
+}//end stMMapPageManager::GetHeaderPage
+
+//------------------------------------------------------------------------------
+stPage * stMMapPageManager::GetPage(u_int32_t pageid){
+   stMappedPage * myPage;
+
+   // Do not allow users to load header page from this file.
+   if ((pageid != 0) && (pageid <= header->PageCount)){
+
+      // Get from cache and point it to the mapping.
+      myPage = pageInstanceCache->Get();
+      myPage->Map(base + PageID2Offset(pageid), header->PageSize, pageid);
+
+      // Update Counters
+      UpdateReadCounter();
+      return myPage;
+   }else{
+      // Error!!!
+      #ifdef __stDEBUG__
+      throw invalid_argument("Invalid page ID.");
+      #else
+      return NULL;
+      #endif //__stDEBUG__
+   }//end if
+}//end stMMapPageManager::GetPage
+
+//------------------------------------------------------------------------------
+void stMMapPageManager::ReleasePage(stPage * page){
+
+   // The header page is not a view.
+   if (page != this->headerPage){
+      pageInstanceCache->Put((stMappedPage *) page);
+   }//end if
+}//end stMMapPageManager::ReleasePage
+
+//------------------------------------------------------------------------------
+stPage * stMMapPageManager::GetNewPage(){
+   u_int32_t * next;
+   stPage * page;
+
+   CheckWritable();
+   if (header->Available == 0){
+      // Creating the new page
+      Grow(PageID2Offset(header->PageCount + 2));
+      header->PageCount++;
+      page = GetPage(header->PageCount);
+   }else{
+      // Remove from free list
+      page = GetPage(header->Available);
+      next = (u_int32_t *)(page->GetData());
+      header->Available = * next;
+   }//end if
+
+   // Update header
+   header->UsedPages++;
+   UpdateHeader();
+
+   return page;
+}//end stMMapPageManager::GetNewPage
+
+//------------------------------------------------------------------------------
+void stMMapPageManager::WritePage(stPage * page){
+   unsigned char * data;
+
+   #ifdef __stDEBUG__
+   if (page->GetPageID() == 0){
+      throw invalid_argument("Do not use WritePage to write header pages.");
+   }//end if
+   #endif //__stDEBUG__
+   CheckWritable();
+
+   // Pages created by this page manager are already there.
+   data = base + PageID2Offset(page->GetPageID());
+   if (page->GetData() != data){
+      memcpy(data, page->GetData(), header->PageSize);
+   }//end if
+   UpdateWriteCounter();
+}//end stMMapPageManager::WritePage
+
+//------------------------------------------------------------------------------
+void stMMapPageManager::WriteHeaderPage(stPage * headerpage){
+
+   #ifdef __stDEBUG__
+   if (headerpage->GetPageID() != 0){
+      throw invalid_argument("Do not use WriteHeaderPage to write standard pages.");
+   }//end if
+   #endif //__stDEBUG__
+
+   // The private copy is all that changes in read-only mode.
+   if (!readOnly){
+      memcpy(base, this->headerPage->GetTrueData(), header->PageSize);
+   }//end if
+   UpdateWriteCounter();
+}//end stMMapPageManager::WriteHeaderPage
+
+//------------------------------------------------------------------------------
+void stMMapPageManager::DisposePage(stPage * page){
+   u_int32_t * next;
+
+   CheckWritable();
+   // Append to free list
+   next = (u_int32_t *)page->GetData();
+   *next = header->Available;
+   header->Available = page->GetPageID();
+   WritePage(page);
+
+   // Update header
+   header->UsedPages--;
+   UpdateHeader();
+
+   // Free resources
+   ReleasePage(page);
+}//end stMMapPageManager::DisposePage
+
+//------------------------------------------------------------------------------
+void stMMapPageManager::Prefetch(const u_int32_t * pageIDs, u_int32_t n){
+   unsigned char * start;
+   u_int64_t size;
+   u_int32_t i;
+
+   for (i = 0; i < n; i++){
+      if ((pageIDs[i] != 0) && (pageIDs[i] <= header->PageCount)){
+         GetSystemPages(pageIDs[i], start, size);
+         madvise(start, size, MADV_WILLNEED);
+      }//end if
+   }//end for
+}//end stMMapPageManager::Prefetch
+
+//------------------------------------------------------------------------------
+u_int32_t stMMapPageManager::LockPages(const u_int32_t * pageIDs, u_int32_t n){
+   unsigned char * start;
+   u_int64_t size;
+   u_int32_t i;
+
+   for (i = 0; i < n; i++){
+      if ((pageIDs[i] != 0) && (pageIDs[i] <= header->PageCount)){
+         GetSystemPages(pageIDs[i], start, size);
+         if (mlock(start, size) != 0){
+            // Limit reached.
+            return i;
+         }//end if
+      }//end if
+   }//end for
+   return n;
+}//end stMMapPageManager::LockPages
+
+//------------------------------------------------------------------------------
+void stMMapPageManager::Flush(){
+
+   if (!readOnly){
+      UpdateHeader();
+      msync(base, fileSize, MS_SYNC);
+   }//end if
+}//end stMMapPageManager::Flush
+
+//------------------------------------------------------------------------------
+void stMMapPageManager::GetSystemPages(u_int32_t pageid, unsigned char * & start,
+      u_int64_t & size){
+   u_int64_t first;
+   u_int64_t end;
+
+   first = PageID2Offset(pageid);
+   end = first + header->PageSize;
+   first = first & ~((u_int64_t) sysconf(_SC_PAGESIZE) - 1);
+   start = base + first;
+   size = end - first;
+}//end stMMapPageManager::GetSystemPages
+
+//------------------------------------------------------------------------------
+void stMMapPageManager::Map(u_int64_t reserve){
+   void * addr;
+
+   if ((readOnly) && (fileSize < reserve)){
+      // A read-only file can not grow. The pages after its end are read from
+      // an anonymous mapping, so they read as zeroes.
+      addr = mmap(NULL, reserve, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if ((addr != MAP_FAILED) && (fileSize > 0) &&
+            (mmap(addr, fileSize, PROT_READ, MAP_SHARED | MAP_FIXED, fd, 0) ==
+            MAP_FAILED)){
+         munmap(addr, reserve);
+         addr = MAP_FAILED;
+      }//end if
+   }else{
+      // The mapping may be larger than the file. Only the bytes inside the
+      // file are touched.
+      addr = mmap(NULL, reserve, readOnly ? PROT_READ : PROT_READ | PROT_WRITE,
+            MAP_SHARED, fd, 0);
+   }//end if
+   if (addr == MAP_FAILED){
+      throw std::logic_error("Unable to map file.");
+   }//end if
+   base = (unsigned char *) addr;
+   mapSize = reserve;
+}//end stMMapPageManager::Map
+
+//------------------------------------------------------------------------------
+void stMMapPageManager::Abort(){
+
+   if (base != NULL){
+      munmap(base, mapSize);
+      base = NULL;
+   }//end if
+   delete this->headerPage;
+   this->headerPage = NULL;
+   close(fd);
+}//end stMMapPageManager::Abort
+
+//------------------------------------------------------------------------------
+void stMMapPageManager::Grow(u_int64_t size){
+   u_int64_t newSize;
+
+   if (size > fileSize){
+      // Grow one extent at least.
+      newSize = fileSize + STMMAPPAGEMANAGER_EXTENTSIZE;
+      if (newSize < size){
+         newSize = size;
+      }//end if
+
+      // The mapping can not move because the pages point into it.
+      if (newSize > mapSize){
+         #ifdef __linux__
+         if (mremap(base, mapSize, newSize, 0) == MAP_FAILED){
+            throw std::logic_error("Unable to grow the file mapping.");
+         }//end if
+         mapSize = newSize;
+         #else
+         throw std::logic_error("Unable to grow the file mapping.");
+         #endif //__linux__
+      }//end if
+
+      if (ftruncate(fd, newSize) != 0){
+         throw std::logic_error("Unable to grow the file.");
+      }//end if
+      fileSize = newSize;
+   }//end if
+}//end stMMapPageManager::Grow
+
+//------------------------------------------------------------------------------
+void stMMapPageManager::NewHeader(tHeader * header, u_int32_t pagesize){
+
+   // Magic header. Always "DPM1".
+   header->Magic[0] = 'D';
+   header->Magic[1] = 'P';
+   header->Magic[2] = 'M';
+   header->Magic[3] = '1';
+
+   // Organization
+   header->PageSize = pagesize;
+
+   // Page control
+   header->PageCount = 0;
+   header->UsedPages = 0;
+   header->Available = 0;
+}//end stMMapPageManager::NewHeader
+
+//------------------------------------------------------------------------------
+bool stMMapPageManager::IsValidHeader(tHeader * header){
+
+   return (header->Magic[0] == 'D') &&
+         (header->Magic[1] == 'P') &&
+         (header->Magic[2] == 'M') &&
+         (header->Magic[3] == '1');
+}//end stMMapPageManager::IsValidHeader
@@ -30,7 +30,8 @@
 //==============================================================================
 // stPlainDiskPageManager
 //------------------------------------------------------------------------------
-stPlainDiskPageManager::stPlainDiskPageManager(const char * fName, u_int32_t pagesize){
+stPlainDiskPageManager::stPlainDiskPageManager(const char * fName, u_int32_t pagesize,
+      bool checksum){
 
    // Open file
    fd = open(fName, O_CREAT|O_TRUNC|O_RDWR|O_BINARY, S_IREAD|S_IWRITE); // New file with 0 bytes
@@ -39,14 +40,17 @@ stPlainDiskPageManager::stPlainDiskPageManager(const char * fName, u_int32_t pag
    }//end if
 
    // Initialize fields.
+   this->headerInterval = 0;
+   this->headerChanges = 0;
+   this->syncOnFlush = false;
    this->headerPage = new stLockablePage(pagesize, sizeof(tHeader), 0);
    this->header = (tHeader *)(this->headerPage->GetTrueData());
-   NewHeader(this->header, pagesize);
+   NewHeader(this->header, pagesize, checksum);
    WriteHeaderPage(headerPage);
 
    // Page cache
    pageInstanceCache = new stPageInstanceCache(STDISKPAGEMANAGER_INSTANCECACHESIZE,
-         new stPageAllocator(pagesize));      
+         new stPageAllocator(pagesize, GetChecksumSize()));      
 }//end stPlainDiskPageManager::stPlainDiskPageManager
 //------------------------------------------------------------------------------
 
@@ -69,6 +73,9 @@ stPlainDiskPageManager::stPlainDiskPageManager(const char * fName){
    // stLockablePage documentation for further info.
       
    // Ok, now I must reload the header again. I can not use
+   this->headerInterval = 0;
+   this->headerChanges = 0;
+   this->syncOnFlush = false;
    this->headerPage = new stLockablePage(tmpHeader.PageSize, sizeof(tHeader), 0);
    this->header = (tHeader *)(this->headerPage->GetTrueData());
 
@@ -83,7 +90,7 @@ stPlainDiskPageManager::stPlainDiskPageManager(const char * fName){
 
    // Page cache   
    pageInstanceCache = new stPageInstanceCache(STDISKPAGEMANAGER_INSTANCECACHESIZE,
-         new stPageAllocator(header->PageSize));      
+         new stPageAllocator(header->PageSize, GetChecksumSize()));      
 }//end stPlainDiskPageManager::stPlainDiskPageManager
 
 //------------------------------------------------------------------------------
@@ -93,6 +100,9 @@ stPlainDiskPageManager::~stPlainDiskPageManager(){
    delete pageInstanceCache;
    // Save header page info.
    WriteHeaderPage(headerPage);
+   if (syncOnFlush){
+      Flush();
+   }//end if
    // Delete header page.
    delete this->headerPage;
    // Close file
@@ -110,6 +120,11 @@ stPage * stPlainDiskPageManager::GetHeaderPage(){
    
    // Update read count
    UpdateReadCounter();
+
+   // Deferred changes must not be lost by the read below.
+   if (headerChanges > 0){
+      WriteHeaderPage(headerPage);
+   }//end if
    
    // Effective read
    lseek(fd, 0, SEEK_SET);  
@@ -130,8 +145,15 @@ stPage * stPlainDiskPageManager::GetPage(u_int32_t pageid){
       
       // Read data...
       lseek(fd, PageID2Offset(pageid), SEEK_SET);
-      read(fd, myPage->GetData(), header->PageSize);
-      myPage->SetPageID(pageid);
+      if (HasChecksum()){
+         read(fd, (void *)((stLockablePage *) myPage)->GetTrueData(),
+               header->PageSize);
+         myPage->SetPageID(pageid);
+         VerifyChecksum((stLockablePage *) myPage);
+      }else{
+         read(fd, myPage->GetData(), header->PageSize);
+         myPage->SetPageID(pageid);
+      }//end if
    
       // Update Counters
       UpdateReadCounter();
@@ -150,7 +172,7 @@ stPage * stPlainDiskPageManager::GetPage(u_int32_t pageid){
 void stPlainDiskPageManager::ReleasePage(stPage * page){
    
    // Put it back
-   if (page->GetPageSize() == header->PageSize){
+   if ((page != headerPage) && (page->GetPageSize() == GetMinimumPageSize())){
       pageInstanceCache->Put(page);
    }else if (page->GetPageID() != 0){
       delete page;
@@ -180,7 +202,7 @@ stPage * stPlainDiskPageManager::GetNewPage(){
    
    // Update header
    header->UsedPages++;
-   WriteHeaderPage(headerPage);
+   HeaderChanged();
    
    return page;   
 }//end stPlainDiskPageManager::GetNewPage
@@ -195,7 +217,20 @@ void stPlainDiskPageManager::WritePage(stPage * page){
    #endif //__stDEBUG__
 
    lseek(fd, PageID2Offset(page->GetPageID()), SEEK_SET);
-   write(fd, page->GetData(), header->PageSize);      
+   if (HasChecksum()){
+      // Only our pages have room for the checksum before their data.
+      stLockablePage * lPage = dynamic_cast<stLockablePage *>(page);
+      if ((lPage == NULL) ||
+            (lPage->GetPageSize() + GetChecksumSize() != header->PageSize)){
+         throw std::invalid_argument("The page was not created by this page manager.");
+      }//end if
+      u_int32_t crc = PageChecksum(lPage);
+
+      memcpy((void *) lPage->GetTrueData(), &crc, sizeof(crc));
+      write(fd, lPage->GetTrueData(), header->PageSize);
+   }else{
+      write(fd, page->GetData(), header->PageSize);
+   }//end if
    UpdateWriteCounter();
 }//end stPlainDiskPageManager::WritePage
 
@@ -210,9 +245,34 @@ void stPlainDiskPageManager::WriteHeaderPage(stPage * headerpage){
    
    lseek(fd, 0, SEEK_SET);
    write(fd, this->headerPage->GetTrueData(), header->PageSize);
+   headerChanges = 0;
    UpdateWriteCounter();
 }//end stPlainDiskPageManager::WriteHeaderPage
 
+//------------------------------------------------------------------------------
+void stPlainDiskPageManager::SetDeferredHeader(u_int32_t interval, bool sync){
+
+   // Pending changes follow the old rules.
+   Flush();
+   headerInterval = interval;
+   syncOnFlush = sync;
+}//end stPlainDiskPageManager::SetDeferredHeader
+
+//------------------------------------------------------------------------------
+void stPlainDiskPageManager::Flush(){
+
+   if (headerChanges > 0){
+      WriteHeaderPage(headerPage);
+   }//end if
+   if (syncOnFlush){
+      #ifdef __linux__
+      fdatasync(fd);
+      #else
+      fsync(fd);
+      #endif //__linux__
+   }//end if
+}//end stPlainDiskPageManager::Flush
+
 //------------------------------------------------------------------------------
 void stPlainDiskPageManager::DisposePage(stPage * page){
    u_int32_t * next;
@@ -225,20 +285,62 @@ void stPlainDiskPageManager::DisposePage(stPage * page){
 
    // Update header   
    header->UsedPages--;
-   WriteHeaderPage(headerPage);
+   HeaderChanged();
    
    // Free resources
    ReleasePage(page);
 }//end stPlainDiskPageManager::DisposePage
 
 //------------------------------------------------------------------------------
-void stPlainDiskPageManager::NewHeader(tHeader * header, u_int32_t pagesize){
+void stPlainDiskPageManager::Prefetch(const u_int32_t * pageIDs, u_int32_t n){
+   #ifdef POSIX_FADV_WILLNEED
+   u_int32_t i;
+   u_int32_t first;
+   u_int32_t count;
+
+   i = 0;
+   while (i < n){
+      // Find a run of consecutive pages.
+      first = pageIDs[i];
+      count = 1;
+      i++;
+      while ((i < n) && (pageIDs[i] == first + count)){
+         count++;
+         i++;
+      }//end while
+      if ((first != 0) && (first + count - 1 <= header->PageCount)){
+         posix_fadvise(fd, (off_t) PageID2Offset(first),
+               (off_t) count * header->PageSize, POSIX_FADV_WILLNEED);
+      }//end if
+   }//end while
+   #endif //POSIX_FADV_WILLNEED
+}//end stPlainDiskPageManager::Prefetch
+
+//------------------------------------------------------------------------------
+void stPlainDiskPageManager::VerifyChecksum(stLockablePage * page){
+   u_int32_t crc;
+   u_int32_t i;
+
+   memcpy(&crc, page->GetTrueData(), sizeof(crc));
+   if (crc != PageChecksum(page)){
+      // Pages allocated but never written are blank.
+      for (i = 0; i < header->PageSize; i++){
+         if (page->GetTrueData()[i] != 0){
+            throw std::logic_error("Page checksum mismatch.");
+         }//end if
+      }//end for
+   }//end if
+}//end stPlainDiskPageManager::VerifyChecksum
+
+//------------------------------------------------------------------------------
+void stPlainDiskPageManager::NewHeader(tHeader * header, u_int32_t pagesize,
+      bool checksum){
    
-   // Magic header. Always "DPM1".
+   // Magic header. "DPM1" or "DPMC".
    header->Magic[0] = 'D';
    header->Magic[1] = 'P';
    header->Magic[2] = 'M';
-   header->Magic[3] = '1';
+   header->Magic[3] = checksum ? 'C' : '1';
 
    // Organization
    header->PageSize = pagesize;
@@ -255,6 +357,6 @@ bool stPlainDiskPageManager::IsValidHeader(tHeader * header){
    return (header->Magic[0] == 'D') &&
          (header->Magic[1] == 'P') &&
          (header->Magic[2] == 'M') &&
-         (header->Magic[3] == '1'); 
+         ((header->Magic[3] == '1') || (header->Magic[3] == 'C')); 
 }//end stPlainDiskPageManager::IsValidHeader
 //------------------------------------------------------------------------------
@@ -22,6 +22,12 @@
 */
 #include <arboretum/stSlimNode.h>
 
+/**
+* Maximum number of bytes added by stSlimIndexNode::Compress() to the used
+* size of an index node.
+*/
+#define STSLIMNODE_INDEXCODECOVERHEAD 16
+
 //------------------------------------------------------------------------------
 // class stSlimNode
 //------------------------------------------------------------------------------
@@ -34,6 +40,7 @@ stSlimNode * stSlimNode::CreateNode(stPage * page){
          // Create an index page
          return new stSlimIndexNode(page, false);
       case LEAF:
+      case CODEDLEAF:
          // Create a leaf page
          return new stSlimLeafNode(page, false);
       default:
@@ -215,9 +222,63 @@ u_int32_t stSlimIndexNode::GetFree(){
          (Page->GetPageSize() - Entries[GetNumberOfEntries() - 1].Offset);
    }//end if
 
+   // Compact storage
+   if (Page->GetStorageSize() < Page->GetPageSize()){
+      if (Page->GetStorageSize() < usedsize + STSLIMNODE_INDEXCODECOVERHEAD){
+         return 0;
+      }else{
+         return Page->GetStorageSize() - usedsize - STSLIMNODE_INDEXCODECOVERHEAD;
+      }//end if
+   }//end if
+
    return Page->GetPageSize() - usedsize;
 }//end stSlimIndexNode::GetFree()
 
+//------------------------------------------------------------------------------
+void stSlimIndexNode::Compress(stCompressor & out){
+   u_int32_t n = GetNumberOfEntries();
+   u_int32_t objSize;
+
+   out.WriteVarUInt(n);
+   out.WriteVarUInt(Page->GetPageSize());
+   if (n > 0){
+      objSize = Page->GetPageSize() - Entries[n - 1].Offset;
+      out.Write((unsigned char *) Entries, n * sizeof(stSlimIndexEntry));
+      out.WriteVarUInt(objSize);
+      out.Write(Page->GetData() + Entries[n - 1].Offset, objSize);
+   }//end if
+}//end stSlimIndexNode::Compress
+
+//------------------------------------------------------------------------------
+void stSlimIndexNode::Decompress(stDecompressor & in){
+   u_int32_t n;
+   u_int32_t oldSize;
+   u_int32_t objSize;
+   u_int32_t i;
+
+   n = in.ReadVarUInt();
+   oldSize = in.ReadVarUInt();
+   if (n > 0){
+      if (sizeof(stSlimNodeHeader) + n * sizeof(stSlimIndexEntry) >
+            Page->GetPageSize()){
+         throw std::logic_error("The compressed node does not fit in the page.");
+      }//end if
+      in.Read((unsigned char *) Entries, n * sizeof(stSlimIndexEntry));
+      objSize = in.ReadVarUInt();
+      if (sizeof(stSlimNodeHeader) + n * sizeof(stSlimIndexEntry) + objSize >
+            Page->GetPageSize()){
+         throw std::logic_error("The compressed node does not fit in the page.");
+      }//end if
+      in.Read(Page->GetData() + Page->GetPageSize() - objSize, objSize);
+
+      // Offsets are relative to the end of the page.
+      for (i = 0; i < n; i++){
+         Entries[i].Offset = Entries[i].Offset + Page->GetPageSize() - oldSize;
+      }//end for
+   }//end if
+   Header->Occupation = n;
+}//end stSlimIndexNode::Decompress
+
 //------------------------------------------------------------------------------
 double stSlimIndexNode::GetMinimumRadius(){
    double minRadius = 0;
@@ -251,21 +312,37 @@ u_int32_t stSlimIndexNode::GetTotalObjectCount(){
 //------------------------------------------------------------------------------
 // class stSlimLeafNode
 //------------------------------------------------------------------------------
-stSlimLeafNode::stSlimLeafNode(stPage * page, bool create):
+stSlimLeafNode::stSlimLeafNode(stPage * page, bool create, u_int32_t codeSize):
       stSlimNode(page){
 
-   // Attention to this manouver! It is the brain of this
-   // implementation.
-   Entries = (stSlimLeafEntry*)(page->GetData() + sizeof(stSlimNodeHeader));
-
    // Initialize page
    if (create){
       #ifdef __stDEBUG__
       Page->Clear();
       #endif //__stDEBUG__
-      this->Header->Type = LEAF;
       this->Header->Occupation = 0;
+      if (codeSize > 0){
+         this->Header->Type = CODEDLEAF;
+         memcpy(page->GetData() + sizeof(stSlimNodeHeader), &codeSize,
+                sizeof(u_int32_t));
+      }else{
+         this->Header->Type = LEAF;
+      }//end if
+   }//end if
+
+   // The size of the codes follows the header.
+   CodeSize = 0;
+   if (this->Header->Type == CODEDLEAF){
+      memcpy(&CodeSize, page->GetData() + HeaderSize, sizeof(u_int32_t));
+      HeaderSize += sizeof(u_int32_t);
    }//end if
+   EntrySize = sizeof(stSlimLeafEntry) + CodeSize;
+
+   // Attention to this manouver! It is the brain of this
+   // implementation.
+   Entries = page->GetData() + HeaderSize;
+   CompressedBits = 0;
+   CompressedCount = 0;
 }//end stSlimLeafNode::stSlimLeafNode()
 
 //------------------------------------------------------------------------------
@@ -279,7 +356,7 @@ int stSlimLeafNode::AddEntry(u_int32_t size, const unsigned char * object){
    #endif //__stDEBUG__
 
    // Does it fit ?
-   entrySize = size + sizeof(stSlimLeafEntry);
+   entrySize = size + EntrySize;
    if (entrySize > this->GetFree()){
       // No, it doesn't.
       return -1;
@@ -291,16 +368,35 @@ int stSlimLeafNode::AddEntry(u_int32_t size, const unsigned char * object){
    // node. The idea is to put the object of an entry in the reverse order
    // in the data array.
    if (Header->Occupation == 0){
-      Entries[Header->Occupation].Offset = Page->GetPageSize() - size;
+      Entry(Header->Occupation).Offset = Page->GetPageSize() - size;
    }else{
-      Entries[Header->Occupation].Offset = Entries[Header->Occupation - 1].Offset - size;
+      Entry(Header->Occupation).Offset = Entry(Header->Occupation - 1).Offset - size;
    }//end if
-   memcpy((void *)(Page->GetData() + Entries[Header->Occupation].Offset),
+   memcpy((void *)(Page->GetData() + Entry(Header->Occupation).Offset),
           (void *)object, size);
+   // The codes are written by the tree.
+   memset(Entries + (Header->Occupation * EntrySize) + sizeof(stSlimLeafEntry),
+          0, CodeSize);
 
    // Update # of entries
    Header->Occupation++; // One more!
 
+   // RemoveAll() may have dropped the sized entries.
+   if (CompressedCount >= Header->Occupation){
+      CompressedBits = 0;
+      CompressedCount = 0;
+   }//end if
+
+   // The compact form must fit in the storage. The cost of the new entry
+   // depends only on the previous one, so only it is sized.
+   if ((Page->GetStorageSize() < Page->GetPageSize()) &&
+         (GetCompressedSize() > Page->GetStorageSize())){
+      CompressedBits -= GetEntryCompressedBits(Header->Occupation - 1);
+      CompressedCount--;
+      Header->Occupation--;
+      return -1;
+   }//end if
+
    return Header->Occupation - 1;
 }//end stSlimLeafNode::AddEntry()
 
@@ -313,7 +409,7 @@ int stSlimLeafNode::GetRepresentativeEntry(){
    i = 0;
    stop = (i == Header->Occupation);
    while (!stop){
-      if (Entries[i].Distance == 0.0){
+      if (Entry(i).Distance == 0.0){
          // Found!
          stop = true;
       }else{
@@ -342,7 +438,7 @@ const unsigned char * stSlimLeafNode::GetObject(u_int32_t idx){
    }//end if
    #endif //__stDEBUG__
 
-   return Page->GetData() + Entries[idx].Offset;
+   return Page->GetData() + Entry(idx).Offset;
 }//end stSlimLeafNode::GetObject()
 
 //------------------------------------------------------------------------------
@@ -355,10 +451,10 @@ u_int32_t stSlimLeafNode::GetObjectSize(u_int32_t idx){
 
    if (idx == 0){
       // First object
-      return Page->GetPageSize() - Entries[0].Offset;
+      return Page->GetPageSize() - Entry(0).Offset;
    }else{
       // Any other
-      return Entries[idx - 1].Offset - Entries[idx].Offset;
+      return Entry(idx - 1).Offset - Entry(idx).Offset;
    }//end if
 }//end stSlimLeafIndexNode::GetObjectSize()
 
@@ -390,23 +486,26 @@ void stSlimLeafNode::RemoveEntry(u_int32_t idx){
       // it handles the overlap between src and dst. Remember that src is the
       // offset of the last object and the dst is the offset of the last
       // object plus removed object size.
-      memmove(Page->GetData() + Entries[lastID].Offset + rObjSize,
-              Page->GetData() + Entries[lastID].Offset,
-              Entries[idx].Offset - Entries[lastID].Offset);
+      memmove(Page->GetData() + Entry(lastID).Offset + rObjSize,
+              Page->GetData() + Entry(lastID).Offset,
+              Entry(idx).Offset - Entry(lastID).Offset);
 
       // Let's move entries...
       for (i = idx; i < lastID; i++){
          // Copy all fields with memcpy (it's faster than field copy).
-         memcpy(Entries + i, Entries + i + 1, sizeof(stSlimLeafEntry));
+         memcpy(&Entry(i), &Entry(i + 1), EntrySize);
 
          // Update offset by adding the removed object size to it. It will
          // reflect the previous move operation.
-         Entries[i].Offset += rObjSize;
+         Entry(i).Offset += rObjSize;
       }//end for
    }//end if
 
    // Update counter...
    Header->Occupation--;
+   // The next entry is now compared with another one.
+   CompressedBits = 0;
+   CompressedCount = 0;
 }//end stSlimLeafNode::RemoveEntry
 
 //------------------------------------------------------------------------------
@@ -428,17 +527,296 @@ u_int32_t stSlimLeafNode::GetFree(){
    u_int32_t usedSize;
 
    // Fixed size
-   usedSize = sizeof(stSlimNodeHeader);
+   usedSize = HeaderSize;
 
    // Entries
    if (GetNumberOfEntries() > 0){
 
       usedSize +=
          // Total size of entries
-         (sizeof(stSlimLeafEntry) * GetNumberOfEntries()) +
+         (EntrySize * GetNumberOfEntries()) +
          // Total object size
-         (Page->GetPageSize() - Entries[GetNumberOfEntries() - 1].Offset);
+         (Page->GetPageSize() - Entry(GetNumberOfEntries() - 1).Offset);
    }//end if
 
    return Page->GetPageSize() - usedSize;
 }//end stSlimLeafNode::GetFree()
+
+//------------------------------------------------------------------------------
+void stSlimLeafNode::Compress(stCompressor & out){
+   const unsigned char * obj;
+   const unsigned char * prev = NULL;
+   u_int32_t prevSize = 0;
+   u_int32_t size;
+   u_int32_t common;
+   u_int32_t diffBits;
+   u_int32_t i;
+   u_int32_t j;
+
+   out.WriteVarUInt(GetNumberOfEntries());
+   for (i = 0; i < GetNumberOfEntries(); i++){
+      out.Write((unsigned char *) &(Entry(i).Distance), sizeof(double));
+      out.Write(GetLeafCode(i), CodeSize);
+
+      // Size
+      size = GetObjectSize(i);
+      if (i == 0){
+         out.WriteVarUInt(size);
+      }else if (size == prevSize){
+         out.WriteUInt(0, 1);
+      }else{
+         out.WriteUInt(1, 1);
+         out.WriteVarUInt(size);
+      }//end if
+
+      // Object
+      obj = GetObject(i);
+      if (prev != NULL){
+         common = (size < prevSize) ? size : prevSize;
+         diffBits = common;
+         for (j = 0; j < common; j++){
+            if (obj[j] != prev[j]){
+               diffBits += 8;
+            }//end if
+         }//end for
+         if (diffBits < common * 8){
+            // Difference to the previous object.
+            out.WriteUInt(1, 1);
+            for (j = 0; j < common; j++){
+               if (obj[j] == prev[j]){
+                  out.WriteUInt(0, 1);
+               }else{
+                  out.WriteUInt(1, 1);
+                  out.WriteUInt(obj[j] ^ prev[j], 8);
+               }//end if
+            }//end for
+            out.Write((unsigned char *) obj + common, size - common);
+         }else{
+            out.WriteUInt(0, 1);
+            out.Write((unsigned char *) obj, size);
+         }//end if
+      }else{
+         out.Write((unsigned char *) obj, size);
+      }//end if
+      prev = obj;
+      prevSize = size;
+   }//end for
+}//end stSlimLeafNode::Compress
+
+//------------------------------------------------------------------------------
+void stSlimLeafNode::Decompress(stDecompressor & in){
+   unsigned char * obj;
+   unsigned char * prev = NULL;
+   u_int32_t prevSize = 0;
+   u_int32_t size = 0;
+   u_int32_t common;
+   u_int32_t offset;
+   u_int32_t limit;
+   u_int32_t n;
+   u_int32_t i;
+   u_int32_t j;
+
+   n = in.ReadVarUInt();
+   if (n > (Page->GetPageSize() - HeaderSize) / EntrySize){
+      throw std::logic_error("The compressed node does not fit in the page.");
+   }//end if
+   limit = HeaderSize + n * EntrySize;
+   offset = Page->GetPageSize();
+   for (i = 0; i < n; i++){
+      in.Read((unsigned char *) &(Entry(i).Distance), sizeof(double));
+      in.Read(Entries + (i * EntrySize) + sizeof(stSlimLeafEntry), CodeSize);
+
+      // Size
+      if ((i == 0) || (in.ReadUInt(1) == 1)){
+         size = in.ReadVarUInt();
+      }//end if
+      if (size > offset - limit){
+         throw std::logic_error("The compressed node does not fit in the page.");
+      }//end if
+      offset -= size;
+      Entry(i).Offset = offset;
+
+      // Object
+      obj = Page->GetData() + offset;
+      if ((prev != NULL) && (in.ReadUInt(1) == 1)){
+         common = (size < prevSize) ? size : prevSize;
+         for (j = 0; j < common; j++){
+            if (in.ReadUInt(1) == 0){
+               obj[j] = prev[j];
+            }else{
+               obj[j] = prev[j] ^ (unsigned char) in.ReadUInt(8);
+            }//end if
+         }//end for
+         in.Read(obj + common, size - common);
+      }else{
+         in.Read(obj, size);
+      }//end if
+      prev = obj;
+      prevSize = size;
+   }//end for
+   Header->Occupation = n;
+   CompressedBits = 0;
+   CompressedCount = 0;
+}//end stSlimLeafNode::Decompress
+
+//------------------------------------------------------------------------------
+u_int32_t stSlimLeafNode::GetCompressedSize(){
+   u_int32_t bits;
+   u_int32_t i;
+
+   // RemoveAll() may have dropped the sized entries.
+   if (CompressedCount > GetNumberOfEntries()){
+      CompressedBits = 0;
+      CompressedCount = 0;
+   }//end if
+
+   // Sizes the entries added since the last call.
+   for (i = CompressedCount; i < GetNumberOfEntries(); i++){
+      CompressedBits += GetEntryCompressedBits(i);
+   }//end for
+   CompressedCount = GetNumberOfEntries();
+
+   // Same rounding as stCompressor::GetDataSize(). The size of the codes
+   // is written by stSlimPageCodec.
+   bits = GetVarUIntBits(GetNumberOfEntries()) + CompressedBits;
+   if (CodeSize > 0){
+      bits += GetVarUIntBits(CodeSize);
+   }//end if
+   return (bits >> 3) + ((bits & 0x7) ? 1 : 0);
+}//end stSlimLeafNode::GetCompressedSize
+
+//------------------------------------------------------------------------------
+u_int32_t stSlimLeafNode::GetEntryCompressedBits(u_int32_t idx){
+   const unsigned char * obj;
+   const unsigned char * prev;
+   u_int32_t prevSize;
+   u_int32_t size;
+   u_int32_t common;
+   u_int32_t diffBits;
+   u_int32_t bits;
+   u_int32_t j;
+
+   // Distance and codes
+   bits = (sizeof(double) + CodeSize) * 8;
+   size = GetObjectSize(idx);
+   if (idx == 0){
+      return bits + GetVarUIntBits(size) + (size * 8);
+   }//end if
+
+   // Size
+   prevSize = GetObjectSize(idx - 1);
+   if (size == prevSize){
+      bits += 1;
+   }else{
+      bits += 1 + GetVarUIntBits(size);
+   }//end if
+
+   // Object. See Compress().
+   obj = GetObject(idx);
+   prev = GetObject(idx - 1);
+   common = (size < prevSize) ? size : prevSize;
+   diffBits = common;
+   for (j = 0; j < common; j++){
+      if (obj[j] != prev[j]){
+         diffBits += 8;
+      }//end if
+   }//end for
+   if (diffBits < common * 8){
+      return bits + 1 + diffBits + ((size - common) * 8);
+   }else{
+      return bits + 1 + (size * 8);
+   }//end if
+}//end stSlimLeafNode::GetEntryCompressedBits
+
+//------------------------------------------------------------------------------
+// class stSlimPageCodec
+//------------------------------------------------------------------------------
+u_int32_t stSlimPageCodec::Encode(stPage * page, unsigned char * dst,
+      u_int32_t size){
+   stSlimNode * node;
+   unsigned char format;
+   u_int32_t n;
+
+   out.Reset();
+   node = stSlimNode::CreateNode(page);
+   if (node == NULL){
+      // Not a node. Drop the trailing zeroes.
+      n = page->GetPageSize();
+      while ((n > 0) && (page->GetData()[n - 1] == 0)){
+         n--;
+      }//end while
+      if (n == 0){
+         format = fmZERO;
+      }else{
+         format = fmRAW;
+         out.WriteVarUInt(n);
+         out.Write(page->GetData(), n);
+      }//end if
+   }else if (node->GetNodeType() == stSlimNode::LEAF){
+      if (((stSlimLeafNode *) node)->GetCodeSize() > 0){
+         format = fmCODEDLEAF;
+         out.WriteVarUInt(((stSlimLeafNode *) node)->GetCodeSize());
+      }else{
+         format = fmLEAF;
+      }//end if
+      ((stSlimLeafNode *) node)->Compress(out);
+   }else{
+      format = fmINDEX;
+      ((stSlimIndexNode *) node)->Compress(out);
+   }//end if
+   delete node;
+
+   if (out.GetDataSize() + 1 > size){
+      return 0;
+   }//end if
+   dst[0] = format;
+   memcpy(dst + 1, out.GetData(), out.GetDataSize());
+   return out.GetDataSize() + 1;
+}//end stSlimPageCodec::Encode
+
+//------------------------------------------------------------------------------
+void stSlimPageCodec::Decode(const unsigned char * src, u_int32_t size,
+      stPage * page){
+   u_int32_t n;
+
+   if ((size == 0) || (src[0] == fmZERO)){
+      page->Clear();
+      return;
+   }//end if
+
+   in.SetData(src + 1, size - 1);
+   switch (src[0]){
+      case fmRAW:
+         n = in.ReadVarUInt();
+         if (n > page->GetPageSize()){
+            throw std::logic_error("Invalid compressed page.");
+         }//end if
+         page->Clear();
+         in.Read(page->GetData(), n);
+         break;
+      case fmLEAF:
+         {
+            stSlimLeafNode node(page, true);
+            node.Decompress(in);
+         }
+         break;
+      case fmINDEX:
+         {
+            stSlimIndexNode node(page, true);
+            node.Decompress(in);
+         }
+         break;
+      case fmCODEDLEAF:
+         n = in.ReadVarUInt();
+         if ((n == 0) || (n > page->GetPageSize())){
+            throw std::logic_error("Invalid compressed page.");
+         }//end if
+         {
+            stSlimLeafNode node(page, true, n);
+            node.Decompress(in);
+         }
+         break;
+      default:
+         throw std::logic_error("Invalid compressed page.");
+   }//end switch
+}//end stSlimPageCodec::Decode
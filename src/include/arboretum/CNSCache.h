@@ -72,7 +72,7 @@ class CNSCache {
 
    private:
       #define TxCrescBlocos 51
-      #define CNSCACHE_NIL 0xFFFFU
+      #define CNSCACHE_NIL 0xFFFFFFFFU
       //---- Tipos ----
       //-- estrutura para mapeamento de enderecos de registros
       //   para paginas em memoria
@@ -46,6 +46,7 @@
 #include <arboretum/stCommonIO.h>
 #include <arboretum/CNSCache.h>
 #include <arboretum/stUtil.h>
+#include <arboretum/stChecksum.h>
 
 //---- Constant definitions ----
 #define CSTORAGE_MAX_FNAME_LENGTH 256
@@ -72,6 +73,15 @@
 * as an academic tool for testing and tuning indexing methods, and not as a
 * commercial one. So, it is not RELIABLE! Don't expect too much.
 *
+* <P>Files may be created with page checksums. In this case, each page is
+* followed on disk by the CRC32C of its id and contents. The checksum is
+* computed when the cache writes the page and verified when the cache reads it,
+* so corrupted and torn pages are detected at the first read after a crash. The
+* flag is kept in the file header (bit CSTORAGE_CHECKSUMFLAG of the page size).
+* Older versions do not know this flag and do not check for it. They read a
+* page size above 1 GB, so opening these files with them usually fails when
+* the cache is allocated, but this is not guaranteed.
+*
 * <P>To aid the disk access, a cache manager is used. Its page replacement
 * policy is the Natural Selection Page Replacement Policy (a mixing between
 * the LRU and LFU replacement policies).
@@ -128,11 +138,12 @@ class CStorage // Naming: csto
       * result in an automatically defined size.
       * @param cacheNPages Number of pages in cache. It can't be a value smaller than
       * 5.
+      * @param checksum If true, each page will be protected by a checksum.
       * @warning This object CAN'T have another file opened.
       * @exception std::logic_error If the file can not be created.
       */
       void Create(const char *fName, int pageSize, int userHeaderSize,
-                  int cacheNPages = 100);
+                  int cacheNPages = 100, bool checksum = false);
 
       /**
       * Returns true if file is open or false otherwise.
@@ -179,6 +190,8 @@ class CStorage // Naming: csto
       *
       * @param pageId The page ID.
       * @param page The page.
+      * @exception std::logic_error If the page is read from the disk and its
+      * checksum does not match.
       */
       void ReadPage(long pageId, void *page);
 
@@ -204,6 +217,14 @@ class CStorage // Naming: csto
       */
       void FreePage(long pageId);
 
+      /**
+      * Asks the operating system to read a page in background. Pages in the
+      * cache are not checked.
+      *
+      * @param pageId The page ID.
+      */
+      void Prefetch(long pageId);
+
       /**
       * Flushes the cache.
       */
@@ -233,6 +254,13 @@ class CStorage // Naming: csto
          return fileHeader.pageSize;
       }//end GetPageSize
 
+      /**
+      * Returns true if the pages of this file have checksums.
+      */
+      bool HasChecksum(){
+         return checksum;
+      }//end HasChecksum
+
       /**
       * Returns the number of allocated pages.
       */
@@ -353,6 +381,12 @@ class CStorage // Naming: csto
       };//end tFileHeader
       #define CSTORAGE_HEADERSIZE sizeof(tFileHeader)
 
+      // Bit of tFileHeader::pageSize set in files with page checksums.
+      #define CSTORAGE_CHECKSUMFLAG 0x40000000
+
+      // Size of the checksum that follows each page.
+      #define CSTORAGE_CHECKSUMSIZE 4
+
       /**
       * Name of the file in use
       */
@@ -372,6 +406,16 @@ class CStorage // Naming: csto
       * Position on disk of the first page. It is used to calculate other pages addresses.
       */
       long firstPageDiskAddress;
+
+      /**
+      * If true, each page is followed by its checksum.
+      */
+      bool checksum;
+
+      /**
+      * Size of each page on disk, including the checksum.
+      */
+      long slotSize;
     
       /**
       * The cache pointer.
@@ -386,14 +430,22 @@ class CStorage // Naming: csto
       void ReadHeader(){
          lseek(fd, 0, SEEK_SET);
          read(fd, &fileHeader, CSTORAGE_HEADERSIZE);
+         checksum = (fileHeader.pageSize & CSTORAGE_CHECKSUMFLAG) != 0;
+         fileHeader.pageSize &= ~CSTORAGE_CHECKSUMFLAG;
+         slotSize = fileHeader.pageSize + (checksum ? CSTORAGE_CHECKSUMSIZE : 0);
       }//end ReadHeader
 
       /**
       * Writes system header.
       */
       void WriteHeader(){
+         tFileHeader diskHeader = fileHeader;
+
+         if (checksum){
+            diskHeader.pageSize |= CSTORAGE_CHECKSUMFLAG;
+         }//end if
          lseek(fd, 0, SEEK_SET);
-         write(fd, &fileHeader, CSTORAGE_HEADERSIZE);
+         write(fd, &diskHeader, CSTORAGE_HEADERSIZE);
       }//end WriteHeader
 
       /**
@@ -408,7 +460,7 @@ class CStorage // Naming: csto
       * @param fileCursor The offset of the file.
       */
       long ToPageId(long fileCursor){
-         return ((fileCursor - firstPageDiskAddress) / fileHeader.pageSize);
+         return ((fileCursor - firstPageDiskAddress) / slotSize);
       }//end ToPageId
 
       /**
@@ -417,7 +469,7 @@ class CStorage // Naming: csto
       * @param pageId The page id.
       */
       long ToFileCursor(long pageId){
-         return (firstPageDiskAddress + (pageId * fileHeader.pageSize));
+         return (firstPageDiskAddress + (pageId * slotSize));
       }//end ToFileCursor
 
       /**
@@ -433,6 +485,8 @@ class CStorage // Naming: csto
       *
       * @param pageId The page id.
       * @param page The page data.
+      * @exception std::logic_error If the page cannot be read or its checksum
+      * does not match.
       */
       void DiskReadPage(long pageId, void *page);
 
@@ -444,6 +498,21 @@ class CStorage // Naming: csto
       */
       void DiskWritePage(long pageId, void *page);
 
+      /**
+      * Computes the checksum of a page. The page id is included, so pages
+      * written at the wrong position are also detected. The id is hashed as
+      * a 32-bit value, so the checksums do not depend on sizeof(long).
+      *
+      * @param pageId The page id.
+      * @param page The page data.
+      */
+      u_int32_t PageChecksum(long pageId, void *page){
+         u_int32_t id = (u_int32_t) pageId;
+
+         return stChecksum::CRC32C(page, fileHeader.pageSize,
+               stChecksum::CRC32C(&id, sizeof(id)));
+      }//end PageChecksum
+
       /**
       * Initalize all variables with zero or NULL.
       */
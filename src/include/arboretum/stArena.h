@@ -0,0 +1,278 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**
+* @file
+*
+* This file defines the class stArena and the class template stArenaAllocator.
+*
+* @version 1.0
+*/
+#ifndef __STARENA_H
+#define __STARENA_H
+
+#include <arboretum/stCommon.h>
+#include <cstddef>
+#include <new>
+
+// Size of the first chunk of an arena.
+#ifndef STARENA_FIRSTCHUNK
+   #define STARENA_FIRSTCHUNK 1024
+#endif //STARENA_FIRSTCHUNK
+
+// Maximum size of a chunk of an arena.
+#ifndef STARENA_MAXCHUNK
+   #define STARENA_MAXCHUNK 65536
+#endif //STARENA_MAXCHUNK
+
+// Granularity of the blocks of an arena. It is also their alignment.
+#define STARENA_GRANULARITY 16
+
+// Blocks larger than this are not taken from the chunks.
+#define STARENA_MAXBLOCK 1024
+
+//==============================================================================
+// stArena
+//------------------------------------------------------------------------------
+/**
+* This class implements a bump allocator for small blocks with the same
+* lifetime, such as the pairs of a query result.
+*
+* <P>Blocks are carved from chunks that grow geometrically from
+* STARENA_FIRSTCHUNK to STARENA_MAXCHUNK bytes. Freed blocks are kept in one
+* free list per size class and reused by later allocations of the same size,
+* so a k-nearest neighbor query that keeps replacing its candidates does not
+* grow the arena without bound. The chunks are only returned to the system
+* when the arena is destroyed.
+*
+* <P>Blocks larger than STARENA_MAXBLOCK bytes are allocated and released
+* with the global operators new and delete. This class is not thread safe.
+*
+* @version 1.0
+* @ingroup struct
+* @see stArenaAllocator
+*/
+class stArena{
+   public:
+      /**
+      * Creates a new empty arena. No memory is allocated until the first call
+      * to Allocate().
+      */
+      stArena();
+
+      /**
+      * Disposes this arena and all its chunks.
+      */
+      ~stArena();
+
+      /**
+      * Allocates a block. It is aligned to STARENA_GRANULARITY bytes.
+      *
+      * @param size The size of the block in bytes.
+      * @return The block.
+      */
+      void * Allocate(size_t size){
+         size_t cls;
+         void * block;
+
+         if (size > STARENA_MAXBLOCK){
+            return ::operator new(size);
+         }//end if
+         cls = GetClass(size);
+         if (FreeBlocks[cls] != NULL){
+            block = FreeBlocks[cls];
+            FreeBlocks[cls] = *((void **) block);
+            return block;
+         }//end if
+         size = (cls + 1) * STARENA_GRANULARITY;
+         if (size > Free){
+            NewChunk();
+         }//end if
+         block = Next;
+         Next += size;
+         Free -= size;
+         return block;
+      }//end Allocate
+
+      /**
+      * Releases a block.
+      *
+      * @param block The block returned by Allocate().
+      * @param size The size used to allocate it.
+      */
+      void Release(void * block, size_t size){
+         size_t cls;
+
+         if (size > STARENA_MAXBLOCK){
+            ::operator delete(block);
+         }else{
+            cls = GetClass(size);
+            *((void **) block) = FreeBlocks[cls];
+            FreeBlocks[cls] = block;
+         }//end if
+      }//end Release
+
+      /**
+      * Returns the total size of the chunks of this arena.
+      */
+      size_t GetChunkSize(){
+         return ChunkSize;
+      }//end GetChunkSize
+
+   private:
+      /**
+      * Number of size classes.
+      */
+      static const size_t CLASSES = STARENA_MAXBLOCK / STARENA_GRANULARITY;
+
+      /**
+      * Header of each chunk. It keeps the chunks in a linked list.
+      */
+      struct tChunk{
+         /**
+         * Next chunk.
+         */
+         tChunk * NextChunk;
+
+         /**
+         * Padding that keeps the blocks aligned.
+         */
+         unsigned char Padding[STARENA_GRANULARITY - sizeof(tChunk *)];
+      };
+
+      /**
+      * The most recent chunk.
+      */
+      tChunk * Chunks;
+
+      /**
+      * The next free byte of the most recent chunk.
+      */
+      unsigned char * Next;
+
+      /**
+      * Free bytes after Next.
+      */
+      size_t Free;
+
+      /**
+      * Total size of the chunks.
+      */
+      size_t ChunkSize;
+
+      /**
+      * Size of the last chunk.
+      */
+      size_t LastChunk;
+
+      /**
+      * Free lists.
+      */
+      void * FreeBlocks[CLASSES];
+
+      /**
+      * Returns the size class of a block.
+      *
+      * @param size The size of the block.
+      */
+      static size_t GetClass(size_t size){
+         return (size == 0) ? 0 : (size - 1) / STARENA_GRANULARITY;
+      }//end GetClass
+
+      /**
+      * Allocates a new chunk. The unused bytes of the current chunk are lost.
+      */
+      void NewChunk();
+
+      // Arenas can not be copied.
+      stArena(const stArena &);
+      stArena & operator = (const stArena &);
+};//end stArena
+
+//==============================================================================
+// stArenaAllocator
+//------------------------------------------------------------------------------
+/**
+* This class template is a standard allocator that takes its memory from an
+* stArena. It allows the standard containers to allocate their nodes from the
+* arena of its owner.
+*
+* @version 1.0
+* @ingroup struct
+* @see stArena
+*/
+template <class T>
+class stArenaAllocator{
+   public:
+      /**
+      * Type of the elements.
+      */
+      typedef T value_type;
+
+      /**
+      * Creates a new allocator.
+      *
+      * @param arena The arena.
+      */
+      stArenaAllocator(stArena * arena){
+         Arena = arena;
+      }//end stArenaAllocator
+
+      /**
+      * Creates a copy of an allocator of another type.
+      *
+      * @param other The allocator.
+      */
+      template <class U>
+      stArenaAllocator(const stArenaAllocator<U> & other){
+         Arena = other.GetArena();
+      }//end stArenaAllocator
+
+      /**
+      * Allocates n elements.
+      */
+      T * allocate(size_t n){
+         return (T *) Arena->Allocate(n * sizeof(T));
+      }//end allocate
+
+      /**
+      * Releases n elements.
+      */
+      void deallocate(T * p, size_t n){
+         Arena->Release(p, n * sizeof(T));
+      }//end deallocate
+
+      /**
+      * Returns the arena.
+      */
+      stArena * GetArena() const{
+         return Arena;
+      }//end GetArena
+
+   private:
+      /**
+      * The arena.
+      */
+      stArena * Arena;
+};//end stArenaAllocator
+
+template <class T, class U>
+bool operator == (const stArenaAllocator<T> & a, const stArenaAllocator<U> & b){
+   return a.GetArena() == b.GetArena();
+}//end operator ==
+
+template <class T, class U>
+bool operator != (const stArenaAllocator<T> & a, const stArenaAllocator<U> & b){
+   return a.GetArena() != b.GetArena();
+}//end operator !=
+
+#endif //__STARENA_H
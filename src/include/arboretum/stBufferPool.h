@@ -0,0 +1,626 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**
+* @file
+*
+* This file defines the class stBufferPool and its replacement policies.
+*
+* @version 1.0
+*/
+#ifndef __STBUFFERPOOL_H
+#define __STBUFFERPOOL_H
+
+#include <stdexcept>
+#include <vector>
+#include <list>
+#include <unordered_map>
+
+#include <arboretum/stPage.h>
+#include <arboretum/CStorage.h>
+
+/**
+* Minimum number of frames of a buffer pool.
+*/
+#define STBUFFERPOOL_MINFRAMES 16
+
+/**
+* Invalid frame index.
+*/
+#define STBUFFERPOOL_NOFRAME 0xFFFFFFFFU
+
+//==============================================================================
+// stFrameList
+//------------------------------------------------------------------------------
+/**
+* This class implements a doubly linked list of frame indexes. The links are
+* kept in arrays indexed by frame. They grow with the frames of the pool, so
+* insertions and removals only allocate memory the first time a frame is
+* seen. A frame may belong to only one list at a time.
+*
+* @version 1.0
+* @ingroup storage
+*/
+class stFrameList{
+   public:
+      /**
+      * Creates a new empty list.
+      */
+      stFrameList();
+
+      /**
+      * Inserts a frame in the head of this list.
+      *
+      * @param frame The frame.
+      */
+      void PushFront(u_int32_t frame);
+
+      /**
+      * Removes a frame from this list.
+      *
+      * @param frame The frame.
+      */
+      void Remove(u_int32_t frame);
+
+      /**
+      * Returns the first frame or STBUFFERPOOL_NOFRAME if this list is empty.
+      */
+      u_int32_t GetHead(){
+         return head;
+      }//end GetHead
+
+      /**
+      * Returns the last frame or STBUFFERPOOL_NOFRAME if this list is empty.
+      */
+      u_int32_t GetTail(){
+         return tail;
+      }//end GetTail
+
+      /**
+      * Returns the frame before the given frame.
+      *
+      * @param frame The frame.
+      */
+      u_int32_t GetPrevious(u_int32_t frame){
+         return prev[frame];
+      }//end GetPrevious
+
+      /**
+      * Returns the number of frames in this list.
+      */
+      u_int32_t GetSize(){
+         return size;
+      }//end GetSize
+
+      /**
+      * Returns the first unpinned frame from the tail to the head of this list.
+      *
+      * @param pins The pin counts of the frames.
+      * @return The frame or STBUFFERPOOL_NOFRAME if all of them are pinned.
+      */
+      u_int32_t FindUnpinned(const u_int32_t * pins);
+
+   private:
+      /**
+      * Previous frame of each frame.
+      */
+      std::vector<u_int32_t> prev;
+
+      /**
+      * Next frame of each frame.
+      */
+      std::vector<u_int32_t> next;
+
+      /**
+      * First frame.
+      */
+      u_int32_t head;
+
+      /**
+      * Last frame.
+      */
+      u_int32_t tail;
+
+      /**
+      * Number of frames.
+      */
+      u_int32_t size;
+};//end stFrameList
+
+//==============================================================================
+// stReplacementPolicy
+//------------------------------------------------------------------------------
+/**
+* This class defines the interface of the replacement policies used by
+* stBufferPool. A policy only tracks frame indexes. The pool notifies it about
+* every insertion, access and removal and asks it for a victim when there is no
+* free frame left. Pinned frames must never be chosen.
+*
+* @version 1.0
+* @see stBufferPool
+* @ingroup storage
+*/
+class stReplacementPolicy{
+   public:
+      /**
+      * Disposes this instance.
+      */
+      virtual ~stReplacementPolicy(){}
+
+      /**
+      * Notifies that a page was loaded into a frame.
+      *
+      * @param frame The frame.
+      * @param pageID The id of the page.
+      */
+      virtual void Insert(u_int32_t frame, u_int32_t pageID) = 0;
+
+      /**
+      * Notifies that a frame was accessed again.
+      *
+      * @param frame The frame.
+      */
+      virtual void Access(u_int32_t frame) = 0;
+
+      /**
+      * Notifies that a frame was emptied.
+      *
+      * @param frame The frame.
+      * @param evicted True if the frame was chosen by Victim() or false if
+      * the page was disposed.
+      */
+      virtual void Remove(u_int32_t frame, bool evicted) = 0;
+
+      /**
+      * Chooses the frame to be evicted. This method does not remove it.
+      *
+      * @param pins The pin counts of the frames.
+      * @return The frame or STBUFFERPOOL_NOFRAME if all frames are pinned.
+      */
+      virtual u_int32_t Victim(const u_int32_t * pins) = 0;
+};//end stReplacementPolicy
+
+//==============================================================================
+// stLRUPolicy
+//------------------------------------------------------------------------------
+/**
+* This class implements the least recently used replacement policy.
+*
+* @version 1.0
+* @ingroup storage
+*/
+class stLRUPolicy: public stReplacementPolicy{
+   public:
+      virtual void Insert(u_int32_t frame, u_int32_t){
+         list.PushFront(frame);
+      }//end Insert
+
+      virtual void Access(u_int32_t frame){
+         list.Remove(frame);
+         list.PushFront(frame);
+      }//end Access
+
+      virtual void Remove(u_int32_t frame, bool){
+         list.Remove(frame);
+      }//end Remove
+
+      virtual u_int32_t Victim(const u_int32_t * pins){
+         return list.FindUnpinned(pins);
+      }//end Victim
+
+   private:
+      /**
+      * Frames from the most to the least recently used.
+      */
+      stFrameList list;
+};//end stLRUPolicy
+
+//==============================================================================
+// stClockPolicy
+//------------------------------------------------------------------------------
+/**
+* This class implements the CLOCK (second chance) replacement policy. It
+* approximates LRU without touching any list on hits.
+*
+* @version 1.0
+* @ingroup storage
+*/
+class stClockPolicy: public stReplacementPolicy{
+   public:
+      /**
+      * Creates a new instance of this class.
+      */
+      stClockPolicy();
+
+      virtual void Insert(u_int32_t frame, u_int32_t){
+         if (frame >= used.size()){
+            used.resize(frame + 1, false);
+            referenced.resize(frame + 1, false);
+         }//end if
+         used[frame] = true;
+         referenced[frame] = true;
+      }//end Insert
+
+      virtual void Access(u_int32_t frame){
+         referenced[frame] = true;
+      }//end Access
+
+      virtual void Remove(u_int32_t frame, bool){
+         used[frame] = false;
+         referenced[frame] = false;
+      }//end Remove
+
+      virtual u_int32_t Victim(const u_int32_t * pins);
+
+   private:
+      /**
+      * Frames in use. It grows with the frames of the pool.
+      */
+      std::vector<bool> used;
+
+      /**
+      * Reference bits.
+      */
+      std::vector<bool> referenced;
+
+      /**
+      * Position of the clock hand.
+      */
+      u_int32_t hand;
+};//end stClockPolicy
+
+//==============================================================================
+// st2QPolicy
+//------------------------------------------------------------------------------
+/**
+* This class implements the 2Q replacement policy (T. Johnson and D. Shasha,
+* VLDB 1994). Pages referenced once stay in a small FIFO queue (A1in). Pages
+* referenced again after leaving it, which are remembered by a queue of page
+* ids only (A1out), go to the main LRU queue (Am). It resists the sequential
+* scans performed by large range queries better than LRU.
+*
+* @version 1.0
+* @ingroup storage
+*/
+class st2QPolicy: public stReplacementPolicy{
+   public:
+      /**
+      * Creates a new instance of this class. A1in will hold 25% of the frames
+      * and A1out will remember as many page ids as 50% of the frames.
+      *
+      * @param capacity Number of frames.
+      */
+      st2QPolicy(u_int32_t capacity);
+
+      virtual void Insert(u_int32_t frame, u_int32_t pageID);
+
+      virtual void Access(u_int32_t frame);
+
+      virtual void Remove(u_int32_t frame, bool evicted);
+
+      virtual u_int32_t Victim(const u_int32_t * pins);
+
+   private:
+      /**
+      * The FIFO queue of pages referenced once.
+      */
+      stFrameList a1in;
+
+      /**
+      * The LRU queue of pages referenced more than once.
+      */
+      stFrameList am;
+
+      /**
+      * Tells if a frame is in Am. It grows with the frames of the pool.
+      */
+      std::vector<bool> inAm;
+
+      /**
+      * Page id of each frame.
+      */
+      std::vector<u_int32_t> pages;
+
+      /**
+      * Ids of the pages recently evicted from A1in.
+      */
+      std::list<u_int32_t> a1out;
+
+      /**
+      * Index of a1out.
+      */
+      std::unordered_map<u_int32_t, std::list<u_int32_t>::iterator> a1outIndex;
+
+      /**
+      * Maximum size of A1in.
+      */
+      u_int32_t kin;
+
+      /**
+      * Maximum size of A1out.
+      */
+      u_int32_t kout;
+};//end st2QPolicy
+
+//==============================================================================
+// stBufferPool
+//------------------------------------------------------------------------------
+/**
+* This class implements the buffer pool used by stDiskPageManager. It keeps
+* up to a given number of bytes of pages of a CStorage in memory and hands the
+* frames themselves to the trees, so a hit costs a hash lookup only.
+*
+* <P>Each frame has a pin count. Get() and New() pin the returned frame and
+* Release() unpins it. Pinned frames are never evicted. The same frame is
+* returned if a page is requested twice. Modified frames are written back to
+* the storage when they are evicted or when Flush() is called.
+*
+* <P>The page ids used by this class are the ids seen by the users of
+* stDiskPageManager (the first page is 1).
+*
+* @version 1.0
+* @see stDiskPageManager
+* @see stReplacementPolicy
+* @ingroup storage
+*/
+class stBufferPool{
+   public:
+      /**
+      * Available replacement policies.
+      */
+      enum tReplacementPolicy{
+         /**
+         * Least recently used.
+         */
+         rpLRU,
+
+         /**
+         * CLOCK (second chance).
+         */
+         rpCLOCK,
+
+         /**
+         * 2Q.
+         */
+         rp2Q
+      };//end tReplacementPolicy
+
+      /**
+      * Creates a new buffer pool. The number of frames is budget / pageSize,
+      * but never less than STBUFFERPOOL_MINFRAMES. Frames are allocated on
+      * demand.
+      *
+      * @param storage The storage. It is not owned by this pool.
+      * @param pageSize The size of the pages.
+      * @param budget Maximum number of bytes used by the frames.
+      * @param policy The replacement policy.
+      */
+      stBufferPool(CStorage * storage, u_int32_t pageSize, u_int64_t budget,
+            tReplacementPolicy policy = rpLRU);
+
+      /**
+      * Disposes this pool. Modified frames are not written. Call Flush()
+      * before it.
+      */
+      ~stBufferPool();
+
+      /**
+      * Returns the pinned frame of a page, reading it if required.
+      *
+      * @param pageID The id of the page.
+      * @return The frame.
+      * @exception std::logic_error If all frames are pinned.
+      */
+      stPage * Get(u_int32_t pageID);
+
+      /**
+      * Allocates a new page in the storage and returns its pinned frame.
+      *
+      * @return The frame.
+      * @exception std::logic_error If all frames are pinned.
+      */
+      stPage * New();
+
+      /**
+      * Unpins a frame.
+      *
+      * @param page The frame.
+      * @return False if the page is not a frame of this pool.
+      */
+      bool Release(stPage * page);
+
+      /**
+      * Writes a page. If the page is a frame, it is only marked as modified.
+      * If other instance of the page is in the pool, the frame is updated.
+      * Otherwise, the page is written to the storage.
+      *
+      * @param page The page.
+      */
+      void Write(stPage * page);
+
+      /**
+      * Removes a page from this pool and frees it in the storage. The frame
+      * must be pinned only by the caller.
+      *
+      * @param page The page.
+      * @return False if the page is not a frame of this pool.
+      * @exception std::logic_error If the frame is pinned by someone else.
+      */
+      bool Dispose(stPage * page);
+
+      /**
+      * Writes all modified frames to the storage.
+      */
+      void Flush();
+
+      /**
+      * Tells if a page is in this pool.
+      *
+      * @param pageID The id of the page.
+      */
+      bool Contains(u_int32_t pageID){
+         return Find(pageID) != STBUFFERPOOL_NOFRAME;
+      }//end Contains
+
+      /**
+      * Returns the maximum number of frames.
+      */
+      u_int32_t GetCapacity(){
+         return capacity;
+      }//end GetCapacity
+
+      /**
+      * Returns the number of requests served from memory.
+      */
+      u_int64_t GetHitCount(){
+         return hits;
+      }//end GetHitCount
+
+      /**
+      * Returns the number of requests that required a read.
+      */
+      u_int64_t GetMissCount(){
+         return misses;
+      }//end GetMissCount
+
+      /**
+      * Returns the number of evicted frames.
+      */
+      u_int64_t GetEvictionCount(){
+         return evictions;
+      }//end GetEvictionCount
+
+      /**
+      * Returns the number of modified frames written to the storage.
+      */
+      u_int64_t GetWriteBackCount(){
+         return writeBacks;
+      }//end GetWriteBackCount
+
+      /**
+      * Restarts the statistics.
+      */
+      void ResetStatistics(){
+         hits = 0;
+         misses = 0;
+         evictions = 0;
+         writeBacks = 0;
+      }//end ResetStatistics
+
+   private:
+      /**
+      * The storage.
+      */
+      CStorage * storage;
+
+      /**
+      * The replacement policy.
+      */
+      stReplacementPolicy * policy;
+
+      /**
+      * Size of the pages.
+      */
+      u_int32_t pageSize;
+
+      /**
+      * Maximum number of frames.
+      */
+      u_int32_t capacity;
+
+      /**
+      * The frames.
+      */
+      std::vector<stPage *> frames;
+
+      /**
+      * Pin counts of the frames.
+      */
+      std::vector<u_int32_t> pins;
+
+      /**
+      * Modified flags of the frames.
+      */
+      std::vector<bool> modified;
+
+      /**
+      * Frames without pages.
+      */
+      std::vector<u_int32_t> freeFrames;
+
+      /**
+      * Maps page ids to frames.
+      */
+      std::unordered_map<u_int32_t, u_int32_t> pageTable;
+
+      /**
+      * Statistics.
+      */
+      u_int64_t hits;
+      u_int64_t misses;
+      u_int64_t evictions;
+      u_int64_t writeBacks;
+
+      /**
+      * Returns the frame of a page or STBUFFERPOOL_NOFRAME.
+      *
+      * @param pageID The id of the page.
+      */
+      u_int32_t Find(u_int32_t pageID){
+         std::unordered_map<u_int32_t, u_int32_t>::iterator i;
+
+         i = pageTable.find(pageID);
+         return (i == pageTable.end()) ? STBUFFERPOOL_NOFRAME : i->second;
+      }//end Find
+
+      /**
+      * Returns the frame of a page if the page is the frame itself.
+      *
+      * @param page The page.
+      * @return The frame or STBUFFERPOOL_NOFRAME.
+      */
+      u_int32_t FindFrame(stPage * page){
+         u_int32_t frame = Find(page->GetPageID());
+
+         return ((frame != STBUFFERPOOL_NOFRAME) && (frames[frame] == page)) ?
+               frame : STBUFFERPOOL_NOFRAME;
+      }//end FindFrame
+
+      /**
+      * Returns an empty frame, evicting a page if required.
+      *
+      * @exception std::logic_error If all frames are pinned.
+      */
+      u_int32_t GetEmptyFrame();
+
+      /**
+      * Registers a page in an empty frame and pins it.
+      *
+      * @param frame The frame.
+      * @param pageID The id of the page.
+      */
+      void Register(u_int32_t frame, u_int32_t pageID);
+
+      /**
+      * Writes a frame to the storage.
+      *
+      * @param frame The frame.
+      */
+      void WriteBack(u_int32_t frame){
+         storage->WritePage(frames[frame]->GetPageID() - 1,
+               (void *) frames[frame]->GetData());
+         modified[frame] = false;
+         writeBacks++;
+      }//end WriteBack
+};//end stBufferPool
+
+#endif //__STBUFFERPOOL_H
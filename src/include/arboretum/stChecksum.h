@@ -0,0 +1,82 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**
+* @file
+*
+* This file defines the class stChecksum.
+*
+* @version 1.0
+*/
+#ifndef __STCHECKSUM_H
+#define __STCHECKSUM_H
+
+#include <arboretum/stCommon.h>
+
+//==============================================================================
+// stChecksum
+//------------------------------------------------------------------------------
+/**
+* This class computes CRC32C (Castagnoli) checksums. They are used by the page
+* managers to detect corrupted and torn pages.
+*
+* <P>The SSE4.2 instruction crc32 is used when the processor supports it. The
+* test is performed only once. Other processors use a table driven
+* implementation that produces the same values.
+*
+* @version 1.0
+* @ingroup storage
+*/
+class stChecksum{
+   public:
+      /**
+      * Computes the CRC32C of a memory block. Large blocks may be processed in
+      * parts by passing the result of the previous part as crc.
+      *
+      * @param data The data.
+      * @param size The size of data in bytes.
+      * @param crc The checksum of the previous parts or 0.
+      * @return The checksum.
+      */
+      static u_int32_t CRC32C(const void * data, u_int32_t size,
+            u_int32_t crc = 0);
+
+      /**
+      * Returns true if the hardware implementation is in use.
+      */
+      static bool IsAccelerated();
+
+   private:
+      /**
+      * Table driven implementation.
+      *
+      * @param data The data.
+      * @param size The size of data in bytes.
+      * @param crc The inverted checksum of the previous parts.
+      * @return The inverted checksum.
+      */
+      static u_int32_t Software(const unsigned char * data, u_int32_t size,
+            u_int32_t crc);
+
+      /**
+      * SSE4.2 implementation.
+      *
+      * @param data The data.
+      * @param size The size of data in bytes.
+      * @param crc The inverted checksum of the previous parts.
+      * @return The inverted checksum.
+      */
+      static u_int32_t Hardware(const unsigned char * data, u_int32_t size,
+            u_int32_t crc);
+};//end stChecksum
+
+#endif //__STCHECKSUM_H
@@ -24,7 +24,8 @@
 #define __STCOMPRESS_H
 
 #include <arboretum/stCommon.h>
-
+#include <arboretum/stPage.h>
+#include <stdexcept>
 
 /**
 *
@@ -32,6 +33,18 @@
 */
 class stCompressor{
    public:
+      /**
+      * Creates a new empty compressor.
+      *
+      * @param increment Increment of the internal buffer in bytes.
+      */
+      stCompressor(u_int32_t increment = 256);
+
+      /**
+      * Disposes this instance and releases the internal buffer.
+      */
+      virtual ~stCompressor();
+
       /**
       * Returns a pointer to the data array.
       */
@@ -70,6 +83,29 @@ class stCompressor{
       void Reserve(u_int32_t size){
          Resize(size * 8);
       }//end Reserve
+
+      /**
+      * Returns the number of bits written so far.
+      */
+      u_int32_t GetBitCount() const{
+         return bitOffset;
+      }//end GetBitCount
+
+      /**
+      * Writes the lower bits of an unsigned integer.
+      *
+      * @param value The value.
+      * @param bits Number of bits (up to 32).
+      */
+      void WriteUInt(u_int32_t value, u_int32_t bits);
+
+      /**
+      * Writes an unsigned integer using groups of 7 bits. Small values
+      * use less bits.
+      *
+      * @param value The value.
+      */
+      void WriteVarUInt(u_int32_t value);
    protected:
       /**
       * Bit buffer.
@@ -120,6 +156,16 @@ class stCompressor{
 */
 class stDecompressor{
    public:
+      /**
+      * Creates a new decompressor without data.
+      */
+      stDecompressor();
+
+      /**
+      * Disposes this instance and releases the internal buffer.
+      */
+      virtual ~stDecompressor();
+
       /**
       * Sets the compressed data. This method copies the contents of
       * buff to an internal buffer.
@@ -143,6 +189,18 @@ class stDecompressor{
       void Reset(){
          bitOffset = 0;
       }//end Reset
+
+      /**
+      * Reads an unsigned integer written by stCompressor::WriteUInt().
+      *
+      * @param bits Number of bits (up to 32).
+      */
+      u_int32_t ReadUInt(u_int32_t bits);
+
+      /**
+      * Reads an unsigned integer written by stCompressor::WriteVarUInt().
+      */
+      u_int32_t ReadVarUInt();
    protected:
       /**
       * Bit buffer.
@@ -158,6 +216,11 @@ class stDecompressor{
       * Current bit offset.
       */
       u_int32_t bitOffset;
+
+      /**
+      * Capacity of the bit buffer in bytes.
+      */
+      u_int32_t capacity;
       
       /**
       * Reads some bits from data.
@@ -168,5 +231,97 @@ class stDecompressor{
       void ReadBits(unsigned char * buff, u_int32_t size);
 };//end stDecompressor
 
+//==============================================================================
+// stBitCompressor
+//------------------------------------------------------------------------------
+/**
+* This class implements a compressor that writes the bytes as they are. It is
+* used to build bit streams with the methods of stCompressor.
+*
+* @ingroup userlayerutil
+*/
+class stBitCompressor: public stCompressor{
+   public:
+      /**
+      * Creates a new empty compressor.
+      *
+      * @param increment Increment of the internal buffer in bytes.
+      */
+      stBitCompressor(u_int32_t increment = 256):stCompressor(increment){
+      }//end stBitCompressor
+
+      /**
+      * Writes the contents of buff to this compressor.
+      *
+      * @param buff The buffer.
+      * @param size Size of the buffer in bytes.
+      */
+      virtual void Write(unsigned char * buff, u_int32_t size){
+         WriteBits(buff, size * 8);
+      }//end Write
+};//end stBitCompressor
+
+//==============================================================================
+// stBitDecompressor
+//------------------------------------------------------------------------------
+/**
+* This class reads the streams created by stBitCompressor.
+*
+* @ingroup userlayerutil
+*/
+class stBitDecompressor: public stDecompressor{
+   public:
+      /**
+      * Reads some bytes to a buffer.
+      *
+      * @param buff The buffer.
+      * @param size Size of the buffer in bytes.
+      */
+      virtual void Read(unsigned char * buff, u_int32_t size){
+         ReadBits(buff, size * 8);
+      }//end Read
+};//end stBitDecompressor
+
+//==============================================================================
+// stPageCodec
+//------------------------------------------------------------------------------
+/**
+* This abstract class defines the interface of the codecs used to store pages
+* in a compact form. A codec knows the layout of the nodes of a given tree.
+*
+* @see stCompressedPageManager
+* @ingroup storage
+*/
+class stPageCodec{
+   public:
+      /**
+      * Disposes this instance.
+      */
+      virtual ~stPageCodec(){
+      }//end ~stPageCodec
+
+      /**
+      * Encodes a page.
+      *
+      * @param page The page.
+      * @param dst The destination buffer.
+      * @param size The size of the destination buffer.
+      * @return The number of bytes written or 0 if the encoded page does
+      * not fit in the destination buffer.
+      */
+      virtual u_int32_t Encode(stPage * page, unsigned char * dst,
+            u_int32_t size) = 0;
+
+      /**
+      * Decodes a page encoded by Encode().
+      *
+      * @param src The encoded page.
+      * @param size The size of the encoded page.
+      * @param page The destination page.
+      * @exception std::logic_error If the data is not valid.
+      */
+      virtual void Decode(const unsigned char * src, u_int32_t size,
+            stPage * page) = 0;
+};//end stPageCodec
 
 #endif //__STCOMPRESS_H
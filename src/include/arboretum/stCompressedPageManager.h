@@ -0,0 +1,271 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**
+* @file
+*
+* This file defines the class stCompressedPageManager.
+*
+* @version 1.0
+*/
+#ifndef __STCOMPRESSEDPAGEMANAGER_H
+#define __STCOMPRESSEDPAGEMANAGER_H
+
+#include <stdexcept>
+#include <vector>
+
+#include <arboretum/stPageManager.h>
+#include <arboretum/stCompress.h>
+
+//==============================================================================
+// stCompressedPageManager
+//------------------------------------------------------------------------------
+/**
+* This class stores the pages of a tree in a compact form, using another page
+* manager as the storage. The pages seen by the tree are <i>factor</i> times
+* larger than the pages of the base page manager, and a stPageCodec packs each
+* one of them into a single base page.
+*
+* <P>The nodes of the tree grow while their compact form fits in the base
+* page (see stPage::GetStorageSize()). So, if the codec compresses leaf nodes,
+* each leaf holds more entries and a query reads less pages.
+*
+* <P>Example:
+* <pre>
+* stPlainDiskPageManager * disk = new stPlainDiskPageManager("tree.dat", 4096);
+* stSlimPageCodec codec;
+* stCompressedPageManager * pm = new stCompressedPageManager(disk, &codec);
+* mySlimTree * tree = new mySlimTree(pm);
+* </pre>
+*
+* <P>The header page is not compressed. The base page manager and the codec
+* are not disposed by this class.
+*
+* @version 1.0
+* @see stPageCodec
+* @see stSlimPageCodec
+* @ingroup storage
+*/
+class stCompressedPageManager: public stPageManager{
+   public:
+      /**
+      * Creates a new instance of this class.
+      *
+      * @param base The base page manager.
+      * @param codec The codec.
+      * @param factor Ratio between the size of the pages seen by the tree
+      * and the size of the base pages.
+      */
+      stCompressedPageManager(stPageManager * base, stPageCodec * codec,
+            u_int32_t factor = 2);
+
+      /**
+      * Disposes this page and free all allocated resources.
+      */
+      virtual ~stCompressedPageManager();
+
+      /**
+      * This method will checks if this page manager is empty.
+      * If this method returns true, the stSlimTree will create a
+      * new tree otherwise it will continue to use the existing tree.
+      *
+      * @return True if the page manager is empty or false otherwise.
+      */
+      virtual bool IsEmpty(){
+         return base->IsEmpty();
+      }//end IsEmpty
+
+      /**
+      * Returns the header page of the base page manager.
+      *
+      * @return The header page.
+      * @see WriteHeaderPage()
+      */
+      virtual stPage * GetHeaderPage();
+
+      /**
+      * Reads and decodes the page with the given page ID.
+      *
+      * @param pageid The desired page id.
+      * @return The page or NULL for an invalid page ID.
+      * @see WritePage()
+      * @see ReleasePage()
+      */
+      virtual stPage * GetPage(u_int32_t pageid);
+
+      /**
+      * Releases a page returned by this page manager.
+      *
+      * @param page The page.
+      * @see GetPage()
+      */
+      virtual void ReleasePage(stPage * page);
+
+      /**
+      * Allocates a new page for use.
+      *
+      * <P>To dispose this page (make it free), use DisposePage().
+      *
+      * @return A new page.
+      * @see ReleasePage()
+      * @see WritePage()
+      * @see DisposePage()
+      */
+      virtual stPage * GetNewPage();
+
+      /**
+      * Encodes and writes the given page.
+      *
+      * @param page The page to be written.
+      * @exception std::logic_error If the encoded page does not fit in a
+      * base page.
+      * @see ReleasePage()
+      */
+      virtual void WritePage(stPage * page);
+
+      /**
+      * Writes the header page.
+      *
+      * @see GetHeaderPage()
+      */
+      virtual void WriteHeaderPage(stPage * headerpage){
+         base->WriteHeaderPage(headerpage);
+         UpdateWriteCounter();
+      }//end WriteHeaderPage
+
+      /**
+      * Disposes the given page. This method will make the page
+      * available (not allocated) for the next calls of GetNewPage().
+      *
+      * <P>Since this page will not be used anymore, this method will
+      * release the page.
+      *
+      * @param page The page to be disposed.
+      * @see GetNewPage()
+      */
+      virtual void DisposePage(stPage * page);
+
+      /**
+      * Forwards the hint to the base page manager.
+      *
+      * @param pageIDs The ids of the pages.
+      * @param n The number of ids.
+      */
+      virtual void Prefetch(const u_int32_t * pageIDs, u_int32_t n){
+         base->Prefetch(pageIDs, n);
+      }//end Prefetch
+
+      /**
+      * Flushes the base page manager.
+      */
+      virtual void Flush(){
+         base->Flush();
+      }//end Flush
+
+      /**
+      * Returns the size of the pages seen by the tree.
+      */
+      virtual u_int32_t GetMinimumPageSize(){
+         return pageSize;
+      }//end GetMinimumPageSize
+
+      /**
+      * Returns the number of pages.
+      */
+      virtual u_int32_t GetPageCount(){
+         return base->GetPageCount();
+      }//end GetPageCount
+
+   private:
+      /**
+      * A page seen by the tree. It keeps the base page that stores it.
+      */
+      class stCompressedPage: public stPage{
+         public:
+            /**
+            * Creates a new page.
+            *
+            * @param size The page size in bytes.
+            * @param storageSize The storage size in bytes.
+            */
+            stCompressedPage(u_int32_t size, u_int32_t storageSize):
+                  stPage(size){
+               this->storageSize = storageSize;
+               this->BasePage = NULL;
+            }//end stCompressedPage
+
+            /**
+            * Returns the storage size.
+            */
+            virtual u_int32_t GetStorageSize(){
+               return storageSize;
+            }//end GetStorageSize
+
+            /**
+            * The base page.
+            */
+            stPage * BasePage;
+
+         private:
+            /**
+            * The storage size.
+            */
+            u_int32_t storageSize;
+      };//end stCompressedPage
+
+      /**
+      * The base page manager.
+      */
+      stPageManager * base;
+
+      /**
+      * The codec.
+      */
+      stPageCodec * codec;
+
+      /**
+      * The header page of the base page manager.
+      */
+      stPage * headerPage;
+
+      /**
+      * Size of the pages seen by the tree.
+      */
+      u_int32_t pageSize;
+
+      /**
+      * Size of the base pages.
+      */
+      u_int32_t basePageSize;
+
+      /**
+      * Released pages ready for reuse.
+      */
+      std::vector<stCompressedPage *> freePages;
+
+      /**
+      * Returns an unused page attached to the given base page.
+      *
+      * @param basePage The base page.
+      */
+      stCompressedPage * NewPage(stPage * basePage);
+
+      /**
+      * Detaches the page from its base page and keeps it for reuse.
+      *
+      * @param page The page.
+      */
+      void FreePage(stCompressedPage * page);
+
+};//end stCompressedPageManager
+
+#endif //__STCOMPRESSEDPAGEMANAGER_H
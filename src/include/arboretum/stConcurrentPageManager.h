@@ -0,0 +1,453 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**
+* @file
+*
+* This file defines the class stConcurrentPageManager.
+*
+* @version 1.0
+*/
+#ifndef __STCONCURRENTPAGEMANAGER_H
+#define __STCONCURRENTPAGEMANAGER_H
+
+#include <stdexcept>
+#include <atomic>
+#include <mutex>
+
+#include <arboretum/stPageManager.h>
+#include <arboretum/stCommonIO.h>
+
+/**
+* Default size of the page cache in bytes (16 MB).
+*/
+#define STCONCURRENTPAGEMANAGER_DEFAULTCACHE (((u_int64_t) 1) << 24)
+
+/**
+* Minimum number of slots of the page cache.
+*/
+#define STCONCURRENTPAGEMANAGER_MINSLOTS 16
+
+/**
+* Number of stripes of the statistic counters.
+*/
+#define STCONCURRENTPAGEMANAGER_STRIPES 32
+
+//==============================================================================
+// stConcurrentPageManager
+//------------------------------------------------------------------------------
+/**
+* This class implements a disk page manager that may be used by many threads at
+* the same time. It allows a single tree to answer queries from a thread pool.
+*
+* <P>The file layout is the same used by stPlainDiskPageManager ("DPM1"), so
+* files created by one of them may be opened by the other. Pages are read and
+* written with pread() and pwrite(), so threads never share a file offset.
+*
+* <P>Pages are cached in a direct mapped table of slots indexed by the page ID.
+* Each slot has its own sequence lock: readers copy the slot and check that the
+* sequence did not change, so a cache hit never blocks nor writes to shared
+* memory. A slot that is being filled by another thread is treated as a miss.
+* A miss reads the sequence of the slot before reading the page from the disk
+* and caches the page only if the sequence is still the same, so a page read
+* before a concurrent WritePage() never replaces the newer image.
+* Every call of GetPage() returns a private copy of the page that is
+* deleted by ReleasePage().
+*
+* <P>The read and write counters are split in stripes shared by a few threads
+* and merged by GetReadCount() and GetWriteCount().
+*
+* <P>GetPage(), ReleasePage() and the statistics are thread safe. GetNewPage(),
+* WritePage() and DisposePage() are serialized by a mutex, but modifying the
+* tree while other threads query it is still not allowed by the trees.
+*
+* @version 1.0
+* @see stPageManager
+* @see stPlainDiskPageManager
+* @ingroup storage
+*/
+class stConcurrentPageManager: public stPageManager{
+   public:
+      /**
+      * Creates a new instance of this class. This constructor will create a new
+      * file with the given name.
+      *
+      * @param fName The file name.
+      * @param pagesize Size of each page in file. This value must be larger
+      * or equal than 64.
+      * @param cacheSize Size of the page cache in bytes.
+      * @exception std::logic_error If the file can not be created.
+      */
+      stConcurrentPageManager(const char * fName, u_int32_t pagesize,
+            u_int64_t cacheSize = STCONCURRENTPAGEMANAGER_DEFAULTCACHE);
+
+      /**
+      * Creates a new instance of this class. This constructor will open an
+      * existing file. The page cache will have
+      * STCONCURRENTPAGEMANAGER_DEFAULTCACHE bytes.
+      *
+      * @param fName The file name.
+      * @exception std::logic_error If the file can not be opened or the file is
+      * not a valid disk page manager file.
+      */
+      stConcurrentPageManager(const char * fName);
+
+      /**
+      * Disposes this page and free all allocated resources.
+      */
+      virtual ~stConcurrentPageManager();
+
+      /**
+      * This method will checks if this page manager is empty.
+      * If this method returns true, the stSlimTree will create a
+      * new tree otherwise it will continue to use the existing tree.
+      *
+      * @return True if the page manager is empty or false otherwise.
+      */
+      virtual bool IsEmpty();
+
+      /**
+      * Returns the header page. This method will return a special
+      * page that will be used by SlimTree to write some information
+      * about the tree itself.
+      *
+      * <P>The header page is kept in memory and shared by all threads.
+      *
+      * @return The header page.
+      * @see WriteHeaderPage()
+      */
+      virtual stPage * GetHeaderPage();
+
+      /**
+      * Returns a private copy of the page with the given page ID. This
+      * method is thread safe.
+      *
+      * @param pageid The desired page id.
+      * @return The page or NULL for an invalid page ID.
+      * @see WritePage()
+      * @see ReleasePage()
+      */
+      virtual stPage * GetPage(u_int32_t pageid);
+
+      /**
+      * Releases a page returned by this page manager. This method is thread
+      * safe.
+      *
+      * @param page The page.
+      * @see GetPage()
+      */
+      virtual void ReleasePage(stPage * page);
+
+      /**
+      * Allocates a new page for use.
+      *
+      * <P>To dispose this page (make it free), use DisposePage().
+      *
+      * @return A new page.
+      * @see ReleasePage()
+      * @see WritePage()
+      * @see DisposePage()
+      */
+      virtual stPage * GetNewPage();
+
+      /**
+      * Writes the given page to the disk and updates the page cache. This
+      * method will write the page but will not release it. Use
+      * ReleasePage() to do it.
+      *
+      * @param page The page to be written.
+      * @see ReleasePage()
+      */
+      virtual void WritePage(stPage * page);
+
+      /**
+      * Writes the header page to the disk.
+      *
+      * @see GetHeaderPage()
+      */
+      virtual void WriteHeaderPage(stPage * headerpage);
+
+      /**
+      * Disposes the given page. This method will make the page
+      * available (not allocated) for the next calls of GetNewPage().
+      *
+      * <P>Since this page will not be used anymore, this method will
+      * release the page.
+      *
+      * @param page The page to be disposed.
+      * @see GetNewPage()
+      */
+      virtual void DisposePage(stPage * page);
+
+      /**
+      * Returns the minimum size of a page. The size of the header page is
+      * always ignored since it may be smaller than others.
+      */
+      virtual u_int32_t GetMinimumPageSize(){
+         return header->PageSize;
+      }//end GetMinimumPageSize
+
+      /**
+      * Returns the number of pages.
+      */
+      virtual u_int32_t GetPageCount(){
+         return header->PageCount;
+      }//end GetPageCount
+
+      /**
+      * Forces the file to the disk.
+      */
+      virtual void Flush();
+
+      /**
+      * Resets the statistics of all threads.
+      */
+      virtual void ResetStatistics();
+
+      /**
+      * Returns the number of reads performed by all threads since the last
+      * call of ResetStatistics().
+      */
+      virtual long int GetReadCount();
+
+      /**
+      * Returns the number of writes performed by all threads since the last
+      * call of ResetStatistics().
+      */
+      virtual long int GetWriteCount();
+
+      /**
+      * Returns the number of reads served by the page cache.
+      */
+      long int GetCacheHitCount();
+
+   private:
+      #pragma pack(1)
+      /**
+      * The header of the file. It is the same header used by
+      * stPlainDiskPageManager.
+      */
+      struct tHeader{
+         /**
+         * Magic header. Always "DPM1".
+         */
+         char Magic[4];
+
+         /**
+         * Size of each page in bytes.
+         */
+         u_int32_t PageSize;
+
+         /**
+         * Number of pages allocated including deleted ones and the header pages.
+         * In other words, it is the id of last allocated page.
+         */
+         u_int32_t PageCount;
+
+         /**
+         * Number of used pages.
+         */
+         u_int32_t UsedPages;
+
+         /**
+         * The page ID of the first available page. It is used
+         * to manage the free list.
+         */
+         u_int32_t Available;
+      };//end tHeader
+      #pragma pack()
+
+      /**
+      * A slot of the page cache.
+      */
+      struct tSlot{
+         /**
+         * Sequence lock. It is odd while the slot is being modified.
+         */
+         std::atomic<u_int32_t> Sequence;
+
+         /**
+         * The page in this slot or 0.
+         */
+         std::atomic<u_int32_t> PageID;
+      };//end tSlot
+
+      /**
+      * Statistic counters of a stripe. Each stripe uses its own cache line.
+      */
+      struct alignas(64) tCounters{
+         /**
+         * Number of reads.
+         */
+         std::atomic<long> Reads;
+
+         /**
+         * Number of writes.
+         */
+         std::atomic<long> Writes;
+
+         /**
+         * Number of cache hits.
+         */
+         std::atomic<long> Hits;
+      };//end tCounters
+
+      /**
+      * File descriptor.
+      */
+      int fd;
+
+      /**
+      * The header of this instance. It points to the headerPage's
+      * internal buffer.
+      */
+      tHeader * header;
+
+      /**
+      * Header page.
+      */
+      stLockablePage * headerPage;
+
+      /**
+      * Serializes the allocation, disposal and writing of pages.
+      */
+      std::mutex writeMutex;
+
+      /**
+      * Slots of the page cache.
+      */
+      tSlot * slots;
+
+      /**
+      * Data of the slots. The slot i uses the bytes starting at
+      * i * PageSize.
+      */
+      unsigned char * slotData;
+
+      /**
+      * Number of slots. It is a power of 2.
+      */
+      u_int32_t slotCount;
+
+      /**
+      * Statistic counters.
+      */
+      tCounters counters[STCONCURRENTPAGEMANAGER_STRIPES];
+
+      /**
+      * Creates the page cache.
+      *
+      * @param cacheSize Size of the page cache in bytes.
+      */
+      void CreateCache(u_int64_t cacheSize);
+
+      /**
+      * Returns the slot of a page.
+      *
+      * @param pageid The page id.
+      */
+      u_int32_t GetSlot(u_int32_t pageid){
+         return pageid & (slotCount - 1);
+      }//end GetSlot
+
+      /**
+      * Copies a page from the cache.
+      *
+      * @param pageid The page id.
+      * @param data The destination.
+      * @return True if the page was found or false otherwise.
+      */
+      bool CacheRead(u_int32_t pageid, unsigned char * data);
+
+      /**
+      * Copies a page into the cache. It waits for the slot.
+      *
+      * @param pageid The page id.
+      * @param data The page data.
+      */
+      void CacheWrite(u_int32_t pageid, const unsigned char * data);
+
+      /**
+      * Returns the sequence of the slot of a page. It must be read before
+      * the page is read from the disk and given to CacheFill().
+      *
+      * @param pageid The page id.
+      */
+      u_int32_t CacheSequence(u_int32_t pageid){
+         return slots[GetSlot(pageid)].Sequence.load(std::memory_order_acquire);
+      }//end CacheSequence
+
+      /**
+      * Copies a page read from the disk into the cache, but only if its slot
+      * was not modified since its sequence was read. Otherwise, a WritePage()
+      * may have cached a newer image and the page is not cached.
+      *
+      * @param pageid The page id.
+      * @param data The page data.
+      * @param seq The sequence returned by CacheSequence() before the read.
+      */
+      void CacheFill(u_int32_t pageid, const unsigned char * data, u_int32_t seq);
+
+      /**
+      * Returns the statistic counters of the calling thread.
+      */
+      tCounters & GetCounters();
+
+      /**
+      * Reads a page from the disk.
+      *
+      * @param pageid The page id.
+      * @param data The destination.
+      */
+      void DiskRead(u_int32_t pageid, unsigned char * data){
+         pread(fd, data, header->PageSize, PageID2Offset(pageid));
+      }//end DiskRead
+
+      /**
+      * Writes a page to the disk.
+      *
+      * @param pageid The page id.
+      * @param data The page data.
+      */
+      void DiskWrite(u_int32_t pageid, const unsigned char * data){
+         pwrite(fd, data, header->PageSize, PageID2Offset(pageid));
+      }//end DiskWrite
+
+      /**
+      * Creates the header for an empty file.
+      *
+      * @param header the pointer to the header.
+      * @param pagesize the size of the page.
+      */
+      void NewHeader(tHeader * header, u_int32_t pagesize);
+
+      /**
+      * Validates a header.
+      *
+      * @param header The header.
+      * @return True for a valid header of false otherwise.
+      */
+      bool IsValidHeader(tHeader * header);
+
+      /**
+      * Converts a page ID to the file offset.
+      *
+      * @param pageid The page id.
+      * @return The offset of the given page id.
+      */
+      off_t PageID2Offset(u_int32_t pageid){
+         return ((off_t) pageid) * header->PageSize;
+      }//end PageID2Offset
+
+};//end stConcurrentPageManager
+
+#endif //__STCONCURRENTPAGEMANAGER_H
@@ -5463,7 +5463,8 @@ stResult<ObjectType> * stDBMTree<ObjectType, EvaluatorType>::RangeQuery(
                if (!currNode->GetEntry(idx).PageID){
                   // No, there is not a subtree. But this object qualifies.
                   // Add the object.
-                  result->AddPair(tmpObj.Clone(), distance);
+                  result->AddPair(currNode->GetObject(idx),
+                                  currNode->GetObjectSize(idx), distance);
 
                   #ifdef __stMAMVIEW__
                      comment.Clear();
@@ -5592,7 +5593,8 @@ void stDBMTree<ObjectType, EvaluatorType>::RangeQuery(
             // is there a subtree?
             if (!currNode->GetEntry(idx).PageID){
                // No, there is not a subtree. But this object qualifies.
-               result->AddPair(tmpObj.Clone(), distance);
+               result->AddPair(currNode->GetObject(idx),
+                               currNode->GetObjectSize(idx), distance);
 
                #ifdef __stMAMVIEW__
                   comment.Clear();
@@ -5761,7 +5763,8 @@ stResult<ObjectType> * stDBMTree<ObjectType, EvaluatorType>::NearestQuery(
 	               if (distance <= rangeK){
 	                  // No, there is not a subtree. But this object qualifies.
 	                  // Add the object.
-	                  result->AddPair(tmpObj.Clone(), distance);
+	                  result->AddPair(currNode->GetObject(idx),
+	                                  currNode->GetObjectSize(idx), distance);
 	                  // there is more than k elements?
 	                  if (result->GetNumOfEntries() >= k){
 	                     //cut if there is more than k elements
@@ -5948,7 +5951,8 @@ void stDBMTree<ObjectType, EvaluatorType>::NearestQuery(tResult * result,
 	               if (distance <= rangeK){
 	                  // No, there is not a subtree. But this object qualifies.
 	                  // Add the object.
-	                  result->AddPair(tmpObj.Clone(), distance);
+	                  result->AddPair(currNode->GetObject(idx),
+	                                  currNode->GetObjectSize(idx), distance);
 	                  // there is more than k elements?
 	                  if (result->GetNumOfEntries() >= k){
 	                     //cut if there is more than k elements
@@ -6555,7 +6559,8 @@ stResult<ObjectType> * stDBMTree<ObjectType, EvaluatorType>::PointQuery(
                   //test if the object qualify
                   if (distance == 0){
                      // Add the object.
-                     result->AddPair(tmpObj.Clone(), distance);
+                     result->AddPair(currNode->GetObject(idx),
+                                     currNode->GetObjectSize(idx), distance);
                      // find the element, stop the query!
                      find = true;
                   }//end if
@@ -6634,7 +6639,8 @@ void stDBMTree<ObjectType, EvaluatorType>::PointQuery(
                   //test if the object qualify
                   if (distance == 0){
                      // Add the object.
-                     result->AddPair(tmpObj.Clone(), distance);
+                     result->AddPair(currNode->GetObject(idx),
+                                     currNode->GetObjectSize(idx), distance);
                      // find the element, stop the query!
                      find = true;
                   }//end if
@@ -1985,7 +1985,8 @@ stResult<ObjectType> * tmpl_stDFTree::RangeQuery(
                // is it a object that qualified?
                if (distance <= range){
                   // Yes! Put it in the result set.
-                  result->AddPair(tmpObj.Clone(), distance);
+                  result->AddPair(leafNode->GetObject(idx),
+                                  leafNode->GetObjectSize(idx), distance);
                }//end if
             }//end if
          }//end for
@@ -2068,7 +2069,8 @@ void tmpl_stDFTree::RangeQuery(u_int32_t pageID, tResult * result,
                    // Is this a qualified object?
                    if (distance <= range){
                       // Yes! Put it in the result set.
-                      result->AddPair(tmpObj.Clone(), distance);
+                      result->AddPair(leafNode->GetObject(idx),
+                                      leafNode->GetObjectSize(idx), distance);
                    }//end if
                }//end if
             }//end if
@@ -2184,7 +2186,8 @@ void stDFTree<ObjectType, EvaluatorType>::NearestQuery(tResult * result,
                    //test if the object qualify
                    if (distance <= rangeK){
                       // Add the object.
-                      result->AddPair(tmpObj.Clone(), distance);
+                      result->AddPair(leafNode->GetObject(idx),
+                                      leafNode->GetObjectSize(idx), distance);
                       // there is more than k elements?
                       if (result->GetNumOfEntries() >= k){
                          //cut if there is more than k elements
@@ -2328,7 +2331,8 @@ void stDFTree<ObjectType, EvaluatorType>::PointQuery(
                   //test if the object qualify
                   if (distance == 0){
                      // Add the object.
-                     result->AddPair(tmpObj.Clone(), distance);
+                     result->AddPair(leafNode->GetObject(idx),
+                                     leafNode->GetObjectSize(idx), distance);
                      // Stop the query because the object was found!
                      find = true;
                   }//end if
@@ -28,6 +28,7 @@
 
 #include  <arboretum/stPageManager.h>
 #include  <arboretum/CStorage.h>
+#include  <arboretum/stBufferPool.h>
 #include  <arboretum/stUtil.h>
 
 //==============================================================================
@@ -40,6 +41,10 @@
 *<P> This version uses CStorage to disk access, ie, all disk controls is made by
 * CStorage.
 *
+*<P> An optional stBufferPool may be placed between the trees and CStorage
+* with SetBufferPool(). When it is enabled, GetPage() returns the pinned frame
+* of the page and ReleasePage() unpins it.
+*
 * @version 1.0
 * @author Marcos Rodrigues Vieira (mrvieira@icmc.usp.br)
 * @author Josiel Maimone de Figueiredo (josiel@icmc.usp.br)
@@ -59,6 +64,7 @@ class stDiskPageManager: public stPageManager{
       */
       stDiskPageManager(){
          myStorage = NULL;
+         bufferPool = NULL;
       }//end stDiskPageManager
 
       /**
@@ -71,11 +77,13 @@ class stDiskPageManager: public stPageManager{
       * @param userHeaderSize Size of header.
       * @param cacheNPages Number of pages holded by cache. This value must
       * be larger or equal than 5.
+      * @param checksum If true, each page will be protected by a checksum.
+      * See CStorage for details.
       * @exception std::logic_error If the file can not be created.
       */
       stDiskPageManager(const std::string & fName, u_int32_t pagesize,
             u_int32_t userHeaderSize = -1,
-            int cacheNPages = 5);
+            int cacheNPages = 5, bool checksum = false);
 
       /**
       * Creates a new instance of this class. This constructor will open an
@@ -193,10 +201,22 @@ class stDiskPageManager: public stPageManager{
       * release the lock for this page instance.
       *
       * @param page The page to be disposed.
+      * @exception std::logic_error If the buffer pool is enabled and the page
+      * was also returned to someone else who did not release it.
       * @see GetNewPage()
       */
       virtual void DisposePage(stPage * page);
 
+      /**
+      * Hints that the given pages will be read soon. Pages held by the buffer
+      * pool are ignored. The others are hinted to the operating system by
+      * CStorage.
+      *
+      * @param pageIDs The ids of the pages.
+      * @param n The number of ids.
+      */
+      virtual void Prefetch(const u_int32_t * pageIDs, u_int32_t n);
+
       /**
       * Create a disk file that will store the data
       *
@@ -257,7 +277,27 @@ class stDiskPageManager: public stPageManager{
       /**
       * Flushes the cache data to disk.
       */
-      void Flush();
+      virtual void Flush();
+
+      /**
+      * Enables the buffer pool. The current pool, if any, is flushed and
+      * replaced. No page may be locked when this method is called.
+      *
+      * @param budget Maximum number of bytes used by the pool. Use 0 to
+      * disable the buffer pool.
+      * @param policy The replacement policy.
+      * @see stBufferPool
+      */
+      void SetBufferPool(u_int64_t budget,
+            stBufferPool::tReplacementPolicy policy = stBufferPool::rpLRU);
+
+      /**
+      * Returns the buffer pool or NULL if it is disabled. Use it to access
+      * the hit, miss and eviction counters.
+      */
+      stBufferPool * GetBufferPool(){
+         return bufferPool;
+      }//end GetBufferPool
 
       /**
       * Restarts the statistics.
@@ -323,6 +363,11 @@ class stDiskPageManager: public stPageManager{
       * page will not use the cache because it has a different size.
       */
       stPageInstanceCache * pageInstanceCache;
+
+      /**
+      * The buffer pool or NULL if it is disabled.
+      */
+      stBufferPool * bufferPool;
    
       /**
       * Controler of disk access.
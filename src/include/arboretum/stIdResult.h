@@ -0,0 +1,253 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**
+* @file
+*
+* This file defines the classes stIdPair and stIdResult.
+*
+* @version 1.0
+*/
+#ifndef __STIDRESULT_H
+#define __STIDRESULT_H
+
+#include <arboretum/stCommon.h>
+#include <arboretum/stResult.h>
+#include <vector>
+
+//----------------------------------------------------------------------------
+// Class stIdPair
+//----------------------------------------------------------------------------
+/**
+* This class defines the pair OID/Distance stored by stIdResult.
+*
+* @version 1.0
+* @ingroup struct
+* @see stIdResult
+*/
+class stIdPair{
+   public:
+      /**
+      * Returns the OID of the object.
+      */
+      u_int32_t GetOID() const{
+         return OID;
+      }//end GetOID
+
+      /**
+      * Returns the distance from the sample.
+      */
+      double GetDistance() const{
+         return Distance;
+      }//end GetDistance
+
+   private:
+      /**
+      * The distance from the sample.
+      */
+      double Distance;
+
+      /**
+      * The OID of the object.
+      */
+      u_int32_t OID;
+
+      friend class stIdResult;
+};//end stIdPair
+
+//----------------------------------------------------------------------------
+// Class stIdResult
+//----------------------------------------------------------------------------
+/**
+* This class implements a query result that holds only the OID of each
+* object and its distance from the sample. It is filled by the Id*Query()
+* methods of the metric trees, which never rebuild the objects they find.
+*
+* <P>The pairs are kept in a single packed array. While the query runs the
+* array is a max-heap on the distance, so Cut() and GetMaximumDistance() are
+* cheap for k-nearest neighbor queries. The first call to GetPair() or
+* GetPairs() sorts it by distance, and the sorted array may be handed to the
+* application as is.
+*
+* @version 1.0
+* @ingroup struct
+* @see stResult
+*/
+class stIdResult{
+   public:
+      /**
+      * Creates a new empty result.
+      */
+      stIdResult(){
+         SetQueryInfo();
+         Sorted = true;
+      }//end stIdResult
+
+      /**
+      * Adds information about the query.
+      *
+      * @param querytype The query type (see tQueryType).
+      * @param k The value of k (if it makes sence).
+      * @param radius The value of radius (if it makes sence).
+      * @param tie The tie list.
+      */
+      void SetQueryInfo(int querytype = UNKNOWN, u_int32_t k = 0,
+            double radius = 0.0, bool tie = false){
+         QueryType = querytype;
+         K = k;
+         Radius = radius;
+         Tie = tie;
+      }//end SetQueryInfo
+
+      /**
+      * Returns the type of the query.
+      */
+      int GetQueryType(){
+         return QueryType;
+      }//end GetQueryType
+
+      /**
+      * Returns the k of the query.
+      */
+      unsigned int GetK(){
+         return K;
+      }//end GetK
+
+      /**
+      * Returns the radius of the query.
+      */
+      double GetRadius(){
+         return Radius;
+      }//end GetRadius
+
+      /**
+      * Returns true if the ties of the k-th pair are kept.
+      */
+      bool GetTie(){
+         return Tie;
+      }//end GetTie
+
+      /**
+      * Returns the number of pairs.
+      */
+      unsigned int GetNumOfEntries(){
+         return Pairs.size();
+      }//end GetNumOfEntries
+
+      /**
+      * Adds a pair OID/Distance.
+      *
+      * @param oid The OID of the object.
+      * @param distance The distance from the sample object.
+      * @warning There is no duplicate pair checking.
+      */
+      void AddPair(u_int32_t oid, double distance);
+
+      /**
+      * Returns a pair. Pairs are ordered by distance.
+      *
+      * @param idx The index of the pair.
+      */
+      const stIdPair & GetPair(unsigned int idx){
+         Sort();
+         return Pairs[idx];
+      }//end GetPair
+
+      /**
+      * Returns the array of pairs ordered by distance. It is valid until
+      * the next change of this result.
+      */
+      const stIdPair * GetPairs(){
+         Sort();
+         return Pairs.data();
+      }//end GetPairs
+
+      /**
+      * Returns the smallest distance or -1 if this result is empty.
+      */
+      double GetMinimumDistance();
+
+      /**
+      * Returns the greatest distance or -1 if this result is empty.
+      */
+      double GetMaximumDistance(){
+         if (Pairs.empty()){
+            return -1;
+         }//end if
+         return Sorted ? Pairs.back().Distance : Pairs.front().Distance;
+      }//end GetMaximumDistance
+
+      /**
+      * Removes the pair with the greatest distance.
+      */
+      void RemoveLast();
+
+      /**
+      * Removes the pairs with the greatest distances until this result has
+      * <i>limit</i> pairs. If the tie list is enabled, the pairs whose
+      * distance is equal to the distance of the last kept pair are kept.
+      *
+      * @param limit The number of pairs to keep.
+      */
+      void Cut(unsigned int limit);
+
+      /**
+      * Removes all pairs.
+      */
+      void Clear(){
+         Pairs.clear();
+         Sorted = true;
+      }//end Clear
+
+   private:
+      /**
+      * The pairs.
+      */
+      std::vector<stIdPair> Pairs;
+
+      /**
+      * If true, Pairs is sorted by distance. Otherwise it is a max-heap.
+      */
+      bool Sorted;
+
+      /**
+      * The type of the query.
+      */
+      int QueryType;
+
+      /**
+      * The k of the query.
+      */
+      unsigned int K;
+
+      /**
+      * The radius of the query.
+      */
+      double Radius;
+
+      /**
+      * The tie list flag.
+      */
+      bool Tie;
+
+      /**
+      * Turns Pairs into a max-heap.
+      */
+      void MakeHeap();
+
+      /**
+      * Sorts Pairs by distance.
+      */
+      void Sort();
+};//end stIdResult
+
+#endif //__STIDRESULT_H
@@ -115,6 +115,21 @@ class stResult : public stBasicResult < ObjectType > {
       */
       void AddPair(tObject * obj, double distance);
 
+      /**
+      * This method adds a pair Object/Distance to this result list from a
+      * serialized object. This implementation unserializes it immediately.
+      *
+      * @param data The serialized object.
+      * @param size The size of the serialized object.
+      * @param distance The distance from the sample object.
+      */
+      void AddPair(const unsigned char * data, u_int32_t size, double distance){
+         tObject * obj = new tObject();
+
+         obj->Unserialize(data, size);
+         AddPair(obj, distance);
+      }//end AddPair
+
       /**
       * This method will remove the last object from this result list.
       */
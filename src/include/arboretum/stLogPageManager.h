@@ -0,0 +1,425 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**
+* @file
+*
+* This file defines the class stLogPageManager.
+*
+* @version 1.0
+*/
+#ifndef __STLOGPAGEMANAGER_H
+#define __STLOGPAGEMANAGER_H
+
+#include <stdexcept>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <arboretum/stPageManager.h>
+#include <arboretum/stCommonIO.h>
+#include <arboretum/stChecksum.h>
+
+/**
+* Default size of the log in bytes that triggers a checkpoint (16 MB).
+*/
+#define STLOGPAGEMANAGER_DEFAULTCHECKPOINT (((u_int64_t) 1) << 24)
+
+//==============================================================================
+// stLogPageManager
+//------------------------------------------------------------------------------
+/**
+* This class adds a redo log (write-ahead log) to another page manager. It
+* makes the modifications of a tree atomic, so a crash never leaves a broken
+* tree on disk.
+*
+* <P>The modifications are grouped in transactions. A transaction ends when
+* Commit() or Flush() is called; stSlimTree::Flush() writes the header of the
+* tree and calls Flush(), so it should be called after each insertion or
+* batch of insertions. The written pages are kept in memory until the next
+* checkpoint (no-steal), so the base page manager only sees committed
+* transactions.
+*
+* <P>Commit() appends the images of all pages written in the transaction and a
+* commit record, protected by CRC32C, to the log file. The log is forced to the
+* disk once every <i>groupSize</i> commits (group commit). A crash may lose the
+* last commits not forced yet, but never a part of a transaction.
+*
+* <P>When the log grows beyond <i>checkpointSize</i> bytes, the pages are
+* written to the base page manager, the base is flushed and the log is
+* truncated. Disposed pages are kept out of the free list of the base until
+* the checkpoint is complete. When the log is opened, the committed
+* transactions are replayed and a checkpoint is executed, so the recovery time
+* depends only on the size of the log.
+*
+* <P>The base page manager must make its contents durable when its Flush() is
+* called, e.g. stPlainDiskPageManager with SetDeferredHeader(n, true). A crash
+* during a checkpoint may leak disposed pages but never reuses a page that is
+* still referenced by the tree.
+*
+* @version 1.0
+* @see stPageManager
+* @see stPlainDiskPageManager
+* @ingroup storage
+*/
+class stLogPageManager: public stPageManager{
+   public:
+      /**
+      * Creates a new instance of this class. If the log file exists, the
+      * committed transactions found in it are applied to the base page
+      * manager.
+      *
+      * @param base The base page manager. It is not disposed by this class.
+      * @param logName The name of the log file.
+      * @param groupSize Number of commits that share a single disk sync.
+      * @param checkpointSize Size of the log in bytes that triggers a
+      * checkpoint.
+      * @exception std::logic_error If the log file can not be opened.
+      */
+      stLogPageManager(stPageManager * base, const char * logName,
+            u_int32_t groupSize = 1,
+            u_int64_t checkpointSize = STLOGPAGEMANAGER_DEFAULTCHECKPOINT);
+
+      /**
+      * Commits the current transaction, executes a checkpoint and closes the
+      * log file.
+      */
+      virtual ~stLogPageManager();
+
+      /**
+      * This method will checks if this page manager is empty.
+      * If this method returns true, the stSlimTree will create a
+      * new tree otherwise it will continue to use the existing tree.
+      *
+      * @return True if the page manager is empty or false otherwise.
+      */
+      virtual bool IsEmpty(){
+         return base->IsEmpty() && pages.empty();
+      }//end IsEmpty
+
+      /**
+      * Returns the header page. It is a copy of the header page of the base
+      * page manager that is updated only by checkpoints.
+      *
+      * @return The header page.
+      * @see WriteHeaderPage()
+      */
+      virtual stPage * GetHeaderPage();
+
+      /**
+      * Returns the page with the given page ID. Pages modified since the
+      * last checkpoint are returned from memory.
+      *
+      * @param pageid The desired page id.
+      * @return The page or NULL for an invalid page ID.
+      * @see WritePage()
+      * @see ReleasePage()
+      */
+      virtual stPage * GetPage(u_int32_t pageid);
+
+      /**
+      * Releases a page returned by this page manager.
+      *
+      * @param page The page.
+      * @see GetPage()
+      */
+      virtual void ReleasePage(stPage * page);
+
+      /**
+      * Allocates a new page for use. The allocation is done by the base
+      * page manager.
+      *
+      * @return A new page.
+      * @see ReleasePage()
+      * @see WritePage()
+      * @see DisposePage()
+      */
+      virtual stPage * GetNewPage();
+
+      /**
+      * Adds the page to the current transaction. It will be written to the
+      * log by the next Commit().
+      *
+      * @param page The page to be written.
+      * @see Commit()
+      */
+      virtual void WritePage(stPage * page);
+
+      /**
+      * Adds the header page to the current transaction.
+      *
+      * @param headerpage The header page.
+      * @see GetHeaderPage()
+      */
+      virtual void WriteHeaderPage(stPage * headerpage);
+
+      /**
+      * Adds the disposal of the page to the current transaction. The page
+      * will be disposed in the base page manager by the next checkpoint.
+      *
+      * @param page The page to be disposed.
+      * @see GetNewPage()
+      */
+      virtual void DisposePage(stPage * page);
+
+      /**
+      * Forwards the hint to the base page manager.
+      *
+      * @param pageIDs The ids of the pages.
+      * @param n The number of ids.
+      */
+      virtual void Prefetch(const u_int32_t * pageIDs, u_int32_t n){
+         base->Prefetch(pageIDs, n);
+      }//end Prefetch
+
+      /**
+      * Commits the current transaction. Same as Commit().
+      */
+      virtual void Flush(){
+         Commit();
+      }//end Flush
+
+      /**
+      * Returns the minimum size of a page. The size of the header page is
+      * always ignored since it may be smaller than others.
+      */
+      virtual u_int32_t GetMinimumPageSize(){
+         return base->GetMinimumPageSize();
+      }//end GetMinimumPageSize
+
+      /**
+      * Returns the number of pages.
+      */
+      virtual u_int32_t GetPageCount(){
+         return base->GetPageCount();
+      }//end GetPageCount
+
+      /**
+      * Ends the current transaction. Its pages are written to the log and,
+      * once every <i>groupSize</i> commits, the log is forced to the disk.
+      * It may also execute a checkpoint.
+      */
+      void Commit();
+
+      /**
+      * Forces the log to the disk. All committed transactions become
+      * durable.
+      */
+      void Sync();
+
+      /**
+      * Commits the current transaction and writes all committed pages to the
+      * base page manager. The log is truncated.
+      */
+      void Checkpoint(){
+         Commit();
+         Apply();
+      }//end Checkpoint
+
+      /**
+      * Returns the current size of the log in bytes.
+      */
+      u_int64_t GetLogSize(){
+         return logSize;
+      }//end GetLogSize
+
+      /**
+      * Returns the number of transactions recovered from the log when this
+      * instance was created.
+      */
+      u_int32_t GetRecoveredCount(){
+         return recovered;
+      }//end GetRecoveredCount
+
+   private:
+      /**
+      * Types of log records.
+      */
+      enum tRecordType{
+         /**
+         * Image of a page.
+         */
+         rtPAGE = 1,
+
+         /**
+         * Image of the header page.
+         */
+         rtHEADER = 2,
+
+         /**
+         * Page disposal.
+         */
+         rtDISPOSE = 3,
+
+         /**
+         * End of a transaction.
+         */
+         rtCOMMIT = 4
+      };//end tRecordType
+
+      #pragma pack(1)
+      /**
+      * Header of a log record. It is followed by Size bytes of data.
+      */
+      struct tRecord{
+         /**
+         * Type of the record (tRecordType).
+         */
+         u_int32_t Type;
+
+         /**
+         * Page ID.
+         */
+         u_int32_t PageID;
+
+         /**
+         * Size of the data.
+         */
+         u_int32_t Size;
+
+         /**
+         * CRC32C of the record with this field set to 0 followed by the
+         * data.
+         */
+         u_int32_t Checksum;
+      };//end tRecord
+      #pragma pack()
+
+      /**
+      * The base page manager.
+      */
+      stPageManager * base;
+
+      /**
+      * The header page of the base page manager.
+      */
+      stPage * baseHeader;
+
+      /**
+      * The header page seen by the tree.
+      */
+      stPage * headerPage;
+
+      /**
+      * Log file descriptor.
+      */
+      int logFd;
+
+      /**
+      * Size of the log in bytes.
+      */
+      u_int64_t logSize;
+
+      /**
+      * Number of commits that share a single disk sync.
+      */
+      u_int32_t groupSize;
+
+      /**
+      * Size of the log that triggers a checkpoint.
+      */
+      u_int64_t checkpointSize;
+
+      /**
+      * Number of commits not forced to the disk.
+      */
+      u_int32_t unsynced;
+
+      /**
+      * Number of transactions recovered.
+      */
+      u_int32_t recovered;
+
+      /**
+      * Images of the pages written since the last checkpoint.
+      */
+      std::unordered_map<u_int32_t, stPage *> pages;
+
+      /**
+      * Pages written in the current transaction.
+      */
+      std::unordered_set<u_int32_t> batch;
+
+      /**
+      * Pages disposed since the last checkpoint.
+      */
+      std::vector<u_int32_t> disposed;
+
+      /**
+      * Number of entries of disposed that belong to the current
+      * transaction.
+      */
+      u_int32_t batchDisposed;
+
+      /**
+      * If true, the header was written in the current transaction.
+      */
+      bool batchHeader;
+
+      /**
+      * If true, the header was written since the last checkpoint.
+      */
+      bool dirtyHeader;
+
+      /**
+      * If true, pages were allocated in the current transaction.
+      */
+      bool batchAllocated;
+
+      /**
+      * Pages returned by GetPage() that belong to this instance.
+      */
+      std::unordered_set<stPage *> ownPages;
+
+      /**
+      * Buffer used to build the log records.
+      */
+      std::vector<unsigned char> buffer;
+
+      /**
+      * Appends a record to the buffer.
+      *
+      * @param type The type of the record.
+      * @param pageid The page id.
+      * @param data The data.
+      * @param size The size of the data.
+      */
+      void AppendRecord(u_int32_t type, u_int32_t pageid, const void * data,
+            u_int32_t size);
+
+      /**
+      * Stores the image of a page.
+      *
+      * @param pageid The page id.
+      * @param data The data.
+      * @param size The size of the data.
+      */
+      void StoreImage(u_int32_t pageid, const unsigned char * data,
+            u_int32_t size);
+
+      /**
+      * Writes all committed pages to the base page manager, truncates the
+      * log and disposes the pending pages. The current transaction must be
+      * empty.
+      */
+      void Apply();
+
+      /**
+      * Reads the log and loads all committed transactions.
+      *
+      * @return The number of transactions found.
+      */
+      u_int32_t Recover();
+
+};//end stLogPageManager
+
+#endif //__STLOGPAGEMANAGER_H
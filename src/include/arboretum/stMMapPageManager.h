@@ -0,0 +1,443 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**
+* @file
+*
+* This file defines the class stMMapPageManager.
+*
+* @version 1.0
+*/
+#ifndef __STMMAPPAGEMANAGER_H
+#define __STMMAPPAGEMANAGER_H
+
+#include <stdexcept>
+
+#include <arboretum/stPageManager.h>
+#include <arboretum/stUtil.h>
+#include <arboretum/stCommonIO.h>
+
+/**
+* Default size of the address space reserved for the mapping (64 GB).
+*/
+#define STMMAPPAGEMANAGER_DEFAULTRESERVE (((u_int64_t) 1) << 36)
+
+/**
+* The file grows in extents of at least this number of bytes (16 MB).
+*/
+#define STMMAPPAGEMANAGER_EXTENTSIZE (((u_int64_t) 1) << 24)
+
+//==============================================================================
+// stMMapPageManager
+//------------------------------------------------------------------------------
+/**
+* This class implements a page manager backed by a memory mapped file. The
+* pages returned by GetPage() and GetNewPage() are instances of stMappedPage
+* which point directly into the mapping, so reading a node costs neither a
+* system call nor a copy. Read-mostly trees are served straight from the
+* operating system page cache.
+*
+* <P>The file layout is the same used by stPlainDiskPageManager (header page
+* with the "DPM1" header followed by the data pages), so files created by one
+* of them may be opened by the other.
+*
+* <P>The mapping reserves a large segment of the address space when the file is
+* opened and the file grows inside it in extents of at least
+* STMMAPPAGEMANAGER_EXTENTSIZE bytes. Since the mapping never moves, pages
+* returned before a growth remain valid. If the file outgrows the reserved
+* segment, this page manager tries to extend the mapping in place and fails
+* with std::logic_error if it is not possible.
+*
+* <P>Since the pages share the memory of the mapping, WritePage() does not copy
+* anything. Use Flush() to force the modified pages to the disk.
+*
+* <P>An existing file may also be opened in read-only mode. The file is mapped
+* without write permission, so any number of processes may open it at the same
+* time and share a single physical copy of each page through the operating
+* system page cache. Opening costs only the mapping itself because no page is
+* read in advance. Place the file in a memory file system (/dev/shm) to serve
+* it without a disk. LockPages() keeps a hot set (usually the upper levels of
+* the tree) resident for all processes.
+*
+* @version 1.0
+* @see stPageManager
+* @see stPlainDiskPageManager
+* @see stMappedPage
+* @ingroup storage
+*/
+class stMMapPageManager: public stPageManager{
+   public:
+      /**
+      * Access modes of existing files.
+      */
+      enum tAccessMode{
+         /**
+         * The file may be read and modified.
+         */
+         amReadWrite,
+
+         /**
+         * The file may only be read. All methods that modify it throw
+         * std::logic_error, except WriteHeaderPage() which only changes the
+         * private copy of the header page. The pages are mapped without
+         * write permission, so changing their contents raises SIGSEGV. Do
+         * not insert or remove objects from a tree opened in this mode.
+         */
+         amReadOnly
+      };//end tAccessMode
+
+      /**
+      * Creates a new instance of this class. This constructor will create a new
+      * file with the given name.
+      *
+      * @param fName The file name.
+      * @param pagesize Size of each page in file. This value must be larger
+      * or equal than 64.
+      * @param reserve Size of the address space reserved for the mapping.
+      * @exception std::logic_error If the file can not be created or mapped.
+      */
+      stMMapPageManager(const char * fName, u_int32_t pagesize,
+            u_int64_t reserve = STMMAPPAGEMANAGER_DEFAULTRESERVE);
+
+      /**
+      * Creates a new instance of this class. This constructor will open an
+      * existing file.
+      *
+      * <P>The reserved address space is STMMAPPAGEMANAGER_DEFAULTRESERVE or the
+      * file size, whichever is larger. Read-only files are mapped with their
+      * exact size since they never grow.
+      *
+      * <P>The file may end before its last page, as stPlainDiskPageManager
+      * does not write the pages that were allocated but never written. In
+      * read-write mode the file grows to hold all pages. In read-only mode
+      * the missing pages read as zeroes.
+      *
+      * @param fName The file name.
+      * @param mode The access mode.
+      * @exception std::logic_error If the file can not be opened or the file is
+      * not a valid disk page manager file.
+      */
+      stMMapPageManager(const char * fName, tAccessMode mode = amReadWrite);
+
+      /**
+      * Disposes this page and free all allocated resources. The file is
+      * truncated to the size of the allocated pages.
+      */
+      virtual ~stMMapPageManager();
+
+      /**
+      * This method will checks if this page manager is empty.
+      * If this method returns true, the stSlimTree will create a
+      * new tree otherwise it will continue to use the existing tree.
+      *
+      * @return True if the page manager is empty or false otherwise.
+      */
+      virtual bool IsEmpty();
+
+      /**
+      * Returns the header page. This method will return a special
+      * page that will be used by SlimTree to write some information
+      * about the tree itself.
+      *
+      * <P>The header page is a private copy of the first page of the file. Use
+      * WriteHeaderPage() to copy it back to the mapping.
+      *
+      * @return The header page.
+      * @see WriteHeaderPage()
+      * @see ReleasePage()
+      */
+      virtual stPage * GetHeaderPage();
+
+      /**
+      * Returns the page with the given page ID. The returned page points
+      * directly into the mapping. Use WritePage() to notify the changes.
+      *
+      * <P>The returning instance of stPage will be locked to prevent
+      * its reuse by this page manager. Use ReleasePage() to unlock
+      * this instance.
+      *
+      * @param pageid The desired page id.
+      * @return The page or NULL for an invalid page ID.
+      * @see WritePage()
+      * @see ReleasePage()
+      */
+      virtual stPage * GetPage(u_int32_t pageid);
+
+      /**
+      * Releases this instace for reuse by this page manager.
+      *
+      * @param page The locked page.
+      * @see GetPage()
+      * @see GetHeaderPage()
+      */
+      virtual void ReleasePage(stPage * page);
+
+      /**
+      * Allocates a new page for use. As GetPage() and
+      * GetHeaderPage(), the returning instance will be
+      * locked to prevent reuse by this page manager.
+      *
+      * <P>To dispose this page (make it free), use DisposePage().
+      *
+      * @return A new page or NULL for errors.
+      * @exception std::logic_error If the file can not grow.
+      * @see ReleasePage()
+      * @see WritePage()
+      * @see DisposePage()
+      */
+      virtual stPage * GetNewPage();
+
+      /**
+      * Notifies that the given page was modified. Since the pages returned by
+      * this page manager share the memory of the mapping, this method only
+      * copies the page if it is not one of them.
+      *
+      * @param page The page to be written.
+      * @see ReleasePage()
+      */
+      virtual void WritePage(stPage * page);
+
+      /**
+      * Copies the header page to the mapping.
+      *
+      * @see ReleasePage()
+      * @see WritePage()
+      */
+      virtual void WriteHeaderPage(stPage * headerpage);
+
+      /**
+      * Disposes the given page. This method will make the page
+      * available (not allocated) for the next calls of GetNewPage().
+      *
+      * <P>Since this page will not be used anymore, this method will
+      * release the lock for this page instance.
+      *
+      * @param page The page to be disposed.
+      * @see GetNewPage()
+      */
+      virtual void DisposePage(stPage * page);
+
+      /**
+      * Hints that the given pages will be read soon. The operating system is
+      * asked to bring them to the mapping in background (madvise).
+      *
+      * @param pageIDs The ids of the pages.
+      * @param n The number of ids.
+      */
+      virtual void Prefetch(const u_int32_t * pageIDs, u_int32_t n);
+
+      /**
+      * Returns the minimum size of a page. The size of the header page is
+      * always ignored since it may be smaller than others.
+      */
+      virtual u_int32_t GetMinimumPageSize(){
+         return header->PageSize;
+      }//end GetMinimumPageSize
+
+      /**
+      * Returns the number of pages.
+      */
+      virtual u_int32_t GetPageCount() {
+         return header->PageCount;
+      }//end GetPageCount
+
+      /**
+      * Writes the modified pages of the mapping to the disk. This method
+      * blocks until the operating system finishes the operation. It does
+      * nothing in read-only mode.
+      */
+      virtual void Flush();
+
+      /**
+      * Returns true if this page manager was opened in read-only mode.
+      */
+      bool IsReadOnly(){
+         return readOnly;
+      }//end IsReadOnly
+
+      /**
+      * Locks the given pages in memory (mlock). They will not be evicted
+      * while this page manager exists. Since the mapping is shared, other
+      * processes that map the same file use the same physical pages.
+      *
+      * <P>The amount of locked memory is limited by the operating system
+      * (RLIMIT_MEMLOCK). Pages are locked in the given order until the limit
+      * is reached.
+      *
+      * @param pageIDs The ids of the pages.
+      * @param n The number of ids.
+      * @return The number of pages locked.
+      */
+      u_int32_t LockPages(const u_int32_t * pageIDs, u_int32_t n);
+
+   private:
+      #pragma pack(1)
+      /**
+      * The header of the file. It is the same header used by
+      * stPlainDiskPageManager.
+      */
+      struct tHeader{
+         /**
+         * Magic header. Always "DPM1".
+         */
+         char Magic[4];
+
+         /**
+         * Size of each page in bytes.
+         */
+         u_int32_t PageSize;
+
+         /**
+         * Number of pages allocated including deleted ones and the header pages.
+         * In other words, it is the id of last allocated page.
+         */
+         u_int32_t PageCount;
+
+         /**
+         * Number of used pages.
+         */
+         u_int32_t UsedPages;
+
+         /**
+         * The page ID of the first available page. It is used
+         * to manage the free list.
+         */
+         u_int32_t Available;
+      };//end tHeader
+      #pragma pack()
+
+      /**
+      * Type of the instance cache used by this page manager.
+      */
+      typedef stInstanceCache <stMappedPage, stMappedPageAllocator> stPageInstanceCache;
+
+      /**
+      * The page instance cache used by this page manager. The header
+      * page will not use the cache because it is not mapped.
+      */
+      stPageInstanceCache * pageInstanceCache;
+
+      /**
+      * File descriptor.
+      */
+      int fd;
+
+      /**
+      * First byte of the mapping.
+      */
+      unsigned char * base;
+
+      /**
+      * Size of the mapping in bytes.
+      */
+      u_int64_t mapSize;
+
+      /**
+      * Current size of the file in bytes.
+      */
+      u_int64_t fileSize;
+
+      /**
+      * The header of this instance. It points to the headerPage's
+      * internal buffer.
+      */
+      tHeader * header;
+
+      /**
+      * Private copy of the header page.
+      */
+      stLockablePage * headerPage;
+
+      /**
+      * If true, the file is mapped without write permission.
+      */
+      bool readOnly;
+
+      /**
+      * Throws std::logic_error in read-only mode.
+      */
+      void CheckWritable(){
+         if (readOnly){
+            throw std::logic_error("The page manager is read-only.");
+         }//end if
+      }//end CheckWritable
+
+      /**
+      * Returns the range of the mapping that holds a page. The range is
+      * aligned to the system page size as required by madvise() and mlock().
+      *
+      * @param pageid The page id.
+      * @param start The first byte of the range.
+      * @param size The size of the range.
+      */
+      void GetSystemPages(u_int32_t pageid, unsigned char * & start,
+            u_int64_t & size);
+
+      /**
+      * Maps the file. The mapping will have at least reserve bytes.
+      *
+      * @param reserve Size of the address space to be reserved.
+      * @exception std::logic_error If the file can not be mapped.
+      */
+      void Map(u_int64_t reserve);
+
+      /**
+      * Releases the mapping, the header page and the file when a constructor
+      * fails.
+      */
+      void Abort();
+
+      /**
+      * Grows the file (and the mapping if required) to hold at least the
+      * given number of bytes.
+      *
+      * @param size The minimum size of the file.
+      * @exception std::logic_error If the file can not grow.
+      */
+      void Grow(u_int64_t size);
+
+      /**
+      * Copies the file header (not the user header) to the mapping.
+      */
+      void UpdateHeader(){
+         memcpy(base, header, sizeof(tHeader));
+      }//end UpdateHeader
+
+      /**
+      * Creates the header for an empty file.
+      *
+      * @param header the pointer to the header.
+      * @param pagesize the size of the page.
+      */
+      void NewHeader(tHeader * header, u_int32_t pagesize);
+
+      /**
+      * Validates a header.
+      *
+      * @param header The header.
+      * @return True for a valid header of false otherwise.
+      */
+      bool IsValidHeader(tHeader * header);
+
+      /**
+      * Converts a page ID to the file offset.
+      *
+      * @param pageid The page id.
+      * @return The offset of the given page id.
+      */
+      u_int64_t PageID2Offset(u_int32_t pageid){
+         return ((u_int64_t) pageid) * header->PageSize;
+      }//end PageID2Offset
+
+};//end stMMapPageManager
+
+#endif //__STMMAPPAGEMANAGER_H
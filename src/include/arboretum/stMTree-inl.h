@@ -440,7 +440,7 @@ bool tmpl_stMTree::Add(ObjectType * newObj){
       tMetricTree::GetPageManager()->WritePage(auxPage);
       Header->Height++; // Update Height
       delete leafNode;
-      delete auxPage;
+      tMetricTree::GetPageManager()->ReleasePage(auxPage);
    }//end if
 
    // Let's continue our search for the grail!
@@ -2219,7 +2219,8 @@ stResult<ObjectType> * tmpl_stMTree::RangeQuery(
             // is it a object that qualified?
             if (distance <= range){
                // Yes! Put it in the result set.
-               result->AddPair(tmpObj.Clone(), distance);
+               result->AddPair(leafNode->GetObject(idx),
+                               leafNode->GetObjectSize(idx), distance);
             }//end if
          }//end for
       }//end else
@@ -2289,7 +2290,8 @@ void tmpl_stMTree::RangeQuery(
                // Is this a qualified object?
                if (distance <= range){
                   // Yes! Put it in the result set.
-                  result->AddPair(tmpObj.Clone(), distance);
+                  result->AddPair(leafNode->GetObject(idx),
+                                  leafNode->GetObjectSize(idx), distance);
                }//end if
             }//end if
          }//end for
@@ -2389,7 +2391,8 @@ void stMTree<ObjectType, EvaluatorType>::NearestQuery(tResult * result,
                //test if the object qualify
                if (distance <= rangeK){
                   // Add the object.
-                  result->AddPair(tmpObj.Clone(), distance);
+                  result->AddPair(leafNode->GetObject(idx),
+                                  leafNode->GetObjectSize(idx), distance);
                   // there is more than k elements?
                   if (result->GetNumOfEntries() >= k){
                      //cut if there is more than k elements
@@ -2516,7 +2519,8 @@ void stMTree<ObjectType, EvaluatorType>::PointQuery(
                //test if the object qualify
                if (distance == 0){
                   // Add the object.
-                  result->AddPair(tmpObj.Clone(), distance);
+                  result->AddPair(leafNode->GetObject(idx),
+                                  leafNode->GetObjectSize(idx), distance);
                   // Stop the query because the object was found!
                   find = true;
                }//end if
@@ -2864,7 +2868,7 @@ bool tmpl_stMTree::BulkLoadMemory(vector< SampleMTreeSon<ObjectType> > objects,
 
       // write to disk
       tMetricTree::GetPageManager()->WritePage(newPage);
-      delete newPage;
+      tMetricTree::GetPageManager()->ReleasePage(newPage);
 
 
    } else {
@@ -3055,7 +3059,7 @@ bool tmpl_stMTree::BulkLoadMemory(vector< SampleMTreeSon<ObjectType> > objects,
       delete indexNode;
 
       tMetricTree::GetPageManager()->WritePage(newIndexPage);
-      delete newIndexPage;
+      tMetricTree::GetPageManager()->ReleasePage(newIndexPage);
 
       delete[] sample;
 
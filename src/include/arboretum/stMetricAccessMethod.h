@@ -23,6 +23,7 @@
 #define __STMETRICACCESSMETHOD_H
 
 #include <arboretum/stResult.h>
+#include <arboretum/stIdResult.h>
 #include <arboretum/stUtil.h>
 #include <stdexcept>
 #include <arboretum/stQueryHint.h>
@@ -146,6 +147,47 @@ class stMetricAccessMethod{
                author for more details.");
       }//end NearestQuery
 
+      /**
+      * This method will perform a range query that returns only the OID and
+      * the distance of each object found. No object is rebuilt.
+      *
+      * <P>The object pointed by <b>sample</b> will not be destroyed by this
+      * method.
+      *
+      * @param sample The sample object.
+      * @param range The range of the results.
+      * @return The result.
+      * @warning The instance of stIdResult returned must be destroied by user.
+      * @exception std::logic_error If this method is not supported
+      * by this tree.
+      */
+      virtual stIdResult * IdRangeQuery(tObject * sample, double range){
+         throw std::logic_error("Unsupported method! Contact the tree \
+               author for more details.");
+      }//end IdRangeQuery
+
+      /**
+      * This method will perform a k nearest neighbour query that returns
+      * only the OID and the distance of each object found. No object is
+      * rebuilt.
+      *
+      * <P>The object pointed by <b>sample</b> will not be destroyed by this
+      * method.
+      *
+      * @param sample The sample object.
+      * @param k The number of neighbours.
+      * @param tie The tie list. Default false.
+      * @return The result.
+      * @warning The instance of stIdResult returned must be destroied by user.
+      * @exception std::logic_error If this method is not supported
+      * by this tree.
+      */
+      virtual stIdResult * IdNearestQuery(tObject * sample, u_int32_t k,
+            bool tie = false){
+         throw std::logic_error("Unsupported method! Contact the tree \
+               author for more details.");
+      }//end IdNearestQuery
+
       /**
       * This method will return the object in the tree that has the distance 0
       * to the query object. In other words, the query object itself.
@@ -0,0 +1,808 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**
+* @file
+*
+* This file defines the class template stObjectViewer and the helpers used by
+* the metric trees to evaluate distances against the objects it returns.
+*
+* @version 1.0
+*/
+#ifndef __STOBJECTVIEW_H
+#define __STOBJECTVIEW_H
+
+#include <arboretum/stCommon.h>
+#include <cmath>
+#include <deque>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+//==============================================================================
+// stObjectViewer
+//------------------------------------------------------------------------------
+/**
+* This class template is used by the metric trees to read the objects stored
+* in their nodes. Wrap() returns an object of type ViewType built from the
+* serialized object and Materialize() creates a new ObjectType from it when
+* the object must be returned to the user (when it is added to a result).
+*
+* <P>This generic version unserializes each object into a temporary instance
+* of ObjectType, which is exactly what the trees always did.
+*
+* <P>If ObjectType declares a nested type ViewType that can be built over the
+* serialized bytes (see BasicArrayObjectView) and the EvaluatorType is able to
+* compute GetDistance(ViewType &, ObjectType &), the specialization below is
+* selected instead and no object is rebuilt to compute a distance.
+*
+* <P>A view type must provide a default constructor and the methods
+* Wrap(const u_char *, size_t), Serialize(), GetSerializedSize() and GetOID().
+*
+* @version 1.0
+* @ingroup struct
+*/
+template <class ObjectType, class EvaluatorType, class Enable = void>
+class stObjectViewer{
+   public:
+      /**
+      * Type returned by Wrap().
+      */
+      typedef ObjectType ViewType;
+
+      /**
+      * Returns the object stored in the given serialized form. The returned
+      * reference is valid until the next call to Wrap().
+      *
+      * @param data The serialized object.
+      * @param size The size of the serialized object.
+      */
+      ViewType & Wrap(const unsigned char * data, u_int32_t size){
+         tmpObj.Unserialize(data, size);
+         return tmpObj;
+      }//end Wrap
+
+      /**
+      * Creates a new instance of ObjectType from a view returned by Wrap().
+      * The caller is responsible for its disposal.
+      *
+      * @param view The view.
+      */
+      ObjectType * Materialize(ViewType & view){
+         return (ObjectType *) view.Clone();
+      }//end Materialize
+
+   private:
+      /**
+      * The temporary object.
+      */
+      ObjectType tmpObj;
+};//end stObjectViewer
+
+//==============================================================================
+// stObjectViewer (zero-copy)
+//------------------------------------------------------------------------------
+/**
+* Zero-copy version of stObjectViewer. It is used when ObjectType has a view
+* type accepted by the distance evaluator.
+*
+* @version 1.0
+* @ingroup struct
+*/
+template <class ObjectType, class EvaluatorType>
+class stObjectViewer<ObjectType, EvaluatorType, std::void_t<
+      typename ObjectType::ViewType,
+      decltype(std::declval<EvaluatorType &>().GetDistance(
+            std::declval<typename ObjectType::ViewType &>(),
+            std::declval<ObjectType &>()))> >{
+   public:
+      /**
+      * Type returned by Wrap().
+      */
+      typedef typename ObjectType::ViewType ViewType;
+
+      /**
+      * Returns a view of the given serialized object. The returned reference
+      * is valid until the next call to Wrap() and while the serialized object
+      * is not modified or released.
+      *
+      * @param data The serialized object.
+      * @param size The size of the serialized object.
+      */
+      ViewType & Wrap(const unsigned char * data, u_int32_t size){
+         view.Wrap(data, size);
+         return view;
+      }//end Wrap
+
+      /**
+      * Creates a new instance of ObjectType from a view returned by Wrap().
+      * The caller is responsible for its disposal.
+      *
+      * @param view The view.
+      */
+      ObjectType * Materialize(ViewType & view){
+         ObjectType * obj = new ObjectType();
+
+         obj->Unserialize(view.Serialize(), view.GetSerializedSize());
+         return obj;
+      }//end Materialize
+
+   private:
+      /**
+      * The view.
+      */
+      ViewType view;
+};//end stObjectViewer
+
+//==============================================================================
+// stViewOID
+//------------------------------------------------------------------------------
+/**
+* This class template reads the OID of a view returned by
+* stObjectViewer::Wrap(). It is used by the queries that return only the OIDs
+* of the objects (see stIdResult).
+*
+* <P>This generic version is selected when ViewType has no GetOID() method.
+* Supported is false and Get() throws.
+*
+* @version 1.0
+* @ingroup struct
+*/
+template <class ViewType, class Enable = void>
+class stViewOID{
+   public:
+      /**
+      * True if ViewType has an OID.
+      */
+      static const bool Supported = false;
+
+      /**
+      * Returns the OID of the view.
+      *
+      * @param view The view.
+      * @exception std::logic_error Always, the view has no OID.
+      */
+      static u_int32_t Get(ViewType & view){
+         throw std::logic_error("This object type has no OID.");
+      }//end Get
+};//end stViewOID
+
+//==============================================================================
+// stViewOID (GetOID)
+//------------------------------------------------------------------------------
+/**
+* Version of stViewOID used when ViewType has a GetOID() method.
+*
+* @version 1.0
+* @ingroup struct
+*/
+template <class ViewType>
+class stViewOID<ViewType, std::void_t<
+      decltype(std::declval<ViewType &>().GetOID())> >{
+   public:
+      /**
+      * True if ViewType has an OID.
+      */
+      static const bool Supported = true;
+
+      /**
+      * Returns the OID of the view.
+      *
+      * @param view The view.
+      */
+      static u_int32_t Get(ViewType & view){
+         return view.GetOID();
+      }//end Get
+};//end stViewOID
+
+//==============================================================================
+// stBoundedDistance
+//------------------------------------------------------------------------------
+/**
+* This class template computes a distance that is only of interest if it is
+* not greater than a given bound. It is used by the queries to let the
+* evaluators abandon the calculation as soon as the bound is exceeded.
+*
+* <P>This generic version is selected when EvaluatorType has no
+* GetDistanceBounded() method and always computes the full distance.
+*
+* @version 1.0
+* @ingroup struct
+*/
+template <class EvaluatorType, class ViewType, class ObjectType, class Enable = void>
+class stBoundedDistance{
+   public:
+      /**
+      * Returns the distance between view and obj if it is not greater than
+      * bound, or a value greater than bound otherwise.
+      *
+      * @param evaluator The distance evaluator.
+      * @param view The first object.
+      * @param obj The second object.
+      * @param bound The greatest distance of interest.
+      */
+      static double GetDistance(EvaluatorType * evaluator, ViewType & view,
+            ObjectType & obj, double bound){
+         return evaluator->GetDistance(view, obj);
+      }//end GetDistance
+};//end stBoundedDistance
+
+//==============================================================================
+// stBoundedDistance (GetDistanceBounded)
+//------------------------------------------------------------------------------
+/**
+* Version of stBoundedDistance used when EvaluatorType has a
+* GetDistanceBounded() method (see the Hermes distance functions).
+*
+* @version 1.0
+* @ingroup struct
+*/
+template <class EvaluatorType, class ViewType, class ObjectType>
+class stBoundedDistance<EvaluatorType, ViewType, ObjectType, std::void_t<
+      decltype(std::declval<EvaluatorType &>().GetDistanceBounded(
+            std::declval<ViewType &>(), std::declval<ObjectType &>(),
+            std::declval<double>()))> >{
+   public:
+      /**
+      * Returns the distance between view and obj if it is not greater than
+      * bound, or a value greater than bound otherwise.
+      *
+      * @param evaluator The distance evaluator.
+      * @param view The first object.
+      * @param obj The second object.
+      * @param bound The greatest distance of interest.
+      */
+      static double GetDistance(EvaluatorType * evaluator, ViewType & view,
+            ObjectType & obj, double bound){
+         return evaluator->GetDistanceBounded(view, obj, bound);
+      }//end GetDistance
+};//end stBoundedDistance
+
+//==============================================================================
+// stQueryOperand
+//------------------------------------------------------------------------------
+/**
+* This class template holds the operand given to the evaluator in place of the
+* query sample (see stPreparedQuery).
+*
+* <P>This generic version is selected when EvaluatorType cannot prepare a
+* query sample. The operand is the sample itself and the evaluator is not
+* accessed.
+*
+* @version 1.0
+* @ingroup struct
+*/
+template <class EvaluatorType, class ObjectType, class Enable = void>
+class stQueryOperand{
+   public:
+      /**
+      * Type of the operand.
+      */
+      typedef ObjectType OperandType;
+
+      /**
+      * Creates the operand.
+      *
+      * @param evaluator The distance evaluator.
+      * @param sample The query sample.
+      */
+      stQueryOperand(EvaluatorType * evaluator, ObjectType * sample){
+         this->sample = sample;
+      }//end stQueryOperand
+
+      /**
+      * Returns the operand.
+      */
+      OperandType & Get(){
+         return *sample;
+      }//end Get
+
+   private:
+      /**
+      * The query sample.
+      */
+      ObjectType * sample;
+};//end stQueryOperand
+
+//==============================================================================
+// stQueryOperand (PreparedQuery)
+//------------------------------------------------------------------------------
+/**
+* Version of stQueryOperand used when EvaluatorType declares the type
+* PreparedQuery, the method PrepareQuery(sample, prepared) and the method
+* GetDistance(obj, prepared) (see the Hermes distance functions). The operand
+* is the data computed once by PrepareQuery() and it is owned by the query, so
+* concurrent queries never share it.
+*
+* @version 1.0
+* @ingroup struct
+*/
+template <class EvaluatorType, class ObjectType>
+class stQueryOperand<EvaluatorType, ObjectType, std::void_t<
+      typename EvaluatorType::PreparedQuery,
+      decltype(std::declval<EvaluatorType &>().PrepareQuery(
+            std::declval<ObjectType &>(),
+            std::declval<typename EvaluatorType::PreparedQuery &>())),
+      decltype(std::declval<EvaluatorType &>().GetDistance(
+            std::declval<ObjectType &>(),
+            std::declval<typename EvaluatorType::PreparedQuery &>())),
+      decltype(std::declval<EvaluatorType &>().GetDistance(
+            std::declval<typename stObjectViewer<ObjectType, EvaluatorType>::ViewType &>(),
+            std::declval<typename EvaluatorType::PreparedQuery &>()))> >{
+   public:
+      /**
+      * Type of the operand.
+      */
+      typedef typename EvaluatorType::PreparedQuery OperandType;
+
+      /**
+      * Prepares the query sample.
+      *
+      * @param evaluator The distance evaluator.
+      * @param sample The query sample.
+      */
+      stQueryOperand(EvaluatorType * evaluator, ObjectType * sample){
+         evaluator->PrepareQuery(*sample, prepared);
+      }//end stQueryOperand
+
+      /**
+      * Returns the operand.
+      */
+      OperandType & Get(){
+         return prepared;
+      }//end Get
+
+   private:
+      /**
+      * The prepared query sample.
+      */
+      OperandType prepared;
+};//end stQueryOperand
+
+//==============================================================================
+// stBatchDistance
+//------------------------------------------------------------------------------
+/**
+* This class template computes the distances between the query sample and a
+* batch of objects (see stCandidateBatch). As stBoundedDistance, a distance
+* greater than bound may be replaced by any value greater than bound.
+*
+* <P>This generic version is selected when EvaluatorType has no template
+* GetDistances() method and evaluates one object at a time.
+*
+* @version 1.0
+* @ingroup struct
+*/
+template <class EvaluatorType, class ViewType, class ObjectType, class Enable = void>
+class stBatchDistance{
+   public:
+      /**
+      * False, the objects are evaluated one at a time.
+      */
+      static const bool Batched = false;
+
+      /**
+      * Computes the distances between the n objects and obj.
+      *
+      * @param evaluator The distance evaluator.
+      * @param obj The query sample.
+      * @param entries The n objects.
+      * @param n The number of objects.
+      * @param distances The n distances (output).
+      * @param bound The greatest distance of interest.
+      */
+      static void GetDistances(EvaluatorType * evaluator, ObjectType & obj,
+            ViewType ** entries, u_int32_t n, double * distances, double bound){
+         for (u_int32_t i = 0; i < n; i++){
+            distances[i] = stBoundedDistance<EvaluatorType, ViewType, ObjectType>::GetDistance(
+                  evaluator, *entries[i], obj, bound);
+         }//end for
+      }//end GetDistances
+};//end stBatchDistance
+
+//==============================================================================
+// stBatchDistance (GetDistances)
+//------------------------------------------------------------------------------
+/**
+* Version of stBatchDistance used when EvaluatorType has a template
+* GetDistances() method over views (see the Lp distances of Hermes). The
+* whole batch is given to the evaluator in a single call. The default
+* GetDistances() of DistanceFunction is not used, as it only loops over the
+* objects.
+*
+* @version 1.0
+* @ingroup struct
+*/
+template <class EvaluatorType, class ViewType, class ObjectType>
+class stBatchDistance<EvaluatorType, ViewType, ObjectType, std::void_t<
+      decltype(std::declval<EvaluatorType &>().template GetDistances<ViewType>(
+            std::declval<ObjectType &>(), std::declval<ViewType **>(),
+            std::declval<size_t>(), std::declval<double *>(),
+            std::declval<double>()))> >{
+   public:
+      /**
+      * True, the evaluator computes the whole batch in a single call.
+      */
+      static const bool Batched = true;
+
+      /**
+      * Computes the distances between the n objects and obj.
+      *
+      * @param evaluator The distance evaluator.
+      * @param obj The query sample.
+      * @param entries The n objects.
+      * @param n The number of objects.
+      * @param distances The n distances (output).
+      * @param bound The greatest distance of interest.
+      */
+      static void GetDistances(EvaluatorType * evaluator, ObjectType & obj,
+            ViewType ** entries, u_int32_t n, double * distances, double bound){
+         evaluator->GetDistances(obj, entries, n, distances, bound);
+      }//end GetDistances
+};//end stBatchDistance
+
+//==============================================================================
+// stLeafCodes
+//------------------------------------------------------------------------------
+/**
+* This class template gives the tree access to the quantized copies of the
+* objects kept by its leaf entries (see stSlimLeafNode). The evaluator builds
+* the codes of an object and computes, from the codes alone, a lower bound of
+* the distance between that object and a query sample.
+*
+* <P>This generic version is selected when EvaluatorType has no
+* GetLeafCodeSize() method. The leaves have no codes.
+*
+* @version 1.0
+* @ingroup struct
+*/
+template <class EvaluatorType, class ObjectType, class Enable = void>
+class stLeafCodes{
+   public:
+      /**
+      * Returns 0, the objects have no codes.
+      */
+      static u_int32_t GetCodeSize(EvaluatorType *){
+         return 0;
+      }//end GetCodeSize
+
+      /**
+      * Does nothing.
+      */
+      static void Encode(EvaluatorType *, ObjectType &, unsigned char *){
+      }//end Encode
+
+      /**
+      * Returns 0, a bound that never rejects an object.
+      */
+      static double GetBound(EvaluatorType *, const unsigned char *,
+            ObjectType &, double){
+         return 0;
+      }//end GetBound
+};//end stLeafCodes
+
+//==============================================================================
+// stLeafCodes (GetLeafCodeSize)
+//------------------------------------------------------------------------------
+/**
+* Version of stLeafCodes used when EvaluatorType has the GetLeafCodeSize(),
+* EncodeLeaf() and GetLeafBound() methods (see EuclideanDistance).
+*
+* @version 1.0
+* @ingroup struct
+*/
+template <class EvaluatorType, class ObjectType>
+class stLeafCodes<EvaluatorType, ObjectType, std::void_t<
+      decltype(std::declval<EvaluatorType &>().GetLeafCodeSize()),
+      decltype(std::declval<EvaluatorType &>().EncodeLeaf(
+            std::declval<ObjectType &>(), std::declval<unsigned char *>())),
+      decltype(std::declval<EvaluatorType &>().GetLeafBound(
+            std::declval<const unsigned char *>(), std::declval<ObjectType &>(),
+            std::declval<double>()))> >{
+   public:
+      /**
+      * Returns the size of the codes of an object, or 0 if there are none.
+      *
+      * @param evaluator The distance evaluator.
+      */
+      static u_int32_t GetCodeSize(EvaluatorType * evaluator){
+         return evaluator->GetLeafCodeSize();
+      }//end GetCodeSize
+
+      /**
+      * Builds the codes of an object.
+      *
+      * @param evaluator The distance evaluator.
+      * @param obj The object.
+      * @param code The codes (output).
+      */
+      static void Encode(EvaluatorType * evaluator, ObjectType & obj,
+            unsigned char * code){
+         evaluator->EncodeLeaf(obj, code);
+      }//end Encode
+
+      /**
+      * Returns a lower bound of the distance between the object of the codes
+      * and obj.
+      *
+      * @param evaluator The distance evaluator.
+      * @param code The codes.
+      * @param obj The query sample.
+      * @param bound The greatest distance of interest.
+      */
+      static double GetBound(EvaluatorType * evaluator, const unsigned char * code,
+            ObjectType & obj, double bound){
+         return evaluator->GetLeafBound(code, obj, bound);
+      }//end GetBound
+};//end stLeafCodes
+
+//==============================================================================
+// stPreparedQuery
+//------------------------------------------------------------------------------
+/**
+* This class template is the query sample as seen by a query. It is created
+* once per query and passed down to every node the query visits, so the
+* evaluator may prepare the sample once (see stQueryOperand) without storing
+* anything in the evaluator itself.
+*
+* @version 1.0
+* @ingroup struct
+*/
+template <class EvaluatorType, class ObjectType>
+class stPreparedQuery{
+   public:
+      /**
+      * Type of the operand given to the evaluator.
+      */
+      typedef typename stQueryOperand<EvaluatorType, ObjectType>::OperandType OperandType;
+
+      /**
+      * Prepares the query.
+      *
+      * @param evaluator The distance evaluator.
+      * @param sample The query sample.
+      */
+      stPreparedQuery(EvaluatorType * evaluator, ObjectType * sample):
+            operand(evaluator, sample){
+         this->evaluator = evaluator;
+         this->sample = sample;
+      }//end stPreparedQuery
+
+      /**
+      * Returns the query sample.
+      */
+      ObjectType * GetSample(){
+         return sample;
+      }//end GetSample
+
+      /**
+      * Returns the distance between an object and the query sample.
+      *
+      * @param obj The object.
+      */
+      template <class ViewType>
+      double GetDistance(ViewType & obj){
+         return evaluator->GetDistance(obj, operand.Get());
+      }//end GetDistance
+
+      /**
+      * Returns the distance between an object and the query sample if it is
+      * not greater than bound, or a value greater than bound otherwise (see
+      * stBoundedDistance).
+      *
+      * @param obj The object.
+      * @param bound The greatest distance of interest.
+      */
+      template <class ViewType>
+      double GetDistanceBounded(ViewType & obj, double bound){
+         return stBoundedDistance<EvaluatorType, ViewType, OperandType>::GetDistance(
+               evaluator, obj, operand.Get(), bound);
+      }//end GetDistanceBounded
+
+      /**
+      * Computes the distances between n objects and the query sample (see
+      * stBatchDistance).
+      *
+      * @param entries The n objects.
+      * @param n The number of objects.
+      * @param distances The n distances (output).
+      * @param bound The greatest distance of interest.
+      */
+      template <class ViewType>
+      void GetDistances(ViewType ** entries, u_int32_t n, double * distances,
+            double bound){
+         stBatchDistance<EvaluatorType, ViewType, OperandType>::GetDistances(
+               evaluator, operand.Get(), entries, n, distances, bound);
+      }//end GetDistances
+
+      /**
+      * Returns a lower bound of the distance between the object of a leaf
+      * entry and the query sample, computed from the codes of the entry
+      * (see stLeafCodes).
+      *
+      * @param code The codes.
+      * @param bound The greatest distance of interest.
+      */
+      double GetLeafBound(const unsigned char * code, double bound){
+         return stLeafCodes<EvaluatorType, ObjectType>::GetBound(
+               evaluator, code, *sample, bound);
+      }//end GetLeafBound
+
+   private:
+      /**
+      * The distance evaluator.
+      */
+      EvaluatorType * evaluator;
+
+      /**
+      * The query sample.
+      */
+      ObjectType * sample;
+
+      /**
+      * The operand given to the evaluator.
+      */
+      stQueryOperand<EvaluatorType, ObjectType> operand;
+
+      // Not copyable.
+      stPreparedQuery(const stPreparedQuery &);
+      stPreparedQuery & operator = (const stPreparedQuery &);
+};//end stPreparedQuery
+
+//==============================================================================
+// stCandidateBatch
+//------------------------------------------------------------------------------
+/**
+* This class template gathers the entries of a node that survived the pruning
+* of a query, so their distances to the query sample can be computed in a
+* single call to the evaluator (see stBatchDistance) instead of one call per
+* entry interleaved with the pruning tests.
+*
+* <P>Each candidate is read by its own stObjectViewer, so all views remain
+* valid together until Clear() is called and while the node is not released.
+* The viewers are kept between batches, so a tree may reuse the same instance
+* for all of its nodes.
+*
+* @version 1.0
+* @ingroup struct
+*/
+template <class ObjectType, class EvaluatorType>
+class stCandidateBatch{
+   public:
+      /**
+      * Type of the viewers.
+      */
+      typedef stObjectViewer < ObjectType, EvaluatorType > tViewer;
+
+      /**
+      * Type of the candidates.
+      */
+      typedef typename tViewer::ViewType ViewType;
+
+      /**
+      * True if the evaluator computes a batch in a single call (see
+      * stBatchDistance). Otherwise a batch only adds overhead to the
+      * evaluation of each candidate.
+      */
+      static const bool Batched = stBatchDistance < EvaluatorType, ViewType,
+            typename stPreparedQuery < EvaluatorType, ObjectType >::OperandType >::Batched;
+
+      /**
+      * Creates an empty batch.
+      */
+      stCandidateBatch(){
+         count = 0;
+      }//end stCandidateBatch
+
+      /**
+      * Removes all candidates.
+      */
+      void Clear(){
+         count = 0;
+      }//end Clear
+
+      /**
+      * Adds a candidate.
+      *
+      * @param data The serialized object.
+      * @param size The size of the serialized object.
+      * @param idx The index of the entry in its node.
+      */
+      void Add(const unsigned char * data, u_int32_t size, u_int32_t idx){
+         if (count == viewers.size()){
+            viewers.emplace_back();
+            entries.push_back(NULL);
+            indexes.push_back(0);
+            distances.push_back(0);
+         }//end if
+         entries[count] = &viewers[count].Wrap(data, size);
+         indexes[count] = idx;
+         count++;
+      }//end Add
+
+      /**
+      * Returns the number of candidates.
+      */
+      u_int32_t GetCount(){
+         return count;
+      }//end GetCount
+
+      /**
+      * Returns a candidate.
+      *
+      * @param i The candidate.
+      */
+      ViewType & GetEntry(u_int32_t i){
+         return *entries[i];
+      }//end GetEntry
+
+      /**
+      * Returns the index in its node of a candidate.
+      *
+      * @param i The candidate.
+      */
+      u_int32_t GetIndex(u_int32_t i){
+         return indexes[i];
+      }//end GetIndex
+
+      /**
+      * Returns the distance of a candidate computed by GetDistances().
+      *
+      * @param i The candidate.
+      */
+      double GetDistance(u_int32_t i){
+         return distances[i];
+      }//end GetDistance
+
+      /**
+      * Computes the distances between all candidates and the query sample.
+      * A distance greater than bound may be replaced by any value greater
+      * than bound.
+      *
+      * @param query The query.
+      * @param bound The greatest distance of interest.
+      */
+      void GetDistances(stPreparedQuery < EvaluatorType, ObjectType > & query,
+            double bound = HUGE_VAL){
+         query.GetDistances(entries.data(), count, distances.data(), bound);
+      }//end GetDistances
+
+   private:
+      /**
+      * The viewers. A deque never moves its elements, so the views already
+      * returned remain valid when it grows.
+      */
+      std::deque < tViewer > viewers;
+
+      /**
+      * The views of the candidates.
+      */
+      std::vector < ViewType * > entries;
+
+      /**
+      * The indexes of the candidates in their node.
+      */
+      std::vector < u_int32_t > indexes;
+
+      /**
+      * The distances of the candidates.
+      */
+      std::vector < double > distances;
+
+      /**
+      * Number of candidates.
+      */
+      u_int32_t count;
+};//end stCandidateBatch
+
+#endif //__STOBJECTVIEW_H
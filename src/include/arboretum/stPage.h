@@ -13,7 +13,7 @@
 /**
 * @file
 *
-* This file defines the classes stPage and stLockablePage.
+* This file defines the classes stPage, stLockablePage and stMappedPage.
 *
 * @version 1.0
 * @author Fabio Jun Takada Chino (chino@icmc.usp.br)
@@ -74,6 +74,18 @@ class stPage{
       */
       virtual u_int32_t GetPageSize();
 
+      /**
+      * Returns the number of bytes this page may use in its storage. It is
+      * smaller than the page size only if the page is stored in a compact
+      * form (see stCompressedPageManager). Nodes must check the size of their
+      * compact form against this value before they grow.
+      *
+      * @return The storage size in bytes.
+      */
+      virtual u_int32_t GetStorageSize(){
+         return GetPageSize();
+      }//end GetStorageSize
+
       /**
       * Returns the pointer to the data array. This method allows the direct access
       * to the internal page data array. It will be used by the stDiskPageManager to
@@ -124,6 +136,17 @@ class stPage{
 
    protected:
 
+      /**
+      * Creates a new page without a buffer. It may be used by subclasses that
+      * do not own the memory they expose.
+      */
+      stPage (void){
+
+         this->Buffer = 0;
+         this->BufferSize = 0;
+         this->SetPageID(0);
+      }//end stPage
+
       /**
       * The page (buffer).
       */
@@ -282,6 +305,57 @@ class stLockablePage: public stPage{
       
 };//end stLockablePage
 
+//----------------------------------------------------------------------------
+// Class stMappedPage
+//----------------------------------------------------------------------------
+/**
+* This class is an extension to stPage which does not own its buffer. It is a
+* view of a memory segment owned by someone else, such as a memory mapped
+* file, so a page manager can hand pages to the trees without copying them.
+*
+* <P>The memory pointed by an instance of this class is never released by it.
+* Deleting an instance of this class is always safe, even if the owner of the
+* memory still uses it.
+*
+* @version 1.0
+* @see stMMapPageManager
+* @ingroup storage
+*/
+class stMappedPage: public stPage{
+
+   public:
+
+      /**
+      * Creates a new unmapped page.
+      */
+      stMappedPage():stPage(){
+      }//end stMappedPage
+
+      /**
+      * Disposes this page without releasing the mapped segment.
+      */
+      virtual ~stMappedPage(){
+
+         // The segment is not ours. See stPage::~stPage().
+         this->Buffer = 0;
+      }//end ~stMappedPage
+
+      /**
+      * Maps this page to a memory segment.
+      *
+      * @param buffer The first byte of the segment.
+      * @param size Size of the segment in bytes.
+      * @param pageid Page id.
+      */
+      void Map(unsigned char * buffer, u_int32_t size, u_int32_t pageid){
+
+         this->Buffer = buffer;
+         this->BufferSize = size;
+         this->SetPageID(pageid);
+      }//end Map
+
+};//end stMappedPage
+
 //----------------------------------------------------------------------------
 // Class stPageAllocator
 //----------------------------------------------------------------------------
@@ -304,16 +378,23 @@ class stPageAllocator{
       * pageSize bytes.
       *
       * @param pageSize The size of the new pages created bye this allocator.
+      * @param lockSize If not 0, the allocator will create instances of
+      * stLockablePage with a locked segment of this size.
       */
-      stPageAllocator(u_int32_t pageSize){
+      stPageAllocator(u_int32_t pageSize, u_int32_t lockSize = 0){
          this->pageSize = pageSize;
+         this->lockSize = lockSize;
       }//end pageSize
       
       /**
       * Creates new stPage instances.
       */
       stPage * Create(){
-         return new stPage(pageSize, 0);
+         if (lockSize != 0){
+            return new stLockablePage(pageSize, lockSize, 0);
+         }else{
+            return new stPage(pageSize, 0);
+         }//end if
       }//end Create
       
       /**
@@ -332,7 +413,44 @@ class stPageAllocator{
       * Size of the pages to be created.
       */
       u_int32_t pageSize;
+
+      /**
+      * Size of the locked segment of the pages to be created.
+      */
+      u_int32_t lockSize;
         
 };//end stPageAllocator
 
+//----------------------------------------------------------------------------
+// Class stMappedPageAllocator
+//----------------------------------------------------------------------------
+/**
+* This class is the allocator implementation that allows the use of the
+* stInstanceCacheTemplate with stMappedPage instances.
+*
+* @version 1.0
+* @ingroup storage
+*/
+class stMappedPageAllocator{
+
+   public:
+
+      /**
+      * Creates new stMappedPage instances.
+      */
+      stMappedPage * Create(){
+         return new stMappedPage();
+      }//end Create
+
+      /**
+      * Disposes the given stMappedPage instance.
+      *
+      * @param instance The instance to be disposed.
+      */
+      void Dispose(stMappedPage * instance){
+         delete instance;
+      }//end Dispose
+
+};//end stMappedPageAllocator
+
 #endif //__STPAGE_H
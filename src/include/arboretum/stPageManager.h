@@ -159,6 +159,27 @@ class stPageManager{
       */
       virtual void DisposePage(stPage * page) = 0;
 
+      /**
+      * Hints that the given pages will be read soon. Implementations may
+      * start reading them in background so the next calls of GetPage() do
+      * not wait for the disk. The default implementation does nothing.
+      *
+      * <P>This method never changes the read/write counters.
+      *
+      * @param pageIDs The ids of the pages.
+      * @param n The number of ids.
+      */
+      virtual void Prefetch(const u_int32_t *, u_int32_t){
+      }//end Prefetch
+
+      /**
+      * Writes all data kept in memory by this page manager (cached pages,
+      * deferred header updates, etc) to its storage. The default
+      * implementation does nothing.
+      */
+      virtual void Flush(){
+      }//end Flush
+
       /**
       * Restarts the statistics.
       *
@@ -179,7 +200,7 @@ class stPageManager{
       * @see ResetStatistics()
       * @see GetWriteCount()
       */
-      long int GetReadCount(){
+      virtual long int GetReadCount(){
          return this->ReadCount;
       }//end GetReadCount
 
@@ -191,7 +212,7 @@ class stPageManager{
       * @see GetReadsCount()
       *
       */
-      long int GetWriteCount(){
+      virtual long int GetWriteCount(){
          return this->WriteCount;
       }//end GetWriteCount
       
@@ -199,8 +220,8 @@ class stPageManager{
       * Returns the total page access. This value is the sum of the
       * read count and write count.
       */
-      long int GetAccessCount(){
-         return this->ReadCount + this->WriteCount;
+      virtual long int GetAccessCount(){
+         return GetReadCount() + GetWriteCount();
       }//end GetAccessCount
       
       /**
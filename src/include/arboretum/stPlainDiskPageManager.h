@@ -27,6 +27,12 @@
 #include <arboretum/stPageManager.h>
 #include <arboretum/stUtil.h>
 #include <arboretum/stCommonIO.h>
+#include <arboretum/stChecksum.h>
+
+/**
+* Size of the checksum stored in each page when checksums are enabled.
+*/
+#define STPLAINDISKPAGEMANAGER_CHECKSUMSIZE 4
 
 //==============================================================================
 // stPlainDiskPageManager
@@ -40,6 +46,13 @@
 * operations are performed without chaching pages. As an additional feature, it
 * is possible to disable the system I/O cache in some operational systems.
 *
+* <p>Files may be created with page checksums. In this case, the first
+* STPLAINDISKPAGEMANAGER_CHECKSUMSIZE bytes of each page hold the CRC32C of the
+* page ID and the rest of the page, so the pages returned to the users are
+* smaller (see GetMinimumPageSize()). The checksum is written by WritePage() and
+* verified by GetPage(), detecting corrupted and torn pages at the first read.
+* These files use the magic "DPMC" and can not be opened by older versions.
+*
 * @version 1.0
 * @author Fabio Jun Takada Chino (chino@icmc.usp.br)
 * @author Marcos Rodrigues Vieira (mrvieira@icmc.usp.br)
@@ -57,9 +70,11 @@ class stPlainDiskPageManager: public stPageManager{
       * @param fName The file name.
       * @param pagesize Size of each page in file. This value must be larger
       * or equal than 64.
+      * @param checksum If true, each page will be protected by a checksum.
       * @exception std::logic_error If the file can not be created.
       */
-      stPlainDiskPageManager(const char * fName, u_int32_t pagesize);
+      stPlainDiskPageManager(const char * fName, u_int32_t pagesize,
+            bool checksum = false);
 
       /**
       * Creates a new instance of this class. This constructor will open an
@@ -117,6 +132,7 @@ class stPlainDiskPageManager: public stPageManager{
       *
       * @param pageid The desired page id.
       * @return The page or NULL for an invalid page ID.
+      * @exception std::logic_error If the checksum of the page does not match.
       * @see WritePage()
       * @see ReleasePage()
       */
@@ -157,7 +173,12 @@ class stPlainDiskPageManager: public stPageManager{
       * will write the page but will not release it. Use
       * ReleasePage() to do it.
       *
+      * <P>If the file has page checksums, the page must have been returned
+      * by this page manager, as the checksum is written in front of its data.
+      *
       * @param page The page to be written.
+      * @exception std::invalid_argument If the file has page checksums and
+      * the page was not returned by this page manager.
       * @see ReleasePage()
       */
       virtual void WritePage(stPage * page);
@@ -183,12 +204,23 @@ class stPlainDiskPageManager: public stPageManager{
       */
       virtual void DisposePage(stPage * page);
 
+      /**
+      * Hints that the given pages will be read soon. The operating system is
+      * asked to read them in background (posix_fadvise). Runs of consecutive
+      * pages are hinted at once.
+      *
+      * @param pageIDs The ids of the pages.
+      * @param n The number of ids.
+      */
+      virtual void Prefetch(const u_int32_t * pageIDs, u_int32_t n);
+
       /**
       * Returns the minimum size of a page. The size of the header page is
-      * always ignored since it may be smaller than others.
+      * always ignored since it may be smaller than others. The checksum is
+      * not included.
       */ 
       virtual u_int32_t GetMinimumPageSize(){
-         return header->PageSize;
+         return header->PageSize - GetChecksumSize();
       }//end GetMinimumPageSize
 
       /**
@@ -207,6 +239,35 @@ class stPlainDiskPageManager: public stPageManager{
       void SetSystemCache(bool enabled){
          // Nothing to do.. at least for now.
       }//end SetSystemCache
+
+      /**
+      * Returns true if the pages of this file have checksums.
+      */
+      bool HasChecksum(){
+         return header->Magic[3] == 'C';
+      }//end HasChecksum
+
+      /**
+      * Enables or disables the deferred header mode. By default, GetNewPage()
+      * and DisposePage() write the header page every time they are called.
+      * In the deferred mode, the header is kept modified in memory and
+      * written by Flush(), by the destructor or after the given number of
+      * allocations and disposals.
+      *
+      * @param interval Maximum number of allocations and disposals between
+      * two header writes. Use 0 to write the header every time (the default).
+      * @param sync If true, Flush() will also force the file to the disk
+      * (fdatasync), committing all pages written since the previous Flush()
+      * at once.
+      * @see Flush()
+      */
+      void SetDeferredHeader(u_int32_t interval, bool sync = false);
+
+      /**
+      * Writes the header page if it was modified and, if required by
+      * SetDeferredHeader(), forces the file to the disk.
+      */
+      virtual void Flush();
       
    private:
       #pragma pack(1)
@@ -215,7 +276,7 @@ class stPlainDiskPageManager: public stPageManager{
       */
       struct tHeader{
          /**
-         * Magic header. Always "DPM1".
+         * Magic header. "DPM1" or "DPMC" if the pages have checksums.
          */
          char Magic[4];
          
@@ -272,13 +333,70 @@ class stPlainDiskPageManager: public stPageManager{
       */      
       stLockablePage * headerPage;
 
+      /**
+      * Number of header changes between two header writes. 0 means that
+      * the header is written every time.
+      */
+      u_int32_t headerInterval;
+
+      /**
+      * Number of header changes not written yet.
+      */
+      u_int32_t headerChanges;
+
+      /**
+      * If true, Flush() calls fdatasync.
+      */
+      bool syncOnFlush;
+
+      /**
+      * Notifies that the header was changed by an allocation or disposal.
+      * Depending on the deferred header mode, it writes the header.
+      */
+      void HeaderChanged(){
+         headerChanges++;
+         if (headerChanges >= headerInterval){
+            Flush();
+         }//end if
+      }//end HeaderChanged
+
       /**
       * Creates the header for an empty file.
       *
       * @param header the pointer to the header.
       * @param pagesize the size of the page.
+      * @param checksum True if the pages will have checksums.
+      */
+      void NewHeader(tHeader * header, u_int32_t pagesize, bool checksum);
+
+      /**
+      * Returns the size of the checksum stored in each page.
+      */
+      u_int32_t GetChecksumSize(){
+         return HasChecksum() ? STPLAINDISKPAGEMANAGER_CHECKSUMSIZE : 0;
+      }//end GetChecksumSize
+
+      /**
+      * Computes the checksum of a page. The page ID is included, so pages
+      * written at the wrong position are also detected.
+      *
+      * @param page The page with the checksum segment.
+      * @return The checksum.
+      */
+      u_int32_t PageChecksum(stLockablePage * page){
+         u_int32_t pageid = page->GetPageID();
+
+         return stChecksum::CRC32C(page->GetData(), page->GetPageSize(),
+               stChecksum::CRC32C(&pageid, sizeof(pageid)));
+      }//end PageChecksum
+
+      /**
+      * Verifies the checksum of a page that was just read.
+      *
+      * @param page The page with the checksum segment.
+      * @exception std::logic_error If the checksum does not match.
       */
-      void NewHeader(tHeader * header, u_int32_t pagesize);
+      void VerifyChecksum(stLockablePage * page);
       
       /**
       * Validates a header.
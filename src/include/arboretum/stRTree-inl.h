@@ -68,7 +68,7 @@ bool stRTree<DataType,OIDType>::Add(basicArrayObject * newObj){
          this->myPageManager->WritePage(auxPage);
       }//end if
       delete leafNode;
-      delete auxPage;
+      this->myPageManager->ReleasePage(auxPage);
    }
    // yes, there is already a root
    else{
@@ -24,6 +24,8 @@
 #define __STRESULT_H
 
 #include <vector>
+#include <string.h>
+#include <arboretum/stArena.h>
 
 
 
@@ -190,6 +192,12 @@ class stResultPair{
        */
       typedef KeyType tKey;
 
+      /**
+      * Type of the function that rebuilds the object of a pair created by
+      * Create().
+      */
+      typedef tObject * (*tMaterializer)(const unsigned char * data, u_int32_t size);
+
       /**
       * Creates a new pair Object/Distance.
       *
@@ -199,6 +207,9 @@ class stResultPair{
       stResultPair(){
          this->Object = NULL;
          this->Key = -1;
+         this->Serialized = NULL;
+         this->SerializedSize = 0;
+         this->Materializer = NULL;
       }//end stResultPair
 
       /**
@@ -213,6 +224,9 @@ class stResultPair{
       stResultPair(tObject * obj, tKey key){
          this->Object = obj;
          this->Key = key;
+         this->Serialized = NULL;
+         this->SerializedSize = 0;
+         this->Materializer = NULL;
       }//end stResultPair
 
       /**
@@ -225,17 +239,93 @@ class stResultPair{
          }//end if
       }//end ~stResultPair
 
+      /**
+      * Creates a new pair from a serialized object. The serialized object is
+      * copied into the same arena block of the pair and the object itself is
+      * only created by materializer when GetObject() is called for the first
+      * time. Pairs removed from a result before that never create it.
+      *
+      * @param arena The arena of the result.
+      * @param data The serialized object.
+      * @param size The size of the serialized object.
+      * @param key The key (distance) of the pair.
+      * @param materializer The function that rebuilds the object.
+      * @return The new pair. It must be disposed with delete.
+      */
+      static stResultPair * Create(stArena * arena, const unsigned char * data,
+            u_int32_t size, tKey key, tMaterializer materializer){
+         stResultPair * pair = new (arena, size) stResultPair(NULL, key);
+
+         pair->Serialized = ((unsigned char *) pair) + sizeof(stResultPair);
+         pair->SerializedSize = size;
+         pair->Materializer = materializer;
+         memcpy(pair->Serialized, data, size);
+         return pair;
+      }//end Create
+
+      /**
+      * Allocates a pair with the global operator new.
+      */
+      static void * operator new(size_t size){
+         tBlockHeader * header;
+
+         header = (tBlockHeader *) ::operator new(sizeof(tBlockHeader) + size);
+         header->Arena = NULL;
+         header->Size = sizeof(tBlockHeader) + size;
+         return header + 1;
+      }//end operator new
+
+      /**
+      * Allocates a pair from an arena.
+      *
+      * @param arena The arena.
+      * @param extra Number of bytes reserved after the pair.
+      */
+      static void * operator new(size_t size, stArena * arena, size_t extra){
+         tBlockHeader * header;
+
+         header = (tBlockHeader *) arena->Allocate(sizeof(tBlockHeader) + size + extra);
+         header->Arena = arena;
+         header->Size = sizeof(tBlockHeader) + size + extra;
+         return header + 1;
+      }//end operator new
+
+      /**
+      * Releases a pair allocated by any version of operator new.
+      */
+      static void operator delete(void * p){
+         tBlockHeader * header = ((tBlockHeader *) p) - 1;
+
+         if (header->Arena != NULL){
+            header->Arena->Release(header, header->Size);
+         }else{
+            ::operator delete(header);
+         }//end if
+      }//end operator delete
+
+      /**
+      * Releases a pair whose constructor failed.
+      */
+      static void operator delete(void * p, stArena * arena, size_t extra){
+         operator delete(p);
+      }//end operator delete
+
       /**
       * This method sets the object.
       */
       void SetObject(tObject * obj){
          Object = obj;
+         Materializer = NULL;
       }//end SetObject
 
       /**
-      * This method returns the object.
+      * This method returns the object. If the pair was created from a
+      * serialized object, it is rebuilt here.
       */
       tObject * GetObject() const{
+         if ((Object == NULL) && (Materializer != NULL)){
+            Object = Materializer(Serialized, SerializedSize);
+         }//end if
          return Object;
       }//end GetObject
 
@@ -271,16 +361,47 @@ class stResultPair{
 
    private:
 
+      /**
+      * Header of the memory blocks of the pairs. It tells operator delete
+      * where the block came from.
+      */
+      struct tBlockHeader{
+         /**
+         * The arena or NULL.
+         */
+         stArena * Arena;
+
+         /**
+         * Size of the block.
+         */
+         size_t Size;
+      };
+
       /**
       * The object.
       */
-      tObject * Object;
+      mutable tObject * Object;
 
       /**
       * The key employed to build the result. Regarding similarity queries, it
       *  is the distance from the query object.
       */
       tKey Key;
+
+      /**
+      * The serialized object or NULL.
+      */
+      unsigned char * Serialized;
+
+      /**
+      * Size of the serialized object.
+      */
+      u_int32_t SerializedSize;
+
+      /**
+      * The function that rebuilds the object or NULL.
+      */
+      tMaterializer Materializer;
       
 };//end stResultPair
 
@@ -35,8 +35,12 @@ stSlimMemLeafNode< ObjectType >::stSlimMemLeafNode(stSlimLeafNode * leafNode){
    this->numEntries = 0;
    this->capacity = numberOfEntries;
    this->maximumSize = (leafNode->GetPage())->GetPageSize();
-   this->usedSize = stSlimLeafNode::GetGlobalOverhead();
+   // Compact pages: the raw size is an upper bound of the compressed size.
+   if ((leafNode->GetPage())->GetStorageSize() < this->maximumSize){
+      this->maximumSize = (leafNode->GetPage())->GetStorageSize();
+   }//end if
    this->srcLeafNode = leafNode;
+   this->usedSize = leafNode->GetNodeOverhead();
    // Allocate memory for new entries.
    this->Entries = new stSlimMemNodeEntry[numberOfEntries * sizeof(stSlimMemNodeEntry)];
 
@@ -85,7 +89,7 @@ stSlimLeafNode * stSlimMemLeafNode< ObjectType >::ReleaseNode(){
    
    // update fields.
    this->numEntries = 0;
-   this->usedSize = stSlimLeafNode::GetGlobalOverhead();
+   this->usedSize = srcLeafNode->GetNodeOverhead();
    // return the leafNode
    return srcLeafNode;
 }//end stSlimMemLeafNode::ReleaseNode()
@@ -130,7 +134,7 @@ bool stSlimMemLeafNode< ObjectType >::Add(ObjectType * obj, double distance){
    // Update # of Entries
    this->numEntries++; // One more!
    // Update the usedSize
-   this->usedSize += obj->GetSerializedSize() + stSlimLeafNode::GetLeafEntryOverhead();
+   this->usedSize += obj->GetSerializedSize() + srcLeafNode->GetEntryOverhead();
 
    return true;
 }//end stSlimMemLeafNode::Add()
@@ -160,7 +164,7 @@ ObjectType * stSlimMemLeafNode< ObjectType >::Remove(u_int32_t idx){
    this->numEntries--; // One less!
    // Update the usedSize
    this->usedSize -= (returnObject->GetSerializedSize() +
-                      stSlimLeafNode::GetLeafEntryOverhead());
+                      srcLeafNode->GetEntryOverhead());
    // return the removed entry.
    return returnObject;
 }//end stSlimMemLeafNode::Remove
@@ -182,7 +186,7 @@ ObjectType * stSlimMemLeafNode< ObjectType >::PopObject(){
    this->numEntries--; // One less!
    // Update the usedSize
    this->usedSize -= (returnObject->GetSerializedSize() +
-                      stSlimLeafNode::GetLeafEntryOverhead());
+                      srcLeafNode->GetEntryOverhead());
    // return the removed entry.
    return returnObject;
 }//end stSlimMemLeafNode::PopObject
@@ -27,6 +27,7 @@
 #define __STSLIMNODE_H
 
 #include <arboretum/stPage.h>
+#include <arboretum/stCompress.h>
 #include <stdexcept>
 
 //-----------------------------------------------------------------------------
@@ -73,7 +74,14 @@ class stSlimNode{
          /**
          * ID of a leaf node.
          */
-         LEAF = 0x464C // In little endian "LF"
+         LEAF = 0x464C, // In little endian "LF"
+
+         /**
+         * ID of a leaf node whose entries also hold a quantized copy of
+         * their objects (see stSlimLeafNode). GetNodeType() reports it as
+         * LEAF.
+         */
+         CODEDLEAF = 0x434C // In little endian "LC"
       };//end stSlimNodeType
       
 
@@ -90,6 +98,9 @@ class stSlimNode{
       * @see stNodeType
       */
       u_int16_t GetNodeType(){
+         if (Header->Type == CODEDLEAF){
+            return LEAF;
+         }//end if
          return Header->Type;
       }//end GetNodeType
 
@@ -179,13 +190,9 @@ class stSlimNode{
       void RemoveAll(){
 
          #ifdef __stDEBUG__
-         u_int16_t type;
-         type = Header->Type;
-         Page->Clear();
-         Header->Type = type;
-         #else
-         this->Header->Occupation = 0;
+         memset(Page->GetData() + HeaderSize, 0, Page->GetPageSize() - HeaderSize);
          #endif //__stDEBUG__
+         this->Header->Occupation = 0;
       }//end RemoveAll
 
       /**
@@ -249,6 +256,11 @@ class stSlimNode{
       */
       stPage * Page;
 
+      /**
+      * Size of the fixed part of the page, kept by RemoveAll().
+      */
+      u_int32_t HeaderSize;
+
       /**
       * Creates a new instance of this class.
       *
@@ -257,6 +269,7 @@ class stSlimNode{
       stSlimNode(stPage * page){
          this->Page = page;
          Header = (stSlimNodeHeader *)(this->Page->GetData());
+         HeaderSize = sizeof(stSlimNodeHeader);
       }//end stSlimNode
 };//end stSlimNode
 
@@ -467,10 +480,29 @@ class stSlimIndexNode: public stSlimNode{
       }//end GetIndexEntryOverhead()
 
       /**
-      * Returns the amount of the free space in this node.
+      * Returns the amount of the free space in this node. If the page has a
+      * storage size smaller than its size, the free space is limited by the
+      * storage size.
       */
       u_int32_t GetFree();
 
+      /**
+      * Writes this node to a bit stream. The entries and objects are written
+      * without the free space between them.
+      *
+      * @param out The bit stream.
+      * @see Decompress()
+      */
+      void Compress(stCompressor & out);
+
+      /**
+      * Reads a node written by Compress(). This node must be empty.
+      *
+      * @param in The bit stream.
+      * @exception std::logic_error If the data does not fit in the page.
+      */
+      void Decompress(stDecompressor & in);
+
    private:
 
       /**
@@ -492,16 +524,24 @@ class stSlimIndexNode: public stSlimNode{
 * @image html leafnode.png "Leaf node structure"
 *
 * <P>The <b>Header</b> holds the information about the node itself.
-*     - Type: Type of this node. It is always stSlimNode::LEAF (0x464C).
+*     - Type: Type of this node. It is stSlimNode::LEAF (0x464C), or
+*       stSlimNode::CODEDLEAF (0x434C) if the entries have codes.
 *     - Occupation: Number of entries in this node.
+*     - CodeSize: Size of the codes of each entry. Only in CODEDLEAF nodes.
 *
 * <P>The <b>Entry</b> holds the information of the link to the other node.
 *       - Distance: The distance of this object from the representative object.
 *       - Offset: The offset of the object in the page. DO NOT MODIFY ITS VALUE.
+*       - Code: CodeSize bytes of codes, written by the tree. Only in
+*         CODEDLEAF nodes.
 *
 * <P>The <b>Object</b> is an array of bytes that holds the information required
 * to rebuild the original object.
 *
+* <P>The codes are a quantized copy of the object (see QuantizedBounds). They
+* are stored with the entries, apart from the objects, so a query that
+* rejects an entry by its codes does not read its object at all.
+*
 * @version 1.0
 * @author Fabio Jun Takada Chino (chino@icmc.usp.br)
 * @author Marcos Rodrigues Vieira (mrvieira@icmc.usp.br)
@@ -516,6 +556,9 @@ class stSlimIndexNode: public stSlimNode{
 // +--------------------------------------------------------------------------------------------+
 // | Type | Occupation | Dist0 | OffSet0 | Distn | OffSetn | <-- blankspace --> |Objn |...|Obj0 |
 // +--------------------------------------------------------------------------------------------+
+// +---------------------------------------------------------------------------------------------+
+// | Type | Occupation | CodeSize | Dist0 | OffSet0 | Code0 | ... | <-- blankspace --> |...|Obj0 |
+// +---------------------------------------------------------------------------------------------+
 class stSlimLeafNode: public stSlimNode{
    public:
       /**
@@ -547,8 +590,10 @@ class stSlimLeafNode: public stSlimNode{
       *
       * @param page The page that hold the data of this node.
       * @param create The operation to be performed.
+      * @param codeSize The size of the codes of each entry of a new node, or
+      * 0 for no codes. An existing node keeps its own.
       */
-      stSlimLeafNode(stPage * page, bool create = false);
+      stSlimLeafNode(stPage * page, bool create = false, u_int32_t codeSize = 0);
 
       /**
       * Returns the reference of the desired leaf entry. You may use this method to
@@ -570,10 +615,34 @@ class stSlimLeafNode: public stSlimNode{
          }//end if
          #endif //__stDEBUG__
 
-         return Entries[idx];
+         return Entry(idx);
       }//end GetLeafEntry
 
+      /**
+      * Returns the size of the codes of each entry, or 0 if the entries have
+      * no codes.
+      */
+      u_int32_t GetCodeSize(){
+         return CodeSize;
+      }//end GetCodeSize
+
+      /**
+      * Returns the codes of an entry. They may be read and written.
+      *
+      * @param idx The idx of the leaf entry.
+      * @warning The parameter idx is not verified by this implementation
+      * unless __stDEBUG__ is defined at compile time.
+      * @return The GetCodeSize() bytes of the codes.
+      */
+      unsigned char * GetLeafCode(u_int32_t idx){
+         #ifdef __stDEBUG__
+         if (idx >= GetNumberOfEntries()){
+            throw std::logic_error("idx value is out of range.");
+         }//end if
+         #endif //__stDEBUG__
 
+         return Entries + (idx * EntrySize) + sizeof(stSlimLeafEntry);
+      }//end GetLeafCode
 
       /**
        * Returns Parent Distance.
@@ -590,7 +659,7 @@ class stSlimLeafNode: public stSlimNode{
          }//end if
          #endif //__stDEBUG__
 
-         return Entries[idx].Distance;
+         return Entry(idx).Distance;
       }
       
       
@@ -676,20 +745,196 @@ class stSlimLeafNode: public stSlimNode{
          return sizeof(stSlimLeafEntry);
       }//end GetLeafEntryOverhead()
 
+      /**
+      * Returns the overhead of each entry of this node in bytes, including
+      * its codes.
+      */
+      u_int32_t GetEntryOverhead(){
+         return EntrySize;
+      }//end GetEntryOverhead()
+
+      /**
+      * Returns the size of the header of this node in bytes.
+      */
+      u_int32_t GetNodeOverhead(){
+         return HeaderSize;
+      }//end GetNodeOverhead()
+
       /**
       * Returns the amount of the free space in this node.
       */
       u_int32_t GetFree();
 
+      /**
+      * Writes this node to a bit stream. Object sizes equal to the size of
+      * the previous object use a single bit and each object may be stored as
+      * the difference (XOR) to the previous one, where equal bytes use a
+      * single bit. Distances are stored as they are.
+      *
+      * @param out The bit stream.
+      * @see Decompress()
+      */
+      void Compress(stCompressor & out);
+
+      /**
+      * Reads a node written by Compress(). This node must be empty.
+      *
+      * @param in The bit stream.
+      * @exception std::logic_error If the data does not fit in the page.
+      */
+      void Decompress(stDecompressor & in);
+
+      /**
+      * Returns the number of bytes written by Compress(). The size of the
+      * entries is computed once and then updated by AddEntry(), so filling
+      * a compact node does not encode it again for each new entry.
+      */
+      u_int32_t GetCompressedSize();
+
    private:
       /**
       * Entry pointer
       */
-      stSlimLeafEntry * Entries;
+      unsigned char * Entries;
+
+      /**
+      * Size of the codes of each entry.
+      */
+      u_int32_t CodeSize;
+
+      /**
+      * Size of each entry, codes included.
+      */
+      u_int32_t EntrySize;
+
+      /**
+      * Returns an entry.
+      *
+      * @param idx The idx of the entry.
+      */
+      stSlimLeafEntry & Entry(u_int32_t idx){
+         return *((stSlimLeafEntry *)(Entries + (idx * EntrySize)));
+      }//end Entry
+
+      /**
+      * Number of bits written by Compress() for the first CompressedCount
+      * entries.
+      */
+      u_int32_t CompressedBits;
+
+      /**
+      * Number of entries included in CompressedBits.
+      */
+      u_int32_t CompressedCount;
+
+      /**
+      * Returns the number of bits written by Compress() for an entry. It
+      * depends only on the entry and on the previous one.
+      *
+      * @param idx The idx of the entry.
+      */
+      u_int32_t GetEntryCompressedBits(u_int32_t idx);
+
+      /**
+      * Returns the number of bits written by WriteVarUInt() for a value.
+      *
+      * @param value The value.
+      */
+      static u_int32_t GetVarUIntBits(u_int32_t value){
+         u_int32_t bits = 8;
+
+         while (value >= 0x80){
+            bits += 8;
+            value >>= 7;
+         }//end while
+         return bits;
+      }//end GetVarUIntBits
 
 
 };//end stSlimLeafNode
 
+//-----------------------------------------------------------------------------
+// Class stSlimPageCodec
+//-----------------------------------------------------------------------------
+/**
+* This class stores the SlimTree nodes in a compact form. Leaf nodes are
+* compressed by stSlimLeafNode::Compress() and index nodes lose the free space
+* between entries and objects. Other pages are stored without their trailing
+* zeroes.
+*
+* <P>The nodes check their compact size against stPage::GetStorageSize(), so
+* an encoded node always fits in the storage.
+*
+* @see stCompressedPageManager
+* @ingroup slim
+*/
+class stSlimPageCodec: public stPageCodec{
+   public:
+      /**
+      * Encodes a page.
+      *
+      * @param page The page.
+      * @param dst The destination buffer.
+      * @param size The size of the destination buffer.
+      * @return The number of bytes written or 0 if the encoded page does
+      * not fit in the destination buffer.
+      */
+      virtual u_int32_t Encode(stPage * page, unsigned char * dst,
+            u_int32_t size);
+
+      /**
+      * Decodes a page encoded by Encode().
+      *
+      * @param src The encoded page.
+      * @param size The size of the encoded page.
+      * @param page The destination page.
+      * @exception std::logic_error If the data is not valid.
+      */
+      virtual void Decode(const unsigned char * src, u_int32_t size,
+            stPage * page);
+
+   private:
+      /**
+      * Formats of the encoded pages.
+      */
+      enum tFormat{
+         /**
+         * Page filled with zeroes.
+         */
+         fmZERO = 0,
+
+         /**
+         * Page without its trailing zeroes.
+         */
+         fmRAW = 1,
+
+         /**
+         * Leaf node.
+         */
+         fmLEAF = 2,
+
+         /**
+         * Index node.
+         */
+         fmINDEX = 3,
+
+         /**
+         * Leaf node with codes, preceded by the size of the codes.
+         */
+         fmCODEDLEAF = 4
+      };//end tFormat
+
+      /**
+      * Output stream.
+      */
+      stBitCompressor out;
+
+      /**
+      * Input stream.
+      */
+      stBitDecompressor in;
+};//end stSlimPageCodec
+
 //-----------------------------------------------------------------------------
 // Class stSlimMemLeafNode
 //-----------------------------------------------------------------------------
@@ -835,7 +1080,7 @@ class stSlimMemLeafNode{
          int entrySize;
 
          // Does it fit ?
-         entrySize = obj->GetSerializedSize() + stSlimLeafNode::GetLeafEntryOverhead();
+         entrySize = obj->GetSerializedSize() + srcLeafNode->GetEntryOverhead();
          if (entrySize + this->usedSize > this->maximumSize){
             // No, it doesn't.
             return false;
@@ -802,6 +802,13 @@ tmpl_stSlimTree::stSlimTree(stPageManager * pageman):
 
    this->maxQueue = 0;
 
+   // Prefetch and pinned nodes are disabled.
+   prefetchDepth = 0;
+   leafCodeSize = stLeafCodes<EvaluatorType, ObjectType>::GetCodeSize(
+         this->myMetricEvaluator);
+   pinnedLevels = 0;
+   pinnedValid = false;
+
    // Will I create or load the tree ?
    if (tMetricTree::myPageManager->IsEmpty()){
       DefaultHeader();
@@ -827,6 +834,13 @@ tmpl_stSlimTree::stSlimTree(stPageManager * pageman, EvaluatorType * metricEval)
    // Load header.
    LoadHeader();
 
+   // Prefetch and pinned nodes are disabled.
+   prefetchDepth = 0;
+   leafCodeSize = stLeafCodes<EvaluatorType, ObjectType>::GetCodeSize(
+         this->myMetricEvaluator);
+   pinnedLevels = 0;
+   pinnedValid = false;
+
    // Will I create or load the tree ?
    if (tMetricTree::myPageManager->IsEmpty()){
       DefaultHeader();
@@ -844,6 +858,7 @@ tmpl_stSlimTree::~stSlimTree(){
 
    // Flus header page.
    FlushHeader();
+   UnpinNodes();
 
    // Visualization support
    #ifdef __stMAMVIEW__
@@ -936,7 +951,7 @@ bool tmpl_stSlimTree::Add(ObjectType *newObj){
    if (this->GetRoot() == 0){
       // No! We shall create the new node.
       stPage * auxPage  = this->NewPage();
-      stSlimLeafNode * leafNode = new stSlimLeafNode(auxPage, true);
+      stSlimLeafNode * leafNode = new stSlimLeafNode(auxPage, true, leafCodeSize);
       this->SetRoot(auxPage->GetPageID());
 
       // Insert the new object.
@@ -959,11 +974,11 @@ bool tmpl_stSlimTree::Add(ObjectType *newObj){
          // Update the Height
          Header->Height++;
          // Write the root node.
-         tMetricTree::myPageManager->WritePage(auxPage);
+         WritePage(auxPage);
       }//end if
       delete leafNode;
 	  leafNode = 0;
-      delete auxPage;
+      tMetricTree::myPageManager->ReleasePage(auxPage);
 	  auxPage = 0;
    }else{
       // Let's continue our search for the grail!
@@ -984,6 +999,8 @@ bool tmpl_stSlimTree::Add(ObjectType *newObj){
 
    // Report the modification.
    HeaderUpdate = true;
+   // Load the pinned nodes that were modified.
+   RepinNodes();
    // Ok. The new object was inserted. Return success!
    return true;
 }//end stSlimTree<ObjectType, EvaluatorType>::Add
@@ -1212,7 +1229,7 @@ void tmpl_stSlimTree::AddNewRoot(
    // Update tree
    Header->Height++;
    SetRoot(newRoot->GetPage()->GetPageID());
-   tMetricTree::myPageManager->WritePage(newPage);
+   WritePage(newPage);
 
    // Dispose page
    delete newRoot;
@@ -1327,7 +1344,7 @@ int tmpl_stSlimTree::InsertRecursive(
                      repObj, promo1, promo2);
 
                // Write nodes
-               tMetricTree::myPageManager->WritePage(newPage);
+               WritePage(newPage);
                // Clean home.
                delete newIndexNode;
 			   newIndexNode = 0;
@@ -1380,7 +1397,7 @@ int tmpl_stSlimTree::InsertRecursive(
                         repObj, promo1, promo2);
 
                   // Write nodes
-                  tMetricTree::myPageManager->WritePage(newPage);
+                  WritePage(newPage);
                   // Clean home.
                   delete newIndexNode;
 				  newIndexNode = 0;
@@ -1488,7 +1505,7 @@ int tmpl_stSlimTree::InsertRecursive(
                            repObj, promo1, promo2);
 
                      // Write nodes
-                     tMetricTree::myPageManager->WritePage(newPage);
+                     WritePage(newPage);
                      // Clean home.
                      delete newIndexNode;
 					 newIndexNode = 0;
@@ -1508,7 +1525,7 @@ int tmpl_stSlimTree::InsertRecursive(
                         repObj, promo1, promo2);
 
                   // Write nodes
-                  tMetricTree::myPageManager->WritePage(newPage);
+                  WritePage(newPage);
                   // Clean home.
                   delete newIndexNode;
 				  newIndexNode = 0;
@@ -1541,7 +1558,7 @@ int tmpl_stSlimTree::InsertRecursive(
          leafNode->GetLeafEntry(insertIdx).Distance = dist;
 
          // Write node.
-         tMetricTree::myPageManager->WritePage(currPage);
+         WritePage(currPage);
 
          // Returning values
          promo1.Rep = NULL;
@@ -1553,14 +1570,14 @@ int tmpl_stSlimTree::InsertRecursive(
          // Split it!
          // New node.
          newPage = this->NewPage();
-         newLeafNode = new stSlimLeafNode(newPage, true);
+         newLeafNode = new stSlimLeafNode(newPage, true, leafCodeSize);
 
          // Split!
          SplitLeaf(leafNode, newLeafNode, (ObjectType *)newObj->Clone(),
                    repObj, promo1, promo2);
 
          // Write node.
-         tMetricTree::myPageManager->WritePage(newPage);
+         WritePage(newPage);
          // Clean home.
          delete newLeafNode;
 		 newLeafNode = 0;
@@ -1571,7 +1588,7 @@ int tmpl_stSlimTree::InsertRecursive(
    }//end if
 
    // Write node.
-   tMetricTree::myPageManager->WritePage(currPage);
+   WritePage(currPage);
    // Clean home
    delete currNode;
    currNode = 0;
@@ -1639,8 +1656,8 @@ void tmpl_stSlimTree::MinMaxPromote(tLogicNode * node) {
       delete indexNode2;
 	  indexNode2 = 0;
    }else{//it is a Leaf node
-      stSlimLeafNode * leafNode1 = new stSlimLeafNode(newPage1, true);
-      stSlimLeafNode * leafNode2 = new stSlimLeafNode(newPage2, true);
+      stSlimLeafNode * leafNode1 = new stSlimLeafNode(newPage1, true, leafCodeSize);
+      stSlimLeafNode * leafNode2 = new stSlimLeafNode(newPage2, true, leafCodeSize);
 
       for (i = 0; i < numberOfEntries; i++) {
          for (j = i + 1; j < numberOfEntries; j++) {
@@ -3113,6 +3130,142 @@ long tmpl_stSlimTree::GetIndexNodeCount(u_int32_t pageID){
    return nodeCount;
 }//end stSlimTree<ObjectType, EvaluatorType>::GetIndexNodeCount
 
+//------------------------------------------------------------------------------
+template <class ObjectType, class EvaluatorType>
+void tmpl_stSlimTree::GetUpperLevelPages(u_int32_t levels,
+      std::vector<u_int32_t> & pageIDs){
+   stPage * currPage;
+   stSlimNode * currNode;
+   u_int32_t idx;
+   u_int32_t numberOfEntries;
+   u_int32_t level;
+   u_int32_t first;
+   u_int32_t last;
+   u_int32_t i;
+
+   pageIDs.clear();
+   if ((this->GetRoot() == 0) || (levels == 0)){
+      return;
+   }//end if
+
+   // Breadth first. Each level is the range [first, last) of pageIDs.
+   pageIDs.push_back(this->GetRoot());
+   first = 0;
+   for (level = 1; level < levels; level++){
+      last = pageIDs.size();
+      for (i = first; i < last; i++){
+         currPage = this->myPageManager->GetPage(pageIDs[i]);
+         currNode = stSlimNode::CreateNode(currPage);
+         if (currNode->GetNodeType() == stSlimNode::INDEX){
+            stSlimIndexNode * indexNode = (stSlimIndexNode *)currNode;
+            numberOfEntries = indexNode->GetNumberOfEntries();
+            for (idx = 0; idx < numberOfEntries; idx++){
+               pageIDs.push_back(indexNode->GetIndexEntry(idx).PageID);
+            }//end for
+         }//end if
+         delete currNode;
+         this->myPageManager->ReleasePage(currPage);
+      }//end for
+      first = last;
+   }//end for
+}//end stSlimTree<ObjectType, EvaluatorType>::GetUpperLevelPages
+
+//------------------------------------------------------------------------------
+template <class ObjectType, class EvaluatorType>
+stSlimNode * tmpl_stSlimTree::ReadNode(u_int32_t pageID, stPage * & page,
+      ObjectType ** & objects){
+   typename std::unordered_map<u_int32_t, tPinnedNode>::iterator i;
+
+   if (!pinnedNodes.empty()){
+      i = pinnedNodes.find(pageID);
+      if (i != pinnedNodes.end()){
+         page = NULL;
+         objects = i->second.Objects;
+         return i->second.Node;
+      }//end if
+   }//end if
+
+   page = tMetricTree::myPageManager->GetPage(pageID);
+   objects = NULL;
+   return stSlimNode::CreateNode(page);
+}//end stSlimTree<ObjectType, EvaluatorType>::ReadNode
+
+//------------------------------------------------------------------------------
+template <class ObjectType, class EvaluatorType>
+void tmpl_stSlimTree::PinNodes(){
+   std::vector<u_int32_t> pageIDs;
+   stPage * currPage;
+   tPinnedNode pinned;
+   u_int32_t idx;
+   u_int32_t i;
+
+   UnpinNodes();
+   GetUpperLevelPages(pinnedLevels, pageIDs);
+   for (i = 0; i < pageIDs.size(); i++){
+      currPage = tMetricTree::myPageManager->GetPage(pageIDs[i]);
+      pinned.Page = new stPage(currPage->GetPageSize(), currPage->GetPageID());
+      pinned.Page->Copy(currPage);
+      tMetricTree::myPageManager->ReleasePage(currPage);
+      pinned.Node = (stSlimIndexNode *) stSlimNode::CreateNode(pinned.Page);
+      if (pinned.Node->GetNodeType() == stSlimNode::INDEX){
+         pinned.Objects = new ObjectType * [pinned.Node->GetNumberOfEntries()];
+         for (idx = 0; idx < pinned.Node->GetNumberOfEntries(); idx++){
+            pinned.Objects[idx] = new ObjectType();
+            pinned.Objects[idx]->Unserialize(pinned.Node->GetObject(idx),
+                  pinned.Node->GetObjectSize(idx));
+         }//end for
+         pinnedNodes[pageIDs[i]] = pinned;
+      }else{
+         // Leaves are not kept.
+         delete pinned.Node;
+         delete pinned.Page;
+      }//end if
+   }//end for
+   pinnedValid = true;
+}//end stSlimTree<ObjectType, EvaluatorType>::PinNodes
+
+//------------------------------------------------------------------------------
+template <class ObjectType, class EvaluatorType>
+void tmpl_stSlimTree::UnpinNodes(){
+   typename std::unordered_map<u_int32_t, tPinnedNode>::iterator i;
+   u_int32_t idx;
+
+   for (i = pinnedNodes.begin(); i != pinnedNodes.end(); i++){
+      for (idx = 0; idx < i->second.Node->GetNumberOfEntries(); idx++){
+         delete i->second.Objects[idx];
+      }//end for
+      delete[] i->second.Objects;
+      delete i->second.Node;
+      delete i->second.Page;
+   }//end for
+   pinnedNodes.clear();
+   pinnedValid = false;
+}//end stSlimTree<ObjectType, EvaluatorType>::UnpinNodes
+
+//------------------------------------------------------------------------------
+template <class ObjectType, class EvaluatorType>
+void tmpl_stSlimTree::EncodeLeafCodes(stPage * page){
+   stSlimNode * currNode;
+   stSlimLeafNode * leafNode;
+   ObjectType tmpObj;
+   u_int32_t idx;
+
+   currNode = stSlimNode::CreateNode(page);
+   if ((currNode != NULL) && (currNode->GetNodeType() == stSlimNode::LEAF)){
+      leafNode = (stSlimLeafNode *) currNode;
+      // A leaf written with other codes is never filtered.
+      if (leafNode->GetCodeSize() == leafCodeSize){
+         for (idx = 0; idx < leafNode->GetNumberOfEntries(); idx++){
+            tmpObj.Unserialize(leafNode->GetObject(idx),
+                               leafNode->GetObjectSize(idx));
+            stLeafCodes<EvaluatorType, ObjectType>::Encode(
+                  this->myMetricEvaluator, tmpObj, leafNode->GetLeafCode(idx));
+         }//end for
+      }//end if
+   }//end if
+   delete currNode;
+}//end stSlimTree<ObjectType, EvaluatorType>::EncodeLeafCodes
+
 //------------------------------------------------------------------------------
 template <class ObjectType, class EvaluatorType>
 long tmpl_stSlimTree::GetLeafNodeCount(){
@@ -4301,11 +4454,6 @@ template <class ObjectType, class EvaluatorType>
 stResult<ObjectType> * tmpl_stSlimTree::RangeQuery(
             ObjectType * sample, double range){
    tResult * result = new tResult();  // Create result
-   stPage * currPage;
-   stSlimNode * currNode;
-   ObjectType tmpObj;
-   u_int32_t idx, numberOfEntries;
-   double distance;
    #ifdef __stMAMVIEW__
       stMessageString title;
       stMessageString comment;
@@ -4325,11 +4473,49 @@ stResult<ObjectType> * tmpl_stSlimTree::RangeQuery(
       MAMViewer->BeginAnimation(title.GetStr(), comment.GetStr());
    #endif //__stMAMVIEW__
 
+   // Let's search
+   this->RangeQuery(result, sample, range);
+
+   // Visualization support
+   #ifdef __stMAMVIEW__
+      // Add the last frame with the final result
+      comment.Clear();
+      comment.Append("The final result has ");
+      comment.Append((int)result->GetNumOfEntries());
+      comment.Append(" object(s) and radius ");
+      comment.Append((double)result->GetMaximumDistance());
+      MAMViewer->BeginFrame(comment.GetStr());
+      MAMViewer->SetResult(sample, result);
+      MAMViewer->EndFrame();
+      MAMViewer->EndAnimation();
+   #endif //__stMAMVIEW__
+   return result;
+}//end stSlimTree<ObjectType, EvaluatorType>::RangeQuery
+
+//------------------------------------------------------------------------------
+template <class ObjectType, class EvaluatorType>
+template <class ResultType>
+void tmpl_stSlimTree::RangeQuery(ResultType * result, ObjectType * sample,
+                                 double range){
+   stPage * currPage;
+   stSlimNode * currNode;
+   ObjectType ** objects;
+   tViewer viewer;
+   tCandidateBatch candidates;
+   #ifdef __stMAMVIEW__
+      ObjectType tmpObj;
+      stMessageString comment;
+   #endif //__stMAMVIEW__
+   u_int32_t idx, numberOfEntries;
+   double distance;
+
+   // Let the evaluator prepare the sample
+   tPreparedQuery query(this->myMetricEvaluator, sample);
+
    // Evaluate the root node.
    if (this->GetRoot() != 0){
       // Read node...
-      currPage = tMetricTree::myPageManager->GetPage(this->GetRoot());
-      currNode = stSlimNode::CreateNode(currPage);
+      currNode = ReadNode(this->GetRoot(), currPage, objects);
 
 
 
@@ -4354,22 +4540,33 @@ stResult<ObjectType> * tmpl_stSlimTree::RangeQuery(
                MAMViewer->SetNode(indexNode->GetIndexEntry(idx).PageID, &tmpObj,
                      indexNode->GetIndexEntry(idx).Radius, this->GetRoot(), 0, true);
             }//end for
-            MAMViewer->SetResult(sample, result);
+            SetViewerResult(query.GetSample(), result);
             MAMViewer->EndFrame();
          #endif //__stMAMVIEW__
 
+         // Hint the children.
+         if (prefetchDepth > 0){
+            PrefetchChildren(indexNode, range, -1);
+         }//end if
+
          // For each entry...
          for (idx = 0; idx < numberOfEntries; idx++) {
-            // Rebuild the object
-            tmpObj.Unserialize(indexNode->GetObject(idx),
-                               indexNode->GetObjectSize(idx));
             // Evaluate distance
-            distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
+            if (objects != NULL){
+               distance = query.GetDistanceBounded(*objects[idx],
+                     range + indexNode->GetIndexEntry(idx).Radius);
+            }else{
+               // Read the object
+               tView & view = viewer.Wrap(indexNode->GetObject(idx),
+                                          indexNode->GetObjectSize(idx));
+               distance = query.GetDistanceBounded(view,
+                     range + indexNode->GetIndexEntry(idx).Radius);
+            }//end if
             // test if this subtree qualifies.
             if (distance <= range + indexNode->GetIndexEntry(idx).Radius){
                // Yes! Analyze this subtree.
                this->RangeQuery(indexNode->GetIndexEntry(idx).PageID, result,
-                                sample, range, distance);
+                                query, candidates, range, distance);
             }//end if
          }//end for
          
@@ -4392,51 +4589,60 @@ stResult<ObjectType> * tmpl_stSlimTree::RangeQuery(
             MAMViewer->EndFrame();
          #endif //__stMAMVIEW__
          
-         // For each entry...
+         // Gather the entries whose codes do not reject them...
+         candidates.Clear();
          for (idx = 0; idx < numberOfEntries; idx++) {
-            // Rebuild the object
-            tmpObj.Unserialize(leafNode->GetObject(idx),
-                               leafNode->GetObjectSize(idx));
-            // Evaluate distance
-            distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
+            if (!IsCodeRejected(leafNode, idx, query, range)){
+               candidates.Add(leafNode->GetObject(idx),
+                              leafNode->GetObjectSize(idx), idx);
+            }//end if
+         }//end for
+         // ...and evaluate them at once.
+         candidates.GetDistances(query, range);
+         for (idx = 0; idx < candidates.GetCount(); idx++) {
+            distance = candidates.GetDistance(idx);
             // is it a object that qualified?
             if (distance <= range){
                // Yes! Put it in the result set.
-               result->AddPair((ObjectType*) tmpObj.Clone(), distance);
+               AddResult(result, leafNode, candidates.GetIndex(idx),
+                         candidates.GetEntry(idx), distance);
             }//end if
          }//end for
       }//end else
 
       // Free it all
-      delete currNode;
+      ReleaseNode(currNode, currPage);
 	  currNode = 0;
-      tMetricTree::myPageManager->ReleasePage(currPage);
    }//end if
+}//end stSlimTree<ObjectType, EvaluatorType>::RangeQuery
 
-   // Visualization support
-   #ifdef __stMAMVIEW__
-      // Add the last frame with the final result
-      comment.Clear();
-      comment.Append("The final result has ");
-      comment.Append((int)result->GetNumOfEntries());
-      comment.Append(" object(s) and radius ");
-      comment.Append((double)result->GetMaximumDistance());
-      MAMViewer->BeginFrame(comment.GetStr());
-      MAMViewer->SetResult(sample, result);
-      MAMViewer->EndFrame();
-      MAMViewer->EndAnimation();
-   #endif //__stMAMVIEW__
+//------------------------------------------------------------------------------
+template <class ObjectType, class EvaluatorType>
+stIdResult * tmpl_stSlimTree::IdRangeQuery(ObjectType * sample, double range){
+   if (!stViewOID<tView>::Supported){
+      throw std::logic_error("Unsupported method! The objects have no OID.");
+   }//end if
+
+   stIdResult * result = new stIdResult();
+
+   result->SetQueryInfo(RANGEQUERY, -1, range, false);
+   this->RangeQuery(result, sample, range);
    return result;
-}//end stSlimTree<ObjectType, EvaluatorType>::RangeQuery
+}//end stSlimTree<ObjectType, EvaluatorType>::IdRangeQuery
 
 //------------------------------------------------------------------------------
 template <class ObjectType, class EvaluatorType>
+template <class ResultType>
 void tmpl_stSlimTree::RangeQuery(
-         u_int32_t pageID, tResult * result, ObjectType * sample,
-         double range, double distanceRepres){
+         u_int32_t pageID, ResultType * result, tPreparedQuery & query,
+         tCandidateBatch & candidates, double range, double distanceRepres){
    stPage * currPage;
    stSlimNode * currNode;
-   ObjectType tmpObj;
+   ObjectType ** objects;
+   tViewer viewer;
+   #ifdef __stMAMVIEW__
+      ObjectType tmpObj;
+   #endif //__stMAMVIEW__
    double distance;
    u_int32_t idx;
    u_int32_t numberOfEntries;
@@ -4447,8 +4653,7 @@ void tmpl_stSlimTree::RangeQuery(
    // Let's search
    if (pageID != 0){
       // Read node...
-      currPage = tMetricTree::myPageManager->GetPage(pageID);
-      currNode = stSlimNode::CreateNode(currPage);
+      currNode = ReadNode(pageID, currPage, objects);
       // Is it an Index node?
       if (currNode->GetNodeType() == stSlimNode::INDEX) {
          // Get Index node
@@ -4473,25 +4678,36 @@ void tmpl_stSlimTree::RangeQuery(
                MAMViewer->SetNode(indexNode->GetIndexEntry(idx).PageID, &tmpObj,
                      indexNode->GetIndexEntry(idx).Radius, pageID, 0, true);
             }//end for
-            MAMViewer->SetResult(sample, result);
+            SetViewerResult(query.GetSample(), result);
             MAMViewer->EndFrame();
          #endif //__stMAMVIEW__
 
+         // Hint the children that survive the triangle inequality.
+         if (prefetchDepth > 0){
+            PrefetchChildren(indexNode, range, distanceRepres);
+         }//end if
+
          // For each entry...
          for (idx = 0; idx < numberOfEntries; idx++) {
             // use of the triangle inequality to cut a subtree
             if ( fabs(distanceRepres - indexNode->GetIndexEntry(idx).Distance) <=
                       range + indexNode->GetIndexEntry(idx).Radius){
-               // Rebuild the object
-               tmpObj.Unserialize(indexNode->GetObject(idx),
-                                  indexNode->GetObjectSize(idx));
                // Evaluate distance
-               distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
+               if (objects != NULL){
+                  distance = query.GetDistanceBounded(*objects[idx],
+                        range + indexNode->GetIndexEntry(idx).Radius);
+               }else{
+                  // Read the object
+                  tView & view = viewer.Wrap(indexNode->GetObject(idx),
+                                             indexNode->GetObjectSize(idx));
+                  distance = query.GetDistanceBounded(view,
+                        range + indexNode->GetIndexEntry(idx).Radius);
+               }//end if
                // is this a qualified subtree?
                if (distance <= range + indexNode->GetIndexEntry(idx).Radius){
                   // Yes! Analyze it!
                   this->RangeQuery(indexNode->GetIndexEntry(idx).PageID, result,
-                                    sample, range, distance);
+                                    query, candidates, range, distance);
                   #ifdef __stMAMVIEW__
                      comment.Clear();
                      comment.Append("Returning to the index node ");
@@ -4533,21 +4749,25 @@ void tmpl_stSlimTree::RangeQuery(
             MAMViewer->EndFrame();
          #endif //__stMAMVIEW__
          
-         // for each entry...
+         // Gather the entries that survive the triangle inequality and
+         // their codes...
+         candidates.Clear();
          for (idx = 0; idx < numberOfEntries; idx++) {
-            // use of the triangle inequality.
-            if ( fabs(distanceRepres - leafNode->GetLeafEntry(idx).Distance) <=
-                      range){
-               // Rebuild the object
-               tmpObj.Unserialize(leafNode->GetObject(idx),
-                                  leafNode->GetObjectSize(idx));
-               // No, it is not a representative. Evaluate distance
-               distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
-               // Is this a qualified object?
-               if (distance <= range){
-                  // Yes! Put it in the result set.
-                  result->AddPair((ObjectType*) tmpObj.Clone(), distance);
-               }//end if
+            if (( fabs(distanceRepres - leafNode->GetLeafEntry(idx).Distance) <=
+                      range) && !IsCodeRejected(leafNode, idx, query, range)){
+               candidates.Add(leafNode->GetObject(idx),
+                              leafNode->GetObjectSize(idx), idx);
+            }//end if
+         }//end for
+         // ...and evaluate them at once.
+         candidates.GetDistances(query, range);
+         for (idx = 0; idx < candidates.GetCount(); idx++) {
+            distance = candidates.GetDistance(idx);
+            // Is this a qualified object?
+            if (distance <= range){
+               // Yes! Put it in the result set.
+               AddResult(result, leafNode, candidates.GetIndex(idx),
+                         candidates.GetEntry(idx), distance);
             }//end if
          }//end for
 
@@ -4562,15 +4782,14 @@ void tmpl_stSlimTree::RangeQuery(
             comment.Append(" object(s) and radius ");
             comment.Append((double)result->GetMaximumDistance());
             MAMViewer->BeginFrame(comment.GetStr());
-            MAMViewer->SetResult(sample, result);
+            SetViewerResult(query.GetSample(), result);
             MAMViewer->EndFrame();
          #endif //__stMAMVIEW__
       }//end else
 
       // Free it all
-      delete currNode;
+      ReleaseNode(currNode, currPage);
 	  currNode = 0;
-      tMetricTree::myPageManager->ReleasePage(currPage);
    }//end if
 }//end stSlimTree<ObjectType, EvaluatorType>::RangeQuery
 
@@ -4587,6 +4806,9 @@ stResult<ObjectType> * tmpl_stSlimTree::ReversedRangeQuery(
 
    result->SetQueryInfo(sample->Clone(), REVERSEDRANGEQUERY, -1, range, false);
 
+   // Let the evaluator prepare the sample
+   tPreparedQuery query(this->myMetricEvaluator, sample);
+
    // Evaluate the root node.
    if (this->GetRoot() != 0){
       // Read node...
@@ -4605,12 +4827,12 @@ stResult<ObjectType> * tmpl_stSlimTree::ReversedRangeQuery(
             tmpObj.Unserialize(indexNode->GetObject(idx),
                                indexNode->GetObjectSize(idx));
             // Evaluate distance
-            distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
+            distance = query.GetDistance(tmpObj);
             // test if this subtree qualifies.
             if (distance + indexNode->GetIndexEntry(idx).Radius >= range){
                // Yes! Analyze this subtree.
                this->ReversedRangeQuery(indexNode->GetIndexEntry(idx).PageID, result,
-                                        sample, range, distance);
+                                        query, range, distance);
             }//end if
          }//end for
 
@@ -4625,11 +4847,12 @@ stResult<ObjectType> * tmpl_stSlimTree::ReversedRangeQuery(
             tmpObj.Unserialize(leafNode->GetObject(idx),
                                leafNode->GetObjectSize(idx));
             // Evaluate distance
-            distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
+            distance = query.GetDistance(tmpObj);
             // is it a object that qualified?
             if (distance >= range){
                // Yes! Put it in the result set.
-               result->AddPair(tmpObj.Clone(), distance);
+               result->AddPair(leafNode->GetObject(idx),
+                               leafNode->GetObjectSize(idx), distance);
             }//end if
          }//end for
       }//end else
@@ -4646,7 +4869,7 @@ stResult<ObjectType> * tmpl_stSlimTree::ReversedRangeQuery(
 //------------------------------------------------------------------------------
 template <class ObjectType, class EvaluatorType>
 void tmpl_stSlimTree::ReversedRangeQuery(
-         u_int32_t pageID, tResult * result, ObjectType * sample,
+         u_int32_t pageID, tResult * result, tPreparedQuery & query,
          double range, double distanceRepres){
    stPage * currPage;
    stSlimNode * currNode;
@@ -4675,12 +4898,12 @@ void tmpl_stSlimTree::ReversedRangeQuery(
                tmpObj.Unserialize(indexNode->GetObject(idx),
                                   indexNode->GetObjectSize(idx));
                // Evaluate distance
-               distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
+               distance = query.GetDistance(tmpObj);
                // is this a qualified subtree?
                if (distance + indexNode->GetIndexEntry(idx).Radius >= range){
                   // Yes! Analyze it!
                   this->ReversedRangeQuery(indexNode->GetIndexEntry(idx).PageID, result,
-                                           sample, range, distance);
+                                           query, range, distance);
                }//end if
             }//end if
          }//end for
@@ -4697,11 +4920,12 @@ void tmpl_stSlimTree::ReversedRangeQuery(
                tmpObj.Unserialize(leafNode->GetObject(idx),
                                   leafNode->GetObjectSize(idx));
                // No, it is not a representative. Evaluate distance
-               distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
+               distance = query.GetDistance(tmpObj);
                // Is this a qualified object?
                if (distance >= range){
                   // Yes! Put it in the result set.
-                  result->AddPair(tmpObj.Clone(), distance);
+                  result->AddPair(leafNode->GetObject(idx),
+                                  leafNode->GetObjectSize(idx), distance);
                }//end if
             }//end if
          }//end for
@@ -4732,6 +4956,9 @@ stResult<ObjectType> * tmpl_stSlimTree::LocalNearestQuery(
    // Set information for this query
    result->SetQueryInfo(sample->Clone(), KNEARESTQUERY, k, rangeK, tie);
 
+   // Let the evaluator prepare the sample
+   tPreparedQuery query(this->myMetricEvaluator, sample);
+
    // Let's search
    if (this->GetRoot() != 0){
       // Read node...
@@ -4752,7 +4979,7 @@ stResult<ObjectType> * tmpl_stSlimTree::LocalNearestQuery(
             tmpObj.Unserialize(indexNode->GetObject(idx),
                                indexNode->GetObjectSize(idx));
             // Evaluate distance
-            distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
+            distance = query.GetDistance(tmpObj);
             // Is this a qualified subtree?
             if (distance <= rangeK + indexNode->GetIndexEntry(idx).Radius){
                // Yes! Put it in the queue.
@@ -4771,7 +4998,7 @@ stResult<ObjectType> * tmpl_stSlimTree::LocalNearestQuery(
             if (distance <= rangeK + indexNode->GetIndexEntry(pid).Radius){
                // Yes! Analyze it recursively.
                this->LocalNearestQuery(indexNode->GetIndexEntry(pid).PageID, result,
-                                       sample, rangeK, k, distance);
+                                       query, rangeK, k, distance);
             }//end if
          }//end while
 
@@ -4789,11 +5016,12 @@ stResult<ObjectType> * tmpl_stSlimTree::LocalNearestQuery(
             tmpObj.Unserialize(leafNode->GetObject(idx),
                                leafNode->GetObjectSize(idx));
             // Evaluate the distance.
-            distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
+            distance = query.GetDistance(tmpObj);
             //test if the object qualify
             if (distance <= rangeK){
                // Add the object.
-               result->AddPair(tmpObj.Clone(), distance);
+               result->AddPair(leafNode->GetObject(idx),
+                               leafNode->GetObjectSize(idx), distance);
                // there is more than k elements?
                if (result->GetNumOfEntries() >= k){
                   //cut if there is more than k elements
@@ -4817,7 +5045,7 @@ stResult<ObjectType> * tmpl_stSlimTree::LocalNearestQuery(
 //------------------------------------------------------------------------------
 template <class ObjectType, class EvaluatorType>
 void tmpl_stSlimTree::LocalNearestQuery(
-         u_int32_t pageID, tResult * result, ObjectType * sample,
+         u_int32_t pageID, tResult * result, tPreparedQuery & query,
          double & rangeK, u_int32_t k, double distanceRepres){
    stPage * currPage;
    stSlimNode * currNode;
@@ -4849,7 +5077,7 @@ void tmpl_stSlimTree::LocalNearestQuery(
                tmpObj.Unserialize(indexNode->GetObject(idx),
                                   indexNode->GetObjectSize(idx));
                // Evaluate distance
-               distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
+               distance = query.GetDistance(tmpObj);
                // Is it a qualified subtree?
                if (distance <= rangeK + indexNode->GetIndexEntry(idx).Radius){
                   // Yes! Put it in the queue.
@@ -4868,7 +5096,7 @@ void tmpl_stSlimTree::LocalNearestQuery(
             if (distance <= rangeK + indexNode->GetIndexEntry(pid).Radius){
                // Yes! Analyze it.
                this->LocalNearestQuery(indexNode->GetIndexEntry(pid).PageID, result,
-                                  sample, rangeK, k, distance);
+                                  query, rangeK, k, distance);
             }//end if
          }//end while
 
@@ -4891,14 +5119,15 @@ void tmpl_stSlimTree::LocalNearestQuery(
                // is it a Representative?
                if (leafNode->GetLeafEntry(idx).Distance != 0) {
                   // No, it is not a representative. Evaluate distance
-                  distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
+                  distance = query.GetDistance(tmpObj);
                }else{
                   distance = distanceRepres;
                }//end if
                // is this a qualified object?
                if (distance <= rangeK){
                   // Yes, add it in the result set.
-                  result->AddPair(tmpObj.Clone(), distance);
+                  result->AddPair(leafNode->GetObject(idx),
+                                  leafNode->GetObjectSize(idx), distance);
                   // there is more than k elements?
                   if (result->GetNumOfEntries() >= k){
                      //cut if there is more than k elements
@@ -4951,6 +5180,9 @@ void stSlimTree<ObjectType, EvaluatorType>::ListNearestQuery(tResult * result,
    u_int32_t numberOfEntries;
    bool stop;
 
+   // Let the evaluator prepare the sample
+   tPreparedQuery query(this->myMetricEvaluator, sample);
+
    if (this->GetRoot() != 0){
       // allocate the priority list.
       globalQueue = new tGenericPriorityQueue();
@@ -4968,7 +5200,7 @@ void stSlimTree<ObjectType, EvaluatorType>::ListNearestQuery(tResult * result,
             tmpObj.Unserialize(indexNode->GetObject(idx),
                                indexNode->GetObjectSize(idx));
             // Evaluate distance
-            distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
+            distance = query.GetDistance(tmpObj);
             // Put the Node in the Queue.
             globalQueue->Add(tmpObj.Clone(), indexNode->GetIndexEntry(idx).PageID, distance,
                              indexNode->GetIndexEntry(idx).Radius, tGenericEntry::NODE);
@@ -4985,11 +5217,12 @@ void stSlimTree<ObjectType, EvaluatorType>::ListNearestQuery(tResult * result,
             tmpObj.Unserialize(leafNode->GetObject(idx),
                                leafNode->GetObjectSize(idx));
             // Evaluate the distance.
-            distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
+            distance = query.GetDistance(tmpObj);
             //test if the object qualify
             if (distance <= rangeK){
                // Add the object.
-               result->AddPair(tmpObj.Clone(), distance);
+               result->AddPair(leafNode->GetObject(idx),
+                               leafNode->GetObjectSize(idx), distance);
                // there is more than k elements?
                if (result->GetNumOfEntries() >= k){
                   //cut if there is more than k elements
@@ -5028,7 +5261,7 @@ void stSlimTree<ObjectType, EvaluatorType>::ListNearestQuery(tResult * result,
                   tmpObj.Unserialize(indexNode->GetObject(idx),
                                      indexNode->GetObjectSize(idx));
                   // calculate its distance.
-                  distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
+                  distance = query.GetDistance(tmpObj);
                   // add in the priority queue.
                   globalQueue->Add(tmpObj.Clone(), indexNode->GetIndexEntry(idx).PageID,
                                    distance, indexNode->GetIndexEntry(idx).Radius,
@@ -5051,11 +5284,12 @@ void stSlimTree<ObjectType, EvaluatorType>::ListNearestQuery(tResult * result,
                   // When this entry is a representative, it does not need to evaluate
                   // a distance, because distanceRepres is iqual to distance.
                   // Evaluate distance
-                  distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
+                  distance = query.GetDistance(tmpObj);
                   //test if the object qualify
                   if (distance <= rangeK){
                      // Add the object.
-                     result->AddPair(tmpObj.Clone(), distance);
+                     result->AddPair(leafNode->GetObject(idx),
+                                     leafNode->GetObjectSize(idx), distance);
                      // there is more than k elements?
                      if (result->GetNumOfEntries() >= k){
                         //cut if there is more than k elements
@@ -5131,23 +5365,55 @@ stResult<ObjectType> * stSlimTree<ObjectType, EvaluatorType>::NearestQuery(
 
 //------------------------------------------------------------------------------
 template <class ObjectType, class EvaluatorType>
-void stSlimTree<ObjectType, EvaluatorType>::NearestQuery(tResult * result,
+stIdResult * stSlimTree<ObjectType, EvaluatorType>::IdNearestQuery(
+      ObjectType * sample, u_int32_t k, bool tie){
+   if (!stViewOID<tView>::Supported){
+      throw std::logic_error("Unsupported method! The objects have no OID.");
+   }//end if
+
+   stIdResult * result = new stIdResult();
+
+   result->SetQueryInfo(KNEARESTQUERY, k, MAXDOUBLE, tie);
+   if (this->GetRoot() != 0){
+      this->NearestQuery(result, sample, MAXDOUBLE, k);
+   }//end if
+   return result;
+}//end stSlimTree<ObjectType, EvaluatorType>::IdNearestQuery
+
+//------------------------------------------------------------------------------
+template <class ObjectType, class EvaluatorType>
+template <class ResultType>
+void stSlimTree<ObjectType, EvaluatorType>::NearestQuery(ResultType * result,
          ObjectType * sample, double rangeK, u_int32_t k){
    tDynamicPriorityQueue * queue;
    u_int32_t idx;
    stPage * currPage;
    stSlimNode * currNode;
-   ObjectType tmpObj;
+   ObjectType ** objects;
+   tViewer viewer;
+   tCandidateBatch candidates;
+   #ifdef __stMAMVIEW__
+      ObjectType tmpObj;
+   #endif //__stMAMVIEW__
    double distance;
    double distanceRepres = 0;
    u_int32_t numberOfEntries;
+   u_int32_t i;
    stQueryPriorityQueueValue pqCurrValue;
    stQueryPriorityQueueValue pqTmpValue;
+   stQueryPriorityQueueValue pqNextValues[STSLIMTREE_MAXPREFETCH];
+   u_int32_t nextIDs[STSLIMTREE_MAXPREFETCH];
+   u_int32_t lastIDs[STSLIMTREE_MAXPREFETCH];
+   u_int32_t lastCount = 0;
+   int nNext;
    bool stop;
    #ifdef __stMAMVIEW__
       stMessageString comment;
    #endif //__stMAMVIEW__   
 
+   // Let the evaluator prepare the sample
+   tPreparedQuery query(this->myMetricEvaluator, sample);
+
    // Root node
    pqCurrValue.PageID = this->GetRoot();
    pqCurrValue.Radius = 0;
@@ -5162,8 +5428,7 @@ void stSlimTree<ObjectType, EvaluatorType>::NearestQuery(tResult * result,
    // Let's search
    while (pqCurrValue.PageID != 0){
       // Read node...
-      currPage = tMetricTree::myPageManager->GetPage(pqCurrValue.PageID);
-      currNode = stSlimNode::CreateNode(currPage);
+      currNode = ReadNode(pqCurrValue.PageID, currPage, objects);
       // Is it a Index node?
       if (currNode->GetNodeType() == stSlimNode::INDEX) {
          // Get Index node
@@ -5189,7 +5454,7 @@ void stSlimTree<ObjectType, EvaluatorType>::NearestQuery(tResult * result,
                                   indexNode->GetIndexEntry(idx).Radius,
                                   pqCurrValue.PageID, 0, true);
             }//end for
-            MAMViewer->SetResult(sample, result);
+            SetViewerResult(query.GetSample(), result);
             MAMViewer->EndFrame();
          #endif //__stMAMVIEW__
          
@@ -5198,11 +5463,17 @@ void stSlimTree<ObjectType, EvaluatorType>::NearestQuery(tResult * result,
             // try to cut this subtree with the triangle inequality.
             if ( fabs(distanceRepres - indexNode->GetIndexEntry(idx).Distance) <=
                       rangeK + indexNode->GetIndexEntry(idx).Radius){
-               // Rebuild the object
-               tmpObj.Unserialize(indexNode->GetObject(idx),
-                                  indexNode->GetObjectSize(idx));
                // Evaluate distance
-               distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
+               if (objects != NULL){
+                  distance = query.GetDistanceBounded(*objects[idx],
+                        rangeK + indexNode->GetIndexEntry(idx).Radius);
+               }else{
+                  // Read the object
+                  tView & view = viewer.Wrap(indexNode->GetObject(idx),
+                                             indexNode->GetObjectSize(idx));
+                  distance = query.GetDistanceBounded(view,
+                        rangeK + indexNode->GetIndexEntry(idx).Radius);
+               }//end if
 
                if (distance <= rangeK + indexNode->GetIndexEntry(idx).Radius){
                   // Yes! I'm qualified! Put it in the queue.
@@ -5241,22 +5512,21 @@ void stSlimTree<ObjectType, EvaluatorType>::NearestQuery(tResult * result,
             MAMViewer->EndFrame();
          #endif //__stMAMVIEW__
 
-         // for each entry...
-         for (idx = 0; idx < numberOfEntries; idx++) {
-            // try to cut this object with the triangle inequality.
-            if ( fabs(distanceRepres - leafNode->GetLeafEntry(idx).Distance) <=
-                      rangeK){
-               // Rebuild the object
-               tmpObj.Unserialize(leafNode->GetObject(idx),
-                                  leafNode->GetObjectSize(idx));
-               // When this entry is a representative, it does not need to evaluate
-               // a distance, because distanceRepres is iqual to distance.
+         idx = 0;
+         while ((!tCandidateBatch::Batched) && (idx < numberOfEntries)){
+            // The evaluator has no batch. Evaluate the entries one at a
+            // time, so each one is filtered with the latest rangeK.
+            if (( fabs(distanceRepres - leafNode->GetLeafEntry(idx).Distance) <=
+                      rangeK) && !IsCodeRejected(leafNode, idx, query, rangeK)){
+               // Read the object
+               tView & view = viewer.Wrap(leafNode->GetObject(idx),
+                                          leafNode->GetObjectSize(idx));
                // Evaluate distance
-               distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
+               distance = query.GetDistanceBounded(view, rangeK);
                //test if the object qualify
                if (distance <= rangeK){
                   // Add the object.
-                  result->AddPair((ObjectType*) tmpObj.Clone(), distance);
+                  AddResult(result, leafNode, idx, view, distance);
                   // there is more than k elements?
                   if (result->GetNumOfEntries() >= k){
                      //cut if there is more than k elements
@@ -5266,7 +5536,41 @@ void stSlimTree<ObjectType, EvaluatorType>::NearestQuery(tResult * result,
                   }//end if
                }//end if
             }//end if
-         }//end for
+            idx++;
+         }//end while
+         while (idx < numberOfEntries){
+            // Gather the next entries that survive the triangle inequality
+            // and their codes...
+            candidates.Clear();
+            while ((idx < numberOfEntries) &&
+                   (candidates.GetCount() < STSLIMTREE_NEARESTBATCH)){
+               if (( fabs(distanceRepres - leafNode->GetLeafEntry(idx).Distance) <=
+                         rangeK) && !IsCodeRejected(leafNode, idx, query, rangeK)){
+                  candidates.Add(leafNode->GetObject(idx),
+                                 leafNode->GetObjectSize(idx), idx);
+               }//end if
+               idx++;
+            }//end while
+            // ...and evaluate them at once. The batches are kept small, so
+            // the next one is filtered with the rangeK shrunk by this one.
+            candidates.GetDistances(query, rangeK);
+            for (i = 0; i < candidates.GetCount(); i++) {
+               distance = candidates.GetDistance(i);
+               //test if the object qualify
+               if (distance <= rangeK){
+                  // Add the object.
+                  AddResult(result, leafNode, candidates.GetIndex(i),
+                            candidates.GetEntry(i), distance);
+                  // there is more than k elements?
+                  if (result->GetNumOfEntries() >= k){
+                     //cut if there is more than k elements
+                     result->Cut(k);
+                     //may I use this for performance?
+                     rangeK = result->GetMaximumDistance();
+                  }//end if
+               }//end if
+            }//end for
+         }//end while
 
          #ifdef __stMAMVIEW__
             comment.Clear();
@@ -5279,15 +5583,14 @@ void stSlimTree<ObjectType, EvaluatorType>::NearestQuery(tResult * result,
             comment.Append(" object(s) and radius ");
             comment.Append((double)result->GetMaximumDistance());
             MAMViewer->BeginFrame(comment.GetStr());
-            MAMViewer->SetResult(sample, result);
+            SetViewerResult(query.GetSample(), result);
             MAMViewer->EndFrame();
          #endif //__stMAMVIEW__
       }//end else
 
       // Free it all
-      delete currNode;
+      ReleaseNode(currNode, currPage);
 	  currNode = 0;
-      tMetricTree::myPageManager->ReleasePage(currPage);
 
       if (queue->GetSize() > this->maxQueue)
          this->maxQueue = queue->GetSize();
@@ -5311,6 +5614,15 @@ void stSlimTree<ObjectType, EvaluatorType>::NearestQuery(tResult * result,
             stop = true;
          }//end if
       }while (!stop);
+
+      // Hint the nodes that will be visited after the next one.
+      if ((prefetchDepth > 0) && (pqCurrValue.PageID != 0)){
+         nNext = queue->GetFirst(pqNextValues, prefetchDepth);
+         for (idx = 0; idx < (u_int32_t) nNext; idx++){
+            nextIDs[idx] = pqNextValues[idx].PageID;
+         }//end for
+         PrefetchNodes(nextIDs, nNext, lastIDs, lastCount);
+      }//end if
    }// end while
 
    // Release the Global Priority Queue
@@ -5318,6 +5630,60 @@ void stSlimTree<ObjectType, EvaluatorType>::NearestQuery(tResult * result,
    queue = 0;
 }//end stSlimTree<ObjectType, EvaluatorType>::NearestQuery
 
+//------------------------------------------------------------------------------
+template <class ObjectType, class EvaluatorType>
+void stSlimTree<ObjectType, EvaluatorType>::PrefetchNodes(
+      const u_int32_t * pageIDs, u_int32_t n, u_int32_t * lastIDs,
+      u_int32_t & lastCount){
+   u_int32_t ids[STSLIMTREE_MAXPREFETCH];
+   u_int32_t count;
+   u_int32_t i;
+   u_int32_t j;
+
+   // Skip the nodes hinted by the last call.
+   count = 0;
+   for (i = 0; i < n; i++){
+      j = 0;
+      while ((j < lastCount) && (lastIDs[j] != pageIDs[i])){
+         j++;
+      }//end while
+      if (j == lastCount){
+         ids[count++] = pageIDs[i];
+      }//end if
+   }//end for
+   if (count > 0){
+      tMetricTree::myPageManager->Prefetch(ids, count);
+   }//end if
+
+   // Remember them.
+   memcpy(lastIDs, pageIDs, n * sizeof(u_int32_t));
+   lastCount = n;
+}//end stSlimTree<ObjectType, EvaluatorType>::PrefetchNodes
+
+//------------------------------------------------------------------------------
+template <class ObjectType, class EvaluatorType>
+void stSlimTree<ObjectType, EvaluatorType>::PrefetchChildren(
+      stSlimIndexNode * indexNode, double range, double distanceRepres){
+   u_int32_t ids[STSLIMTREE_MAXPREFETCH];
+   u_int32_t count;
+   u_int32_t idx;
+   u_int32_t numberOfEntries;
+
+   count = 0;
+   numberOfEntries = indexNode->GetNumberOfEntries();
+   for (idx = 0; (idx < numberOfEntries) && (count < prefetchDepth); idx++){
+      // Only the triangle inequality. Distances are not evaluated here.
+      if ((distanceRepres < 0) ||
+            (fabs(distanceRepres - indexNode->GetIndexEntry(idx).Distance) <=
+            range + indexNode->GetIndexEntry(idx).Radius)){
+         ids[count++] = indexNode->GetIndexEntry(idx).PageID;
+      }//end if
+   }//end for
+   if (count > 0){
+      tMetricTree::myPageManager->Prefetch(ids, count);
+   }//end if
+}//end stSlimTree<ObjectType, EvaluatorType>::PrefetchChildren
+
 //------------------------------------------------------------------------------
 template <class ObjectType, class EvaluatorType>
 stResult<ObjectType> * stSlimTree<ObjectType, EvaluatorType>::FarthestQuery(
@@ -5351,6 +5717,9 @@ void stSlimTree<ObjectType, EvaluatorType>::FarthestQuery(tResult * result,
    stQueryPriorityQueueValue pqTmpValue;
    bool stop;
 
+   // Let the evaluator prepare the sample
+   tPreparedQuery query(this->myMetricEvaluator, sample);
+
    // Root node
    pqCurrValue.PageID = this->GetRoot();
    pqCurrValue.Radius = 0;
@@ -5378,7 +5747,7 @@ void stSlimTree<ObjectType, EvaluatorType>::FarthestQuery(tResult * result,
                tmpObj.Unserialize(indexNode->GetObject(idx),
                                   indexNode->GetObjectSize(idx));
                // Evaluate distance
-               distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
+               distance = query.GetDistance(tmpObj);
 
                if (distance + indexNode->GetIndexEntry(idx).Radius >= rangeK){
                   // Yes! I'm qualified! Put it in the queue.
@@ -5404,11 +5773,12 @@ void stSlimTree<ObjectType, EvaluatorType>::FarthestQuery(tResult * result,
                // When this entry is a representative, it does not need to evaluate
                // a distance, because distanceRepres is iqual to distance.
                // Evaluate distance
-               distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
+               distance = query.GetDistance(tmpObj);
                //test if the object qualify
                if (distance >= rangeK){
                   // Add the object.
-                  result->AddPair(tmpObj.Clone(), distance);
+                  result->AddPair(leafNode->GetObject(idx),
+                                  leafNode->GetObjectSize(idx), distance);
                   // there is more than k elements?
                   if (result->GetNumOfEntries() >= k){
                      //cut if there is more than k elements
@@ -5542,7 +5912,8 @@ void stSlimTree<ObjectType, EvaluatorType>::PointQuery(
                //test if the object qualify
                if (distance == 0){
                   // Add the object.
-                  result->AddPair((ObjectType*) tmpObj.Clone(), distance);
+                  result->AddPair(leafNode->GetObject(idx),
+                                  leafNode->GetObjectSize(idx), distance);
                   // Stop the query because the object was found!
                   find = true;
                }//end if
@@ -5695,6 +6066,9 @@ void tmpl_stSlimTree::KAndRangeQuery(
    u_int32_t numberOfEntries;
    bool stop;
 
+   // Let the evaluator prepare the sample
+   tPreparedQuery query(this->myMetricEvaluator, sample);
+
    // Root node
    pqCurrValue.PageID = this->GetRoot();
    pqCurrValue.Radius = 0;
@@ -5721,7 +6095,7 @@ void tmpl_stSlimTree::KAndRangeQuery(
                tmpObj.Unserialize(indexNode->GetObject(idx),
                                   indexNode->GetObjectSize(idx));
                // Evaluate distance
-               distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
+               distance = query.GetDistance(tmpObj);
                // test if this subtree qualifies.
                if (distance <= range + indexNode->GetIndexEntry(idx).Radius){
                   // Yes! I'm qualified! Put it in the queue.
@@ -5748,7 +6122,7 @@ void tmpl_stSlimTree::KAndRangeQuery(
                // is it a Representative?
                if (leafNode->GetLeafEntry(idx).Distance != 0) {
                   // No, it is not a representative. Evaluate distance
-                  distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
+                  distance = query.GetDistance(tmpObj);
                }else{
                   distance = distanceRepres;
                }//end if
@@ -5756,12 +6130,14 @@ void tmpl_stSlimTree::KAndRangeQuery(
                   // Yes! I'm qualified !
                   if (result->GetNumOfEntries() < k){
                      // Has less than k.
-                     result->AddPair((ObjectType*) tmpObj.Clone(), distance);
+                     result->AddPair(leafNode->GetObject(idx),
+                                     leafNode->GetObjectSize(idx), distance);
                   }else{
                      // May I add ?
                      if (distance <= result->GetMaximumDistance()){
                         // Yes! I'll add it and cut the results if necessary
-                        result->AddPair((ObjectType*) tmpObj.Clone(), distance);
+                        result->AddPair(leafNode->GetObject(idx),
+                                        leafNode->GetObjectSize(idx), distance);
                         //cut if there is more than k elements
                         result->Cut(k);
                         //may I use this for performance?
@@ -5838,6 +6214,9 @@ void tmpl_stSlimTree::KOrRangeQuery(
    u_int32_t numberOfEntries;
    bool stop;
 
+   // Let the evaluator prepare the sample
+   tPreparedQuery query(this->myMetricEvaluator, sample);
+
    // Root node
    pqCurrValue.PageID = this->GetRoot();
    pqCurrValue.Radius = 0;
@@ -5864,7 +6243,7 @@ void tmpl_stSlimTree::KOrRangeQuery(
                tmpObj.Unserialize(indexNode->GetObject(idx),
                                   indexNode->GetObjectSize(idx));
                // Evaluate distance
-               distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
+               distance = query.GetDistance(tmpObj);
                // test if this subtree qualifies.
                if (distance <= distanceK + indexNode->GetIndexEntry(idx).Radius){
                   // Yes! I'm qualified! Put it in the queue.
@@ -5891,14 +6270,15 @@ void tmpl_stSlimTree::KOrRangeQuery(
                // is it a Representative?
                if (leafNode->GetLeafEntry(idx).Distance != 0) {
                   // No, it is not a representative. Evaluate distance
-                  distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
+                  distance = query.GetDistance(tmpObj);
                }else{
                   distance = distanceRepres;
                }//end if
                // KorRange part
                if (distance <= distanceK){
                   //Add in the result.
-                  result->AddPair((ObjectType*) tmpObj.Clone(), distance);
+                  result->AddPair(leafNode->GetObject(idx),
+                                  leafNode->GetObjectSize(idx), distance);
                   // distanceK will never be smaller than range
                   if (distanceK > range){//Nearest > Range then to cut the result is possible
 
@@ -5957,11 +6337,14 @@ stResult<ObjectType> * tmpl_stSlimTree::RingQuery(
 
    result->SetQueryInfo((ObjectType*) sample->Clone(), RINGQUERY, -1, outRange, inRange);
 
+   // Let the evaluator prepare the sample
+   tPreparedQuery query(this->myMetricEvaluator, sample);
+
    // check if inRange is smaller than outRange
    if (inRange < outRange){
       // Let's search
       if (this->GetRoot() != 0){
-         this->RingQuery(this->GetRoot(), result, sample, inRange, outRange,
+         this->RingQuery(this->GetRoot(), result, query, inRange, outRange,
                          distanceRepres);
       }//end if
    }//end if
@@ -5972,7 +6355,7 @@ stResult<ObjectType> * tmpl_stSlimTree::RingQuery(
 //------------------------------------------------------------------------------
 template <class ObjectType, class EvaluatorType>
 void tmpl_stSlimTree::RingQuery(
-         u_int32_t pageID, tResult * result, ObjectType * sample,
+         u_int32_t pageID, tResult * result, tPreparedQuery & query,
          double inRange, double outRange, double distanceRepres){
 
    stPage * currPage;
@@ -6005,7 +6388,7 @@ void tmpl_stSlimTree::RingQuery(
                tmpObj.Unserialize(indexNode->GetObject(idx),
                                   indexNode->GetObjectSize(idx));
                // Evaluate distance
-               distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
+               distance = query.GetDistance(tmpObj);
 
                if ((distance <= outRange + indexNode->GetIndexEntry(idx).Radius) &&
                    (distance + indexNode->GetIndexEntry(idx).Radius > inRange)){
@@ -6024,7 +6407,7 @@ void tmpl_stSlimTree::RingQuery(
 
                // Yes! I'm qualified !
                this->RingQuery(indexNode->GetIndexEntry(pid).PageID, result,
-                     sample, inRange, outRange, distance);
+                     query, inRange, outRange, distance);
             }//end if
          }//end while
 
@@ -6047,14 +6430,15 @@ void tmpl_stSlimTree::RingQuery(
                // is it a Representative?
                if (leafNode->GetLeafEntry(idx).Distance != 0) {
                   // No, it is not a representative. Evaluate distance
-                  distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
+                  distance = query.GetDistance(tmpObj);
                }else{
                   distance = distanceRepres;
                }//end if
                //test if the object qualify
                if ((distance <= outRange) && (distance > inRange)){
                   // Add the object.
-                  result->AddPair((ObjectType*) tmpObj.Clone(), distance);
+                  result->AddPair(leafNode->GetObject(idx),
+                                  leafNode->GetObjectSize(idx), distance);
                }//end if
             }//end if
          }//end for
@@ -6080,11 +6464,14 @@ stResult<ObjectType> * tmpl_stSlimTree::LocalKRingQuery(
    result->SetQueryInfo(sample->Clone(), KRINGQUERY, -1,
                         outRange, inRange, tie);
 
+   // Let the evaluator prepare the sample
+   tPreparedQuery query(this->myMetricEvaluator, sample);
+
    // check if inRange is smaller than outRange
    if (inRange < outRange){
       // Let's search
       if (this->GetRoot() != 0){
-         this->LocalKRingQuery(this->GetRoot(), result, sample, inRange,
+         this->LocalKRingQuery(this->GetRoot(), result, query, inRange,
                                outRange, k, distanceRepres);
       }//end if
    }//end if
@@ -6095,7 +6482,7 @@ stResult<ObjectType> * tmpl_stSlimTree::LocalKRingQuery(
 //------------------------------------------------------------------------------
 template <class ObjectType, class EvaluatorType>
 void tmpl_stSlimTree::LocalKRingQuery(
-         u_int32_t pageID, tResult * result, ObjectType * sample,
+         u_int32_t pageID, tResult * result, tPreparedQuery & query,
          double inRange, double & outRange, u_int32_t k,
          double distanceRepres){
 
@@ -6129,7 +6516,7 @@ void tmpl_stSlimTree::LocalKRingQuery(
                tmpObj.Unserialize(indexNode->GetObject(idx),
                                   indexNode->GetObjectSize(idx));
                // Evaluate distance
-               distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
+               distance = query.GetDistance(tmpObj);
 
                if ((distance <= outRange + indexNode->GetIndexEntry(idx).Radius) &&
                    (distance + indexNode->GetIndexEntry(idx).Radius > inRange)){
@@ -6148,7 +6535,7 @@ void tmpl_stSlimTree::LocalKRingQuery(
 
                // Yes! I'm qualified !
                this->LocalKRingQuery(indexNode->GetIndexEntry(pid).PageID, result,
-                                     sample, inRange, outRange, k, distance);
+                                     query, inRange, outRange, k, distance);
             }//end if
          }//end while
 
@@ -6171,14 +6558,15 @@ void tmpl_stSlimTree::LocalKRingQuery(
                // is it a Representative?
                if (leafNode->GetLeafEntry(idx).Distance != 0) {
                   // No, it is not a representative. Evaluate distance
-                  distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
+                  distance = query.GetDistance(tmpObj);
                }else{
                   distance = distanceRepres;
                }//end if
                //test if the object qualify
                if ((distance <= outRange) && (distance > inRange)){
                   // Add the object.
-                  result->AddPair(tmpObj.Clone(), distance);
+                  result->AddPair(leafNode->GetObject(idx),
+                                  leafNode->GetObjectSize(idx), distance);
                   // there is more than k elements?
                   if (result->GetNumOfEntries() >= k){
                      //cut if there is more than k elements
@@ -6224,10 +6612,13 @@ stResult<ObjectType> * stSlimTree<ObjectType, EvaluatorType>::LocalEstimateNeare
    result->SetQueryInfo(sample->Clone(), ESTIMATEKNEARESTQUERY, k,
                         MAXDOUBLE, tie);
 
+   // Let the evaluator prepare the sample
+   tPreparedQuery query(this->myMetricEvaluator, sample);
+
    // Let's search
    if (this->GetRoot() != 0){
       //do a nearest query with a estimated range
-      this->LocalNearestQuery(this->GetRoot(), result, sample, estimatedRange,
+      this->LocalNearestQuery(this->GetRoot(), result, query, estimatedRange,
                               k, distanceRepres);
 
       nroObjects = result->GetNumOfEntries();
@@ -6248,7 +6639,7 @@ stResult<ObjectType> * stSlimTree<ObjectType, EvaluatorType>::LocalEstimateNeare
             estimatedRange = 1.1 * exp(log(firstRange) + logK/fractalDimension);
          }//end if
          //do the ring query to reach k elements or range radius
-         this->LocalKRingQuery(this->GetRoot(), result, sample, firstRange,
+         this->LocalKRingQuery(this->GetRoot(), result, query, firstRange,
                                estimatedRange, k, distanceRepres);
          nroObjects = result->GetNumOfEntries();
 
@@ -6304,6 +6695,9 @@ void stSlimTree<ObjectType, EvaluatorType>::KRingQuery(
    u_int32_t numberOfEntries;
    bool stop;
 
+   // Let the evaluator prepare the sample
+   tPreparedQuery query(this->myMetricEvaluator, sample);
+
    // Root node.
    pqCurrValue.PageID = this->GetRoot();
    pqCurrValue.Radius = 0;
@@ -6330,7 +6724,7 @@ void stSlimTree<ObjectType, EvaluatorType>::KRingQuery(
                tmpObj.Unserialize(indexNode->GetObject(idx),
                                   indexNode->GetObjectSize(idx));
                // Evaluate distance
-               distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
+               distance = query.GetDistance(tmpObj);
 
                if ((distance <= outRange + indexNode->GetIndexEntry(idx).Radius) &&
                    (distance + indexNode->GetIndexEntry(idx).Radius > inRange)){
@@ -6358,14 +6752,15 @@ void stSlimTree<ObjectType, EvaluatorType>::KRingQuery(
                // is it a Representative?
                if (leafNode->GetLeafEntry(idx).Distance != 0) {
                   // No, it is not a representative. Evaluate distance
-                  distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
+                  distance = query.GetDistance(tmpObj);
                }else{
                   distance = distanceRepres;
                }//end if
                //test if the object qualify
                if ((distance <= outRange) && (distance > inRange)){
                   // Add the object.
-                  result->AddPair((ObjectType*) tmpObj.Clone(), distance);
+                  result->AddPair(leafNode->GetObject(idx),
+                                  leafNode->GetObjectSize(idx), distance);
                   // there is more than k elements?
                   if (result->GetNumOfEntries() >= k){
                      //cut if there is more than k elements
@@ -6863,7 +7258,8 @@ void stSlimTree<ObjectType, EvaluatorType>::LazyRangeQuery(
 
                if (distance <= range){
                   // Yes! I'm qualified !
-                  result->AddPair(tmpObj.Clone(), distance);
+                  result->AddPair(leafNode->GetObject(idx),
+                                  leafNode->GetObjectSize(idx), distance);
                   // if has k elements, stop!
                   if (result->GetNumOfEntries() == k)
                      // cut the rest!
@@ -6975,7 +7371,8 @@ void tmpl_stSlimTree::AproximateNearestQuery(
                //test if the object qualify
                if (distance <= rangeK){
                   // Add the object.
-                  result->AddPair(tmpObj.Clone(), distance);
+                  result->AddPair(leafNode->GetObject(i),
+                                  leafNode->GetObjectSize(i), distance);
                   // there is more than k elements?
                   if (result->GetNumOfEntries() >= k){
                      //cut if there is more than k elements
@@ -8003,6 +8400,8 @@ void tmpl_stSlimTree::Optimize(){
       SlimDownRecursive(this->GetRoot(), 0);
       // Notify modifications.
       HeaderUpdate = true;
+      // Load the pinned nodes that were modified.
+      RepinNodes();
       // Don't worry. This is a debug block!!!
    #ifdef __stPRINTMSG__
    }else{
@@ -8072,7 +8471,7 @@ double tmpl_stSlimTree::SlimDownRecursive(u_int32_t pageID, int level){
       // Write me and get the garbage.
       delete currNode;
 	  currNode = 0;
-      tMetricTree::myPageManager->WritePage(currPage);
+      WritePage(currPage);
       tMetricTree::myPageManager->ReleasePage(currPage);
       return radius;
    }else{
@@ -8168,7 +8567,7 @@ double tmpl_stSlimTree::SlimDown(u_int32_t pageID){
             tmpPage = leafNode->GetPage();
             delete leafNode;
 			leafNode = 0;
-            tMetricTree::myPageManager->WritePage(tmpPage);
+            WritePage(tmpPage);
             tMetricTree::myPageManager->ReleasePage(tmpPage);
          }else{
             // Empty node
@@ -8198,7 +8597,7 @@ double tmpl_stSlimTree::SlimDown(u_int32_t pageID){
       // Write me and get the garbage.
       delete currNode;
 	  currNode = 0;
-      tMetricTree::myPageManager->WritePage(currPage);
+      WritePage(currPage);
       tMetricTree::myPageManager->ReleasePage(currPage);
       return radius;
    }else{
@@ -8314,7 +8713,7 @@ template <class ObjectType, class EvaluatorType>
 int tmpl_stSlimTree::BulkLoadSimple(ObjectType **objects, u_int32_t numObj, double leafNodeOccupancy, stPage *& auxPage, int currObj) {
 
    auxPage  = this->NewPage();
-   stSlimLeafNode * leafNode = new stSlimLeafNode(auxPage, true);
+   stSlimLeafNode * leafNode = new stSlimLeafNode(auxPage, true, leafCodeSize);
 
    ObjectType *newObj; // Object
    u_int32_t insertIdx; // Insertion index
@@ -8647,10 +9046,10 @@ bool tmpl_stSlimTree::BulkLoadOrdered(ObjectType **objects, u_int32_t numObj, do
       sub1.NObjects = 0;
 
       // Write the node.
-      tMetricTree::myPageManager->WritePage(auxPage);
+      WritePage(auxPage);
       delete leafNode;
 	  leafNode = 0;
-      delete auxPage;
+      tMetricTree::myPageManager->ReleasePage(auxPage);
 	  auxPage = 0;
 
       BulkInsert(sub1, sub, indexNodeOccupancy, method);
@@ -8700,7 +9099,7 @@ bool tmpl_stSlimTree::BulkLoadOrdered(ObjectType **objects, u_int32_t numObj, do
       fatherNode->GetIndexEntry(repIdx).NEntries = currNode->GetTotalObjectCount(); // Update the number of objects
 
       // Write the current page (node).
-      tMetricTree::myPageManager->WritePage(stackPage);
+      WritePage(stackPage);
       // Write the current page (node). // @TODO: Optimize this... disk access
       //tMetricTree::myPageManager->WritePage(fatherPage);
 
@@ -8708,7 +9107,7 @@ bool tmpl_stSlimTree::BulkLoadOrdered(ObjectType **objects, u_int32_t numObj, do
 	  currNode = 0;
       delete fatherNode;
 	  fatherNode = 0;
-      delete stackPage;
+      tMetricTree::myPageManager->ReleasePage(stackPage);
 	  stackPage = 0;
 
 
@@ -8718,13 +9117,15 @@ bool tmpl_stSlimTree::BulkLoadOrdered(ObjectType **objects, u_int32_t numObj, do
    if(!this->rightPathEntries.empty()) {
         stPage * stackPage = this->rightPathEntries.top();
          // Write the current page (node).
-        tMetricTree::myPageManager->WritePage(stackPage);
+        WritePage(stackPage);
         //cout << "\nNode " << stackPage->GetPageID() << endl;
-        delete stackPage;
+        tMetricTree::myPageManager->ReleasePage(stackPage);
 		stackPage = 0;
         this->rightPathEntries.pop();
    } // end if
 
+   // Load the pinned nodes that were modified.
+   RepinNodes();
 
    // Ok. Objects inserted. Return success!
    return true;
@@ -8929,7 +9330,7 @@ bool tmpl_stSlimTree::BulkInsert(stSubtreeInfo & sub1, stSubtreeInfo & sub, doub
 
 
        // Write the current page (node).
-      tMetricTree::myPageManager->WritePage(currPage);
+      WritePage(currPage);
 
 
 
@@ -8939,7 +9340,7 @@ bool tmpl_stSlimTree::BulkInsert(stSubtreeInfo & sub1, stSubtreeInfo & sub, doub
 
 
       // Clean the mess.
-      delete currPage;
+      tMetricTree::myPageManager->ReleasePage(currPage);
 	  currPage = 0;
 
       // New node
@@ -9150,6 +9551,8 @@ bool tmpl_stSlimTree::BulkLoadMemory(vector< SampleSon<ObjectType> > objects, do
 
    // Report the modification.
    HeaderUpdate = true;
+   // Load the pinned nodes that were modified.
+   RepinNodes();
 
    return ret;
 } //end stSlimTree<ObjectType, EvaluatorType>::BulkLoadMemory
@@ -9230,7 +9633,7 @@ bool tmpl_stSlimTree::BulkLoadMemory(vector< SampleSon<ObjectType> > objects, in
 
       // new leaf node
       stPage * newPage  = this->NewPage();
-      stSlimLeafNode * leafNode = new stSlimLeafNode(newPage, true);
+      stSlimLeafNode * leafNode = new stSlimLeafNode(newPage, true, leafCodeSize);
 
       u_int32_t repIdx = father;
 
@@ -9257,8 +9660,8 @@ bool tmpl_stSlimTree::BulkLoadMemory(vector< SampleSon<ObjectType> > objects, in
 	  leafNode = 0;
 
       // write to disk
-      tMetricTree::myPageManager->WritePage(newPage);
-      delete newPage;
+      WritePage(newPage);
+      tMetricTree::myPageManager->ReleasePage(newPage);
 	  newPage = 0;
 
 
@@ -9578,8 +9981,8 @@ bool tmpl_stSlimTree::BulkLoadMemory(vector< SampleSon<ObjectType> > objects, in
       delete indexNode;
 	  indexNode = 0;
 
-      tMetricTree::myPageManager->WritePage(newIndexPage);
-      delete newIndexPage;
+      WritePage(newIndexPage);
+      tMetricTree::myPageManager->ReleasePage(newIndexPage);
 	  newIndexPage = 0;
 
       delete[] sample;
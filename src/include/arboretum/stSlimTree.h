@@ -31,6 +31,8 @@
 #include <arboretum/stSlimNode.h>
 #include <arboretum/stPageManager.h>
 #include <arboretum/stGenericPriorityQueue.h>
+#include <arboretum/stObjectView.h>
+#include <arboretum/stIdResult.h>
 
 // this is used to set the initial size of the dynamic queue
 #ifndef STARTVALUEQUEUE
@@ -49,6 +51,15 @@
    #define SECUREVALUE 1.2
 #endif //SECUREVALUE
 
+// this is the maximum number of nodes hinted at once to the page manager
+#define STSLIMTREE_MAXPREFETCH 31
+
+// this is the maximum number of leaf entries a k-NN query evaluates in a
+// single call to the evaluator before it shrinks its range again
+#ifndef STSLIMTREE_NEARESTBATCH
+   #define STSLIMTREE_NEARESTBATCH 8
+#endif //STSLIMTREE_NEARESTBATCH
+
 #include <string.h>
 #include <math.h>
 //#include <values.h>
@@ -57,6 +68,7 @@
 
 #include <stack>
 #include <vector>
+#include <unordered_map>
 
 // Include disk access statistics classes
 #ifdef __stDISKACCESSSTATS__
@@ -926,6 +938,29 @@ class stSlimTree: public stMetricTree <ObjectType, EvaluatorType> {
       */
       typedef stSlimMemLeafNode < ObjectType > tMemLeafNode;
 
+      /**
+      * Reader of the objects stored in the nodes. It avoids the
+      * unserialization of each entry when ObjectType has a view type.
+      */
+      typedef stObjectViewer < ObjectType, EvaluatorType > tViewer;
+
+      /**
+      * Type of the objects returned by tViewer.
+      */
+      typedef typename tViewer::ViewType tView;
+
+      /**
+      * The sample of a query, prepared once by the evaluator and passed down
+      * to every node visited by the query.
+      */
+      typedef stPreparedQuery < EvaluatorType, ObjectType > tPreparedQuery;
+
+      /**
+      * Gathers the leaf entries that survive the pruning of a query. Each
+      * query owns its batch, so concurrent queries never share one.
+      */
+      typedef stCandidateBatch < ObjectType, EvaluatorType > tCandidateBatch;
+
       #ifdef __stDISKACCESSSTATS__
          typedef stHistogram < ObjectType, EvaluatorType > tHistogram;
       #endif //__stDISKACCESSSTATS__
@@ -944,6 +979,11 @@ class stSlimTree: public stMetricTree <ObjectType, EvaluatorType> {
       * not claim the ownership of the given page manager. It means that the
       * application must dispose the page manager when it is no loger necessary.
       *
+      * <P>If the evaluator keeps quantized copies of the objects (see
+      * stLeafCodes), the leaf entries hold them and the queries reject the
+      * entries whose copy is already too far from the sample without reading
+      * their objects. The evaluator must be set as when the tree was built.
+      *
       * @param pageman The bage manager to be used by this metric tree.
       * @param metricEval The shared metric evaluator be used by this metric tree.
       * @warning metricEval will not be delete by this class.
@@ -1089,6 +1129,17 @@ class stSlimTree: public stMetricTree <ObjectType, EvaluatorType> {
       */
       long GetLeafNodeCount();
 
+      /**
+      * Collects the page IDs of the nodes in the upper levels of this tree,
+      * level by level from the root. These nodes are read by almost every
+      * query, so they are good candidates for the hot set of a page manager
+      * (see stMMapPageManager::LockPages()).
+      *
+      * @param levels The number of levels. 1 means only the root.
+      * @param pageIDs The vector that will receive the page IDs.
+      */
+      void GetUpperLevelPages(u_int32_t levels, std::vector<u_int32_t> & pageIDs);
+
       /**
       * Returns the average radius in leaf nodes of this tree.
       */
@@ -1227,6 +1278,81 @@ class stSlimTree: public stMetricTree <ObjectType, EvaluatorType> {
          return Header->ChooseMethod;
       }//end GetChooseMethod
 
+      /**
+      * Sets the number of nodes hinted to the page manager before they are
+      * read by RangeQuery() and NearestQuery(). The range query hints the
+      * children of each index node that survive the triangle inequality and
+      * the k-NN query hints the next nodes of its priority queue. It only
+      * helps page managers that implement stPageManager::Prefetch().
+      *
+      * <P>The default value is 0 (disabled). Values above
+      * STSLIMTREE_MAXPREFETCH are reduced to it.
+      *
+      * @param depth The number of nodes.
+      */
+      void SetPrefetchDepth(u_int32_t depth){
+         if (depth > STSLIMTREE_MAXPREFETCH){
+            depth = STSLIMTREE_MAXPREFETCH;
+         }//end if
+         prefetchDepth = depth;
+      }//end SetPrefetchDepth
+
+      /**
+      * Returns the number of nodes hinted to the page manager.
+      *
+      * @see SetPrefetchDepth()
+      */
+      u_int32_t GetPrefetchDepth(){
+         return prefetchDepth;
+      }//end GetPrefetchDepth
+
+      /**
+      * Keeps the index nodes of the upper levels of this tree decoded in
+      * memory. RangeQuery() and NearestQuery() use them without reading
+      * their pages or unserializing their objects. The nodes are loaded by
+      * this method and loaded again at the end of each modification of the
+      * tree (Add(), Optimize() and the bulk loads) that changed one of them
+      * or the root. Queries never load them, so concurrent queries only
+      * read the pinned nodes.
+      *
+      * <P>The default value is 0 (disabled).
+      *
+      * @param levels The number of levels. 1 means only the root.
+      */
+      void SetPinnedLevels(u_int32_t levels){
+         UnpinNodes();
+         pinnedLevels = levels;
+         RepinNodes();
+      }//end SetPinnedLevels
+
+      /**
+      * Returns the number of levels kept in memory.
+      *
+      * @see SetPinnedLevels()
+      */
+      u_int32_t GetPinnedLevels(){
+         return pinnedLevels;
+      }//end GetPinnedLevels
+
+      /**
+      * Returns the number of index nodes kept in memory now.
+      *
+      * @see SetPinnedLevels()
+      */
+      u_int32_t GetPinnedNodeCount(){
+         return pinnedNodes.size();
+      }//end GetPinnedNodeCount
+
+      /**
+      * Writes the header of this tree if it was modified and flushes the
+      * page manager. After this call, the tree stored by the page manager
+      * is complete. With stLogPageManager, each call ends a transaction.
+      */
+      void Flush(){
+         WriteHeader();
+         tMetricTree::myPageManager->Flush();
+      }//end Flush
+
       #ifdef __stDEBUG__
          /**
          * Get root page id.
@@ -1431,6 +1557,35 @@ class stSlimTree: public stMetricTree <ObjectType, EvaluatorType> {
       */
       tResult * NearestQuery(ObjectType * sample, u_int32_t k, bool tie = false);
 
+      /**
+      * This method performs the same search of RangeQuery() but returns
+      * only the OIDs and distances of the objects. The objects are never
+      * rebuilt.
+      *
+      * @param sample The sample object.
+      * @param range The range of the results.
+      * @return The result.
+      * @warning The instance of stIdResult returned must be destroied by user.
+      * @exception std::logic_error If the objects have no OID.
+      * @see tResult * RangeQuery()
+      */
+      stIdResult * IdRangeQuery(ObjectType * sample, double range);
+
+      /**
+      * This method performs the same search of NearestQuery() but returns
+      * only the OIDs and distances of the objects. The objects are never
+      * rebuilt.
+      *
+      * @param sample The sample object.
+      * @param k The number of neighbors.
+      * @param tie The tie list. Default false.
+      * @return The result.
+      * @warning The instance of stIdResult returned must be destroied by user.
+      * @exception std::logic_error If the objects have no OID.
+      * @see tResult * NearestQuery()
+      */
+      stIdResult * IdNearestQuery(ObjectType * sample, u_int32_t k, bool tie = false);
+
       /**
       * This method will perform a K-Farthest Neighbor query using a global priority
       * queue based on chained list to "enhance" its performance. We believe that the
@@ -2182,6 +2337,52 @@ class stSlimTree: public stMetricTree <ObjectType, EvaluatorType> {
       */
       bool HeaderUpdate;
 
+      /**
+      * Number of nodes hinted to the page manager.
+      */
+      u_int32_t prefetchDepth;
+
+      /**
+      * Size of the codes of each leaf entry, or 0 if the leaves have no
+      * codes (see stLeafCodes).
+      */
+      u_int32_t leafCodeSize;
+
+      /**
+      * An index node kept in memory.
+      */
+      struct tPinnedNode{
+         /**
+         * Private copy of the page.
+         */
+         stPage * Page;
+
+         /**
+         * The node.
+         */
+         stSlimIndexNode * Node;
+
+         /**
+         * The unserialized objects of the entries.
+         */
+         ObjectType ** Objects;
+      };//end tPinnedNode
+
+      /**
+      * Number of levels kept in memory.
+      */
+      u_int32_t pinnedLevels;
+
+      /**
+      * If true, pinnedNodes is up to date.
+      */
+      bool pinnedValid;
+
+      /**
+      * The index nodes kept in memory by page ID.
+      */
+      std::unordered_map<u_int32_t, tPinnedNode> pinnedNodes;
+
       /**
       * The SlimTree header. This variable points to data in the HeaderPage.
       */
@@ -2239,9 +2440,96 @@ class stSlimTree: public stMetricTree <ObjectType, EvaluatorType> {
       */
       void DisposePage(stPage * page){
          Header->NodeCount--;
+         if (pinnedNodes.count(page->GetPageID()) > 0){
+            UnpinNodes();
+         }//end if
          tMetricTree::myPageManager->DisposePage(page);
       }//end DisposePage
 
+      /**
+      * Writes a node. The nodes kept in memory are discarded if it is one of
+      * them.
+      */
+      void WritePage(stPage * page){
+         if (pinnedNodes.count(page->GetPageID()) > 0){
+            UnpinNodes();
+         }//end if
+         if (leafCodeSize > 0){
+            EncodeLeafCodes(page);
+         }//end if
+         tMetricTree::myPageManager->WritePage(page);
+      }//end WritePage
+
+      /**
+      * Builds the codes of the entries of a leaf node. Other pages are not
+      * changed.
+      *
+      * @param page The page of the node.
+      */
+      void EncodeLeafCodes(stPage * page);
+
+      /**
+      * Returns true if the codes of a leaf entry prove that its object is
+      * farther than range from the query sample, so the object does not
+      * need to be read.
+      *
+      * @param leafNode The leaf node.
+      * @param idx The idx of the entry.
+      * @param query The query sample.
+      * @param range The greatest distance of interest.
+      */
+      bool IsCodeRejected(stSlimLeafNode * leafNode, u_int32_t idx,
+            tPreparedQuery & query, double range){
+         return (leafCodeSize > 0) && (leafNode->GetCodeSize() == leafCodeSize) &&
+               (query.GetLeafBound(leafNode->GetLeafCode(idx), range) > range);
+      }//end IsCodeRejected
+
+      /**
+      * Returns a node for reading. Pinned nodes are returned without reading
+      * their pages. Use ReleaseNode() to release it.
+      *
+      * @param pageID The page ID of the node.
+      * @param page Receives the page of the node or NULL if it is pinned.
+      * @param objects Receives the unserialized objects of a pinned node or
+      * NULL.
+      * @return The node.
+      */
+      stSlimNode * ReadNode(u_int32_t pageID, stPage * & page,
+            ObjectType ** & objects);
+
+      /**
+      * Releases a node returned by ReadNode().
+      *
+      * @param node The node.
+      * @param page The page of the node or NULL if it is pinned.
+      */
+      void ReleaseNode(stSlimNode * node, stPage * page){
+         if (page != NULL){
+            delete node;
+            tMetricTree::myPageManager->ReleasePage(page);
+         }//end if
+      }//end ReleaseNode
+
+      /**
+      * Loads the index nodes of the upper pinnedLevels levels.
+      */
+      void PinNodes();
+
+      /**
+      * Loads the pinned nodes again if a modification discarded them. It is
+      * called at the end of each modification of the tree.
+      */
+      void RepinNodes(){
+         if ((pinnedLevels > 0) && (!pinnedValid)){
+            PinNodes();
+         }//end if
+      }//end RepinNodes
+
+      /**
+      * Discards all nodes kept in memory.
+      */
+      void UnpinNodes();
+
       /**
       * Recursevely calculates the total number of index nodes of this tree.
       */
@@ -2323,6 +2611,7 @@ class stSlimTree: public stMetricTree <ObjectType, EvaluatorType> {
       void SetRoot(u_int32_t root){
          Header->Root = root;
          HeaderUpdate = true;
+         UnpinNodes();
       }//end SetRoot
 
       /**
@@ -2531,14 +2820,28 @@ class stSlimTree: public stMetricTree <ObjectType, EvaluatorType> {
       *
       * @param pageID the page to be analyzed.
       * @param result the result set.
-      * @param sample The sample object.
+      * @param query The query.
+      * @param candidates The candidate batch of the query.
       * @param range The range of the result.
       * @param distanceRepres The distance of the representative.
       * @see tResult * RangeQuery()
       */
-      void RangeQuery(u_int32_t pageID, tResult * result,
-                      ObjectType * sample, double range,
-                      double distanceRepres);
+      template <class ResultType>
+      void RangeQuery(u_int32_t pageID, ResultType * result,
+                      tPreparedQuery & query, tCandidateBatch & candidates,
+                      double range, double distanceRepres);
+
+      /**
+      * This method performs a range query starting at the root. It is
+      * shared by RangeQuery() and IdRangeQuery().
+      *
+      * @param result the result set (tResult or stIdResult).
+      * @param sample The sample object.
+      * @param range The range of the result.
+      * @see tResult * RangeQuery()
+      */
+      template <class ResultType>
+      void RangeQuery(ResultType * result, ObjectType * sample, double range);
 
       /**
       * This method will perform a reverse range query.
@@ -2546,14 +2849,14 @@ class stSlimTree: public stMetricTree <ObjectType, EvaluatorType> {
       *
       * @param pageID the page to be analyzed.
       * @param result the result set.
-      * @param sample The sample object.
+      * @param query The query.
       * @param range The range of the result. All object that are
       * greater than the range distance will be included in the result set.
       * @param distanceRepres The distance of the representative.
       * @see tResult * RangeQuery()
       */
       void ReversedRangeQuery(u_int32_t pageID, tResult * result,
-                              ObjectType * sample, double range,
+                              tPreparedQuery & query, double range,
                               double distanceRepres);
 
       /**
@@ -2562,14 +2865,14 @@ class stSlimTree: public stMetricTree <ObjectType, EvaluatorType> {
       *
       * @param pageID the page to be analyzed.
       * @param result the result set.
-      * @param sample The sample object.
+      * @param query The query.
       * @param range The range of the results.
       * @param k The number of neighbours.
       * @param globalQueue The global priority queue.
       * @see tResult * NearestQuery
       */
       void LocalNearestQuery(u_int32_t pageID, tResult * result,
-                             ObjectType * sample, double & rangeK,
+                             tPreparedQuery & query, double & rangeK,
                              u_int32_t k, double distanceRepres);
 
       /**
@@ -2597,9 +2900,80 @@ class stSlimTree: public stMetricTree <ObjectType, EvaluatorType> {
       * @param k The number of neighbours.
       * @see tResult * NearestQuery
       */
-      void NearestQuery(tResult * result, ObjectType * sample,
+      template <class ResultType>
+      void NearestQuery(ResultType * result, ObjectType * sample,
                         double rangeK, u_int32_t k);
 
+      /**
+      * Adds a qualified leaf entry to a result. The object is only copied
+      * in its serialized form.
+      *
+      * @param result The result.
+      * @param leafNode The leaf node.
+      * @param idx The index of the entry.
+      * @param view The view of the entry.
+      * @param distance The distance from the sample.
+      */
+      void AddResult(tResult * result, stSlimLeafNode * leafNode,
+                     u_int32_t idx, tView & view, double distance){
+         result->AddPair(leafNode->GetObject(idx),
+                         leafNode->GetObjectSize(idx), distance);
+      }//end AddResult
+
+      /**
+      * Adds a qualified leaf entry to an OID result.
+      *
+      * @param result The result.
+      * @param leafNode The leaf node.
+      * @param idx The index of the entry.
+      * @param view The view of the entry.
+      * @param distance The distance from the sample.
+      */
+      void AddResult(stIdResult * result, stSlimLeafNode * leafNode,
+                     u_int32_t idx, tView & view, double distance){
+         result->AddPair(stViewOID<tView>::Get(view), distance);
+      }//end AddResult
+
+      #ifdef __stMAMVIEW__
+         /**
+         * Shows the partial result of a query.
+         */
+         void SetViewerResult(ObjectType * sample, tResult * result){
+            MAMViewer->SetResult(sample, result);
+         }//end SetViewerResult
+
+         /**
+         * OID results can not be shown.
+         */
+         void SetViewerResult(ObjectType * sample, stIdResult * result){
+         }//end SetViewerResult
+      #endif //__stMAMVIEW__
+
+      /**
+      * Hints the given nodes to the page manager. Nodes hinted by the previous
+      * call of the same query are skipped.
+      *
+      * @param pageIDs The ids of the nodes.
+      * @param n The number of ids.
+      * @param lastIDs The nodes hinted by the previous call of the query. They
+      * are replaced by pageIDs.
+      * @param lastCount The number of entries in lastIDs. It is replaced by n.
+      */
+      void PrefetchNodes(const u_int32_t * pageIDs, u_int32_t n,
+            u_int32_t * lastIDs, u_int32_t & lastCount);
+
+      /**
+      * Hints the children of an index node that may be visited by a range
+      * query. At most prefetchDepth children are hinted.
+      *
+      * @param indexNode The index node.
+      * @param range The range of the query.
+      * @param distanceRepres The distance between the query and the
+      * representative of the node or a negative value if it is unknown.
+      */
+      void PrefetchChildren(stSlimIndexNode * indexNode, double range,
+                            double distanceRepres);
+
       /**
       * This method will perform a K-Farthest Neighbor query using a priority
       * queue.
@@ -2676,7 +3050,7 @@ class stSlimTree: public stMetricTree <ObjectType, EvaluatorType> {
       *
       * @param pageID the page to be analyzed.
       * @param result the result set.
-      * @param sample The sample object.
+      * @param query The query.
       * @param inRange The outter range of the results.
       * @param outRange The inner range of the results.
       * @return The result or NULL if this method is not implemented.
@@ -2685,7 +3059,7 @@ class stSlimTree: public stMetricTree <ObjectType, EvaluatorType> {
       * @see tResult * RingQuery()
       */
       void RingQuery(u_int32_t pageID, tResult * result,
-                     ObjectType * sample, double inRange,
+                     tPreparedQuery & query, double inRange,
                      double outRange, double distanceRepres);
 
       /**
@@ -2711,7 +3085,7 @@ class stSlimTree: public stMetricTree <ObjectType, EvaluatorType> {
       *
       * @param pageID the page to be analyzed.
       * @param result the result set.
-      * @param sample The sample object.
+      * @param query The query.
       * @param inRange The outter range of the results.
       * @param outRange The inner range of the results.
       * @param k The number of nearest neighbor.
@@ -2721,7 +3095,7 @@ class stSlimTree: public stMetricTree <ObjectType, EvaluatorType> {
       * @warning The value of outRange must be higher than inRange.
       * @see tResult * RingKQuery()
       */
-      void LocalKRingQuery(u_int32_t pageID, tResult * result, ObjectType * sample,
+      void LocalKRingQuery(u_int32_t pageID, tResult * result, tPreparedQuery & query,
                            double inRange, double & outRange, u_int32_t k,
                            double distanceRepres);
 
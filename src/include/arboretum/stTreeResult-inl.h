@@ -27,33 +27,21 @@
 template < class ObjectType >
 stResult<ObjectType>::~stResult(){
    while(Pairs.size() > 0){
-      tItePairs ite = Pairs.end();
-      ite--; //last element
-      delete *ite;
-      Pairs.erase(ite);
+      delete Pairs.back();
+      Pairs.pop_back();
    }//end while
    // Dispose sample object.
    if (Sample != NULL){
       delete Sample;
    }//end if
-   // Dispose vector of pairs.
-   if (allpairs != NULL)
-       delete[] allpairs;
-   allpairs = NULL;
 }//end stResult<ObjectType>::~stResult
 
 //----------------------------------------------------------------------------
 #ifdef _DEPRECATED_ARBORETUM
 template < class ObjectType >
 stResult<ObjectType>::tPair & stResult<ObjectType>::operator [] (unsigned int idx){
-   if (idx < Pairs.size()){
-      tItePairs ite = Pairs.begin();
-      int i;
-      for(i=0; i < idx; i++){
-         ite++;
-      }//endfor
-      return *(*ite);
-   }//end if
+   Sort();
+   return *Pairs[idx];
 }//end stResult<ObjectType>::operator []
 #endif //_DEPRECATED_ARBORETUM
 
@@ -61,10 +49,10 @@ stResult<ObjectType>::tPair & stResult<ObjectType>::operator [] (unsigned int id
 template < class ObjectType >
 void stResult<ObjectType>::RemoveLast(){
    if (Pairs.size() > 0){
-      tItePairs ite = Pairs.end();
-      ite--; //last element
-      delete *ite;
-      Pairs.erase(ite);
+      Sort();
+      delete Pairs.back();
+      Pairs.pop_back();
+      SortedCount--;
    }//end if
 }//end RemoveLast
 
@@ -72,10 +60,10 @@ void stResult<ObjectType>::RemoveLast(){
 template < class ObjectType >
 void stResult<ObjectType>::RemoveFirst(){
    if (Pairs.size() > 0){
-      tItePairs ite = Pairs.begin();
-      delete *ite;
-      
-      Pairs.erase(ite);
+      Sort();
+      delete Pairs.front();
+      Pairs.erase(Pairs.begin());
+      SortedCount--;
    }//end if
 }//end RemoveFirst
 
@@ -83,8 +71,8 @@ void stResult<ObjectType>::RemoveFirst(){
 template < class ObjectType >
 double stResult<ObjectType>::GetMinimumDistance(){
    if (Pairs.size() > 0){
-      tItePairs ite = Pairs.begin();
-      return (*ite)->GetDistance();
+      Sort();
+      return Pairs.front()->GetDistance();
    }else{
       return -1;
    }//end if
@@ -94,9 +82,8 @@ double stResult<ObjectType>::GetMinimumDistance(){
 template < class ObjectType >
 double stResult<ObjectType>::GetMaximumDistance(){
    if (Pairs.size() > 0){
-      tItePairs ite = Pairs.end();
-      ite--;
-      return (*ite)->GetDistance();
+      Sort();
+      return Pairs.back()->GetDistance();
    }else{
       return -1;
    }//end if
@@ -105,35 +92,67 @@ double stResult<ObjectType>::GetMaximumDistance(){
 //----------------------------------------------------------------------------
 template < class ObjectType >
 void stResult<ObjectType>::Cut(unsigned int limit){
-   
+   unsigned int last;
    double max;
 
-   if(this->Tie){
-      tItePairs ite = Pairs.begin();
-      for (int i = 0; i < (limit-1) && ite!= Pairs.end(); i++, ite++);
-      max = (*ite)->GetDistance();
-      //ite++; 
-      for(; ite!= Pairs.end(); ite++){
-         if ((*ite)->GetDistance() > max)            
-            RemoveLast();
-      }//end for
-   }else{
-      while(Pairs.size() > limit){
-        RemoveLast();
-      }
-   }
+   if (Pairs.size() > limit){
+      Sort();
+      last = limit;
+      if ((this->Tie) && (limit > 0)){
+         // Keep the draw list of the last pair.
+         max = Pairs[limit - 1]->GetDistance();
+         while ((last < Pairs.size()) && (Pairs[last]->GetDistance() <= max)){
+            last++;
+         }//end while
+      }//end if
+      // Remove the others.
+      while (Pairs.size() > last){
+         delete Pairs.back();
+         Pairs.pop_back();
+      }//end while
+      SortedCount = last;
+   }//end if
 }//end stResult<ObjectType>::Cut
 
 //----------------------------------------------------------------------------
 template < class ObjectType >
 void stResult<ObjectType>::CutFirst(unsigned int limit){
-   while(Pairs.size() > limit){
-      tItePairs ite = Pairs.begin();
-      delete *ite;
-      Pairs.erase(ite);
-   }//end while
+   unsigned int count;
+   unsigned int i;
+
+   if (Pairs.size() > limit){
+      Sort();
+      count = Pairs.size() - limit;
+      for (i = 0; i < count; i++){
+         delete Pairs[i];
+      }//end for
+      Pairs.erase(Pairs.begin(), Pairs.begin() + count);
+      SortedCount = limit;
+   }//end if
 }//end stResult<ObjectType>::CutFirst
 
+//----------------------------------------------------------------------------
+template < class ObjectType >
+void stResult<ObjectType>::Sort(){
+   tItePairs ite;
+   unsigned int idx;
+
+   if (SortedCount < Pairs.size()){
+      if (Pairs.size() - SortedCount <= STRESULT_INSERTIONSORT){
+         // A few new pairs. Move each one to its place.
+         for (idx = SortedCount; idx < Pairs.size(); idx++){
+            ite = std::upper_bound(Pairs.begin(), Pairs.begin() + idx,
+                  Pairs[idx], stLessResultPair< ObjectType >());
+            std::rotate(ite, Pairs.begin() + idx, Pairs.begin() + idx + 1);
+         }//end for
+      }else{
+         std::stable_sort(Pairs.begin(), Pairs.end(),
+               stLessResultPair< ObjectType >());
+      }//end if
+      SortedCount = Pairs.size();
+   }//end if
+}//end stResult<ObjectType>::Sort
+
 /*
 //----------------------------------------------------------------------------
 template < class ObjectType >
@@ -26,7 +26,13 @@
 
 #include <set>
 #include <vector>
+#include <algorithm>
 
+/**
+* Maximum number of unsorted pairs that stResult moves one by one to their
+* places. Larger unsorted tails are sorted at once.
+*/
+#define STRESULT_INSERTIONSORT 8
 
 //----------------------------------------------------------------------------
 // Class stLessResultPair
@@ -117,6 +123,14 @@ struct stLessResultPagedTriple {
 * <P> It also performs basic operations that allows the construction of
 * the result set by the query procedures.
 *
+* <P>The pairs are kept in a vector allocated from the arena of the result.
+* AddPair() only appends the new pair and the vector is sorted by distance
+* when it is read. Pairs with the same distance are kept in the order they
+* were added. A k-nearest neighbor query calls Cut() after each insertion,
+* so only the last pair is out of place and it is moved to its position by a
+* binary search. Larger unsorted tails, as the ones left by range queries,
+* are sorted at once.
+*
 * @author Enzo Seraphim (seraphim@unifei.edu.br)
 * @author Fabio Jun Takada Chino (chino@icmc.usp.br)
 * @author Marcos Rodrigues Vieira (mrvieira@icmc.usp.br)
@@ -139,18 +153,18 @@ class stResult: public stBasicResult < ObjectType > {
       */
       typedef stResultPair< ObjectType > tPair;
 
-      typedef std::multiset < tPair *, stLessResultPair< ObjectType > > tPairs;
+      typedef std::vector < tPair *, stArenaAllocator< tPair * > > tPairs;
       
       typedef typename tPairs::iterator tItePairs;
 
       /**
       * This method will create a new instance of this class.
       */
-      stResult(){
+      stResult():Pairs(stArenaAllocator< tPair * >(&Arena)){
          // No info
          SetQueryInfo();
          Sample = NULL;
-         allpairs = NULL;
+         SortedCount = 0;
       }//end stResult
 
       /**
@@ -158,12 +172,12 @@ class stResult: public stBasicResult < ObjectType > {
       *
       * @warning Deprecated Method.
       */
-      stResult(int k){
+      stResult(int k):Pairs(stArenaAllocator< tPair * >(&Arena)){
          // No info
          SetQueryInfo();
          Sample = NULL;
          this->K = k;
-         allpairs = NULL;
+         SortedCount = 0;
       }//end stResult
 
       /**
@@ -175,6 +189,7 @@ class stResult: public stBasicResult < ObjectType > {
       * Iterator to begin of list.
       */
       tItePairs beginPairs(){
+         Sort();
          return Pairs.begin();
       }//end iteratorPair
       
@@ -184,13 +199,15 @@ class stResult: public stBasicResult < ObjectType > {
       * @warning Decrement the iterator for get the last element.
       */
       tItePairs endPairs(){
+         Sort();
          return Pairs.end();
       }//end iteratorPair
 
       /**
-      * Return the container Pairs
+      * Return the container Pairs sorted by distance.
       */
       tPairs * GetPairs(){
+         Sort();
          return &Pairs;
       }// end GetPairs
 
@@ -200,18 +217,8 @@ class stResult: public stBasicResult < ObjectType > {
       * @return The stResultPair pair
       */
       tPair & operator [] (unsigned int idx) {
-          if (allpairs == NULL) {
-              allpairs = new tPair*[GetNumOfEntries()];
-              int pos = 0;
-              for (tItePairs ite = this->beginPairs(); ite != this->endPairs(); ite++) {
-                  allpairs[pos] = (*ite);
-                  pos++;
-              }
-          }
-          if (idx < GetNumOfEntries())
-              return *allpairs[idx];
-//          else
-//              return NULL;
+          Sort();
+          return *Pairs[idx];
       }
 
       /**
@@ -220,18 +227,12 @@ class stResult: public stBasicResult < ObjectType > {
       * @return The stResultPair pair
       */
       tPair *GetPair(int idx) {
-          if (allpairs == NULL) {
-              allpairs = new tPair*[GetNumOfEntries()];
-              int pos = 0;
-              for (tItePairs ite = this->beginPairs(); ite != this->endPairs(); ite++) {
-                  allpairs[pos] = (*ite);
-                  pos++;
-              }
-          }
-          if (idx < GetNumOfEntries())
-              return allpairs[idx];
-          else
+          if ((idx >= 0) && ((unsigned int) idx < GetNumOfEntries())){
+              Sort();
+              return Pairs[idx];
+          }else{
               return NULL;
+          }
       }
 
       /**
@@ -249,10 +250,23 @@ class stResult: public stBasicResult < ObjectType > {
       * @warning There is no duplicate pair checking. All pairs will be added.
       */
       void AddPair(tObject * obj, double distance){
-         Pairs.insert(Pairs.begin(), new tPair(obj, distance));
-         if (allpairs != NULL)
-             delete[] allpairs;
-         allpairs = NULL;
+         Pairs.push_back(new (&Arena, 0) tPair(obj, distance));
+      }//end AddPair
+
+      /**
+      * This method adds a pair Object/Distance to this result list from a
+      * serialized object. The bytes are copied into the arena of this result
+      * and the object is only unserialized when the pair is accessed, so the
+      * pairs discarded by Cut() never create it.
+      *
+      * @param data The serialized object.
+      * @param size The size of the serialized object.
+      * @param distance The distance from the sample object.
+      * @warning There is no duplicate pair checking. All pairs will be added.
+      */
+      void AddPair(const unsigned char * data, u_int32_t size, double distance){
+         Pairs.push_back(
+               tPair::Create(&Arena, data, size, distance, Materialize));
       }//end AddPair
 
       /**
@@ -281,10 +295,11 @@ class stResult: public stBasicResult < ObjectType > {
       * This method will cut out undesired objects. It may be used
       * by k-Nearest Neighbour queries to control the number of results.
       *
-      * <P>This implementation also treat...
+      * <P>Only the <i>limit</i> nearest pairs are kept. If the tie list is
+      * enabled (see SetQueryInfo()), the pairs whose distance is equal to
+      * the distance of the last kept pair are kept too.
       *
       * @param limit The desired number of results.
-      * @todo Review of this explanation.
       */
       void Cut(unsigned int limit);
 
@@ -398,19 +413,41 @@ class stResult: public stBasicResult < ObjectType > {
    private:
 
       /**
-      * The red-black tree of pairs.
+      * The arena of the pairs. It must be declared before Pairs.
+      */
+      stArena Arena;
+
+      /**
+      * The vector of pairs.
       */
       tPairs Pairs;
 
+      /**
+      * Number of pairs at the beginning of Pairs that are sorted by
+      * distance.
+      */
+      unsigned int SortedCount;
+
       /**
       * Sample object.
       */
       tObject * Sample;
 
       /**
-      * The vector of pairs
+      * Sorts the pairs added since the last call.
       */
-      stResultPair<tObject> **allpairs;
+      void Sort();
+
+      /**
+      * Rebuilds an object added by AddPair(const unsigned char *, u_int32_t,
+      * double).
+      */
+      static tObject * Materialize(const unsigned char * data, u_int32_t size){
+         tObject * obj = new tObject();
+
+         obj->Unserialize(data, size);
+         return obj;
+      }//end Materialize
 };//end stResult
 
 //----------------------------------------------------------------------------
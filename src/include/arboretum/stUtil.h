@@ -611,6 +611,20 @@ class stDynamicRPriorityQueue{
          return size;
       }//end GetSize
 
+      /**
+      * Returns the values of the entries with the smallest keys, in
+      * ascending order of key, without removing them from the queue. It is
+      * intended to peek at the next few entries (the cost grows with the
+      * square of n).
+      *
+      * @param values The array that will receive the values. It must have at
+      * least n positions.
+      * @param n Maximum number of values to return. Values larger than 31 are
+      * treated as 31.
+      * @return The number of values returned.
+      */
+      int GetFirst(TValue * values, int n);
+
    private:
 
       /**
@@ -1391,6 +1405,46 @@ void stDynamicRPriorityQueue < TKey, TValue>::Add(
    size++;
 }//end stDynamicRPriorityQueue::Add
 
+//------------------------------------------------------------------------------
+template < class TKey, class TValue >
+int stDynamicRPriorityQueue < TKey, TValue>::GetFirst(TValue * values, int n){
+   int candidates[32];
+   int nCandidates;
+   int count;
+   int best;
+   int i;
+
+   // The next smallest entry is always the root or a child of an entry
+   // already returned. Each step adds at most one candidate.
+   if (n > 31){
+      n = 31;
+   }//end if
+   nCandidates = 0;
+   if (size > 0){
+      candidates[nCandidates++] = 0;
+   }//end if
+   for (count = 0; (count < n) && (nCandidates > 0); count++){
+      best = 0;
+      for (i = 1; i < nCandidates; i++){
+         if (entries[candidates[i]].key < entries[candidates[best]].key){
+            best = i;
+         }//end if
+      }//end for
+      values[count] = entries[candidates[best]].value;
+
+      // Replace it by its children.
+      i = candidates[best] * 2 + 1;
+      candidates[best] = candidates[--nCandidates];
+      if (i < size){
+         candidates[nCandidates++] = i;
+      }//end if
+      if (i + 1 < size){
+         candidates[nCandidates++] = i + 1;
+      }//end if
+   }//end for
+   return count;
+}//end stDynamicRPriorityQueue::GetFirst
+
 //----------------------------------------------------------------------------
 template < class TKey, class TValue >
 void stDynamicRPriorityQueue < TKey, TValue >::Resize(){
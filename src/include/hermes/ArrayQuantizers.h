@@ -0,0 +1,292 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+* 
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+* 
+* 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+* 
+* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+* 
+* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef ARRAYQUANTIZERS_H
+#define ARRAYQUANTIZERS_H
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <sys/types.h>
+
+/**
+* This class quantizes each value of a feature vector to one byte (256
+* levels from the smallest value of the vector). Code c stands for the
+* interval [minimum + scale * c, minimum + scale * (c + 1)], and encode()
+* checks that each value lies in the interval of its code, as computed by
+* interval(), so a distance function may use the intervals to bound the
+* distance to the original vector (see QuantizedBounds).
+*
+* <P>The scale is a power of two, so scale * c is exact and the bounds of an
+* interval are rounded once. Any code that computes them (a vectorized
+* kernel, or a compiler that contracts the expression to a fused
+* multiply-add) gets the same values.
+*
+* @brief Scalar quantization to 8 bits.
+* @version 1.0
+* @see QuantizedBounds
+*/
+class Int8Quantizer{
+
+    public:
+        /**
+        * The type of a code.
+        */
+        typedef u_int8_t CodeType;
+
+        /**
+        * The layout of the codes: bytes with a minimum and a power of two
+        * scale (QUANTIZEDBOUNDS_AFFINE8, see QuantizedBounds).
+        */
+        static const int Layout = 1;
+
+        /**
+        * Number of parameters kept by each vector: its minimum and the scale.
+        */
+        static const size_t ParameterCount = 2;
+
+        /**
+        * Quantizes a vector.
+        * @param values The n values.
+        * @param n The number of values.
+        * @param params The parameters of the vector (output).
+        * @param codes The n codes (output).
+        * @return False if a value is not finite, if the range of the values
+        * overflows or underflows or if the interval of some code does not
+        * hold its value. The codes must not be used then.
+        */
+        static bool encode(const double *values, size_t n, double *params, CodeType *codes){
+            double minimum = 0.0;
+            double maximum = 0.0;
+            int exponent;
+
+            for (size_t i = 0; i < n; i++){
+                if (!std::isfinite(values[i])){
+                    return false;
+                }
+                if ((i == 0) || (values[i] < minimum)){
+                    minimum = values[i];
+                }
+                if ((i == 0) || (values[i] > maximum)){
+                    maximum = values[i];
+                }
+            }
+            params[0] = minimum;
+            params[1] = 0.0;
+            if (maximum > minimum){
+                // The smallest power of two not smaller than range / 255.
+                frexp((maximum - minimum) / 255.0, &exponent);
+                params[1] = ldexp(1.0, exponent);
+                if (!std::isfinite(params[1]) || (params[1] < ldexp(DBL_MIN, 8))){
+                    return false;
+                }
+            }
+
+            // The rounding of the range may require a wider scale.
+            if (encode(values, n, params, codes, minimum)){
+                return true;
+            }
+            params[1] = params[1] * 2.0;
+            return std::isfinite(params[1]) && encode(values, n, params, codes, minimum);
+        }
+
+        /**
+        * Gets the interval of a code.
+        * @param params The parameters of the vector.
+        * @param code The code.
+        * @param lo The smallest value of the interval (output).
+        * @param hi The greatest value of the interval (output).
+        */
+        static void interval(const double *params, CodeType code, double &lo, double &hi){
+            lo = params[0] + (params[1] * code);
+            hi = params[0] + (params[1] * (code + 1));
+        }
+
+    private:
+
+        /**
+        * Quantizes a vector with the given parameters.
+        * @param values The n values.
+        * @param n The number of values.
+        * @param params The parameters of the vector.
+        * @param codes The n codes (output).
+        * @param minimum The smallest value.
+        * @return False if the interval of some code does not hold its value.
+        */
+        static bool encode(const double *values, size_t n, const double *params,
+                CodeType *codes, double minimum){
+            double lo, hi;
+            double c;
+
+            for (size_t i = 0; i < n; i++){
+                c = (params[1] > 0.0) ? floor((values[i] - minimum) / params[1]) : 0.0;
+                codes[i] = (CodeType) std::min(std::max(c, 0.0), 255.0);
+                // The rounding of the division may pick a neighbour.
+                interval(params, codes[i], lo, hi);
+                if ((values[i] < lo) && (codes[i] > 0)){
+                    codes[i]--;
+                }else if ((values[i] > hi) && (codes[i] < 255)){
+                    codes[i]++;
+                }
+                interval(params, codes[i], lo, hi);
+                if (!((lo <= values[i]) && (values[i] <= hi))){
+                    return false;
+                }
+            }
+            return true;
+        }
+};
+
+/**
+* This class quantizes each value of a feature vector to a half precision
+* (IEEE 754 binary16) number. The value is rounded toward minus infinity, so
+* code c stands for the interval between c and the next binary16 number. The
+* conversions are exact and do not depend on the F16C instructions. Values
+* greater than 65504 get the interval [65504, +inf] and values smaller than
+* -65504 get [-inf, -65504].
+*
+* @brief Quantization to half precision.
+* @version 1.0
+* @see QuantizedBounds
+*/
+class Float16Quantizer{
+
+    public:
+        /**
+        * The type of a code.
+        */
+        typedef u_int16_t CodeType;
+
+        /**
+        * The layout of the codes: binary16 numbers (QUANTIZEDBOUNDS_FLOAT16,
+        * see QuantizedBounds).
+        */
+        static const int Layout = 2;
+
+        /**
+        * Number of parameters kept by each vector.
+        */
+        static const size_t ParameterCount = 0;
+
+        /**
+        * Quantizes a vector.
+        * @param values The n values.
+        * @param n The number of values.
+        * @param codes The n codes (output).
+        * @return False if a value is NaN. The codes must not be used then.
+        */
+        static bool encode(const double *values, size_t n, double *, CodeType *codes){
+            for (size_t i = 0; i < n; i++){
+                if (std::isnan(values[i])){
+                    return false;
+                }
+                codes[i] = roundDown(values[i]);
+            }
+            return true;
+        }
+
+        /**
+        * Gets the interval of a code.
+        * @param code The code.
+        * @param lo The smallest value of the interval (output).
+        * @param hi The greatest value of the interval (output).
+        */
+        static void interval(const double *, CodeType code, double &lo, double &hi){
+            lo = toDouble(code);
+            hi = toDouble(nextUp(code));
+        }
+
+        /**
+        * Converts a binary16 number to double. It is exact.
+        * @param code The binary16 number.
+        * @return The value of code.
+        */
+        static double toDouble(CodeType code){
+            int exponent = (code >> 10) & 0x1F;
+            int mantissa = code & 0x3FF;
+            double value;
+
+            if (exponent == 0x1F){
+                value = (mantissa == 0) ? HUGE_VAL : NAN;
+            }else if (exponent == 0){
+                value = ldexp((double) mantissa, -24);
+            }else{
+                value = ldexp((double) (mantissa | 0x400), exponent - 25);
+            }
+            return (code & 0x8000) ? -value : value;
+        }
+
+        /**
+        * Gets the greatest binary16 number that is not greater than value.
+        * @param value The value. It must not be NaN.
+        * @return The binary16 number.
+        */
+        static CodeType roundDown(double value){
+            CodeType code = truncate(fabs(value));
+
+            if (value >= 0.0){
+                return code;
+            }else{
+                // Its magnitude must be rounded up.
+                if (toDouble(code) != -value){
+                    code++;
+                }
+                return code | 0x8000;
+            }
+        }
+
+    private:
+
+        /**
+        * Gets the greatest non-negative binary16 number that is not greater
+        * than magnitude.
+        * @param magnitude A non-negative value.
+        * @return The binary16 number.
+        */
+        static CodeType truncate(double magnitude){
+            int exponent;
+            double fraction;
+
+            if (magnitude == HUGE_VAL){
+                return 0x7C00;
+            }else if (magnitude >= 65504.0){
+                return 0x7BFF;
+            }else if (magnitude < ldexp(1.0, -14)){
+                // Subnormal: multiples of 2^-24.
+                return (CodeType) floor(ldexp(magnitude, 24));
+            }
+            // magnitude = fraction * 2^exponent, fraction in [0.5, 1)
+            fraction = frexp(magnitude, &exponent);
+            return (CodeType) (((exponent + 14) << 10) |
+                    (int) floor(((2.0 * fraction) - 1.0) * 1024.0));
+        }
+
+        /**
+        * Gets the next binary16 number toward plus infinity.
+        * @param code A binary16 number. +inf is kept.
+        * @return The next binary16 number.
+        */
+        static CodeType nextUp(CodeType code){
+            if (code == 0x7C00){
+                return code;
+            }else if (code == 0x8000){
+                return 0x0001;
+            }else if (code & 0x8000){
+                return code - 1;
+            }else{
+                return code + 1;
+            }
+        }
+};
+
+#endif
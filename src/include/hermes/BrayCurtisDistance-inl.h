@@ -13,21 +13,21 @@
 /**
 * Constructor.
 */
-template <class ObjectType>
-BrayCurtisDistance<ObjectType>::BrayCurtisDistance(){
+template <class ObjectType, class StatisticsPolicy>
+BrayCurtisDistance<ObjectType, StatisticsPolicy>::BrayCurtisDistance(){
 }
 
 /**
 * Destructor.
 */
-template <class ObjectType>
-BrayCurtisDistance<ObjectType>::~BrayCurtisDistance(){}
+template <class ObjectType, class StatisticsPolicy>
+BrayCurtisDistance<ObjectType, StatisticsPolicy>::~BrayCurtisDistance(){}
 
 /**
 * @copydoc DistanceFunction::GetDistance()
 */
-template <class ObjectType>
-double BrayCurtisDistance<ObjectType>::GetDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error){
+template <class ObjectType, class StatisticsPolicy>
+double BrayCurtisDistance<ObjectType, StatisticsPolicy>::GetDistance(ObjectType &obj1, ObjectType &obj2){
 
     return getDistance(obj1, obj2);
 }
@@ -35,13 +35,22 @@ double BrayCurtisDistance<ObjectType>::GetDistance(ObjectType &obj1, ObjectType
 /**
 * @copydoc DistanceFunction::getDistance()
 */
-template <class ObjectType>
-double BrayCurtisDistance<ObjectType>::getDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error){
+template <class ObjectType, class StatisticsPolicy>
+double BrayCurtisDistance<ObjectType, StatisticsPolicy>::getDistance(ObjectType &obj1, ObjectType &obj2){
 
     if (obj1.size() != obj2.size()){
         throw std::length_error("The feature vectors do not have the same size.");
     }
 
+    if constexpr (HistogramKernelTraits<ObjectType, ObjectType>::Supported){
+        double d = HistogramKernels::brayCurtis(obj1.getValueData(), obj2.getValueData(), obj1.size());
+
+        // Statistic support
+        this->updateDistanceCount();
+
+        return d;
+    }
+
     double d;
     double tmpNumerator;
     double tmpDenominator;
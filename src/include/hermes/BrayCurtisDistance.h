@@ -22,6 +22,7 @@
 #define BRAYCURTISDISTANCE_H
 
 #include "DistanceFunction.h"
+#include "HistogramKernels.h"
 #include <cmath>
 #include <stdexcept>
 
@@ -34,16 +35,16 @@
 * @warning Both objects must have the same number of entries.
 * @see DistanceFunction
 */
-template <class ObjectType>
-class BrayCurtisDistance: public DistanceFunction<ObjectType> {
+template <class ObjectType, class StatisticsPolicy = DistanceFunctionStatistics>
+class BrayCurtisDistance final : public DistanceFunction<ObjectType, StatisticsPolicy>{
 
     public:
 
         BrayCurtisDistance();
         virtual ~BrayCurtisDistance();
 
-        double GetDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error);
-        double getDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error);
+        double GetDistance(ObjectType &obj1, ObjectType &obj2);
+        double getDistance(ObjectType &obj1, ObjectType &obj2);
 };
 
 #include "BrayCurtisDistance-inl.h"
@@ -13,15 +13,15 @@
 /**
 * Constructor.
 */
-template <class ObjectType>
-CanberraDistance<ObjectType>::CanberraDistance(){
+template <class ObjectType, class StatisticsPolicy>
+CanberraDistance<ObjectType, StatisticsPolicy>::CanberraDistance(){
 }
 
 /**
 * Destructor.
 */
-template <class ObjectType>
-CanberraDistance<ObjectType>::~CanberraDistance(){
+template <class ObjectType, class StatisticsPolicy>
+CanberraDistance<ObjectType, StatisticsPolicy>::~CanberraDistance(){
 }
 
 /**
@@ -29,8 +29,8 @@ CanberraDistance<ObjectType>::~CanberraDistance(){
 *
 * @copydoc getDistance(ObjectType &obj1, ObjectType &obj2) .
 */
-template <class ObjectType>
-double CanberraDistance<ObjectType>::GetDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error){
+template <class ObjectType, class StatisticsPolicy>
+double CanberraDistance<ObjectType, StatisticsPolicy>::GetDistance(ObjectType &obj1, ObjectType &obj2){
 
     return getDistance(obj1, obj2);
 }
@@ -43,8 +43,8 @@ double CanberraDistance<ObjectType>::GetDistance(ObjectType &obj1, ObjectType &o
 * @throw Exception If the computation is not possible.
 * @return The distance between feature vector 1 and feature vector 2.
 */
-template <class ObjectType>
-double CanberraDistance<ObjectType>::getDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error){
+template <class ObjectType, class StatisticsPolicy>
+double CanberraDistance<ObjectType, StatisticsPolicy>::getDistance(ObjectType &obj1, ObjectType &obj2){
 
     if (obj1.size() != obj2.size())
         throw std::length_error("The feature vectors do not have the same size.");
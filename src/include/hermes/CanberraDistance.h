@@ -31,16 +31,16 @@
 * @author 006
 * @version 1.0.
 */
-template <class ObjectType>
-class CanberraDistance : public DistanceFunction <ObjectType>{
+template <class ObjectType, class StatisticsPolicy = DistanceFunctionStatistics>
+class CanberraDistance final : public DistanceFunction<ObjectType, StatisticsPolicy>{
 
     public:
 
         CanberraDistance();
         virtual ~CanberraDistance();
 
-        double GetDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error);
-        double getDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error);
+        double GetDistance(ObjectType &obj1, ObjectType &obj2);
+        double getDistance(ObjectType &obj1, ObjectType &obj2);
 };
 
 #include "CanberraDistance-inl.h"
@@ -13,15 +13,15 @@
 /**
 * Constructor.
 */
-template <class ObjectType>
-ChebyshevDistance<ObjectType>::ChebyshevDistance(){
+template <class ObjectType, class StatisticsPolicy>
+ChebyshevDistance<ObjectType, StatisticsPolicy>::ChebyshevDistance(){
 }
 
 /**
 * Destructor.
 */
-template <class ObjectType>
-ChebyshevDistance<ObjectType>::~ChebyshevDistance(){
+template <class ObjectType, class StatisticsPolicy>
+ChebyshevDistance<ObjectType, StatisticsPolicy>::~ChebyshevDistance(){
 }
 
 /**
@@ -29,8 +29,29 @@ ChebyshevDistance<ObjectType>::~ChebyshevDistance(){
 *
 * @copydoc getDistance(ObjectType &obj1, ObjectType &obj2) .
 */
-template <class ObjectType>
-double ChebyshevDistance<ObjectType>::GetDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error){
+template <class ObjectType, class StatisticsPolicy>
+double ChebyshevDistance<ObjectType, StatisticsPolicy>::GetDistance(ObjectType &obj1, ObjectType &obj2){
+
+    return getDistance(obj1, obj2);
+}
+
+/**
+* @copydoc getDistance(ViewType &obj1, ObjectType &obj2) .
+*/
+template <class ObjectType, class StatisticsPolicy>
+double ChebyshevDistance<ObjectType, StatisticsPolicy>::getDistance(ObjectType &obj1, ObjectType &obj2){
+
+    return getDistance<ObjectType>(obj1, obj2);
+}
+
+/**
+* @deprecated Use getDistance(ViewType &obj1, ObjectType &obj2) instead.
+*
+* @copydoc getDistance(ViewType &obj1, ObjectType &obj2) .
+*/
+template <class ObjectType, class StatisticsPolicy>
+template <class ViewType>
+double ChebyshevDistance<ObjectType, StatisticsPolicy>::GetDistance(ViewType &obj1, ObjectType &obj2){
 
     return getDistance(obj1, obj2);
 }
@@ -40,24 +61,102 @@ double ChebyshevDistance<ObjectType>::GetDistance(ObjectType &obj1, ObjectType &
 * This calculus is based on the math form max{feature_1[i] - feature_2[i]}.
 * To make this computations both feature vectors should have the same size().
 *
-* @param obj1: The first feature vector.
+* @param obj1: The first feature vector. It may be an ObjectType or a
+* read-only view of a serialized ObjectType (see BasicArrayObjectView).
 * @param obj2: The second feature vector.
 * @throw Exception If the computation is not possible.
 * @return The Chebyshev distance between feature vector 1 and feature vector 2.
 */
-template <class ObjectType>
-double ChebyshevDistance<ObjectType>::getDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error){
+template <class ObjectType, class StatisticsPolicy>
+template <class ViewType>
+double ChebyshevDistance<ObjectType, StatisticsPolicy>::getDistance(ViewType &obj1, ObjectType &obj2){
+
+    return getDistanceBounded(obj1, obj2, HUGE_VAL);
+}
+
+/**
+* @deprecated Use getDistanceBounded(ObjectType &obj1, ObjectType &obj2, double bound) instead.
+*
+* @copydoc getDistanceBounded(ViewType &obj1, ObjectType &obj2, double bound) .
+*/
+template <class ObjectType, class StatisticsPolicy>
+double ChebyshevDistance<ObjectType, StatisticsPolicy>::GetDistanceBounded(ObjectType &obj1, ObjectType &obj2, double bound){
+
+    return getDistanceBounded(obj1, obj2, bound);
+}
+
+/**
+* @copydoc getDistanceBounded(ViewType &obj1, ObjectType &obj2, double bound) .
+*/
+template <class ObjectType, class StatisticsPolicy>
+double ChebyshevDistance<ObjectType, StatisticsPolicy>::getDistanceBounded(ObjectType &obj1, ObjectType &obj2, double bound){
+
+    return getDistanceBounded<ObjectType>(obj1, obj2, bound);
+}
+
+/**
+* @deprecated Use getDistanceBounded(ViewType &obj1, ObjectType &obj2, double bound) instead.
+*
+* @copydoc getDistanceBounded(ViewType &obj1, ObjectType &obj2, double bound) .
+*/
+template <class ObjectType, class StatisticsPolicy>
+template <class ViewType>
+double ChebyshevDistance<ObjectType, StatisticsPolicy>::GetDistanceBounded(ViewType &obj1, ObjectType &obj2, double bound){
+
+    return getDistanceBounded(obj1, obj2, bound);
+}
+
+/**
+* Calculates the Chebyshev distance between two feature vectors if it is
+* not greater than bound. The greatest absolute difference found so far is checked after each
+* block of LPKERNELS_BLOCKSIZE values and the calculation stops as soon as
+* it exceeds the bound.
+*
+* @param obj1: The first feature vector. It may be an ObjectType or a
+* read-only view of a serialized ObjectType (see BasicArrayObjectView).
+* @param obj2: The second feature vector.
+* @param bound: The greatest distance of interest.
+* @throw Exception If the computation is not possible.
+* @return The Chebyshev distance between feature vector 1 and feature vector 2
+* if it is not greater than bound, or a value greater than bound otherwise.
+*/
+template <class ObjectType, class StatisticsPolicy>
+template <class ViewType>
+double ChebyshevDistance<ObjectType, StatisticsPolicy>::getDistanceBounded(ViewType &obj1, ObjectType &obj2, double bound){
 
-    if (obj1.size() != obj2.size())
+    if (obj1.size() != obj2.size()){
         throw std::length_error("The feature vectors do not have the same size.");
+    }
 
+    size_t n = obj1.size();
+    double limit = bound;
     double d = 0;
     double tmp;
+    size_t i = 0;
+    size_t end;
+
+    if constexpr (LpKernelTraits<ViewType, ObjectType>::Supported){
+        typedef typename LpKernelTraits<ViewType, ObjectType>::DataType DataType;
+
+        if (n >= LPKERNELS_MINSIZE){
+            const u_char *data1 = obj1.getVectorData();
+            const u_char *data2 = obj2.getVectorData();
 
-    for (size_t i = 0; i < obj1.size(); i++){
-        tmp = fabs(obj1[i] - obj2[i]);
-        if (tmp > d){
-            d = tmp;
+            for (; (i < n) && (d <= limit); i += LPKERNELS_BLOCKSIZE){
+                end = std::min(n - i, (size_t) LPKERNELS_BLOCKSIZE);
+                d = std::max(d, LpKernels<DataType>::maxAbsoluteDifference(data1 + (i * sizeof(DataType)),
+                        data2 + (i * sizeof(DataType)), end));
+            }
+        }
+    }
+
+    for (; (i < n) && (d <= limit); i = end){
+        end = std::min(n, i + LPKERNELS_BLOCKSIZE);
+        for (; i < end; i++){
+            tmp = fabs(obj1[i] - obj2[i]);
+            if (tmp > d){
+                d = tmp;
+            }
         }
     }
 
@@ -66,3 +165,195 @@ double ChebyshevDistance<ObjectType>::getDistance(ObjectType &obj1, ObjectType &
 
     return d;
 }
+
+/**
+* @deprecated Use getDistances(ObjectType &query, const DType *candidates, size_t count, double *distances) instead.
+*
+* @copydoc getDistances(ObjectType &query, const DType *candidates, size_t count, double *distances) .
+*/
+template <class ObjectType, class StatisticsPolicy>
+template <class DType>
+void ChebyshevDistance<ObjectType, StatisticsPolicy>::GetDistances(ObjectType &query, const DType *candidates, size_t count, double *distances){
+
+    getDistances(query, candidates, count, distances);
+}
+
+/**
+* Calculates the Chebyshev distance between a query and count candidate
+* feature vectors stored one after the other in a single array
+* (count x query.size() values).
+*
+* @param query: The query feature vector. It must provide getVectorData().
+* @param candidates: The candidate feature vectors.
+* @param count: The number of candidates.
+* @param distances: The count distances (output).
+*/
+template <class ObjectType, class StatisticsPolicy>
+template <class DType>
+void ChebyshevDistance<ObjectType, StatisticsPolicy>::getDistances(ObjectType &query, const DType *candidates, size_t count, double *distances){
+
+    static_assert(std::is_same<typename LpKernelTraits<ObjectType, ObjectType>::DataType, DType>::value,
+            "The candidates must have the element type of the query.");
+
+    LpKernels<DType>::maxAbsoluteDifference(query.getVectorData(), candidates, query.size(), count, distances);
+
+    // Statistic support
+    for (size_t i = 0; i < count; i++){
+        this->updateDistanceCount();
+    }
+}
+
+/**
+* @deprecated Use getDistances(ObjectType &query, ObjectType **entries, size_t n, double *distances, double bound) instead.
+*
+* @copydoc getDistances(ObjectType &query, ViewType **entries, size_t n, double *distances, double bound) .
+*/
+template <class ObjectType, class StatisticsPolicy>
+void ChebyshevDistance<ObjectType, StatisticsPolicy>::GetDistances(ObjectType &query, ObjectType **entries, size_t n, double *distances, double bound){
+
+    getDistances(query, entries, n, distances, bound);
+}
+
+/**
+* @copydoc getDistances(ObjectType &query, ViewType **entries, size_t n, double *distances, double bound) .
+*/
+template <class ObjectType, class StatisticsPolicy>
+void ChebyshevDistance<ObjectType, StatisticsPolicy>::getDistances(ObjectType &query, ObjectType **entries, size_t n, double *distances, double bound){
+
+    getDistances<ObjectType>(query, entries, n, distances, bound);
+}
+
+/**
+* @deprecated Use getDistances(ObjectType &query, ViewType **entries, size_t n, double *distances, double bound) instead.
+*
+* @copydoc getDistances(ObjectType &query, ViewType **entries, size_t n, double *distances, double bound) .
+*/
+template <class ObjectType, class StatisticsPolicy>
+template <class ViewType>
+void ChebyshevDistance<ObjectType, StatisticsPolicy>::GetDistances(ObjectType &query, ViewType **entries, size_t n, double *distances, double bound){
+
+    getDistances(query, entries, n, distances, bound);
+}
+
+/**
+* Calculates the Chebyshev distance between a query and n feature vectors, usually
+* the candidates of a node of a metric tree. Each distance is computed by
+* getDistanceBounded(), and the values of the next feature vector are
+* prefetched while the current one is compared.
+*
+* @param query: The query feature vector.
+* @param entries: The n feature vectors. They may be ObjectType or read-only
+* views of serialized ObjectType (see BasicArrayObjectView).
+* @param n: The number of feature vectors.
+* @param distances: The n distances (output). distances[i] is the distance
+* between entries[i] and query if it is not greater than bound, or a value
+* greater than bound otherwise.
+* @param bound: The greatest distance of interest.
+*/
+template <class ObjectType, class StatisticsPolicy>
+template <class ViewType>
+void ChebyshevDistance<ObjectType, StatisticsPolicy>::getDistances(ObjectType &query, ViewType **entries, size_t n, double *distances, double bound){
+
+    for (size_t i = 0; i < n; i++){
+        if constexpr (LpKernelTraits<ViewType, ObjectType>::Supported){
+            if (i + 1 < n){
+                LPKERNELS_PREFETCH(entries[i + 1]->getVectorData());
+            }
+        }
+        distances[i] = getDistanceBounded(*entries[i], query, bound);
+    }
+}
+
+/**
+* Sets the quantized copies of the feature vectors kept by the leaves of a
+* tree that uses this distance (see QuantizedBounds). It must be called
+* before the tree is created.
+*
+* @param layout: QUANTIZEDBOUNDS_AFFINE8, QUANTIZEDBOUNDS_FLOAT16 or 0 for no
+* copies.
+* @param dimensions: The number of values of each feature vector.
+* @throw std::invalid_argument If the layout is not known.
+*/
+template <class ObjectType, class StatisticsPolicy>
+void ChebyshevDistance<ObjectType, StatisticsPolicy>::setLeafCodes(int layout, size_t dimensions){
+
+    leafCodes = QuantizedBounds(layout, dimensions);
+}
+
+/**
+* @deprecated Use getLeafCodeSize() instead.
+*
+* @copydoc getLeafCodeSize() .
+*/
+template <class ObjectType, class StatisticsPolicy>
+u_int32_t ChebyshevDistance<ObjectType, StatisticsPolicy>::GetLeafCodeSize(){
+
+    return getLeafCodeSize();
+}
+
+/**
+* Returns the size in bytes of the quantized copy of a feature vector, or 0
+* if no copies are kept.
+*/
+template <class ObjectType, class StatisticsPolicy>
+u_int32_t ChebyshevDistance<ObjectType, StatisticsPolicy>::getLeafCodeSize(){
+
+    return leafCodes.getCodeSize();
+}
+
+/**
+* @deprecated Use encodeLeaf(ObjectType &obj, u_char *code) instead.
+*
+* @copydoc encodeLeaf(ObjectType &obj, u_char *code) .
+*/
+template <class ObjectType, class StatisticsPolicy>
+void ChebyshevDistance<ObjectType, StatisticsPolicy>::EncodeLeaf(ObjectType &obj, u_char *code){
+
+    encodeLeaf(obj, code);
+}
+
+/**
+* Builds the quantized copy of a feature vector.
+*
+* @param obj: The feature vector.
+* @param code: The getLeafCodeSize() bytes of the copy (output).
+*/
+template <class ObjectType, class StatisticsPolicy>
+void ChebyshevDistance<ObjectType, StatisticsPolicy>::encodeLeaf(ObjectType &obj, u_char *code){
+
+    leafCodes.encode(obj, code);
+}
+
+/**
+* @deprecated Use getLeafBound(const u_char *code, ObjectType &obj, double bound) instead.
+*
+* @copydoc getLeafBound(const u_char *code, ObjectType &obj, double bound) .
+*/
+template <class ObjectType, class StatisticsPolicy>
+double ChebyshevDistance<ObjectType, StatisticsPolicy>::GetLeafBound(const u_char *code, ObjectType &obj, double bound){
+
+    return getLeafBound(code, obj, bound);
+}
+
+/**
+* Calculates a lower bound of the Chebyshev distance between a feature vector
+* and obj from the quantized copy of the first one. Its values are not read
+* and the bound is not counted as a distance calculation. The calculation
+* stops as soon as the bound exceeds bound.
+*
+* @param code: The quantized copy built by encodeLeaf().
+* @param obj: The other feature vector.
+* @param bound: The greatest distance of interest.
+* @return A value that is never greater than the distance.
+*/
+template <class ObjectType, class StatisticsPolicy>
+double ChebyshevDistance<ObjectType, StatisticsPolicy>::getLeafBound(const u_char *code, ObjectType &obj, double bound){
+
+    double d;
+
+    if (bound >= HUGE_VAL){
+        return 0.0;
+    }
+    d = leafCodes.maxAbsoluteGap(code, obj, bound);
+    return d * (1.0 - QUANTIZEDBOUNDS_TOLERANCE);
+}
@@ -13,15 +13,15 @@
 /**
 * Constructor.
 */
-template <class ObjectType>
-ColorLayoutDistance<ObjectType>::ColorLayoutDistance(){
+template <class ObjectType, class StatisticsPolicy>
+ColorLayoutDistance<ObjectType, StatisticsPolicy>::ColorLayoutDistance(){
 }
 
 /**
 * Destructor.
 */
-template <class ObjectType>
-ColorLayoutDistance<ObjectType>::~ColorLayoutDistance(){
+template <class ObjectType, class StatisticsPolicy>
+ColorLayoutDistance<ObjectType, StatisticsPolicy>::~ColorLayoutDistance(){
 }
 
 /**
@@ -29,8 +29,8 @@ ColorLayoutDistance<ObjectType>::~ColorLayoutDistance(){
 *
 * @copydoc getDistance(ObjectType &obj1, ObjectType &obj2) .
 */
-template <class ObjectType>
-double ColorLayoutDistance<ObjectType>::GetDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error){
+template <class ObjectType, class StatisticsPolicy>
+double ColorLayoutDistance<ObjectType, StatisticsPolicy>::GetDistance(ObjectType &obj1, ObjectType &obj2){
 
     return getDistance(obj1, obj2);
 }
@@ -45,8 +45,8 @@ double ColorLayoutDistance<ObjectType>::GetDistance(ObjectType &obj1, ObjectType
 * @throw Exception If the computation is not possible.
 * @return The Color Layout distance between feature vector 1 and feature vector 2.
 */
-template <class ObjectType>
-double ColorLayoutDistance<ObjectType>::getDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error){
+template <class ObjectType, class StatisticsPolicy>
+double ColorLayoutDistance<ObjectType, StatisticsPolicy>::getDistance(ObjectType &obj1, ObjectType &obj2){
 
     if (obj1.size() != obj2.size())
         throw std::length_error("The feature vectors do not have the same size.");
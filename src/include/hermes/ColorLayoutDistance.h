@@ -33,15 +33,15 @@
 * @author 006.
 * @version 1.0.
 */
-template <class ObjectType>
-class ColorLayoutDistance : public DistanceFunction <ObjectType>{
+template <class ObjectType, class StatisticsPolicy = DistanceFunctionStatistics>
+class ColorLayoutDistance final : public DistanceFunction<ObjectType, StatisticsPolicy>{
 
     public:
         ColorLayoutDistance();
         virtual ~ColorLayoutDistance();
 
-        double GetDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error);
-        double getDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error);
+        double GetDistance(ObjectType &obj1, ObjectType &obj2);
+        double getDistance(ObjectType &obj1, ObjectType &obj2);
 };
 
 #include "ColorLayoutDistance-inl.h"
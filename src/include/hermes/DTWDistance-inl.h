@@ -12,20 +12,70 @@
 */
 /**
 * Constructor.
+*
+* @param window The Sakoe-Chiba window. DTWDISTANCE_NOWINDOW (default) does
+* not constrain the warping path.
 */
-template <class ObjectType>
-DTWDistance<ObjectType>::DTWDistance(){
+template <class ObjectType, class StatisticsPolicy>
+DTWDistance<ObjectType, StatisticsPolicy>::DTWDistance(size_t window){
+
+    this->window = window;
 }
 
 /**
 * Destructor.
 */
-template <class ObjectType>
-DTWDistance<ObjectType>::~DTWDistance(){
+template <class ObjectType, class StatisticsPolicy>
+DTWDistance<ObjectType, StatisticsPolicy>::~DTWDistance(){
 }
 
-template <class ObjectType>
-double DTWDistance<ObjectType>::GetDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error){
+/**
+* Gets the Sakoe-Chiba window.
+*
+* @return The window, or DTWDISTANCE_NOWINDOW if the warping path is not
+* constrained.
+*/
+template <class ObjectType, class StatisticsPolicy>
+size_t DTWDistance<ObjectType, StatisticsPolicy>::getWindow(){
+
+    return window;
+}
+
+/**
+* Sets the Sakoe-Chiba window.
+*
+* @param window The window, or DTWDISTANCE_NOWINDOW to not constrain the
+* warping path.
+*/
+template <class ObjectType, class StatisticsPolicy>
+void DTWDistance<ObjectType, StatisticsPolicy>::setWindow(size_t window){
+
+    this->window = window;
+}
+
+/**
+* Gets the window used to compare two series. It is never smaller than the
+* difference between their sizes.
+*
+* @param size1 The size of the first series.
+* @param size2 The size of the second series.
+* @return The window.
+*/
+template <class ObjectType, class StatisticsPolicy>
+size_t DTWDistance<ObjectType, StatisticsPolicy>::getEffectiveWindow(size_t size1, size_t size2){
+
+    size_t diff = (size1 > size2) ? size1 - size2 : size2 - size1;
+
+    return std::min(std::max(window, diff), std::max(size1, size2));
+}
+
+/**
+* @deprecated Use getDistance(ObjectType &obj1, ObjectType &obj2) instead.
+*
+* @copydoc getDistance(ObjectType &obj1, ObjectType &obj2) .
+*/
+template <class ObjectType, class StatisticsPolicy>
+double DTWDistance<ObjectType, StatisticsPolicy>::GetDistance(ObjectType &obj1, ObjectType &obj2){
 
     return getDistance(obj1, obj2);
 }
@@ -38,42 +88,349 @@ double DTWDistance<ObjectType>::GetDistance(ObjectType &obj1, ObjectType &obj2)
 * @throw Exception If the computation is not possible.
 * @return The DTW distance between feature vector 1 and feature vector 2.
 */
-template <class ObjectType>
-double DTWDistance<ObjectType>::getDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error){
+template <class ObjectType, class StatisticsPolicy>
+double DTWDistance<ObjectType, StatisticsPolicy>::getDistance(ObjectType &obj1, ObjectType &obj2){
+
+    return getDistanceBounded(obj1, obj2, HUGE_VAL);
+}
+
+/**
+* @deprecated Use getDistanceBounded(ObjectType &obj1, ObjectType &obj2, double bound) instead.
+*
+* @copydoc getDistanceBounded(ObjectType &obj1, ObjectType &obj2, double bound) .
+*/
+template <class ObjectType, class StatisticsPolicy>
+double DTWDistance<ObjectType, StatisticsPolicy>::GetDistanceBounded(ObjectType &obj1, ObjectType &obj2, double bound){
+
+    return getDistanceBounded(obj1, obj2, bound);
+}
+
+/**
+* Calculates the Dynamic Time Warping distance between two feature vectors if
+* it is not greater than bound.
+*
+* <P>When the bound is finite, LB_Kim and then LB_Keogh (with the envelope of
+* obj2) are checked first. Every warping path crosses every row of the warping
+* matrix, so the calculation also stops as soon as the smallest cost of a row
+* exceeds the bound.
+*
+* @param obj1: The first feature vector.
+* @param obj2: The second feature vector.
+* @param bound: The greatest distance of interest.
+* @throw Exception If the computation is not possible.
+* @return The DTW distance between feature vector 1 and feature vector 2 if
+* it is not greater than bound, or a value greater than bound otherwise.
+*/
+template <class ObjectType, class StatisticsPolicy>
+double DTWDistance<ObjectType, StatisticsPolicy>::getDistanceBounded(ObjectType &obj1, ObjectType &obj2, double bound){
+
+    return computeDistance(obj1, obj2, bound, NULL, NULL);
+}
+
+/**
+* @deprecated Use prepareQuery() instead.
+*
+* @copydoc prepareQuery(ObjectType &query, PreparedQuery &prepared) .
+*/
+template <class ObjectType, class StatisticsPolicy>
+void DTWDistance<ObjectType, StatisticsPolicy>::PrepareQuery(ObjectType &query, PreparedQuery &prepared){
+
+    prepareQuery(query, prepared);
+}
+
+/**
+* Prepares a query sample: its envelope is computed once, with the current
+* window.
+*
+* @param query: The query sample.
+* @param prepared: The data of the query sample (output).
+*/
+template <class ObjectType, class StatisticsPolicy>
+void DTWDistance<ObjectType, StatisticsPolicy>::prepareQuery(ObjectType &query, PreparedQuery &prepared){
+
+    prepared.sample = &query;
+    prepared.window = window;
+    computeEnvelope(query, prepared.upper, prepared.lower);
+}
+
+/**
+* @deprecated Use getDistance(ObjectType &obj, PreparedQuery &query) instead.
+*
+* @copydoc getDistance(ObjectType &obj, PreparedQuery &query) .
+*/
+template <class ObjectType, class StatisticsPolicy>
+double DTWDistance<ObjectType, StatisticsPolicy>::GetDistance(ObjectType &obj, PreparedQuery &query){
+
+    return getDistance(obj, query);
+}
+
+/**
+* Calculates the Dynamic Time Warping distance between a feature vector and a
+* prepared query sample.
+*
+* @param obj: The feature vector.
+* @param query: The query sample prepared by prepareQuery().
+* @throw Exception If the computation is not possible.
+* @return The DTW distance between the feature vector and the query sample.
+*/
+template <class ObjectType, class StatisticsPolicy>
+double DTWDistance<ObjectType, StatisticsPolicy>::getDistance(ObjectType &obj, PreparedQuery &query){
+
+    return computeDistance(obj, *query.sample, HUGE_VAL, NULL, NULL);
+}
+
+/**
+* @deprecated Use getDistanceBounded(ObjectType &obj, PreparedQuery &query, double bound) instead.
+*
+* @copydoc getDistanceBounded(ObjectType &obj, PreparedQuery &query, double bound) .
+*/
+template <class ObjectType, class StatisticsPolicy>
+double DTWDistance<ObjectType, StatisticsPolicy>::GetDistanceBounded(ObjectType &obj, PreparedQuery &query, double bound){
+
+    return getDistanceBounded(obj, query, bound);
+}
+
+/**
+* Calculates the Dynamic Time Warping distance between a feature vector and a
+* prepared query sample if it is not greater than bound. LB_Keogh uses the
+* envelope of the query sample, unless the window was changed after it was
+* prepared.
+*
+* @param obj: The feature vector.
+* @param query: The query sample prepared by prepareQuery().
+* @param bound: The greatest distance of interest.
+* @throw Exception If the computation is not possible.
+* @return The DTW distance between the feature vector and the query sample
+* if it is not greater than bound, or a value greater than bound otherwise.
+*/
+template <class ObjectType, class StatisticsPolicy>
+double DTWDistance<ObjectType, StatisticsPolicy>::getDistanceBounded(ObjectType &obj, PreparedQuery &query, double bound){
+
+    if (query.window != window){
+        return computeDistance(obj, *query.sample, bound, NULL, NULL);
+    }
+    return computeDistance(obj, *query.sample, bound, &query.upper, &query.lower);
+}
+
+/**
+* Calculates the Dynamic Time Warping distance between two feature vectors if
+* it is not greater than bound (see getDistanceBounded()).
+*
+* @param obj1: The first feature vector.
+* @param obj2: The second feature vector.
+* @param bound: The greatest distance of interest.
+* @param upper2: The upper side of the envelope of obj2, or NULL to compute it.
+* @param lower2: The lower side of the envelope of obj2, or NULL to compute it.
+* @throw Exception If the computation is not possible.
+* @return The DTW distance between feature vector 1 and feature vector 2 if
+* it is not greater than bound, or a value greater than bound otherwise.
+*/
+template <class ObjectType, class StatisticsPolicy>
+double DTWDistance<ObjectType, StatisticsPolicy>::computeDistance(ObjectType &obj1, ObjectType &obj2, double bound,
+                                                                 const std::vector<double> *upper2, const std::vector<double> *lower2){
 
     size_t rows = obj1.size();
     size_t cols = obj2.size();
-    double d = 0.0;
-    double **dtw; //Matrix to be used.
+    size_t w = getEffectiveWindow(rows, cols);
+    double limit = bound * bound;
+    double rowMin = 0.0;
+    double left, best, diff;
+    size_t first, last;
+    std::vector<double> upper, lower;
+
+    if ((rows == 0) || (cols == 0)){
+        throw std::length_error("The feature vectors can not be empty.");
+    }
 
-    // Allocates the memory for matrix M
-    dtw = new double*[rows + 1];
-    for (size_t i = 0; i < rows + 1; i++){
-        dtw[i] = new double[cols + 1];
+    // Statistic support
+    this->updateDistanceCount();
+
+    // Lower bounds
+    if (bound < HUGE_VAL){
+        double lb = getLowerBoundKim(obj1, obj2);
+
+        if (lb > bound){
+            return lb;
+        }
+        if (rows == cols){
+            if (upper2 == NULL){
+                computeEnvelope(obj2, upper, lower);
+                upper2 = &upper;
+                lower2 = &lower;
+            }
+            lb = getLowerBoundKeogh(obj1, *upper2, *lower2, bound);
+            if (lb > bound){
+                return lb;
+            }
+        }
     }
 
-    // Initialize
-    dtw[0][0] = pow(obj1[0] - obj2[0], 2.0);
-    // Initialize first col
-    for (size_t i = 1; i < rows; i++)
-        dtw[i][0] = pow(obj1[i] - obj2[0], 2.0) + dtw[i-1][0];
-    // Initialize first row
-    for (size_t i = 1; i < cols; i++)
-        dtw[0][i] = pow(obj1[0] - obj2[i], 2.0) + dtw[0][i-1];
-
-    // Execute the recurrence
-    for (size_t i = 1; i < rows; i++) {
-        for (size_t j = 1; j < cols; j++) {
-            dtw[i][j] = pow(obj1[i] - obj2[j], 2.0) + fmin(dtw[i-1][j-1], fmin(dtw[i][j-1], dtw[i-1][j]));
+    // The two rows of the warping matrix
+    std::vector<double> prevRow(cols, HUGE_VAL);
+    std::vector<double> currRow(cols);
+
+    // Execute the recurrence inside the band
+    for (size_t i = 0; (i < rows) && (rowMin <= limit); i++){
+        first = (i > w) ? i - w : 0;
+        last = std::min(cols - 1, i + w);
+        left = HUGE_VAL;
+        rowMin = HUGE_VAL;
+        for (size_t j = first; j <= last; j++){
+            if (i == 0){
+                best = (j == 0) ? 0.0 : left;
+            }else if (j == 0){
+                best = prevRow[j];
+            }else{
+                best = fmin(prevRow[j-1], fmin(left, prevRow[j]));
+            }
+            diff = (double) obj1[i] - (double) obj2[j];
+            left = (diff * diff) + best;
+            currRow[j] = left;
+            rowMin = fmin(rowMin, left);
         }
+        // The next row may read the cell just after the band
+        if (last + 1 < cols){
+            currRow[last + 1] = HUGE_VAL;
+        }
+        prevRow.swap(currRow);
+    }
+
+    if (rowMin > limit){
+        return sqrt(rowMin);
     }
+    return sqrt(prevRow[cols-1]);
+}
 
-    // stores the result
-    d = sqrt(dtw[rows-1][cols-1]);
+/**
+* Calculates the LB_Kim lower bound of the Dynamic Time Warping distance. Every
+* warping path aligns the first elements and the last elements of both
+* series, so the cost of both alignments can not exceed the distance.
+*
+* @param obj1: The first feature vector.
+* @param obj2: The second feature vector.
+* @return A lower bound of the DTW distance between feature vector 1 and
+* feature vector 2.
+*/
+template <class ObjectType, class StatisticsPolicy>
+double DTWDistance<ObjectType, StatisticsPolicy>::getLowerBoundKim(ObjectType &obj1, ObjectType &obj2){
 
-    // Statistic support
-    this->updateDistanceCount();
+    size_t rows = obj1.size();
+    size_t cols = obj2.size();
+    double diff = (double) obj1[0] - (double) obj2[0];
+    double d = diff * diff;
+
+    if ((rows > 1) || (cols > 1)){
+        diff = (double) obj1[rows-1] - (double) obj2[cols-1];
+        d += diff * diff;
+    }
+
+    return sqrt(d);
+}
+
+/**
+* Computes the envelope of a series used by LB_Keogh: upper[i] and lower[i]
+* are the greatest and the smallest elements of obj whose index is within the
+* window from i. The envelope of a query may be computed once and used with
+* every candidate of the same size.
+*
+* @param obj: The series.
+* @param upper: The upper side of the envelope.
+* @param lower: The lower side of the envelope.
+*/
+template <class ObjectType, class StatisticsPolicy>
+void DTWDistance<ObjectType, StatisticsPolicy>::computeEnvelope(ObjectType &obj, std::vector<double> &upper, std::vector<double> &lower){
+
+    size_t n = obj.size();
+    size_t w = getEffectiveWindow(n, n);
+    size_t k;
+    // The candidates of the envelope
+    std::deque<size_t> maxQueue;
+    std::deque<size_t> minQueue;
+
+    upper.resize(n);
+    lower.resize(n);
+
+    // Sliding window maximum and minimum, each index enters and leaves the
+    // queues only once.
+    for (size_t i = 0; i < n + w; i++){
+        if (i < n){
+            while ((!maxQueue.empty()) && (obj[maxQueue.back()] <= obj[i])){
+                maxQueue.pop_back();
+            }
+            maxQueue.push_back(i);
+            while ((!minQueue.empty()) && (obj[minQueue.back()] >= obj[i])){
+                minQueue.pop_back();
+            }
+            minQueue.push_back(i);
+        }
+        if (i >= w){
+            k = i - w;
+            while (maxQueue.front() + w < k){
+                maxQueue.pop_front();
+            }
+            while (minQueue.front() + w < k){
+                minQueue.pop_front();
+            }
+            upper[k] = obj[maxQueue.front()];
+            lower[k] = obj[minQueue.front()];
+        }
+    }
+}
+
+/**
+* Calculates the LB_Keogh lower bound of the Dynamic Time Warping distance
+* between obj1 and a series of the same size whose envelope is given (see
+* computeEnvelope()).
+*
+* @param obj1: The first feature vector.
+* @param upper: The upper side of the envelope of the second feature vector.
+* @param lower: The lower side of the envelope of the second feature vector.
+* @param bound: The calculation stops as soon as the lower bound exceeds it.
+* @throw Exception If the sizes do not match.
+* @return A lower bound of the DTW distance.
+*/
+template <class ObjectType, class StatisticsPolicy>
+double DTWDistance<ObjectType, StatisticsPolicy>::getLowerBoundKeogh(ObjectType &obj1, const std::vector<double> &upper,
+                                                                   const std::vector<double> &lower, double bound){
+
+    size_t n = obj1.size();
+    double limit = bound * bound;
+    double d = 0.0;
+    double diff, value;
+
+    if ((upper.size() != n) || (lower.size() != n)){
+        throw std::length_error("The feature vector and the envelope do not have the same size.");
+    }
+
+    for (size_t i = 0; (i < n) && (d <= limit); i++){
+        value = obj1[i];
+        if (value > upper[i]){
+            diff = value - upper[i];
+            d += diff * diff;
+        }else if (value < lower[i]){
+            diff = lower[i] - value;
+            d += diff * diff;
+        }
+    }
 
-    return d;
+    return sqrt(d);
 }
 
+/**
+* Calculates the LB_Keogh lower bound of the Dynamic Time Warping distance
+* between two series of the same size.
+*
+* @param obj1: The first feature vector.
+* @param obj2: The second feature vector, whose envelope is computed.
+* @throw Exception If the sizes do not match.
+* @return A lower bound of the DTW distance between feature vector 1 and
+* feature vector 2.
+*/
+template <class ObjectType, class StatisticsPolicy>
+double DTWDistance<ObjectType, StatisticsPolicy>::getLowerBoundKeogh(ObjectType &obj1, ObjectType &obj2){
+
+    std::vector<double> upper, lower;
+
+    computeEnvelope(obj2, upper, lower);
+    return getLowerBoundKeogh(obj1, upper, lower);
+}
@@ -23,24 +23,90 @@
 #define DTWDISTANCE_HPP
 
 #include "DistanceFunction.h"
+#include <algorithm>
 #include <cmath>
+#include <deque>
+#include <stdexcept>
+#include <vector>
 
 /**
-* Class to obtain the Dynamic Time Warping Distance
+* Value of the window that does not constrain the warping path.
+*/
+#define DTWDISTANCE_NOWINDOW ((size_t) -1)
+
+/**
+* Class to obtain the Dynamic Time Warping Distance.
+*
+* <P>The warping path may be constrained by a Sakoe-Chiba band: element i of
+* the first series is only aligned with the elements j of the second one such
+* that |i - j| <= window. The window is widened to the difference between the
+* sizes of the series when it is smaller, so a path always exists. Only the
+* cells inside the band are computed and only two rows of the warping matrix
+* are kept. They are allocated by each call, so an instance may be shared by
+* concurrent queries.
+*
+* <P>The lower bounds LB_Kim and LB_Keogh are cheaper than the distance and
+* never greater than it. getDistanceBounded() checks them before the full
+* computation, and they are also available to be called directly. The
+* envelope of a query sample may be computed once by prepareQuery() and
+* reused by every bounded distance to it.
 *
 * @brief DTW distance class.
 * @author 011
 * @version 1.0.
 */
-template <class ObjectType>
-class DTWDistance : public DistanceFunction <ObjectType>{
+template <class ObjectType, class StatisticsPolicy = DistanceFunctionStatistics>
+class DTWDistance final : public DistanceFunction<ObjectType, StatisticsPolicy>{
+
+    private:
+        //The Sakoe-Chiba window
+        size_t window;
+
+        size_t getEffectiveWindow(size_t size1, size_t size2);
+        double computeDistance(ObjectType &obj1, ObjectType &obj2, double bound,
+                               const std::vector<double> *upper2, const std::vector<double> *lower2);
 
     public:
-        DTWDistance();
+        /**
+        * The data of a query sample computed by prepareQuery().
+        */
+        class PreparedQuery{
+            public:
+                //The query sample
+                ObjectType *sample;
+                //The envelope of the sample and the window it was computed with
+                std::vector<double> upper;
+                std::vector<double> lower;
+                size_t window;
+        };
+
+        DTWDistance(size_t window = DTWDISTANCE_NOWINDOW);
         ~DTWDistance();
 
-        double GetDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error);
-        double getDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error);
+        size_t getWindow();
+        void setWindow(size_t window);
+
+        double GetDistance(ObjectType &obj1, ObjectType &obj2);
+        double getDistance(ObjectType &obj1, ObjectType &obj2);
+
+        double GetDistanceBounded(ObjectType &obj1, ObjectType &obj2, double bound);
+        double getDistanceBounded(ObjectType &obj1, ObjectType &obj2, double bound);
+
+        void PrepareQuery(ObjectType &query, PreparedQuery &prepared);
+        void prepareQuery(ObjectType &query, PreparedQuery &prepared);
+
+        double GetDistance(ObjectType &obj, PreparedQuery &query);
+        double getDistance(ObjectType &obj, PreparedQuery &query);
+
+        double GetDistanceBounded(ObjectType &obj, PreparedQuery &query, double bound);
+        double getDistanceBounded(ObjectType &obj, PreparedQuery &query, double bound);
+
+        double getLowerBoundKim(ObjectType &obj1, ObjectType &obj2);
+
+        void computeEnvelope(ObjectType &obj, std::vector<double> &upper, std::vector<double> &lower);
+        double getLowerBoundKeogh(ObjectType &obj1, const std::vector<double> &upper,
+                                  const std::vector<double> &lower, double bound = HUGE_VAL);
+        double getLowerBoundKeogh(ObjectType &obj1, ObjectType &obj2);
 };
 
 #include "DTWDistance-inl.h"
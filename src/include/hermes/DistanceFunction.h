@@ -37,10 +37,22 @@
 * the number of distances calculated WHEN IT IS REQUIRED (it is not used by the
 * Structure Layer).
 *
-* <p>The implementation of this feature has no standard interface and may be
-* implemented freely but to make the implementation easier, there
-* is a class called DistanceFunctionStatistics that implements the basic
-* functions necessary to accomplish this task.
+* <p>The counter is provided by the StatisticsPolicy template argument, which
+* is also the base class of this class. The default policy,
+* DistanceFunctionStatistics, counts every distance. NoDistanceFunctionStatistics
+* counts nothing, so it costs nothing inside the query loops of the trees.
+*
+* <p>All distance functions of Hermes are declared final. A metric tree holds
+* its evaluator by its concrete type (EvaluatorType), so the compiler calls
+* GetDistance() directly and is able to inline it.
+*
+* <p>A distance function that derives data from the sample of a query (ranks,
+* envelopes, integrals...) may declare a nested type PreparedQuery and the
+* methods prepareQuery(query, prepared) and getDistance(obj, prepared). Before a
+* query evaluates its sample against many objects, a metric tree fills one
+* PreparedQuery and computes the distances to the sample through it. The
+* prepared data is owned by the query, so the distance function is not
+* modified and many queries may use it at the same time.
 *
 * <P>This class may be used as the base class for classes that implements the
 * metric evaluators which will be used by a metric tree to compute distances
@@ -52,19 +64,15 @@
 * @author Marcos Rodrigues Vieira (mrvieira@icmc.usp.br)
 * @date 29-10-2014
 * @see DistanceFunctionStatistics
+* @see NoDistanceFunctionStatistics
 */
 
 #include <cmath>
 #include <cstdlib>
+#include "DistanceFunctionStatistics.h"
 
-template <class ObjectType>
-class DistanceFunction{
-
-    protected:
-        /**
-        * The distance counter itself.
-        */
-        u_int32_t distCount;
+template <class ObjectType, class StatisticsPolicy = DistanceFunctionStatistics>
+class DistanceFunction : public StatisticsPolicy{
 
     public:
 
@@ -72,8 +80,7 @@ class DistanceFunction{
         * Constructor.
         * @param d Internal statistics of distance function.
         */
-        DistanceFunction(u_int32_t d = 0){
-            distCount = d;
+        DistanceFunction(u_int32_t d = 0) : StatisticsPolicy(d){
         }
 
         /**
@@ -100,68 +107,63 @@ class DistanceFunction{
         virtual double getDistance(ObjectType & obj1, ObjectType & obj2) = 0;
 
         /**
-        * Overload on operator to set statistics on a new operator.
+        * This method calculates the metric distance between 2 objects when
+        * it is not greater than bound. The metric trees only need to know
+        * whether a distance qualifies, so an implementation may stop as soon
+        * as the distance is known to exceed bound and return any value
+        * greater than bound. This default implementation computes the whole
+        * distance.
         *
-        * @param evaluator The evaluator statistics to be set.
-        * @return The DF with new statistics.
-        */
-        DistanceFunction& operator=(const DistanceFunction& evaluator){
-
-            distCount = evaluator.getDistanceCount();
-            return *this;
-        }
-      
-
-        /**
-        * @deprecated Use resetStatistics() instead.
-        * Resets statistics.
-        */
-        void ResetStatistics(){
-
-            resetStatistics();
-        }
-
-        /**
-        * @copydoc ResetStatistics() .
-        */
-        void resetStatistics(){
-
-            distCount = 0;
-        }
-        /**
-        * @copydoc getDistanceCount() .
+        * @deprecated Use getDistanceBounded() instead.
+        *
+        * @param obj1 Object 1.
+        * @param obj2 Object 2.
+        * @param bound The greatest distance of interest.
+        * @return The distance between the objects if it is not greater than
+        * bound, or a value greater than bound otherwise.
         */
-        u_int32_t GetDistanceCount() {
-
-            return getDistanceCount();
+        virtual double GetDistanceBounded(ObjectType & obj1, ObjectType & obj2, double bound){
+            return getDistanceBounded(obj1, obj2, bound);
         }
 
         /**
-        * Returns the number of distances performed.
-        * @deprecated use getDistanceCount() instead.
-        * @return Returns the number of distances performed.
+        * @copydoc GetDistanceBounded(ObjectType & obj1, ObjectType & obj2, double bound) .
         */
-        u_int32_t getDistanceCount() {
-            return distCount;
+        virtual double getDistanceBounded(ObjectType & obj1, ObjectType & obj2, double){
+            return getDistance(obj1, obj2);
         }
 
         /**
-        * @copydoc UpdateDistanceCount() .
+        * This method calculates the metric distances between the sample of a
+        * query and n objects, usually the entries of a node that were not
+        * pruned by the metric tree. As in getDistanceBounded(), a distance
+        * greater than bound may be replaced by any value greater than bound.
+        * This default implementation calls getDistanceBounded() for each
+        * object, but an implementation may evaluate the objects together.
+        *
+        * @deprecated Use getDistances() instead.
+        *
+        * @param query The query sample.
+        * @param entries The n objects.
+        * @param n The number of objects.
+        * @param distances The n distances (output). distances[i] is the
+        * distance between entries[i] and query.
+        * @param bound The greatest distance of interest.
         */
-        void UpdateDistanceCount(){
-
-            updateDistanceCount();
+        virtual void GetDistances(ObjectType & query, ObjectType ** entries, size_t n,
+                                  double * distances, double bound = HUGE_VAL){
+            getDistances(query, entries, n, distances, bound);
         }
 
         /**
-        * Updates the distance counter by adding 1.
-        * @deprecated use updateDistanceCount() instead.
+        * @copydoc GetDistances(ObjectType & query, ObjectType ** entries, size_t n, double * distances, double bound) .
         */
-        void updateDistanceCount(){
-
-            distCount++;
+        virtual void getDistances(ObjectType & query, ObjectType ** entries, size_t n,
+                                  double * distances, double bound = HUGE_VAL){
+            for (size_t i = 0; i < n; i++){
+                distances[i] = getDistanceBounded(*entries[i], query, bound);
+            }
         }
 
-   
 };//end DistanceFunction
 #endif //__DistanceFunction_H
@@ -0,0 +1,165 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+* 
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+* 
+* 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+* 
+* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+* 
+* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**
+* @file
+*
+* This file defines the statistics policies of the distance functions.
+*
+* @version 1.0
+*/
+
+#ifndef __DistanceFunctionStatistics_H
+#define __DistanceFunctionStatistics_H
+
+#include <sys/types.h>
+
+/**
+* This class counts the number of distances calculated by a distance function.
+* It is the default statistics policy of all distance functions of Hermes.
+*
+* @version 1.0
+* @ingroup userinterface
+* @see NoDistanceFunctionStatistics
+*/
+class DistanceFunctionStatistics{
+
+    protected:
+        /**
+        * The distance counter itself.
+        */
+        u_int32_t distCount;
+
+    public:
+
+        /**
+        * Constructor.
+        * @param d Initial value of the distance counter.
+        */
+        DistanceFunctionStatistics(u_int32_t d = 0){
+            distCount = d;
+        }
+
+        /**
+        * @deprecated Use resetStatistics() instead.
+        * Resets statistics.
+        */
+        void ResetStatistics(){
+
+            resetStatistics();
+        }
+
+        /**
+        * Resets statistics.
+        */
+        void resetStatistics(){
+
+            distCount = 0;
+        }
+
+        /**
+        * @copydoc getDistanceCount() .
+        */
+        u_int32_t GetDistanceCount() {
+
+            return getDistanceCount();
+        }
+
+        /**
+        * Returns the number of distances performed.
+        * @return Returns the number of distances performed.
+        */
+        u_int32_t getDistanceCount() {
+            return distCount;
+        }
+
+        /**
+        * @copydoc updateDistanceCount() .
+        */
+        void UpdateDistanceCount(){
+
+            updateDistanceCount();
+        }
+
+        /**
+        * Updates the distance counter by adding 1.
+        */
+        void updateDistanceCount(){
+
+            distCount++;
+        }
+};//end DistanceFunctionStatistics
+
+/**
+* This class is a statistics policy that does not count anything. A distance
+* function built with it has no counter to update, so the compiler may inline
+* it into the loops of the metric trees at no extra cost. The distance count
+* is always 0.
+*
+* @version 1.0
+* @ingroup userinterface
+* @see DistanceFunctionStatistics
+*/
+class NoDistanceFunctionStatistics{
+
+    public:
+
+        /**
+        * Constructor.
+        * The argument is ignored.
+        */
+        NoDistanceFunctionStatistics(u_int32_t = 0){
+        }
+
+        /**
+        * @deprecated Use resetStatistics() instead.
+        * Does nothing.
+        */
+        void ResetStatistics(){
+        }
+
+        /**
+        * Does nothing.
+        */
+        void resetStatistics(){
+        }
+
+        /**
+        * @copydoc getDistanceCount() .
+        */
+        u_int32_t GetDistanceCount() {
+
+            return 0;
+        }
+
+        /**
+        * Returns 0, this policy does not count distances.
+        * @return Always 0.
+        */
+        u_int32_t getDistanceCount() {
+            return 0;
+        }
+
+        /**
+        * Does nothing.
+        */
+        void UpdateDistanceCount(){
+        }
+
+        /**
+        * Does nothing.
+        */
+        void updateDistanceCount(){
+        }
+};//end NoDistanceFunctionStatistics
+
+#endif //__DistanceFunctionStatistics_H
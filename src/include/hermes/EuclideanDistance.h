@@ -23,6 +23,8 @@
 #define EUCLIDEANDISTANCE_H
 
 #include "DistanceFunction.h"
+#include "LpKernels.h"
+#include "QuantizedBounds.h"
 #include <cmath>
 #include <stdexcept>
 
@@ -33,16 +35,57 @@
 * @author 006.
 * @version 1.0.
 */
-template <class ObjectType>
-class EuclideanDistance : public DistanceFunction <ObjectType>{
+template <class ObjectType, class StatisticsPolicy = DistanceFunctionStatistics>
+class EuclideanDistance final : public DistanceFunction<ObjectType, StatisticsPolicy>{
+
+    private:
+        //The quantized copies kept by the leaves of a tree
+        QuantizedBounds leafCodes;
 
     public:
 
         EuclideanDistance();
         virtual ~EuclideanDistance();
 
-        double GetDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error);
-        double getDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error);
+        double GetDistance(ObjectType &obj1, ObjectType &obj2);
+        double getDistance(ObjectType &obj1, ObjectType &obj2);
+
+        template <class ViewType>
+        double GetDistance(ViewType &obj1, ObjectType &obj2);
+        template <class ViewType>
+        double getDistance(ViewType &obj1, ObjectType &obj2);
+
+        double GetDistanceBounded(ObjectType &obj1, ObjectType &obj2, double bound);
+        double getDistanceBounded(ObjectType &obj1, ObjectType &obj2, double bound);
+
+        template <class ViewType>
+        double GetDistanceBounded(ViewType &obj1, ObjectType &obj2, double bound);
+        template <class ViewType>
+        double getDistanceBounded(ViewType &obj1, ObjectType &obj2, double bound);
+
+        void GetDistances(ObjectType &query, ObjectType **entries, size_t n, double *distances, double bound = HUGE_VAL);
+        void getDistances(ObjectType &query, ObjectType **entries, size_t n, double *distances, double bound = HUGE_VAL);
+
+        template <class ViewType>
+        void GetDistances(ObjectType &query, ViewType **entries, size_t n, double *distances, double bound = HUGE_VAL);
+        template <class ViewType>
+        void getDistances(ObjectType &query, ViewType **entries, size_t n, double *distances, double bound = HUGE_VAL);
+
+        template <class DType>
+        void GetDistances(ObjectType &query, const DType *candidates, size_t count, double *distances);
+        template <class DType>
+        void getDistances(ObjectType &query, const DType *candidates, size_t count, double *distances);
+
+        void setLeafCodes(int layout, size_t dimensions);
+
+        u_int32_t GetLeafCodeSize();
+        u_int32_t getLeafCodeSize();
+
+        void EncodeLeaf(ObjectType &obj, u_char *code);
+        void encodeLeaf(ObjectType &obj, u_char *code);
+
+        double GetLeafBound(const u_char *code, ObjectType &obj, double bound);
+        double getLeafBound(const u_char *code, ObjectType &obj, double bound);
 };
 
 #include "EuclideanDistance-inl.h"
@@ -13,7 +13,11 @@
 #ifndef HERMES_H
 #define HERMES_H
 
+#include "DistanceFunctionStatistics.h"
 #include "DistanceFunction.h"
+#include "LpKernels.h"
+#include "HistogramKernels.h"
+#include "QuantizedBounds.h"
 
 #include "MetricHistogramDistance.h"
 #include "WarpDistance.h"
@@ -0,0 +1,285 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+* 
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+* 
+* 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+* 
+* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+* 
+* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**
+* @file
+*
+* This file defines the vectorized kernels of the histogram divergences.
+*
+* @version 1.0
+*/
+
+#ifndef HISTOGRAMKERNELS_H
+#define HISTOGRAMKERNELS_H
+
+#include "LpKernels.h"
+
+/**
+* This class holds the kernels of the histogram divergences. They read the
+* transforms kept by HistogramObject (the bins as double and their
+* logarithms), so no log() or sqrt() is evaluated by them:
+* <ul>
+* <li>chiSquare(): the sum of (x[i] - y[i])^2 / (x[i] + y[i]);</li>
+* <li>brayCurtis(): the sum of |x[i] - y[i]| / (x[i] + y[i]);</li>
+* <li>kullbackLeibler(): the sum of x[i] * (log x[i] - log y[i]).</li>
+* </ul>
+* The bins whose denominator is 0 (or, for kullbackLeibler(), where x[i] or
+* y[i] is 0) add nothing, as in the scalar loops of the distance functions.
+* The squared chord distance is the L2 kernel over the square roots (see
+* LpKernels).
+*
+* <p>On x86 the kernels are compiled for AVX2. The first call checks the CPU
+* and selects them if it is supported. The other processors use the scalar
+* kernels.
+*
+* @brief Vectorized histogram kernels.
+* @version 1.0
+*/
+class HistogramKernels{
+
+    public:
+
+        /**
+        * Signature of a kernel over two vectors.
+        */
+        typedef double (*tKernel)(const double *x, const double *y, size_t n);
+
+        /**
+        * Signature of a kernel over two vectors and their logarithms.
+        */
+        typedef double (*tLogKernel)(const double *x, const double *lx,
+                const double *y, const double *ly, size_t n);
+
+        /**
+        * Returns the sum of (x[i] - y[i])^2 / (x[i] + y[i]).
+        * @param x The first vector.
+        * @param y The second vector.
+        * @param n The number of elements.
+        */
+        static double chiSquare(const double *x, const double *y, size_t n){
+            return getTable().ChiSquare(x, y, n);
+        }
+
+        /**
+        * Returns the sum of |x[i] - y[i]| / (x[i] + y[i]).
+        * @param x The first vector.
+        * @param y The second vector.
+        * @param n The number of elements.
+        */
+        static double brayCurtis(const double *x, const double *y, size_t n){
+            return getTable().BrayCurtis(x, y, n);
+        }
+
+        /**
+        * Returns the sum of x[i] * (lx[i] - ly[i]).
+        * @param x The first vector.
+        * @param lx The logarithms of the first vector.
+        * @param y The second vector.
+        * @param ly The logarithms of the second vector.
+        * @param n The number of elements.
+        */
+        static double kullbackLeibler(const double *x, const double *lx,
+                const double *y, const double *ly, size_t n){
+            return getTable().KullbackLeibler(x, lx, y, ly, n);
+        }
+
+        /**
+        * Returns the name of the instruction set selected for this CPU
+        * ("avx2" or "scalar").
+        */
+        static const char *getInstructionSet(){
+            return getTable().Name;
+        }
+
+    private:
+
+        /**
+        * The kernels selected for this CPU.
+        */
+        struct tTable{
+            tKernel ChiSquare;
+            tKernel BrayCurtis;
+            tLogKernel KullbackLeibler;
+            const char *Name;
+        };
+
+        /**
+        * Returns the kernels selected for this CPU. The selection is done
+        * once.
+        */
+        static const tTable &getTable(){
+            static const tTable table = selectTable();
+            return table;
+        }
+
+        /**
+        * Selects the kernels for this CPU.
+        */
+        static tTable selectTable(){
+            tTable table = {scalarChiSquare, scalarBrayCurtis, scalarKullbackLeibler, "scalar"};
+
+            #ifdef LPKERNELS_X86
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2")){
+                table.ChiSquare = avx2ChiSquare;
+                table.BrayCurtis = avx2BrayCurtis;
+                table.KullbackLeibler = avx2KullbackLeibler;
+                table.Name = "avx2";
+            }
+            #endif //LPKERNELS_X86
+            return table;
+        }
+
+        static double scalarChiSquare(const double *x, const double *y, size_t n){
+            return scalarChiSquare(x, y, 0, n, 0);
+        }
+
+        static double scalarChiSquare(const double *x, const double *y, size_t i, size_t n, double d){
+            double tmp;
+
+            for (; i < n; i++){
+                tmp = x[i] + y[i];
+                if (tmp != 0.0){
+                    d = d + (((x[i] - y[i]) * (x[i] - y[i])) / tmp);
+                }
+            }
+            return d;
+        }
+
+        static double scalarBrayCurtis(const double *x, const double *y, size_t n){
+            return scalarBrayCurtis(x, y, 0, n, 0);
+        }
+
+        static double scalarBrayCurtis(const double *x, const double *y, size_t i, size_t n, double d){
+            double tmp;
+
+            for (; i < n; i++){
+                tmp = x[i] + y[i];
+                if (tmp != 0.0){
+                    d = d + (fabs(x[i] - y[i]) / tmp);
+                }
+            }
+            return d;
+        }
+
+        static double scalarKullbackLeibler(const double *x, const double *lx,
+                const double *y, const double *ly, size_t n){
+            return scalarKullbackLeibler(x, lx, y, ly, 0, n, 0);
+        }
+
+        static double scalarKullbackLeibler(const double *x, const double *lx,
+                const double *y, const double *ly, size_t i, size_t n, double d){
+            for (; i < n; i++){
+                if ((x[i] != 0.0) && (y[i] != 0.0)){
+                    d = d + (x[i] * (lx[i] - ly[i]));
+                }
+            }
+            return d;
+        }
+
+        #ifdef LPKERNELS_X86
+        //----------------------------------------------------------------------
+        // AVX2: 4 doubles per register.
+        //----------------------------------------------------------------------
+        __attribute__((target("avx2")))
+        static double avx2Sum(__m256d v){
+            __m128d sum = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+
+            return _mm_cvtsd_f64(_mm_add_sd(sum, _mm_unpackhi_pd(sum, sum)));
+        }
+
+        __attribute__((target("avx2")))
+        static double avx2ChiSquare(const double *x, const double *y, size_t n){
+            const __m256d zero = _mm256_setzero_pd();
+            __m256d sum = _mm256_setzero_pd();
+            __m256d vx, vy, den, dif;
+            size_t i = 0;
+
+            for (; i + 4 <= n; i += 4){
+                vx = _mm256_loadu_pd(x + i);
+                vy = _mm256_loadu_pd(y + i);
+                den = _mm256_add_pd(vx, vy);
+                dif = _mm256_sub_pd(vx, vy);
+                // The empty bins give NaN, which the mask clears
+                sum = _mm256_add_pd(sum, _mm256_and_pd(_mm256_cmp_pd(den, zero, _CMP_NEQ_OQ),
+                        _mm256_div_pd(_mm256_mul_pd(dif, dif), den)));
+            }
+            return scalarChiSquare(x, y, i, n, avx2Sum(sum));
+        }
+
+        __attribute__((target("avx2")))
+        static double avx2BrayCurtis(const double *x, const double *y, size_t n){
+            const __m256d zero = _mm256_setzero_pd();
+            const __m256d sign = _mm256_set1_pd(-0.0);
+            __m256d sum = _mm256_setzero_pd();
+            __m256d vx, vy, den;
+            size_t i = 0;
+
+            for (; i + 4 <= n; i += 4){
+                vx = _mm256_loadu_pd(x + i);
+                vy = _mm256_loadu_pd(y + i);
+                den = _mm256_add_pd(vx, vy);
+                sum = _mm256_add_pd(sum, _mm256_and_pd(_mm256_cmp_pd(den, zero, _CMP_NEQ_OQ),
+                        _mm256_div_pd(_mm256_andnot_pd(sign, _mm256_sub_pd(vx, vy)), den)));
+            }
+            return scalarBrayCurtis(x, y, i, n, avx2Sum(sum));
+        }
+
+        __attribute__((target("avx2")))
+        static double avx2KullbackLeibler(const double *x, const double *lx,
+                const double *y, const double *ly, size_t n){
+            const __m256d zero = _mm256_setzero_pd();
+            __m256d sum = _mm256_setzero_pd();
+            __m256d vx, vy, mask;
+            size_t i = 0;
+
+            for (; i + 4 <= n; i += 4){
+                vx = _mm256_loadu_pd(x + i);
+                vy = _mm256_loadu_pd(y + i);
+                mask = _mm256_and_pd(_mm256_cmp_pd(vx, zero, _CMP_NEQ_OQ),
+                        _mm256_cmp_pd(vy, zero, _CMP_NEQ_OQ));
+                sum = _mm256_add_pd(sum, _mm256_and_pd(mask, _mm256_mul_pd(vx,
+                        _mm256_sub_pd(_mm256_loadu_pd(lx + i), _mm256_loadu_pd(ly + i)))));
+            }
+            return scalarKullbackLeibler(x, lx, y, ly, i, n, avx2Sum(sum));
+        }
+        #endif //LPKERNELS_X86
+};//end HistogramKernels
+
+/**
+* This class template tells whether two histogram types keep the transforms
+* read by HistogramKernels: getValueData(), getLogData() and getSqrtData()
+* (see HistogramObject).
+*
+* @arg Type1 The type of the first histogram.
+* @arg Type2 The type of the second histogram.
+* @version 1.0
+*/
+template <class Type1, class Type2, class Enable = void>
+class HistogramKernelTraits{
+    public:
+        static const bool Supported = false;
+};
+
+template <class Type1, class Type2>
+class HistogramKernelTraits<Type1, Type2, std::void_t<
+        decltype(std::declval<const Type1 &>().getValueData()),
+        decltype(std::declval<const Type1 &>().getLogData()),
+        decltype(std::declval<const Type1 &>().getSqrtData()),
+        decltype(std::declval<const Type2 &>().getValueData()),
+        decltype(std::declval<const Type2 &>().getLogData()),
+        decltype(std::declval<const Type2 &>().getSqrtData())> >{
+    public:
+        static const bool Supported = true;
+};
+
+#endif //HISTOGRAMKERNELS_H
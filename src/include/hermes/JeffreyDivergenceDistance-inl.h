@@ -13,15 +13,15 @@
 /**
 * Constructor.
 */
-template <class ObjectType>
-JeffreyDivergenceDistance<ObjectType>::JeffreyDivergenceDistance(){
+template <class ObjectType, class StatisticsPolicy>
+JeffreyDivergenceDistance<ObjectType, StatisticsPolicy>::JeffreyDivergenceDistance(){
 }
 
 /**
 * Destructor.
 */
-template <class ObjectType>
-JeffreyDivergenceDistance<ObjectType>::~JeffreyDivergenceDistance(){
+template <class ObjectType, class StatisticsPolicy>
+JeffreyDivergenceDistance<ObjectType, StatisticsPolicy>::~JeffreyDivergenceDistance(){
 }
 
 /**
@@ -29,8 +29,8 @@ JeffreyDivergenceDistance<ObjectType>::~JeffreyDivergenceDistance(){
 *
 * @copydoc getDistance(ObjectType &obj1, ObjectType &obj2) .
 */
-template <class ObjectType>
-double JeffreyDivergenceDistance<ObjectType>::GetDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error){
+template <class ObjectType, class StatisticsPolicy>
+double JeffreyDivergenceDistance<ObjectType, StatisticsPolicy>::GetDistance(ObjectType &obj1, ObjectType &obj2){
 
     return getDistance(obj1, obj2);
 }
@@ -44,12 +44,35 @@ double JeffreyDivergenceDistance<ObjectType>::GetDistance(ObjectType &obj1, Obje
 *
 * @return The distance between feature vector 1 and feature vector 2.
 */
-template <class ObjectType>
-double JeffreyDivergenceDistance<ObjectType>::getDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error){
+template <class ObjectType, class StatisticsPolicy>
+double JeffreyDivergenceDistance<ObjectType, StatisticsPolicy>::getDistance(ObjectType &obj1, ObjectType &obj2){
 
     if (obj1.size() != obj2.size())
         throw std::length_error ("The feature vectors do not have the same size.");
 
+    if constexpr (HistogramKernelTraits<ObjectType, ObjectType>::Supported){
+        const double *a = obj1.getValueData();
+        const double *la = obj1.getLogData();
+        const double *b = obj2.getValueData();
+        const double *lb = obj2.getLogData();
+        double m, lm;
+        double d = 0.0;
+
+        // Only the logarithm of the mean is evaluated, the empty bins add 0
+        for (size_t i = 0; i < obj1.size(); i++){
+            m = (a[i] + b[i]) / 2;
+            if (m != 0.0){
+                lm = log(m);
+                d = d + (a[i] * (la[i] - lm)) + (b[i] * (lb[i] - lm));
+            }
+        }
+
+        // Statistic support
+        this->updateDistanceCount();
+
+        return d;
+    }
+
     double d = 0.0;
     double tmp;
     double mi, ai, bi;
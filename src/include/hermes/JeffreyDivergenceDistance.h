@@ -24,6 +24,7 @@
 #define JEFFREYDIVERGENCEDISTANCE_H
 
 #include "DistanceFunction.h"
+#include "HistogramKernels.h"
 #include <cmath>
 #include <stdexcept>
 
@@ -34,16 +35,16 @@
 * @author 006.
 * @version 1.0.
 */
-template <class ObjectType>
-class JeffreyDivergenceDistance : public DistanceFunction <ObjectType>{
+template <class ObjectType, class StatisticsPolicy = DistanceFunctionStatistics>
+class JeffreyDivergenceDistance final : public DistanceFunction<ObjectType, StatisticsPolicy>{
 
     public:
 
         JeffreyDivergenceDistance();
         virtual ~JeffreyDivergenceDistance();
 
-        double GetDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error);
-        double getDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error);
+        double GetDistance(ObjectType &obj1, ObjectType &obj2);
+        double getDistance(ObjectType &obj1, ObjectType &obj2);
 };
 
 #include "JeffreyDivergenceDistance-inl.h"
@@ -13,15 +13,15 @@
 /**
 * Constructor.
 */
-template <class ObjectType>
-KullbackLeiblerDivergenceDistance<ObjectType>::KullbackLeiblerDivergenceDistance(){
+template <class ObjectType, class StatisticsPolicy>
+KullbackLeiblerDivergenceDistance<ObjectType, StatisticsPolicy>::KullbackLeiblerDivergenceDistance(){
 }
 
 /**
 * Destructor.
 */
-template <class ObjectType>
-KullbackLeiblerDivergenceDistance<ObjectType>::~KullbackLeiblerDivergenceDistance(){
+template <class ObjectType, class StatisticsPolicy>
+KullbackLeiblerDivergenceDistance<ObjectType, StatisticsPolicy>::~KullbackLeiblerDivergenceDistance(){
 }
 
 /**
@@ -29,8 +29,8 @@ KullbackLeiblerDivergenceDistance<ObjectType>::~KullbackLeiblerDivergenceDistanc
 *
 * @copydoc getDistance(ObjectType &obj1, ObjectType &obj2) .
 */
-template <class ObjectType>
-double KullbackLeiblerDivergenceDistance<ObjectType>::GetDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error){
+template <class ObjectType, class StatisticsPolicy>
+double KullbackLeiblerDivergenceDistance<ObjectType, StatisticsPolicy>::GetDistance(ObjectType &obj1, ObjectType &obj2){
 
     return getDistance(obj1, obj2);
 }
@@ -44,12 +44,22 @@ double KullbackLeiblerDivergenceDistance<ObjectType>::GetDistance(ObjectType &ob
 * @throw Exception If the computation is not possible.
 * @return The distance between feature vector 1 and feature vector 2.
 */
-template <class ObjectType>
-double KullbackLeiblerDivergenceDistance<ObjectType>::getDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error){
+template <class ObjectType, class StatisticsPolicy>
+double KullbackLeiblerDivergenceDistance<ObjectType, StatisticsPolicy>::getDistance(ObjectType &obj1, ObjectType &obj2){
 
     if (obj1.size() != obj2.size())
         throw std::length_error("The feature vectors do not have the same size.");
 
+    if constexpr (HistogramKernelTraits<ObjectType, ObjectType>::Supported){
+        double d = HistogramKernels::kullbackLeibler(obj1.getValueData(), obj1.getLogData(),
+                obj2.getValueData(), obj2.getLogData(), obj1.size());
+
+        // Statistic support
+        this->updateDistanceCount();
+
+        return d;
+    }
+
     double d = 0.0;
     double tmp;
     double Xi, Yi;
@@ -23,6 +23,7 @@
 #define KULLBACKLEIBLERDIVERGENCEDISTANCE_H
 
 #include "DistanceFunction.h"
+#include "HistogramKernels.h"
 #include <cmath>
 #include <stdexcept>
 
@@ -36,16 +37,16 @@
 * @date 10-13-2014
 * @version 1.0.
 */
-template <class ObjectType>
-class KullbackLeiblerDivergenceDistance : public DistanceFunction <ObjectType>{
+template <class ObjectType, class StatisticsPolicy = DistanceFunctionStatistics>
+class KullbackLeiblerDivergenceDistance final : public DistanceFunction<ObjectType, StatisticsPolicy>{
 
     public:
 
         KullbackLeiblerDivergenceDistance();
         virtual ~KullbackLeiblerDivergenceDistance();
 
-        double GetDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error);
-        double getDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error);
+        double GetDistance(ObjectType &obj1, ObjectType &obj2);
+        double getDistance(ObjectType &obj1, ObjectType &obj2);
 };
 
 #include "KullbackLeiblerDivergenceDistance-inl.h"
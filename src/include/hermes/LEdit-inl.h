@@ -13,15 +13,15 @@
 /**
 * Constructor.
 */
-template <class ObjectType>
-LEditDistance<ObjectType>::LEditDistance(){
+template <class ObjectType, class StatisticsPolicy>
+LEditDistance<ObjectType, StatisticsPolicy>::LEditDistance(){
 }
 
 /**
 * Destructor.
 */
-template <class ObjectType>
-LEditDistance<ObjectType>::~LEditDistance(){
+template <class ObjectType, class StatisticsPolicy>
+LEditDistance<ObjectType, StatisticsPolicy>::~LEditDistance(){
 }
 
 /**
@@ -29,8 +29,8 @@ LEditDistance<ObjectType>::~LEditDistance(){
 *
 * @copydoc getDistance(ObjectType &obj1, ObjectType &obj2) .
 */
-template <class ObjectType>
-double LEditDistance<ObjectType>::GetDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error){
+template <class ObjectType, class StatisticsPolicy>
+double LEditDistance<ObjectType, StatisticsPolicy>::GetDistance(ObjectType &obj1, ObjectType &obj2){
 
     return getDistance(obj1, obj2);
 }
@@ -42,42 +42,234 @@ double LEditDistance<ObjectType>::GetDistance(ObjectType &obj1, ObjectType &obj2
 * @param obj2: The second word.
 * @return The LEdit distance between feature word 1 and word 2.
 */
-template <class ObjectType>
-double LEditDistance<ObjectType>::getDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error){
+template <class ObjectType, class StatisticsPolicy>
+double LEditDistance<ObjectType, StatisticsPolicy>::getDistance(ObjectType &obj1, ObjectType &obj2){
 
-    char aux1, aux2;
-    unsigned int cost;
-    int **diff;
+    return getDistanceBounded(obj1, obj2, HUGE_VAL);
+}
 
-    diff = new int*[obj2.size() + 1];
-    for (int i = 0; i < obj2.size() + 1; i++)
-        diff[i] = new int[obj1.size() + 1];
+/**
+* @deprecated Use getDistanceBounded(ObjectType &obj1, ObjectType &obj2, double bound) instead.
+*
+* @copydoc getDistanceBounded(ObjectType &obj1, ObjectType &obj2, double bound) .
+*/
+template <class ObjectType, class StatisticsPolicy>
+double LEditDistance<ObjectType, StatisticsPolicy>::GetDistanceBounded(ObjectType &obj1, ObjectType &obj2, double bound){
 
-    // Initialize
-    diff[0][0] = 0;
-    for (size_t i = 1; i <= obj1.size(); i++){
-        diff[i][0] = i;
+    return getDistanceBounded(obj1, obj2, bound);
+}
+
+/**
+* Calculates the LEdit distance between two words if it is not greater than
+* bound. The calculation stops as soon as the cost of the last row of the
+* edit matrix, minus the number of characters not processed yet, exceeds the
+* bound.
+*
+* @param obj1: The first word.
+* @param obj2: The second word.
+* @param bound: The greatest distance of interest.
+* @return The LEdit distance between word 1 and word 2 if it is not greater
+* than bound, or a value greater than bound otherwise.
+*/
+template <class ObjectType, class StatisticsPolicy>
+double LEditDistance<ObjectType, StatisticsPolicy>::getDistanceBounded(ObjectType &obj1, ObjectType &obj2, double bound){
+
+    this->updateDistanceCount();
+
+    if constexpr (sizeof(CharType) == 1){
+        ObjectType &pattern = (obj1.size() <= obj2.size()) ? obj1 : obj2;
+        ObjectType &text = (obj1.size() <= obj2.size()) ? obj2 : obj1;
+
+        // The distance is never smaller than the difference of the sizes
+        if (pattern.size() == 0 || (double) (text.size() - pattern.size()) > bound){
+            return text.size() - pattern.size();
+        }else if (pattern.size() <= 64){
+            return getBitParallelDistance(pattern, text, bound);
+        }else{
+            return getBlockedDistance(pattern, text, bound);
+        }
+    }else{
+        return getDynamicDistance(obj1, obj2, bound);
+    }
+}
+
+/**
+* Calculates the LEdit distance of a pattern with 1 to 64 characters to a
+* text that is not shorter.
+*
+* @param pattern: The shorter word.
+* @param text: The longer word.
+* @param bound: The greatest distance of interest.
+* @return The LEdit distance if it is not greater than bound, or a value
+* greater than bound otherwise.
+*/
+template <class ObjectType, class StatisticsPolicy>
+double LEditDistance<ObjectType, StatisticsPolicy>::getBitParallelDistance(ObjectType &pattern, ObjectType &text, double bound){
+
+    size_t m = pattern.size();
+    size_t n = text.size();
+    u_int64_t high = ((u_int64_t) 1) << (m - 1);
+    u_int64_t pv = ~((u_int64_t) 0);
+    u_int64_t mv = 0;
+    u_int64_t eq, xv, xh, ph, mh;
+    size_t score = m;
+    size_t j;
+    //The match vectors of the pattern
+    u_int64_t peq[256];
+
+    memset(peq, 0, sizeof(peq));
+    for (size_t i = 0; i < m; i++){
+        peq[(u_char) pattern[i]] |= ((u_int64_t) 1) << i;
     }//end for
-    for (size_t j = 1; j <= obj2.size(); j++){
-        diff[0][j] = j;
+
+    for (j = 0; j < n; j++){
+        eq = peq[(u_char) text[j]];
+        xv = eq | mv;
+        xh = (((eq & pv) + pv) ^ pv) | eq;
+        ph = mv | ~(xh | pv);
+        mh = pv & xh;
+        if (ph & high){
+            score++;
+        }else if (mh & high){
+            score--;
+        }//end if
+        // The first row of the edit matrix always increases
+        ph = (ph << 1) | 1;
+        mh = mh << 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+        // Each remaining character decreases the cost by 1 at most
+        if ((double) score > bound + (n - j - 1)){
+            score -= n - j - 1;
+            break;
+        }//end if
     }//end for
 
-    for (size_t i = 1; i <= obj1.size(); i++){
-        for (size_t j = 1; j <= obj2.size(); j++){
+    return score;
+}
+
+/**
+* Calculates the LEdit distance of a pattern with more than 64 characters to
+* a text that is not shorter. The pattern is split in blocks of 64 characters
+* and the horizontal delta of the last row of each block is carried to the
+* next one.
+*
+* @param pattern: The shorter word.
+* @param text: The longer word.
+* @param bound: The greatest distance of interest.
+* @return The LEdit distance if it is not greater than bound, or a value
+* greater than bound otherwise.
+*/
+template <class ObjectType, class StatisticsPolicy>
+double LEditDistance<ObjectType, StatisticsPolicy>::getBlockedDistance(ObjectType &pattern, ObjectType &text, double bound){
+
+    size_t m = pattern.size();
+    size_t n = text.size();
+    size_t blocks = (m + 63) / 64;
+    u_int64_t lastHigh = ((u_int64_t) 1) << ((m - 1) % 64);
+    u_int64_t high, eq, xv, xh, ph, mh;
+    const u_int64_t *eqs;
+    size_t score = m;
+    int hin, hout;
+    //The match vectors of the pattern, 256 rows of one word per block
+    std::vector<u_int64_t> blockPeq(256 * blocks, 0);
+    //The vertical delta vectors of each block
+    std::vector<u_int64_t> blockPv(blocks, ~((u_int64_t) 0));
+    std::vector<u_int64_t> blockMv(blocks, 0);
+
+    for (size_t i = 0; i < m; i++){
+        blockPeq[((u_char) pattern[i]) * blocks + (i / 64)] |= ((u_int64_t) 1) << (i % 64);
+    }//end for
+
+    for (size_t j = 0; j < n; j++){
+        eqs = &blockPeq[((u_char) text[j]) * blocks];
+        // The first row of the edit matrix always increases
+        hin = 1;
+        for (size_t b = 0; b < blocks; b++){
+            high = (b == blocks - 1) ? lastHigh : ((u_int64_t) 1) << 63;
+            eq = eqs[b];
+            xv = eq | blockMv[b];
+            if (hin < 0){
+                eq |= 1;
+            }//end if
+            xh = (((eq & blockPv[b]) + blockPv[b]) ^ blockPv[b]) | eq;
+            ph = blockMv[b] | ~(xh | blockPv[b]);
+            mh = blockPv[b] & xh;
+            // The horizontal delta of the last row of the block
+            hout = 0;
+            if (ph & high){
+                hout = 1;
+            }else if (mh & high){
+                hout = -1;
+            }//end if
+            ph = ph << 1;
+            mh = mh << 1;
+            if (hin < 0){
+                mh |= 1;
+            }else if (hin > 0){
+                ph |= 1;
+            }//end if
+            hin = hout;
+            blockPv[b] = mh | ~(xv | ph);
+            blockMv[b] = ph & xv;
+        }//end for
+        score += hin;
+        // Each remaining character decreases the cost by 1 at most
+        if ((double) score > bound + (n - j - 1)){
+            score -= n - j - 1;
+            break;
+        }//end if
+    }//end for
+
+    return score;
+}
+
+/**
+* Calculates the LEdit distance between two words with the dynamic
+* programming algorithm. Only two rows of the edit matrix are kept. The cost
+* along a row never decreases in the next ones, so the calculation stops as
+* soon as the smallest cost of a row exceeds the bound.
+*
+* @param obj1: The first word.
+* @param obj2: The second word.
+* @param bound: The greatest distance of interest.
+* @return The LEdit distance between word 1 and word 2 if it is not greater
+* than bound, or a value greater than bound otherwise.
+*/
+template <class ObjectType, class StatisticsPolicy>
+double LEditDistance<ObjectType, StatisticsPolicy>::getDynamicDistance(ObjectType &obj1, ObjectType &obj2, double bound){
+
+    size_t size1 = obj1.size();
+    size_t size2 = obj2.size();
+    int32_t cost;
+    int32_t rowMin = 0;
+    //The two rows of the edit matrix
+    std::vector<int32_t> prevRow(size2 + 1);
+    std::vector<int32_t> currRow(size2 + 1);
+
+    // Initialize
+    for (size_t j = 0; j <= size2; j++){
+        prevRow[j] = j;
+    }//end for
+
+    for (size_t i = 1; (i <= size1) && (rowMin <= bound); i++){
+        currRow[0] = i;
+        rowMin = currRow[0];
+        for (size_t j = 1; j <= size2; j++){
             // Cost
-            aux1 = obj1[i - 1];
-            aux2 = obj2[j - 1];
-            if ((aux1) == (aux2))
+            if (obj1[i - 1] == obj2[j - 1])
                 cost = 0;
             else
                 cost = 1;
 
-            diff[i][j] = std::min(std::min(diff[i - 1][j] + 1, diff[i][j - 1] + 1),diff[i - 1][j - 1] + (int32_t)cost);
+            currRow[j] = std::min(std::min(prevRow[j] + 1, currRow[j - 1] + 1), prevRow[j - 1] + cost);
+            rowMin = std::min(rowMin, currRow[j]);
         }//end for
+        prevRow.swap(currRow);
     }//end for
 
-
-    this->updateDistanceCount();
-
-    return diff[obj1.size()][obj2.size()];
+    if (rowMin > bound){
+        return rowMin;
+    }//end if
+    return prevRow[size2];
 }
@@ -22,26 +22,51 @@
 #define LEDIT_H
 
 #include "DistanceFunction.h"
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <stdexcept>
+#include <sys/types.h>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 /**
 * Class to obtain the LEdit distance.
 *
+* <P>Words of 1-byte characters are compared by the bit-parallel algorithm of
+* Myers (as formulated by Hyyro): the shorter word is the pattern, and a
+* column of the edit matrix is encoded in 64-bit words, so each character of
+* the longer word is processed with a few word operations for each 64
+* characters of the pattern. Other words use the dynamic programming
+* algorithm with two rows. The buffers are allocated by each call, so an
+* instance may be shared by concurrent queries.
+*
 * @brief L-Edit class.
 * @author 006.
 * @version 1.0.
 */
-template <class ObjectType = std::string >
-class LEditDistance : public DistanceFunction <ObjectType> {
+template <class ObjectType = std::string, class StatisticsPolicy = DistanceFunctionStatistics>
+class LEditDistance final : public DistanceFunction<ObjectType, StatisticsPolicy>{
+
+    private:
+        //The type of the characters of ObjectType
+        typedef typename std::decay<decltype(std::declval<ObjectType &>()[0])>::type CharType;
+
+        double getBitParallelDistance(ObjectType &pattern, ObjectType &text, double bound);
+        double getBlockedDistance(ObjectType &pattern, ObjectType &text, double bound);
+        double getDynamicDistance(ObjectType &obj1, ObjectType &obj2, double bound);
 
     public:
 
         LEditDistance();
         virtual ~LEditDistance();
 
-        double GetDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error);
-        double getDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error);
+        double GetDistance(ObjectType &obj1, ObjectType &obj2);
+        double getDistance(ObjectType &obj1, ObjectType &obj2);
+
+        double GetDistanceBounded(ObjectType &obj1, ObjectType &obj2, double bound);
+        double getDistanceBounded(ObjectType &obj1, ObjectType &obj2, double bound);
 };
 
 #include "LEdit-inl.h"
@@ -0,0 +1,524 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+* 
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+* 
+* 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+* 
+* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+* 
+* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**
+* @file
+*
+* This file defines the vectorized kernels of the Lp distances.
+*
+* @version 1.0
+*/
+
+#ifndef LPKERNELS_H
+#define LPKERNELS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define LPKERNELS_X86
+#include <immintrin.h>
+#endif
+
+/**
+* Vectors with less than this number of elements are compared by the scalar
+* loops of the distance functions. The call through the dispatch table costs
+* more than it saves for them.
+*/
+#define LPKERNELS_MINSIZE 16
+
+/**
+* Number of elements compared between two checks of the bound by the
+* early-abandoning distance functions (see getDistanceBounded()).
+*/
+#define LPKERNELS_BLOCKSIZE 64
+
+/**
+* Hints the processor to load the cache line of the given address. The batch
+* distance functions (see getDistances()) use it to read the next candidate
+* while the current one is compared.
+*/
+#if defined(__GNUC__) || defined(__clang__)
+#define LPKERNELS_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define LPKERNELS_PREFETCH(address)
+#endif
+
+/**
+* This class template holds the kernels of the Lp distances for feature
+* vectors of float or double. Each kernel reads two vectors of n elements and
+* returns the sum of the squared differences (L2), the sum of the absolute
+* differences (L1) or the greatest absolute difference (Linf). The root of
+* the L2 sum is left to the caller.
+*
+* <p>The vectors do not need to be aligned, so a kernel may read the vector
+* stored in a serialized object inside a node page. The differences are
+* computed in DType and accumulated in double, exactly as the scalar loops of
+* EuclideanDistance, ManhattanDistance and ChebyshevDistance do. Only the
+* order of the additions changes.
+*
+* <p>On x86 the kernels are compiled for SSE2, AVX2 and AVX-512F. The first
+* call checks the CPU and selects the widest set it supports. The other
+* processors use the scalar kernels.
+*
+* <p>The batch kernels compare one query against <i>count</i> candidates
+* stored one after the other (count x n elements) and write one result per
+* candidate. The CPU check is done once per batch.
+*
+* @brief Vectorized Lp kernels.
+* @arg DType float or double.
+* @version 1.0
+*/
+template <class DType>
+class LpKernels{
+
+    public:
+
+        /**
+        * Signature of a kernel.
+        */
+        typedef double (*tKernel)(const void *a, const void *b, size_t n);
+
+        /**
+        * Returns the sum of (a[i] - b[i])^2.
+        * @param a The first vector.
+        * @param b The second vector.
+        * @param n The number of elements.
+        */
+        static double sumSquaredDifferences(const void *a, const void *b, size_t n){
+            return getTable().L2(a, b, n);
+        }
+
+        /**
+        * Returns the sum of |a[i] - b[i]|.
+        * @param a The first vector.
+        * @param b The second vector.
+        * @param n The number of elements.
+        */
+        static double sumAbsoluteDifferences(const void *a, const void *b, size_t n){
+            return getTable().L1(a, b, n);
+        }
+
+        /**
+        * Returns the maximum of |a[i] - b[i]|.
+        * @param a The first vector.
+        * @param b The second vector.
+        * @param n The number of elements.
+        */
+        static double maxAbsoluteDifference(const void *a, const void *b, size_t n){
+            return getTable().LInf(a, b, n);
+        }
+
+        /**
+        * Batch version of sumSquaredDifferences().
+        * @param query The query vector.
+        * @param candidates The candidate vectors, one after the other.
+        * @param n The number of elements of each vector.
+        * @param count The number of candidates.
+        * @param out The count results.
+        */
+        static void sumSquaredDifferences(const void *query, const void *candidates,
+                size_t n, size_t count, double *out){
+            batch(getTable().L2, query, candidates, n, count, out);
+        }
+
+        /**
+        * Batch version of sumAbsoluteDifferences().
+        * @copydetails sumSquaredDifferences(const void *, const void *, size_t, size_t, double *)
+        */
+        static void sumAbsoluteDifferences(const void *query, const void *candidates,
+                size_t n, size_t count, double *out){
+            batch(getTable().L1, query, candidates, n, count, out);
+        }
+
+        /**
+        * Batch version of maxAbsoluteDifference().
+        * @copydetails sumSquaredDifferences(const void *, const void *, size_t, size_t, double *)
+        */
+        static void maxAbsoluteDifference(const void *query, const void *candidates,
+                size_t n, size_t count, double *out){
+            batch(getTable().LInf, query, candidates, n, count, out);
+        }
+
+        /**
+        * Returns the name of the instruction set selected for this CPU
+        * ("avx512f", "avx2", "sse2" or "scalar").
+        */
+        static const char *getInstructionSet(){
+            return getTable().Name;
+        }
+
+    private:
+
+        /**
+        * The kernels selected for this CPU.
+        */
+        struct tTable{
+            tKernel L2;
+            tKernel L1;
+            tKernel LInf;
+            const char *Name;
+        };
+
+        /**
+        * Returns the kernels selected for this CPU. The selection is done
+        * once.
+        */
+        static const tTable &getTable(){
+            static const tTable table = selectTable();
+            return table;
+        }
+
+        /**
+        * Selects the kernels for this CPU.
+        */
+        static tTable selectTable(){
+            tTable table = {scalarL2, scalarL1, scalarLInf, "scalar"};
+
+            #ifdef LPKERNELS_X86
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f")){
+                table.L2 = avx512L2;
+                table.L1 = avx512L1;
+                table.LInf = avx512LInf;
+                table.Name = "avx512f";
+            }else if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")){
+                table.L2 = avx2L2;
+                table.L1 = avx2L1;
+                table.LInf = avx2LInf;
+                table.Name = "avx2";
+            }else if (__builtin_cpu_supports("sse2")){
+                table.L2 = sse2L2;
+                table.L1 = sse2L1;
+                table.LInf = sse2LInf;
+                table.Name = "sse2";
+            }
+            #endif //LPKERNELS_X86
+            return table;
+        }
+
+        /**
+        * Runs a kernel over a batch.
+        */
+        static void batch(tKernel kernel, const void *query, const void *candidates,
+                size_t n, size_t count, double *out){
+            const unsigned char *candidate = (const unsigned char *) candidates;
+
+            for (size_t i = 0; i < count; i++){
+                out[i] = kernel(query, candidate, n);
+                candidate += n * sizeof(DType);
+            }
+        }
+
+        /**
+        * Returns a[i] - b[i]. The vectors may be unaligned.
+        */
+        static double difference(const void *a, const void *b, size_t i){
+            DType x;
+            DType y;
+
+            memcpy(&x, (const unsigned char *) a + (i * sizeof(DType)), sizeof(DType));
+            memcpy(&y, (const unsigned char *) b + (i * sizeof(DType)), sizeof(DType));
+            return x - y;
+        }
+
+        static double scalarL2(const void *a, const void *b, size_t n){
+            return scalarL2(a, b, 0, n, 0);
+        }
+
+        static double scalarL2(const void *a, const void *b, size_t i, size_t n, double d){
+            double tmp;
+
+            for (; i < n; i++){
+                tmp = difference(a, b, i);
+                d = d + (tmp * tmp);
+            }
+            return d;
+        }
+
+        static double scalarL1(const void *a, const void *b, size_t n){
+            return scalarL1(a, b, 0, n, 0);
+        }
+
+        static double scalarL1(const void *a, const void *b, size_t i, size_t n, double d){
+            for (; i < n; i++){
+                d = d + fabs(difference(a, b, i));
+            }
+            return d;
+        }
+
+        static double scalarLInf(const void *a, const void *b, size_t n){
+            return scalarLInf(a, b, 0, n, 0);
+        }
+
+        static double scalarLInf(const void *a, const void *b, size_t i, size_t n, double d){
+            double tmp;
+
+            for (; i < n; i++){
+                tmp = fabs(difference(a, b, i));
+                if (tmp > d){
+                    d = tmp;
+                }
+            }
+            return d;
+        }
+
+        #ifdef LPKERNELS_X86
+        //----------------------------------------------------------------------
+        // SSE2: 2 doubles per register.
+        //----------------------------------------------------------------------
+        /**
+        * Loads a[i] - b[i] and a[i + 1] - b[i + 1] as doubles. Floats are
+        * subtracted before the conversion, as the scalar loop does.
+        */
+        __attribute__((target("sse2")))
+        static __m128d sse2Difference(const void *a, const void *b, size_t i){
+            const unsigned char *pa = (const unsigned char *) a + (i * sizeof(DType));
+            const unsigned char *pb = (const unsigned char *) b + (i * sizeof(DType));
+
+            if constexpr (std::is_same<DType, float>::value){
+                return _mm_cvtps_pd(_mm_sub_ps(_mm_castsi128_ps(_mm_loadl_epi64((const __m128i *) pa)),
+                        _mm_castsi128_ps(_mm_loadl_epi64((const __m128i *) pb))));
+            }else{
+                return _mm_sub_pd(_mm_loadu_pd((const double *) pa),
+                        _mm_loadu_pd((const double *) pb));
+            }
+        }
+
+        __attribute__((target("sse2")))
+        static double sse2Sum(__m128d v){
+            double tmp[2];
+
+            _mm_storeu_pd(tmp, v);
+            return tmp[0] + tmp[1];
+        }
+
+        __attribute__((target("sse2")))
+        static double sse2L2(const void *a, const void *b, size_t n){
+            __m128d sum0 = _mm_setzero_pd();
+            __m128d sum1 = _mm_setzero_pd();
+            __m128d d0;
+            __m128d d1;
+            size_t i = 0;
+
+            for (; i + 4 <= n; i += 4){
+                d0 = sse2Difference(a, b, i);
+                d1 = sse2Difference(a, b, i + 2);
+                sum0 = _mm_add_pd(sum0, _mm_mul_pd(d0, d0));
+                sum1 = _mm_add_pd(sum1, _mm_mul_pd(d1, d1));
+            }
+            return scalarL2(a, b, i, n, sse2Sum(_mm_add_pd(sum0, sum1)));
+        }
+
+        __attribute__((target("sse2")))
+        static double sse2L1(const void *a, const void *b, size_t n){
+            const __m128d sign = _mm_set1_pd(-0.0);
+            __m128d sum0 = _mm_setzero_pd();
+            __m128d sum1 = _mm_setzero_pd();
+            size_t i = 0;
+
+            for (; i + 4 <= n; i += 4){
+                sum0 = _mm_add_pd(sum0, _mm_andnot_pd(sign, sse2Difference(a, b, i)));
+                sum1 = _mm_add_pd(sum1, _mm_andnot_pd(sign, sse2Difference(a, b, i + 2)));
+            }
+            return scalarL1(a, b, i, n, sse2Sum(_mm_add_pd(sum0, sum1)));
+        }
+
+        __attribute__((target("sse2")))
+        static double sse2LInf(const void *a, const void *b, size_t n){
+            const __m128d sign = _mm_set1_pd(-0.0);
+            __m128d max0 = _mm_setzero_pd();
+            __m128d max1 = _mm_setzero_pd();
+            double tmp[2];
+            size_t i = 0;
+
+            for (; i + 4 <= n; i += 4){
+                max0 = _mm_max_pd(max0, _mm_andnot_pd(sign, sse2Difference(a, b, i)));
+                max1 = _mm_max_pd(max1, _mm_andnot_pd(sign, sse2Difference(a, b, i + 2)));
+            }
+            _mm_storeu_pd(tmp, _mm_max_pd(max0, max1));
+            return scalarLInf(a, b, i, n, (tmp[0] > tmp[1]) ? tmp[0] : tmp[1]);
+        }
+
+        //----------------------------------------------------------------------
+        // AVX2: 4 doubles per register.
+        //----------------------------------------------------------------------
+        /**
+        * Loads a[i..i+3] - b[i..i+3] as doubles. Floats are subtracted before
+        * the conversion, as the scalar loop does.
+        */
+        __attribute__((target("avx2,fma")))
+        static __m256d avx2Difference(const void *a, const void *b, size_t i){
+            const unsigned char *pa = (const unsigned char *) a + (i * sizeof(DType));
+            const unsigned char *pb = (const unsigned char *) b + (i * sizeof(DType));
+
+            if constexpr (std::is_same<DType, float>::value){
+                return _mm256_cvtps_pd(_mm_sub_ps(_mm_loadu_ps((const float *) pa),
+                        _mm_loadu_ps((const float *) pb)));
+            }else{
+                return _mm256_sub_pd(_mm256_loadu_pd((const double *) pa),
+                        _mm256_loadu_pd((const double *) pb));
+            }
+        }
+
+        __attribute__((target("avx2,fma")))
+        static double avx2Sum(__m256d v){
+            __m128d sum = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+
+            return _mm_cvtsd_f64(_mm_add_sd(sum, _mm_unpackhi_pd(sum, sum)));
+        }
+
+        __attribute__((target("avx2,fma")))
+        static double avx2L2(const void *a, const void *b, size_t n){
+            __m256d sum0 = _mm256_setzero_pd();
+            __m256d sum1 = _mm256_setzero_pd();
+            __m256d d0;
+            __m256d d1;
+            size_t i = 0;
+
+            for (; i + 8 <= n; i += 8){
+                d0 = avx2Difference(a, b, i);
+                d1 = avx2Difference(a, b, i + 4);
+                sum0 = _mm256_fmadd_pd(d0, d0, sum0);
+                sum1 = _mm256_fmadd_pd(d1, d1, sum1);
+            }
+            return scalarL2(a, b, i, n, avx2Sum(_mm256_add_pd(sum0, sum1)));
+        }
+
+        __attribute__((target("avx2,fma")))
+        static double avx2L1(const void *a, const void *b, size_t n){
+            const __m256d sign = _mm256_set1_pd(-0.0);
+            __m256d sum0 = _mm256_setzero_pd();
+            __m256d sum1 = _mm256_setzero_pd();
+            size_t i = 0;
+
+            for (; i + 8 <= n; i += 8){
+                sum0 = _mm256_add_pd(sum0, _mm256_andnot_pd(sign, avx2Difference(a, b, i)));
+                sum1 = _mm256_add_pd(sum1, _mm256_andnot_pd(sign, avx2Difference(a, b, i + 4)));
+            }
+            return scalarL1(a, b, i, n, avx2Sum(_mm256_add_pd(sum0, sum1)));
+        }
+
+        __attribute__((target("avx2,fma")))
+        static double avx2LInf(const void *a, const void *b, size_t n){
+            const __m256d sign = _mm256_set1_pd(-0.0);
+            __m256d max = _mm256_setzero_pd();
+            __m128d half;
+            size_t i = 0;
+
+            for (; i + 8 <= n; i += 8){
+                max = _mm256_max_pd(max, _mm256_andnot_pd(sign, avx2Difference(a, b, i)));
+                max = _mm256_max_pd(max, _mm256_andnot_pd(sign, avx2Difference(a, b, i + 4)));
+            }
+            half = _mm_max_pd(_mm256_castpd256_pd128(max), _mm256_extractf128_pd(max, 1));
+            half = _mm_max_sd(half, _mm_unpackhi_pd(half, half));
+            return scalarLInf(a, b, i, n, _mm_cvtsd_f64(half));
+        }
+
+        //----------------------------------------------------------------------
+        // AVX-512F: 8 doubles per register.
+        //----------------------------------------------------------------------
+        /**
+        * Loads a[i..i+7] - b[i..i+7] as doubles.
+        */
+        __attribute__((target("avx512f")))
+        static __m512d avx512Difference(const void *a, const void *b, size_t i){
+            const unsigned char *pa = (const unsigned char *) a + (i * sizeof(DType));
+            const unsigned char *pb = (const unsigned char *) b + (i * sizeof(DType));
+
+            if constexpr (std::is_same<DType, float>::value){
+                return _mm512_cvtps_pd(_mm256_sub_ps(_mm256_loadu_ps((const float *) pa),
+                        _mm256_loadu_ps((const float *) pb)));
+            }else{
+                return _mm512_sub_pd(_mm512_loadu_pd((const double *) pa),
+                        _mm512_loadu_pd((const double *) pb));
+            }
+        }
+
+        __attribute__((target("avx512f")))
+        static double avx512L2(const void *a, const void *b, size_t n){
+            __m512d sum0 = _mm512_setzero_pd();
+            __m512d sum1 = _mm512_setzero_pd();
+            __m512d d0;
+            __m512d d1;
+            size_t i = 0;
+
+            for (; i + 16 <= n; i += 16){
+                d0 = avx512Difference(a, b, i);
+                d1 = avx512Difference(a, b, i + 8);
+                sum0 = _mm512_fmadd_pd(d0, d0, sum0);
+                sum1 = _mm512_fmadd_pd(d1, d1, sum1);
+            }
+            return scalarL2(a, b, i, n, _mm512_reduce_add_pd(_mm512_add_pd(sum0, sum1)));
+        }
+
+        __attribute__((target("avx512f")))
+        static double avx512L1(const void *a, const void *b, size_t n){
+            __m512d sum0 = _mm512_setzero_pd();
+            __m512d sum1 = _mm512_setzero_pd();
+            size_t i = 0;
+
+            for (; i + 16 <= n; i += 16){
+                sum0 = _mm512_add_pd(sum0, _mm512_abs_pd(avx512Difference(a, b, i)));
+                sum1 = _mm512_add_pd(sum1, _mm512_abs_pd(avx512Difference(a, b, i + 8)));
+            }
+            return scalarL1(a, b, i, n, _mm512_reduce_add_pd(_mm512_add_pd(sum0, sum1)));
+        }
+
+        __attribute__((target("avx512f")))
+        static double avx512LInf(const void *a, const void *b, size_t n){
+            __m512d max = _mm512_setzero_pd();
+            size_t i = 0;
+
+            for (; i + 16 <= n; i += 16){
+                max = _mm512_max_pd(max, _mm512_abs_pd(avx512Difference(a, b, i)));
+                max = _mm512_max_pd(max, _mm512_abs_pd(avx512Difference(a, b, i + 8)));
+            }
+            return scalarLInf(a, b, i, n, _mm512_reduce_max_pd(max));
+        }
+        #endif //LPKERNELS_X86
+};//end LpKernels
+
+/**
+* This class template tells whether two feature vector types may be compared
+* by LpKernels. Both types must provide getVectorData(), which returns the
+* first byte of the stored values, and operator[] must return the same
+* element type, float or double. DataType is that element type.
+*
+* @arg Type1 The type of the first vector (an object or a view).
+* @arg Type2 The type of the second vector.
+* @version 1.0
+*/
+template <class Type1, class Type2, class Enable = void>
+class LpKernelTraits{
+    public:
+        static const bool Supported = false;
+};
+
+template <class Type1, class Type2>
+class LpKernelTraits<Type1, Type2, std::void_t<
+        decltype(std::declval<const Type1 &>().getVectorData()),
+        decltype(std::declval<const Type2 &>().getVectorData())> >{
+    public:
+        typedef typename std::decay<decltype(std::declval<Type1 &>()[0])>::type DataType;
+
+        static const bool Supported =
+                std::is_same<DataType,
+                        typename std::decay<decltype(std::declval<Type2 &>()[0])>::type>::value &&
+                (std::is_same<DataType, float>::value || std::is_same<DataType, double>::value);
+};
+
+#endif //LPKERNELS_H
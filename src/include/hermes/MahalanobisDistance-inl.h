@@ -13,9 +13,12 @@
 /**
 * Constructor.
 */
-template <class ObjectType>
-MahalanobisDistance<ObjectType>::MahalanobisDistance(size_t dim){
+template <class ObjectType, class StatisticsPolicy>
+MahalanobisDistance<ObjectType, StatisticsPolicy>::MahalanobisDistance(size_t dim){
 
+    this->dim = dim;
+    inverted_matrix2 = NULL;
+    whitened = false;
     if (dim != 0){
         this->dim = dim;
         inverted_matrix2 = new boost::numeric::ublas::matrix<double>(dim, dim);
@@ -26,8 +29,8 @@ MahalanobisDistance<ObjectType>::MahalanobisDistance(size_t dim){
 /**
 * Destructor.
 */
-template <class ObjectType>
-MahalanobisDistance<ObjectType>::~MahalanobisDistance(){
+template <class ObjectType, class StatisticsPolicy>
+MahalanobisDistance<ObjectType, StatisticsPolicy>::~MahalanobisDistance(){
 
     if (inverted_matrix2 != NULL){
         delete (inverted_matrix2);
@@ -35,8 +38,8 @@ MahalanobisDistance<ObjectType>::~MahalanobisDistance(){
     mean_vector.clear();
 }
 
-template <class ObjectType>
-void MahalanobisDistance<ObjectType>::init(std::vector<ObjectType> &FVs) throw (std::length_error){
+template <class ObjectType, class StatisticsPolicy>
+void MahalanobisDistance<ObjectType, StatisticsPolicy>::init(std::vector<ObjectType> &FVs){
 
     double covariance_tmp, zscore_derivation;
 
@@ -92,8 +95,8 @@ void MahalanobisDistance<ObjectType>::init(std::vector<ObjectType> &FVs) throw (
     }
 }
 
-template <class ObjectType>
-double MahalanobisDistance<ObjectType>::getDistance(ObjectType &obj1)throw (std::length_error){
+template <class ObjectType, class StatisticsPolicy>
+double MahalanobisDistance<ObjectType, StatisticsPolicy>::getDistance(ObjectType &obj1){
 
     /* =====================================================================================
      * Variable declarations
@@ -131,8 +134,8 @@ double MahalanobisDistance<ObjectType>::getDistance(ObjectType &obj1)throw (std:
 *
 * @copydoc getDistance(ObjectType *obj1, ObjectType *obj2) .
 */
-template <class ObjectType>
-double  MahalanobisDistance<ObjectType>::GetDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error){
+template <class ObjectType, class StatisticsPolicy>
+double  MahalanobisDistance<ObjectType, StatisticsPolicy>::GetDistance(ObjectType &obj1, ObjectType &obj2){
 
     return getDistance(obj1, obj2);
 }
@@ -145,13 +148,20 @@ double  MahalanobisDistance<ObjectType>::GetDistance(ObjectType &obj1, ObjectTyp
 * To make this computations both feature vectors should have the same size.
 * Notice that, values of the feature vector must be non-negative.
 *
+* If the covariance was set by setCovariance(), the distance uses it instead
+* (see getDistanceBounded()).
+*
 * @param obj1: The first feature vector.
 * @param obj2: The second feature vector.
 * @throw Exception If the computation is not possible.
 * @return The distance between feature vector 1 and feature vector 2.
 */
-template <class ObjectType>
-double  MahalanobisDistance<ObjectType>::getDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error){
+template <class ObjectType, class StatisticsPolicy>
+double  MahalanobisDistance<ObjectType, StatisticsPolicy>::getDistance(ObjectType &obj1, ObjectType &obj2){
+
+    if (whitened || isFactored()){
+        return getDistanceBounded(obj1, obj2, HUGE_VAL);
+    }
 
     int dimension = obj1.size(), num_FV = 2;
     double result, covariance_tmp;
@@ -234,8 +244,8 @@ double  MahalanobisDistance<ObjectType>::getDistance(ObjectType &obj1, ObjectTyp
 * @throw Exception If the computation is not possible.
 * @return The distance between feature vector 1 and feature vector 2.
 */
-template <class ObjectType>
-double  MahalanobisDistance<ObjectType>::getDistance(ObjectType &obj1, std::vector<ObjectType> obj2) throw (std::length_error){
+template <class ObjectType, class StatisticsPolicy>
+double  MahalanobisDistance<ObjectType, StatisticsPolicy>::getDistance(ObjectType &obj1, std::vector<ObjectType> obj2){
 
     // Variable declarations
     int dimension = obj1.size(), num_FV = obj2.size();
@@ -317,3 +327,237 @@ double  MahalanobisDistance<ObjectType>::getDistance(ObjectType &obj1, std::vect
     // Result
     return sqrt(result);
 }
+
+/**
+* Sets the covariance matrix used by the distance and factors it as
+* L * L' (Cholesky).
+*
+* @param covariance: The covariance matrix. It must be symmetric and
+* positive definite.
+* @throw Exception If the matrix is not square or not positive definite.
+*/
+template <class ObjectType, class StatisticsPolicy>
+void MahalanobisDistance<ObjectType, StatisticsPolicy>::setCovariance(const boost::numeric::ublas::matrix<double> &covariance){
+
+    size_t n = covariance.size1();
+    double sum;
+
+    if (covariance.size2() != n){
+        throw std::length_error("The covariance matrix is not square.");
+    }
+
+    dim = n;
+    cholesky.assign(n * n, 0.0);
+    for (size_t j = 0; j < n; j++){
+        sum = covariance(j, j);
+        for (size_t k = 0; k < j; k++){
+            sum -= cholesky[j * n + k] * cholesky[j * n + k];
+        }
+        if (sum <= 0.0){
+            cholesky.clear();
+            throw std::length_error("The covariance matrix is not positive definite.");
+        }
+        cholesky[j * n + j] = sqrt(sum);
+        for (size_t i = j + 1; i < n; i++){
+            sum = covariance(i, j);
+            for (size_t k = 0; k < j; k++){
+                sum -= cholesky[i * n + k] * cholesky[j * n + k];
+            }
+            cholesky[i * n + j] = sum / cholesky[j * n + j];
+        }
+    }
+}
+
+/**
+* Applies the rank-one update S + alpha * v * v' to the covariance matrix S
+* set by setCovariance(). Only the factor is updated, in O(dim^2). A negative
+* alpha removes the contribution of v.
+*
+* @param v: The update vector.
+* @param alpha: The weight of the update.
+* @throw Exception If there is no covariance, the sizes do not match or the
+* updated matrix is not positive definite.
+*/
+template <class ObjectType, class StatisticsPolicy>
+void MahalanobisDistance<ObjectType, StatisticsPolicy>::updateCovariance(const std::vector<double> &v, double alpha){
+
+    size_t n = dim;
+    double sign = (alpha < 0.0) ? -1.0 : 1.0;
+    double scale = sqrt(fabs(alpha));
+    double r, c, s, lkk;
+
+    if (!isFactored()){
+        throw std::length_error("The covariance matrix was not set.");
+    }
+    if (v.size() != n){
+        throw std::length_error("The update vector does not have the same size of the covariance matrix.");
+    }
+
+    std::vector<double> x(n);
+    for (size_t i = 0; i < n; i++){
+        x[i] = scale * v[i];
+    }
+    for (size_t k = 0; k < n; k++){
+        lkk = cholesky[k * n + k];
+        r = (lkk * lkk) + (sign * x[k] * x[k]);
+        if (r <= 0.0){
+            throw std::length_error("The updated covariance matrix is not positive definite.");
+        }
+        r = sqrt(r);
+        c = r / lkk;
+        s = x[k] / lkk;
+        cholesky[k * n + k] = r;
+        for (size_t i = k + 1; i < n; i++){
+            cholesky[i * n + k] = (cholesky[i * n + k] + (sign * s * x[i])) / c;
+            x[i] = (c * x[i]) - (s * cholesky[i * n + k]);
+        }
+    }
+}
+
+/**
+* Checks if the covariance matrix was set by setCovariance().
+*
+* @return True if the Cholesky factor is available.
+*/
+template <class ObjectType, class StatisticsPolicy>
+bool MahalanobisDistance<ObjectType, StatisticsPolicy>::isFactored(){
+
+    return !cholesky.empty();
+}
+
+/**
+* Whitens a feature vector in place: obj becomes L^-1 * obj, where L is the
+* Cholesky factor of the covariance. The Euclidean distance between whitened
+* vectors is the Mahalanobis distance between the original ones.
+*
+* @param obj: The feature vector.
+* @throw Exception If there is no covariance or the sizes do not match.
+*/
+template <class ObjectType, class StatisticsPolicy>
+void MahalanobisDistance<ObjectType, StatisticsPolicy>::whiten(ObjectType &obj){
+
+    double sum;
+    std::vector<double> whitened_dif(dim);
+
+    if (!isFactored()){
+        throw std::length_error("The covariance matrix was not set.");
+    }
+    if (obj.size() != dim){
+        throw std::length_error("The feature vector does not have the same size of the covariance matrix.");
+    }
+
+    // Forward substitution, L * z = obj
+    for (size_t i = 0; i < dim; i++){
+        sum = obj[i];
+        for (size_t k = 0; k < i; k++){
+            sum -= cholesky[i * dim + k] * whitened_dif[k];
+        }
+        whitened_dif[i] = sum / cholesky[i * dim + i];
+    }
+    for (size_t i = 0; i < dim; i++){
+        obj[i] = whitened_dif[i];
+    }
+}
+
+/**
+* Tells whether the objects given to getDistance() are already whitened (see
+* whiten()).
+*
+* @param whitened: True if the objects are whitened.
+*/
+template <class ObjectType, class StatisticsPolicy>
+void MahalanobisDistance<ObjectType, StatisticsPolicy>::setWhitened(bool whitened){
+
+    this->whitened = whitened;
+}
+
+/**
+* Checks if the objects given to getDistance() are already whitened.
+*
+* @return True if the objects are whitened.
+*/
+template <class ObjectType, class StatisticsPolicy>
+bool MahalanobisDistance<ObjectType, StatisticsPolicy>::isWhitened(){
+
+    return whitened;
+}
+
+/**
+* @deprecated Use getDistanceBounded(ObjectType &obj1, ObjectType &obj2, double bound) instead.
+*
+* @copydoc getDistanceBounded(ObjectType &obj1, ObjectType &obj2, double bound) .
+*/
+template <class ObjectType, class StatisticsPolicy>
+double MahalanobisDistance<ObjectType, StatisticsPolicy>::GetDistanceBounded(ObjectType &obj1, ObjectType &obj2, double bound){
+
+    return getDistanceBounded(obj1, obj2, bound);
+}
+
+/**
+* Calculates the Mahalanobis distance between two feature vectors if it is
+* not greater than bound. Whitened objects are compared by the Euclidean
+* distance and the others by the Cholesky factor of the covariance; both stop
+* as soon as the partial sum of squares exceeds the bound. Without a
+* covariance, the full distance of getDistance() is returned.
+*
+* @param obj1: The first feature vector.
+* @param obj2: The second feature vector.
+* @param bound: The greatest distance of interest.
+* @throw Exception If the computation is not possible.
+* @return The distance between feature vector 1 and feature vector 2 if it
+* is not greater than bound, or a value greater than bound otherwise.
+*/
+template <class ObjectType, class StatisticsPolicy>
+double MahalanobisDistance<ObjectType, StatisticsPolicy>::getDistanceBounded(ObjectType &obj1, ObjectType &obj2, double bound){
+
+    if (whitened){
+        // Statistic support
+        this->updateDistanceCount();
+
+        return euclidean.getDistanceBounded(obj1, obj2, bound);
+    }else if (isFactored()){
+        return getFactoredDistance(obj1, obj2, bound);
+    }else{
+        return getDistance(obj1, obj2);
+    }
+}
+
+/**
+* Calculates the Mahalanobis distance as the Euclidean norm of
+* L^-1 * (obj1 - obj2). Each step of the forward substitution adds one square
+* to the distance, so it stops as soon as the partial sum exceeds the bound.
+*
+* @param obj1: The first feature vector.
+* @param obj2: The second feature vector.
+* @param bound: The greatest distance of interest.
+* @throw Exception If the sizes do not match.
+* @return The distance if it is not greater than bound, or a value greater
+* than bound otherwise.
+*/
+template <class ObjectType, class StatisticsPolicy>
+double MahalanobisDistance<ObjectType, StatisticsPolicy>::getFactoredDistance(ObjectType &obj1, ObjectType &obj2, double bound){
+
+    double limit = bound * bound;
+    double result = 0.0;
+    double sum;
+    std::vector<double> whitened_dif(dim);
+
+    if ((obj1.size() != dim) || (obj2.size() != dim)){
+        throw std::length_error("The feature vectors do not have the same size of the covariance matrix.");
+    }
+
+    // Forward substitution, L * z = obj1 - obj2
+    for (size_t i = 0; (i < dim) && (result <= limit); i++){
+        sum = (double) obj1[i] - (double) obj2[i];
+        for (size_t k = 0; k < i; k++){
+            sum -= cholesky[i * dim + k] * whitened_dif[k];
+        }
+        whitened_dif[i] = sum / cholesky[i * dim + i];
+        result += whitened_dif[i] * whitened_dif[i];
+    }
+
+    // Statistic support
+    this->updateDistanceCount();
+
+    return sqrt(result);
+}
@@ -21,6 +21,7 @@
 
 
 #include "DistanceFunction.h"
+#include "EuclideanDistance.h"
 #include <cmath>
 #include <stdexcept>
 
@@ -74,31 +75,66 @@ bool InvertMatrix (const boost::numeric::ublas::matrix<T>& input, boost::numeric
 }
 
 /**
+* <P>Besides the original methods, this class may work with a fixed
+* covariance matrix S set by setCovariance(). S is factored once as
+* S = L * L' (Cholesky) and the distance becomes the Euclidean norm of
+* L^-1 * (obj1 - obj2), which is computed by forward substitution and may be
+* abandoned as soon as the partial sum of squares exceeds the bound.
+*
+* <P>The objects may also be whitened in advance by whiten() (z = L^-1 * x).
+* After setWhitened(true), getDistance() expects whitened objects and
+* computes the Euclidean distance between them with the vectorized kernels
+* (see LpKernels), which is exactly the Mahalanobis distance of the original
+* objects. The whitened objects must be computed again when the covariance
+* changes.
+*
+* <P>updateCovariance() applies a rank-one update S + alpha * v * v' to the
+* factor in O(dim^2) instead of factoring S again.
+*
 * @brief Mahalanobis Distance class.
 * @author 012
 * @author 006
 * @date 10-13-2014
 * @version 1.0.
 */
-template <class ObjectType>
-class MahalanobisDistance : public DistanceFunction <ObjectType>{
+template <class ObjectType, class StatisticsPolicy = DistanceFunctionStatistics>
+class MahalanobisDistance final : public DistanceFunction<ObjectType, StatisticsPolicy>{
 
     private:
         size_t dim;
         boost::numeric::ublas::matrix<double> *inverted_matrix2;
         std::vector<double> mean_vector;
+        //The Cholesky factor of the covariance (dim x dim, row-major)
+        std::vector<double> cholesky;
+        //True if the objects are already whitened
+        bool whitened;
+        //The distance between whitened objects
+        EuclideanDistance<ObjectType, NoDistanceFunctionStatistics> euclidean;
+
+        double getFactoredDistance(ObjectType &obj1, ObjectType &obj2, double bound);
 
     public:
 
         MahalanobisDistance(size_t dim = 0);
         virtual ~MahalanobisDistance();
 
-        void init(std::vector<ObjectType> &FVs) throw (std::length_error);
+        void init(std::vector<ObjectType> &FVs);
+
+        void setCovariance(const boost::numeric::ublas::matrix<double> &covariance);
+        void updateCovariance(const std::vector<double> &v, double alpha = 1.0);
+        bool isFactored();
+
+        void whiten(ObjectType &obj);
+        void setWhitened(bool whitened);
+        bool isWhitened();
+
+        double GetDistance(ObjectType &obj1, ObjectType &obj2);
+        double getDistance(ObjectType &obj1, ObjectType &obj2);
+        double getDistance(ObjectType &obj1, std::vector<ObjectType> obj2);
+        double getDistance(ObjectType &obj1);
 
-        double GetDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error);
-        double getDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error);
-        double getDistance(ObjectType &obj1, std::vector<ObjectType> obj2) throw (std::length_error);
-        double getDistance(ObjectType &obj1)throw (std::length_error);
+        double GetDistanceBounded(ObjectType &obj1, ObjectType &obj2, double bound);
+        double getDistanceBounded(ObjectType &obj1, ObjectType &obj2, double bound);
 };
 
 
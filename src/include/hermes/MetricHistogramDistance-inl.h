@@ -13,15 +13,15 @@
 /**
 * Constructor.
 */
-template <class ObjectType>
-MetricHistogramDistance<ObjectType>::MetricHistogramDistance() {
+template <class ObjectType, class StatisticsPolicy>
+MetricHistogramDistance<ObjectType, StatisticsPolicy>::MetricHistogramDistance() {
 }
 
 /**
 * Destructor.
 */
-template <class ObjectType>
-MetricHistogramDistance<ObjectType>::~MetricHistogramDistance() {
+template <class ObjectType, class StatisticsPolicy>
+MetricHistogramDistance<ObjectType, StatisticsPolicy>::~MetricHistogramDistance() {
 }
 
 /**
@@ -29,8 +29,8 @@ MetricHistogramDistance<ObjectType>::~MetricHistogramDistance() {
 *
 * @copydoc getDistance(ObjectType &obj1, ObjectType &obj2) .
 */
-template <class ObjectType>
-double MetricHistogramDistance<ObjectType>::GetDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error){
+template <class ObjectType, class StatisticsPolicy>
+double MetricHistogramDistance<ObjectType, StatisticsPolicy>::GetDistance(ObjectType &obj1, ObjectType &obj2){
 
     return getDistance(obj1, obj2);
 }
@@ -43,42 +43,94 @@ double MetricHistogramDistance<ObjectType>::GetDistance(ObjectType &obj1, Object
 * @param obj2: The second feature vector.
 * @return The distance between feature vector 1 and feature vector 2.
 */
-template <class ObjectType>
-double MetricHistogramDistance<ObjectType>::getDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error){
+template <class ObjectType, class StatisticsPolicy>
+double MetricHistogramDistance<ObjectType, StatisticsPolicy>::getDistance(ObjectType &obj1, ObjectType &obj2){
 
-    double *new_obj1_gray  = new double[(obj1.size()/2)];
-    double *new_obj1_value = new double[(obj1.size()/2)];
+    double d1, d2;
 
-    double *new_obj2_gray  = new double[(obj2.size()/2)];
-    double *new_obj2_value = new double[(obj2.size()/2)];
+    d1 = getArea(obj1);
+    d2 = getArea(obj2);
 
-    for (size_t x = 0; x < (obj1.size()/2); x++){
-        new_obj1_gray[x] = obj1[x];
-        new_obj1_value[x] = obj1[(obj1.size()/2) + x];
-    }
+    this->updateDistanceCount();
 
-    for (size_t x = 0; x < (obj2.size()/2); x++){
-        new_obj2_gray[x] = obj2[x];
-        new_obj2_value[x] = obj2[(obj2.size()/2) + x];
-    }
+    return fabs(d1 - d2);
+}
 
-    double d1, d2;
-    double m;
-    d1 = d2 = 0.0;
+/**
+* @deprecated Use prepareQuery() instead.
+*
+* @copydoc prepareQuery(ObjectType &query, PreparedQuery &prepared) .
+*/
+template <class ObjectType, class StatisticsPolicy>
+void MetricHistogramDistance<ObjectType, StatisticsPolicy>::PrepareQuery(ObjectType &query, PreparedQuery &prepared){
 
-    for (size_t x = 0; x < ((obj1.size()/2)-1); x++){
-        m = (new_obj1_value[x+1] - new_obj1_value[x])/(new_obj1_gray[x+1] - new_obj1_gray[x]);
-        d1 += ((m*new_obj1_gray[x+1]*new_obj1_gray[x+1])/2.0) + (new_obj1_value[x]*new_obj1_gray[x+1]);
-        d1 -= ((m*new_obj1_gray[x]*new_obj1_gray[x])/2.0) + (new_obj1_value[x]*new_obj1_gray[x]);
-    }
+    prepareQuery(query, prepared);
+}
 
-    for (size_t x = 0; x < ((obj2.size()/2)-1); x++){
-        m = (new_obj2_value[x+1] - new_obj2_value[x])/(new_obj2_gray[x+1] - new_obj2_gray[x]);
-        d2 += ((m*new_obj2_gray[x+1]*new_obj2_gray[x+1])/2.0) + (new_obj2_value[x]*new_obj2_gray[x+1]);
-        d2 -= ((m*new_obj2_gray[x]*new_obj2_gray[x])/2.0) + (new_obj2_value[x]*new_obj2_gray[x]);
-    }
+/**
+* Prepares a query sample: its area is computed once.
+*
+* @param query: The query sample.
+* @param prepared: The data of the query sample (output).
+*/
+template <class ObjectType, class StatisticsPolicy>
+void MetricHistogramDistance<ObjectType, StatisticsPolicy>::prepareQuery(ObjectType &query, PreparedQuery &prepared){
+
+    prepared.area = getArea(query);
+}
+
+/**
+* @deprecated Use getDistance(ObjectType &obj, PreparedQuery &query) instead.
+*
+* @copydoc getDistance(ObjectType &obj, PreparedQuery &query) .
+*/
+template <class ObjectType, class StatisticsPolicy>
+double MetricHistogramDistance<ObjectType, StatisticsPolicy>::GetDistance(ObjectType &obj, PreparedQuery &query){
+
+    return getDistance(obj, query);
+}
+
+/**
+* Calculates similariry between a metric histogram and a prepared query
+* sample.
+*
+* @param obj: The feature vector.
+* @param query: The query sample prepared by prepareQuery().
+* @return The distance between the feature vector and the query sample.
+*/
+template <class ObjectType, class StatisticsPolicy>
+double MetricHistogramDistance<ObjectType, StatisticsPolicy>::getDistance(ObjectType &obj, PreparedQuery &query){
+
+    double d = getArea(obj);
 
     this->updateDistanceCount();
 
-    return fabs(d1 - d2);
+    return fabs(d - query.area);
+}
+
+/**
+* Calculates the area under a metric histogram. The first half of the
+* feature vector holds the gray levels of the buckets and the second half
+* their values.
+*
+* @param obj: The metric histogram.
+* @return The area under the metric histogram.
+*/
+template <class ObjectType, class StatisticsPolicy>
+double MetricHistogramDistance<ObjectType, StatisticsPolicy>::getArea(ObjectType &obj){
+
+    size_t half = obj.size() / 2;
+    double gray, nextGray, value, m;
+    double d = 0.0;
+
+    for (size_t x = 0; x + 1 < half; x++){
+        gray = obj[x];
+        nextGray = obj[x + 1];
+        value = obj[half + x];
+        m = (obj[half + x + 1] - value)/(nextGray - gray);
+        d += ((m*nextGray*nextGray)/2.0) + (value*nextGray);
+        d -= ((m*gray*gray)/2.0) + (value*gray);
+    }
+
+    return d;
 }
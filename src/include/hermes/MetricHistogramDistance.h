@@ -27,20 +27,40 @@
 /**
 * Class to the area diferences between two metric histograms.
 *
+* <P>The area of a query sample may be computed once by prepareQuery() and
+* reused by every distance to it.
+*
 * @brief Gets the area between the metric histograms.
 * @author 006.
 * @version 1.0.
 */
-template <class ObjectType>
-class MetricHistogramDistance : public DistanceFunction <ObjectType> {
+template <class ObjectType, class StatisticsPolicy = DistanceFunctionStatistics>
+class MetricHistogramDistance final : public DistanceFunction<ObjectType, StatisticsPolicy>{
+
+    private:
+        double getArea(ObjectType &obj);
 
     public:
+        /**
+        * The data of a query sample computed by prepareQuery().
+        */
+        class PreparedQuery{
+            public:
+                //The area of the query sample
+                double area;
+        };
 
         MetricHistogramDistance();
         virtual ~MetricHistogramDistance();
 
-        double GetDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error);
-        double getDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error);
+        double GetDistance(ObjectType &obj1, ObjectType &obj2);
+        double getDistance(ObjectType &obj1, ObjectType &obj2);
+
+        void PrepareQuery(ObjectType &query, PreparedQuery &prepared);
+        void prepareQuery(ObjectType &query, PreparedQuery &prepared);
+
+        double GetDistance(ObjectType &obj, PreparedQuery &query);
+        double getDistance(ObjectType &obj, PreparedQuery &query);
 };
 
 #include "MetricHistogramDistance-inl.h"
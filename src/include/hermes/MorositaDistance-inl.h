@@ -10,56 +10,90 @@
 * 
 * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
-template <class ObjectType>
-MorositaDistance<ObjectType>::MorositaDistance(){
+template <class ObjectType, class StatisticsPolicy>
+MorositaDistance<ObjectType, StatisticsPolicy>::MorositaDistance(){
 }
 
-template <class ObjectType>
-MorositaDistance<ObjectType>::~MorositaDistance(){
+template <class ObjectType, class StatisticsPolicy>
+MorositaDistance<ObjectType, StatisticsPolicy>::~MorositaDistance(){
 }
 
-template <class ObjectType>
-double MorositaDistance<ObjectType>::GetDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error) {
+template <class ObjectType, class StatisticsPolicy>
+double MorositaDistance<ObjectType, StatisticsPolicy>::GetDistance(ObjectType &obj1, ObjectType &obj2) {
 
     return getDistance(obj1, obj2);
 }
 
-template <class ObjectType>
-double MorositaDistance<ObjectType>::getDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error){
+template <class ObjectType, class StatisticsPolicy>
+double MorositaDistance<ObjectType, StatisticsPolicy>::getDistance(ObjectType &obj1, ObjectType &obj2){
 
-    if (obj1.size() != obj2.size()) {
-        throw std::length_error("The feature vectors do not have the same size.");
-    }
+    double lambda1, lambda2, sum1, sum2;
 
-    double sumx, sumy, sumxy, lambda1, lambda2;
-    double sumaux1, sumaux2, sumaux3, sumaux4;
+    lambda1 = getLambda(obj1, sum1);
+    lambda2 = getLambda(obj2, sum2);
+    return getIndex(obj1, lambda1, sum1, obj2, lambda2, sum2);
+}
 
-    sumx = sumy = sumxy = 0.0;
-    sumaux1 = sumaux2 = sumaux3 = sumaux4 = 0.0;
+template <class ObjectType, class StatisticsPolicy>
+void MorositaDistance<ObjectType, StatisticsPolicy>::PrepareQuery(ObjectType &query, PreparedQuery &prepared){
 
-    for (size_t x = 0; x < obj1.size(); x++){
-        sumaux2 += obj1[x];
-        sumaux1 += obj1[x] - 1;
-        sumaux3 += obj1[x]*(obj1[x] - 1);
-    }
-    lambda1 = sumaux3/(sumaux1*sumaux2);
+    prepareQuery(query, prepared);
+}
+
+template <class ObjectType, class StatisticsPolicy>
+void MorositaDistance<ObjectType, StatisticsPolicy>::prepareQuery(ObjectType &query, PreparedQuery &prepared){
+
+    prepared.sample = &query;
+    prepared.lambda = getLambda(query, prepared.sum);
+}
+
+template <class ObjectType, class StatisticsPolicy>
+double MorositaDistance<ObjectType, StatisticsPolicy>::GetDistance(ObjectType &obj, PreparedQuery &query) {
+
+    return getDistance(obj, query);
+}
+
+template <class ObjectType, class StatisticsPolicy>
+double MorositaDistance<ObjectType, StatisticsPolicy>::getDistance(ObjectType &obj, PreparedQuery &query){
 
-    sumaux1 = sumaux3 = 0.0;
-    for (size_t x = 0; x < obj1.size(); x++){
-        sumaux4 += obj2[x];
-        sumaux1 += obj2[x] - 1;
-        sumaux3 += obj2[x]*(obj2[x] - 1);
+    double lambda, sum;
+
+    lambda = getLambda(obj, sum);
+    return getIndex(obj, lambda, sum, *query.sample, query.lambda, query.sum);
+}
+
+template <class ObjectType, class StatisticsPolicy>
+double MorositaDistance<ObjectType, StatisticsPolicy>::getIndex(ObjectType &obj1, double lambda1, double sum1,
+                                                                ObjectType &obj2, double lambda2, double sum2){
+
+    if (obj1.size() != obj2.size()) {
+        throw std::length_error("The feature vectors do not have the same size.");
     }
-    lambda2 = sumaux3/(sumaux1*sumaux4);
 
+    double sumxy;
 
-    if (((lambda1 + lambda2) == 0.0) || (sumaux2 == 0.0) || (sumaux4 == 0.0)){
+    if (((lambda1 + lambda2) == 0.0) || (sum1 == 0.0) || (sum2 == 0.0)){
         return 0;
     } else {
-        sumaux1 = 0.0;
+        sumxy = 0.0;
         for (size_t x = 0; x < obj1.size(); x++){
-            sumaux1 = obj1[x]*obj2[x];
+            sumxy = obj1[x]*obj2[x];
         }
-        return 2*(sumaux1/((lambda1 + lambda2)*sumaux2*sumaux4));
+        return 2*(sumxy/((lambda1 + lambda2)*sum1*sum2));
     }
 }
+
+template <class ObjectType, class StatisticsPolicy>
+double MorositaDistance<ObjectType, StatisticsPolicy>::getLambda(ObjectType &obj, double &sum){
+
+    double sumaux1, sumaux3;
+
+    sum = sumaux1 = sumaux3 = 0.0;
+    for (size_t x = 0; x < obj.size(); x++){
+        sum += obj[x];
+        sumaux1 += obj[x] - 1;
+        sumaux3 += obj[x]*(obj[x] - 1);
+    }
+
+    return sumaux3/(sumaux1*sum);
+}
@@ -29,19 +29,46 @@
 * Class to obtain the Morosita Index.
 * It is useful to measure abundance data similarity.
 *
+* <P>The dispersion index of a query sample may be computed once by
+* prepareQuery() and reused by every distance to it.
+*
 * @brief Morosita Index Distance class.
 * @author 006
 * @version 1.0.
 */
-template <class ObjectType>
-class MorositaDistance : public DistanceFunction<ObjectType> {
+template <class ObjectType, class StatisticsPolicy = DistanceFunctionStatistics>
+class MorositaDistance final : public DistanceFunction<ObjectType, StatisticsPolicy>{
+
+    public:
+        /**
+        * The data of a query sample computed by prepareQuery().
+        */
+        class PreparedQuery{
+            public:
+                //The query sample
+                ObjectType *sample;
+                //The dispersion index and the abundance sum of the sample
+                double lambda;
+                double sum;
+        };
+
+    private:
+        double getLambda(ObjectType &obj, double &sum);
+        double getIndex(ObjectType &obj1, double lambda1, double sum1,
+                        ObjectType &obj2, double lambda2, double sum2);
 
     public:
         MorositaDistance();
         ~MorositaDistance();
 
-        double GetDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error);
-        double getDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error);
+        double GetDistance(ObjectType &obj1, ObjectType &obj2);
+        double getDistance(ObjectType &obj1, ObjectType &obj2);
+
+        void PrepareQuery(ObjectType &query, PreparedQuery &prepared);
+        void prepareQuery(ObjectType &query, PreparedQuery &prepared);
+
+        double GetDistance(ObjectType &obj, PreparedQuery &query);
+        double getDistance(ObjectType &obj, PreparedQuery &query);
 };
 
 #include "MorositaDistance-inl.h"
@@ -0,0 +1,551 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+* 
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+* 
+* 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+* 
+* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+* 
+* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/**
+* @file
+*
+* This file defines the quantized copies of feature vectors kept by the
+* leaves of a tree and the lower bounds of the Lp distances computed from
+* them.
+*
+* @version 1.0
+*/
+
+#ifndef QUANTIZEDBOUNDS_H
+#define QUANTIZEDBOUNDS_H
+
+#include "ArrayQuantizers.h"
+#include "LpKernels.h"
+#include <stdexcept>
+#include <sys/types.h>
+#include <vector>
+
+/**
+* Relative tolerance of the bounds. A bound is decreased by this fraction,
+* so the rounding of the bound and of the exact distance (whose additions
+* may be done in another order) never rejects a qualified object.
+*/
+#define QUANTIZEDBOUNDS_TOLERANCE 1e-9
+
+/**
+* Layout of the codes of Int8Quantizer: the minimum p0 and the scale p1 (two
+* doubles) followed by one byte c per value, for the interval
+* [p0 + p1 * c, p0 + p1 * (c + 1)]. p1 is a power of two. A NaN p0 marks a
+* vector that could not be quantized.
+*/
+#define QUANTIZEDBOUNDS_AFFINE8 1
+
+/**
+* Layout of the codes of Float16Quantizer: a flag byte (0 if the vector could
+* not be quantized) followed by one binary16 number c per value, for the
+* interval between c and the next binary16 number.
+*/
+#define QUANTIZEDBOUNDS_FLOAT16 2
+
+/**
+* This class builds the quantized copy (the codes) of a feature vector with a
+* fixed number of dimensions and computes lower bounds of the Lp distances
+* between the original vector and another one from the codes alone. Each
+* code gives an interval [lo, hi] that holds its value, so the distance from
+* the other value to the interval is never greater than the difference
+* between both values:
+* <ul>
+* <li>sumSquaredGaps() bounds the sum of the squared differences (L2);</li>
+* <li>sumAbsoluteGaps() bounds the sum of the absolute differences (L1);</li>
+* <li>maxAbsoluteGap() bounds the greatest absolute difference (Linf).</li>
+* </ul>
+* The bound is checked after each block of LPKERNELS_BLOCKSIZE values and the
+* calculation stops as soon as it exceeds the given limit.
+*
+* <p>The codes are kept by the leaf nodes of a tree next to each entry (see
+* stSlimLeafNode), so an entry whose bound already exceeds the range of a
+* query is rejected without reading its object. A vector of another size or
+* that cannot be quantized gets codes whose bound is always 0.
+*
+* <p>The bounds are computed by kernels that decode the intervals exactly as
+* the quantizers do. On x86 they are compiled for AVX2 (and F16C for
+* binary16), selected at the first call if the CPU supports them.
+*
+* @brief Quantized copies of feature vectors.
+* @version 1.0
+*/
+class QuantizedBounds{
+
+    public:
+
+        /**
+        * Creates the codes of a layout.
+        * @param layout QUANTIZEDBOUNDS_AFFINE8, QUANTIZEDBOUNDS_FLOAT16 or 0
+        * for no codes.
+        * @param dimensions The number of values of each vector.
+        * @throw std::invalid_argument If the layout is not known.
+        */
+        QuantizedBounds(int layout = 0, size_t dimensions = 0){
+            if ((layout != 0) && (layout != QUANTIZEDBOUNDS_AFFINE8) &&
+                    (layout != QUANTIZEDBOUNDS_FLOAT16)){
+                throw std::invalid_argument("Unknown layout of the codes.");
+            }
+            this->layout = layout;
+            this->dimensions = (layout == 0) ? 0 : dimensions;
+        }
+
+        /**
+        * Returns the layout of the codes, or 0 if there are no codes.
+        */
+        int getLayout() const{
+            return layout;
+        }
+
+        /**
+        * Returns the number of values of each vector.
+        */
+        size_t getDimensions() const{
+            return dimensions;
+        }
+
+        /**
+        * Returns the size of the codes of a vector in bytes, or 0 if there
+        * are no codes.
+        */
+        u_int32_t getCodeSize() const{
+            if (layout == QUANTIZEDBOUNDS_AFFINE8){
+                return (2 * sizeof(double)) + dimensions;
+            }else if (layout == QUANTIZEDBOUNDS_FLOAT16){
+                return 1 + (dimensions * sizeof(u_int16_t));
+            }
+            return 0;
+        }
+
+        /**
+        * Builds the codes of a vector.
+        * @param obj The feature vector.
+        * @param code The getCodeSize() bytes of the codes (output).
+        */
+        template <class ObjectType>
+        void encode(ObjectType &obj, u_char *code) const{
+            std::vector<double> values(dimensions);
+            bool valid = (obj.size() == dimensions);
+
+            for (size_t i = 0; valid && (i < dimensions); i++){
+                values[i] = obj[i];
+            }
+
+            if (layout == QUANTIZEDBOUNDS_AFFINE8){
+                double params[Int8Quantizer::ParameterCount];
+
+                if (!valid || !Int8Quantizer::encode(values.data(), dimensions, params,
+                        code + sizeof(params))){
+                    params[0] = NAN;
+                    params[1] = 0.0;
+                    memset(code + sizeof(params), 0, dimensions);
+                }
+                memcpy(code, params, sizeof(params));
+            }else if (layout == QUANTIZEDBOUNDS_FLOAT16){
+                std::vector<u_int16_t> codes(dimensions, 0);
+
+                valid = valid && Float16Quantizer::encode(values.data(), dimensions, NULL,
+                        codes.data());
+                code[0] = valid ? 1 : 0;
+                memcpy(code + 1, codes.data(), dimensions * sizeof(u_int16_t));
+            }
+        }
+
+        /**
+        * Returns a lower bound of the sum of the squared differences.
+        * @param code The codes of the first feature vector.
+        * @param obj The other feature vector.
+        * @param limit The calculation stops once the bound exceeds it.
+        */
+        template <class ObjectType>
+        double sumSquaredGaps(const u_char *code, ObjectType &obj, double limit) const{
+            return getBound<L2>(code, obj, limit);
+        }
+
+        /**
+        * Returns a lower bound of the sum of the absolute differences.
+        * @param code The codes of the first feature vector.
+        * @param obj The other feature vector.
+        * @param limit The calculation stops once the bound exceeds it.
+        */
+        template <class ObjectType>
+        double sumAbsoluteGaps(const u_char *code, ObjectType &obj, double limit) const{
+            return getBound<L1>(code, obj, limit);
+        }
+
+        /**
+        * Returns a lower bound of the greatest absolute difference.
+        * @param code The codes of the first feature vector.
+        * @param obj The other feature vector.
+        * @param limit The calculation stops once the bound exceeds it.
+        */
+        template <class ObjectType>
+        double maxAbsoluteGap(const u_char *code, ObjectType &obj, double limit) const{
+            return getBound<LInf>(code, obj, limit);
+        }
+
+        /**
+        * Returns the name of the instruction set selected for this CPU
+        * ("avx2" or "scalar").
+        */
+        static const char *getInstructionSet(){
+            return getTable().Name;
+        }
+
+    private:
+        //The layout of the codes
+        int layout;
+        //The number of values of each vector
+        size_t dimensions;
+
+        /**
+        * The norms.
+        */
+        enum tNorm{
+            L2 = 0,
+            L1 = 1,
+            LInf = 2
+        };
+
+        /**
+        * Signature of a kernel: it combines d with the gaps of the values
+        * i to n - 1.
+        */
+        typedef double (*tKernel)(const u_char *codes, const double *params,
+                const u_char *values, size_t i, size_t n, double d);
+
+        /**
+        * The kernels selected for this CPU.
+        */
+        struct tTable{
+            tKernel Affine8[3];
+            tKernel Float16[3];
+            const char *Name;
+        };
+
+        /**
+        * Returns the kernels selected for this CPU. The selection is done
+        * once.
+        */
+        static const tTable &getTable(){
+            static const tTable table = selectTable();
+            return table;
+        }
+
+        /**
+        * Selects the kernels for this CPU.
+        */
+        static tTable selectTable(){
+            tTable table = {{scalarAffine8<L2>, scalarAffine8<L1>, scalarAffine8<LInf>},
+                            {scalarFloat16<L2>, scalarFloat16<L1>, scalarFloat16<LInf>},
+                            "scalar"};
+
+            #ifdef LPKERNELS_X86
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2")){
+                table.Affine8[L2] = avx2Affine8<L2>;
+                table.Affine8[L1] = avx2Affine8<L1>;
+                table.Affine8[LInf] = avx2Affine8<LInf>;
+                table.Name = "avx2";
+                if (__builtin_cpu_supports("f16c")){
+                    table.Float16[L2] = avx2Float16<L2>;
+                    table.Float16[L1] = avx2Float16<L1>;
+                    table.Float16[LInf] = avx2Float16<LInf>;
+                }
+            }
+            #endif //LPKERNELS_X86
+            return table;
+        }
+
+        /**
+        * Computes a bound.
+        */
+        template <int Norm, class ObjectType>
+        double getBound(const u_char *code, ObjectType &obj, double limit) const{
+            double params[Int8Quantizer::ParameterCount] = {0.0, 0.0};
+            double block[LPKERNELS_BLOCKSIZE];
+            const u_char *codes;
+            size_t width;
+            tKernel kernel;
+            double d = 0.0;
+            size_t i = 0;
+            size_t end;
+
+            if ((layout == 0) || (obj.size() != dimensions)){
+                return 0.0;
+            }else if (layout == QUANTIZEDBOUNDS_AFFINE8){
+                memcpy(params, code, sizeof(params));
+                if (std::isnan(params[0])){
+                    return 0.0;
+                }
+                codes = code + sizeof(params);
+                width = sizeof(u_int8_t);
+                kernel = getTable().Affine8[Norm];
+            }else{
+                if (code[0] == 0){
+                    return 0.0;
+                }
+                codes = code + 1;
+                width = sizeof(u_int16_t);
+                kernel = getTable().Float16[Norm];
+            }
+
+            if constexpr (KernelTraits<ObjectType>::Supported){
+                const u_char *values = obj.getVectorData();
+
+                for (; (i < dimensions) && (d <= limit); i = end){
+                    end = std::min(dimensions, i + LPKERNELS_BLOCKSIZE);
+                    d = kernel(codes, params, values, i, end, d);
+                }
+            }else{
+                // The values are copied to doubles, one block at a time.
+                for (; (i < dimensions) && (d <= limit); i = end){
+                    end = std::min(dimensions, i + LPKERNELS_BLOCKSIZE);
+                    for (size_t j = i; j < end; j++){
+                        block[j - i] = obj[j];
+                    }
+                    d = kernel(codes + (i * width), params, (const u_char *) block, 0, end - i, d);
+                }
+            }
+            return d;
+        }
+
+        /**
+        * Returns the distance between a value and an interval.
+        * @param lo The smallest value of the interval.
+        * @param hi The greatest value of the interval.
+        * @param value The value.
+        */
+        static double gap(double lo, double hi, double value){
+            if (value < lo){
+                return lo - value;
+            }else if (value > hi){
+                return value - hi;
+            }
+            return 0.0;
+        }
+
+        /**
+        * Adds a gap to a bound.
+        */
+        template <int Norm>
+        static double combine(double d, double gap){
+            if constexpr (Norm == L2){
+                return d + (gap * gap);
+            }else if constexpr (Norm == L1){
+                return d + gap;
+            }else{
+                return (gap > d) ? gap : d;
+            }
+        }
+
+        /**
+        * Converts a binary16 number to double. It is exact.
+        */
+        static double halfToDouble(u_int16_t code){
+            u_int32_t bits = ((u_int32_t) (code & 0x7FFF)) << 13;
+            float magnitude;
+            double value;
+
+            // The exponent is rebiased by the multiplication, which also
+            // scales the subnormal numbers.
+            memcpy(&magnitude, &bits, sizeof(float));
+            value = ((code & 0x7C00) == 0x7C00) ? HUGE_VAL : magnitude * 0x1p112;
+            return (code & 0x8000) ? -value : value;
+        }
+
+        /**
+        * Gets the next binary16 number toward plus infinity (+inf is kept).
+        */
+        static u_int16_t halfNextUp(u_int16_t code){
+            if (code == 0x7C00){
+                return code;
+            }else if (code == 0x8000){
+                return 0x0001;
+            }
+            return (code & 0x8000) ? code - 1 : code + 1;
+        }
+
+        /**
+        * Reads a double that may be unaligned.
+        */
+        static double value(const u_char *values, size_t i){
+            double v;
+
+            memcpy(&v, values + (i * sizeof(double)), sizeof(double));
+            return v;
+        }
+
+        template <int Norm>
+        static double scalarAffine8(const u_char *codes, const double *params,
+                const u_char *values, size_t i, size_t n, double d){
+            for (; i < n; i++){
+                d = combine<Norm>(d, gap(params[0] + (params[1] * codes[i]),
+                        params[0] + (params[1] * (codes[i] + 1)), value(values, i)));
+            }
+            return d;
+        }
+
+        template <int Norm>
+        static double scalarFloat16(const u_char *codes, const double *,
+                const u_char *values, size_t i, size_t n, double d){
+            u_int16_t code;
+
+            for (; i < n; i++){
+                memcpy(&code, codes + (i * sizeof(u_int16_t)), sizeof(u_int16_t));
+                d = combine<Norm>(d, gap(halfToDouble(code),
+                        halfToDouble(halfNextUp(code)), value(values, i)));
+            }
+            return d;
+        }
+
+        #ifdef LPKERNELS_X86
+        //----------------------------------------------------------------------
+        // AVX2: 4 doubles per register.
+        //----------------------------------------------------------------------
+        /**
+        * Returns the gaps of 4 values to their intervals.
+        */
+        __attribute__((target("avx2")))
+        static __m256d avx2Gap(__m256d lo, __m256d hi, const u_char *values, size_t i){
+            __m256d v = _mm256_loadu_pd((const double *) (values + (i * sizeof(double))));
+
+            return _mm256_max_pd(_mm256_max_pd(_mm256_sub_pd(lo, v), _mm256_sub_pd(v, hi)),
+                    _mm256_setzero_pd());
+        }
+
+        /**
+        * Adds 4 gaps to a partial bound.
+        */
+        template <int Norm>
+        __attribute__((target("avx2")))
+        static __m256d avx2Combine(__m256d d, __m256d gap){
+            if constexpr (Norm == L2){
+                return _mm256_add_pd(d, _mm256_mul_pd(gap, gap));
+            }else if constexpr (Norm == L1){
+                return _mm256_add_pd(d, gap);
+            }else{
+                return _mm256_max_pd(d, gap);
+            }
+        }
+
+        /**
+        * Combines a partial bound with the partial bounds of two registers.
+        */
+        template <int Norm>
+        __attribute__((target("avx2")))
+        static double avx2Reduce(double d, __m256d v0, __m256d v1){
+            double tmp[4];
+
+            if constexpr (Norm == LInf){
+                _mm256_storeu_pd(tmp, _mm256_max_pd(v0, v1));
+                return std::max(std::max(d, std::max(tmp[0], tmp[1])), std::max(tmp[2], tmp[3]));
+            }else{
+                _mm256_storeu_pd(tmp, _mm256_add_pd(v0, v1));
+                return d + ((tmp[0] + tmp[1]) + (tmp[2] + tmp[3]));
+            }
+        }
+
+        /**
+        * Returns the intervals of 4 affine codes, stored in the lowest 4
+        * bytes of raw. p1 is a power of two, so the products are exact.
+        */
+        __attribute__((target("avx2")))
+        static void avx2Affine8Interval(__m128i raw, __m256d p0, __m256d p1,
+                __m256d &lo, __m256d &hi){
+            __m256d c = _mm256_cvtepi32_pd(_mm_cvtepu8_epi32(raw));
+
+            lo = _mm256_add_pd(p0, _mm256_mul_pd(p1, c));
+            hi = _mm256_add_pd(p0, _mm256_mul_pd(p1, _mm256_add_pd(c, _mm256_set1_pd(1.0))));
+        }
+
+        template <int Norm>
+        __attribute__((target("avx2")))
+        static double avx2Affine8(const u_char *codes, const double *params,
+                const u_char *values, size_t i, size_t n, double d){
+            const __m256d p0 = _mm256_set1_pd(params[0]);
+            const __m256d p1 = _mm256_set1_pd(params[1]);
+            __m256d sum0 = _mm256_setzero_pd();
+            __m256d sum1 = _mm256_setzero_pd();
+            __m256d lo0, hi0, lo1, hi1;
+            __m128i raw;
+
+            for (; i + 8 <= n; i += 8){
+                raw = _mm_loadl_epi64((const __m128i *) (codes + i));
+                avx2Affine8Interval(raw, p0, p1, lo0, hi0);
+                avx2Affine8Interval(_mm_srli_si128(raw, 4), p0, p1, lo1, hi1);
+                sum0 = avx2Combine<Norm>(sum0, avx2Gap(lo0, hi0, values, i));
+                sum1 = avx2Combine<Norm>(sum1, avx2Gap(lo1, hi1, values, i + 4));
+            }
+            return scalarAffine8<Norm>(codes, params, values, i, n, avx2Reduce<Norm>(d, sum0, sum1));
+        }
+
+        /**
+        * Returns the intervals of 4 binary16 codes, stored in the lowest 8
+        * bytes of code.
+        */
+        __attribute__((target("avx2,f16c")))
+        static void avx2Float16Interval(__m128i code, __m256d &lo, __m256d &hi){
+            const __m128i one = _mm_set1_epi16(1);
+            __m128i next, zero, inf;
+
+            // code + 1, or code - 1 if it is negative.
+            next = _mm_sub_epi16(_mm_add_epi16(code, one),
+                    _mm_and_si128(_mm_srai_epi16(code, 15), _mm_set1_epi16(2)));
+            // -0 is followed by the smallest subnormal and +inf is kept.
+            zero = _mm_cmpeq_epi16(code, _mm_set1_epi16((short) 0x8000));
+            inf = _mm_cmpeq_epi16(code, _mm_set1_epi16(0x7C00));
+            next = _mm_or_si128(_mm_andnot_si128(_mm_or_si128(zero, inf), next),
+                    _mm_or_si128(_mm_and_si128(zero, one), _mm_and_si128(inf, code)));
+            lo = _mm256_cvtps_pd(_mm_cvtph_ps(code));
+            hi = _mm256_cvtps_pd(_mm_cvtph_ps(next));
+        }
+
+        template <int Norm>
+        __attribute__((target("avx2,f16c")))
+        static double avx2Float16(const u_char *codes, const double *,
+                const u_char *values, size_t i, size_t n, double d){
+            __m256d sum0 = _mm256_setzero_pd();
+            __m256d sum1 = _mm256_setzero_pd();
+            __m256d lo0, hi0, lo1, hi1;
+            __m128i code;
+
+            for (; i + 8 <= n; i += 8){
+                code = _mm_loadu_si128((const __m128i *) (codes + (i * sizeof(u_int16_t))));
+                avx2Float16Interval(code, lo0, hi0);
+                avx2Float16Interval(_mm_srli_si128(code, 8), lo1, hi1);
+                sum0 = avx2Combine<Norm>(sum0, avx2Gap(lo0, hi0, values, i));
+                sum1 = avx2Combine<Norm>(sum1, avx2Gap(lo1, hi1, values, i + 4));
+            }
+            return scalarFloat16<Norm>(codes, NULL, values, i, n, avx2Reduce<Norm>(d, sum0, sum1));
+        }
+        #endif //LPKERNELS_X86
+
+        /**
+        * Checks if the kernels can read the values of a type directly.
+        */
+        template <class ObjectType, class Enable = void>
+        class KernelTraits{
+            public:
+                static const bool Supported = false;
+        };
+
+        template <class ObjectType>
+        class KernelTraits<ObjectType, std::void_t<
+                decltype(std::declval<const ObjectType &>().getVectorData())> >{
+            public:
+                static const bool Supported =
+                        std::is_same<typename std::decay<decltype(std::declval<ObjectType &>()[0])>::type,
+                                double>::value;
+        };
+};
+
+#endif //QUANTIZEDBOUNDS_H
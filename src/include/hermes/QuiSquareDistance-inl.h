@@ -13,24 +13,24 @@
 /**
 * Constructor.
 */
-template <class ObjectType>
-QuiSquareDistance<ObjectType>::QuiSquareDistance(){
+template <class ObjectType, class StatisticsPolicy>
+QuiSquareDistance<ObjectType, StatisticsPolicy>::QuiSquareDistance(){
 }
 
 /**
 * Destructor.
 */
-template <class ObjectType>
-QuiSquareDistance<ObjectType>::~QuiSquareDistance(){
+template <class ObjectType, class StatisticsPolicy>
+QuiSquareDistance<ObjectType, StatisticsPolicy>::~QuiSquareDistance(){
 }
 
 /**
 * @deprecated Use getDistance() instead.
 *
-* @copydoc getDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error)
+* @copydoc getDistance(ObjectType &obj1, ObjectType &obj2)
 */
-template <class ObjectType>
-double QuiSquareDistance<ObjectType>::GetDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error) {
+template <class ObjectType, class StatisticsPolicy>
+double QuiSquareDistance<ObjectType, StatisticsPolicy>::GetDistance(ObjectType &obj1, ObjectType &obj2) {
 
     if (obj1.size() != obj2.size()) {
         throw std::length_error("The feature vectors do not have the same size.");
@@ -49,13 +49,22 @@ double QuiSquareDistance<ObjectType>::GetDistance(ObjectType &obj1, ObjectType &
 * @throw Exception If the computation is not possible.
 * @return The QuiSquare distance between feature vector 1 and feature vector 2.
 */
-template <class ObjectType>
-double QuiSquareDistance<ObjectType>::getDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error){
+template <class ObjectType, class StatisticsPolicy>
+double QuiSquareDistance<ObjectType, StatisticsPolicy>::getDistance(ObjectType &obj1, ObjectType &obj2){
 
     if (obj1.size() != obj2.size()) {
         throw std::length_error("The feature vectors do not have the same size.");
     }
 
+    if constexpr (HistogramKernelTraits<ObjectType, ObjectType>::Supported){
+        double d = HistogramKernels::chiSquare(obj1.getValueData(), obj2.getValueData(), obj1.size()) / 2;
+
+        // Statistic support
+        this->updateDistanceCount();
+
+        return d;
+    }
+
     double d = 0;
     double tmp;
 
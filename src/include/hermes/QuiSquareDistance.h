@@ -22,6 +22,7 @@
 #define QUISQUAREDISTANCE_H
 
 #include "DistanceFunction.h"
+#include "HistogramKernels.h"
 #include <cmath>
 
 /**
@@ -31,16 +32,16 @@
 * @author 13.
 * @version 1.0.
 */
-template <class ObjectType>
-class QuiSquareDistance : public DistanceFunction<ObjectType> {
+template <class ObjectType, class StatisticsPolicy = DistanceFunctionStatistics>
+class QuiSquareDistance final : public DistanceFunction<ObjectType, StatisticsPolicy>{
 
     public:
 
         QuiSquareDistance();
         ~QuiSquareDistance();
 
-        double GetDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error) ;
-        double getDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error);
+        double GetDistance(ObjectType &obj1, ObjectType &obj2) ;
+        double getDistance(ObjectType &obj1, ObjectType &obj2);
 };
 
 #include "QuiSquareDistance-inl.h"
@@ -13,24 +13,24 @@
 /**
 * Constructor.
 */
-template <class ObjectType>
-SpearmanDistance<ObjectType>::SpearmanDistance(){
+template <class ObjectType, class StatisticsPolicy>
+SpearmanDistance<ObjectType, StatisticsPolicy>::SpearmanDistance(){
 }
 
 /**
 * Destructor.
 */
-template <class ObjectType>
-SpearmanDistance<ObjectType>::~SpearmanDistance(){
+template <class ObjectType, class StatisticsPolicy>
+SpearmanDistance<ObjectType, StatisticsPolicy>::~SpearmanDistance(){
 }
 
 /**
 * @deprecated Use getDistance() instead.
 *
-* @copydoc getDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error)
+* @copydoc getDistance(ObjectType &obj1, ObjectType &obj2)
 */
-template <class ObjectType>
-double SpearmanDistance<ObjectType>::GetDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error){
+template <class ObjectType, class StatisticsPolicy>
+double SpearmanDistance<ObjectType, StatisticsPolicy>::GetDistance(ObjectType &obj1, ObjectType &obj2){
 
     return getDistance(obj1, obj2);
 }
@@ -45,129 +45,97 @@ double SpearmanDistance<ObjectType>::GetDistance(ObjectType &obj1, ObjectType &o
 * @throw Exception If the computation is not possible.
 * @return The Spearman's Rank correlation between feature vector 1 and feature vector 2.
 */
-template <class ObjectType>
-double SpearmanDistance<ObjectType>::getDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error){
+template <class ObjectType, class StatisticsPolicy>
+double SpearmanDistance<ObjectType, StatisticsPolicy>::getDistance(ObjectType &obj1, ObjectType &obj2){
 
     if (obj1.size() != obj2.size()){
         throw std::length_error ("The feature vectors do not have the same size.");
     }
 
-    double* xrank = new double[obj1.size()];
-    double* yrank = new double[obj1.size()];
-
-    for (size_t i = 0; i < obj1.size(); i++){
-        xrank[i] = 0.0;
-        yrank[i] = 0.0;
-    }
-
-    int index = 1;
-
-    double xElement = obj1[0];
-    double yElement = obj2[0];
-
-    //Gets the minor value and set it to *Element
-    for (size_t i = 0; i < obj1.size(); i++){
-        if (obj1[i] < xElement)
-            xElement = obj1[i];
-        if (obj2[i] < yElement)
-            yElement = obj2[i];
-    }
-
-    bool ranking = true;
-
-    //It ranks first time series
-    while (ranking)	{
-        u_int32_t recurrence = 0;
-        //Count the recurrence
-        for (size_t i = 0; i < obj1.size(); i++)
-            if (obj1[i] == xElement)
-                recurrence++;
-
-        double rank = (index * 2) + recurrence - 1;
-        rank /= (double) 2;
-
-        //Set rank to the proper positions
-        for (size_t i = 0; i < obj1.size(); i++)
-            if (obj1[i] == xElement)
-                xrank[i] = rank;
-
-        ranking = false;
-        double newElement;
-
-        for (size_t i = 0; i < obj1.size(); i++) {
-            //Continue if there's a number higher than xElement
-            if (obj1[i] > xElement){
-                ranking = true;
-                newElement = obj1[i];
-            }
-        }
-
-        // it stops if there isn't more numbers to rank in the sequence
-        if (ranking){
-            for (size_t i = 0; i < obj1.size(); i++)
-                if ((obj1[i] > xElement) && (obj1[i] < newElement))
-                    newElement = obj1[i];
-
-            // sets to xElement the minor number not ranked of the sequence
-            xElement = newElement;
-            // xindex gets the next number to be used in the rank
-            index += recurrence;
-        }
-    }
+    std::vector<double> xrank, yrank;
 
+    computeRanks(obj1, xrank);
+    computeRanks(obj2, yrank);
+    return getCorrelation(xrank, yrank);
+}
 
-    ranking = true;
-    index = 1;
+/**
+* @deprecated Use prepareQuery() instead.
+*
+* @copydoc prepareQuery(ObjectType &query, PreparedQuery &prepared)
+*/
+template <class ObjectType, class StatisticsPolicy>
+void SpearmanDistance<ObjectType, StatisticsPolicy>::PrepareQuery(ObjectType &query, PreparedQuery &prepared){
 
-    //It ranks second time series
-    while (ranking) {
+    prepareQuery(query, prepared);
+}
 
-        int recurrence = 0;
+/**
+* Prepares a query sample: its ranks are computed once.
+*
+* @param query: The query sample.
+* @param prepared: The data of the query sample (output).
+*/
+template <class ObjectType, class StatisticsPolicy>
+void SpearmanDistance<ObjectType, StatisticsPolicy>::prepareQuery(ObjectType &query, PreparedQuery &prepared){
 
-        for (size_t i = 0; i < obj1.size(); i++)
-            if (obj2[i] == yElement)
-                recurrence++;
+    computeRanks(query, prepared.ranks);
+}
 
-        double rank = (index * 2) + recurrence - 1;
-        rank /= (double) 2;
+/**
+* @deprecated Use getDistance(ObjectType &obj, PreparedQuery &query) instead.
+*
+* @copydoc getDistance(ObjectType &obj, PreparedQuery &query)
+*/
+template <class ObjectType, class StatisticsPolicy>
+double SpearmanDistance<ObjectType, StatisticsPolicy>::GetDistance(ObjectType &obj, PreparedQuery &query){
 
-        for (size_t i = 0; i < obj1.size(); i++)
-            if (obj2[i] == yElement)
-                yrank[i] = rank;
+    return getDistance(obj, query);
+}
 
-        ranking = false;
-        double newElement;
+/**
+* Calculates the Spearman's Rank correlation between a feature vector and a
+* prepared query sample.
+*
+* @param obj: The feature vector.
+* @param query: The query sample prepared by prepareQuery().
+* @throw Exception If the computation is not possible.
+* @return The Spearman's Rank correlation between the feature vector and the query sample.
+*/
+template <class ObjectType, class StatisticsPolicy>
+double SpearmanDistance<ObjectType, StatisticsPolicy>::getDistance(ObjectType &obj, PreparedQuery &query){
 
-        for (size_t i = 0; i < obj1.size(); i++){
+    if (obj.size() != query.ranks.size()){
+        throw std::length_error ("The feature vectors do not have the same size.");
+    }
 
-            if (obj2[i] > yElement){
-                ranking = true;
-                newElement = obj2[i];
-            }
-        }
+    std::vector<double> xrank;
 
-        if (ranking){
-            for (size_t i = 0; i < obj1.size(); i++)
-                if ((obj2[i] > yElement) && (obj2[i] < newElement))
-                    newElement = obj2[i];
+    computeRanks(obj, xrank);
+    return getCorrelation(xrank, query.ranks);
+}
 
-            yElement = newElement;
-            index += recurrence;
-        }
-    }
+/**
+* Calculates the Spearman's Rank correlation from the ranks of two feature
+* vectors of the same size.
+*
+* @param xrank: The ranks of the first feature vector.
+* @param yrank: The ranks of the second feature vector.
+* @return The Spearman's Rank correlation.
+*/
+template <class ObjectType, class StatisticsPolicy>
+double SpearmanDistance<ObjectType, StatisticsPolicy>::getCorrelation(const std::vector<double> &xrank, const std::vector<double> &yrank){
 
+    size_t n = xrank.size();
     double sum = 0;
 
-    for (size_t i = 0; i < obj1.size(); i++){
+    for (size_t i = 0; i < n; i++){
         double difference = xrank[i] - yrank[i];
         sum += difference * difference;
     }
 
     // Spearman's Rank Correlation formula
-    double result = (1 - 6 * sum / (obj1.size()* (obj1.size() * obj1.size() - 1)));
-
-    delete [] xrank;
-    delete [] yrank;
+    double result = (1 - 6 * sum / (n * (n * n - 1)));
 
     // Statistic support
     this->updateDistanceCount();
@@ -175,3 +143,34 @@ double SpearmanDistance<ObjectType>::getDistance(ObjectType &obj1, ObjectType &o
     return result;
 }
 
+/**
+* Ranks the values of a feature vector from the smallest (rank 1). Equal
+* values receive the mean of the ranks they span.
+*
+* @param obj: The feature vector.
+* @param ranks: The ranks of each position.
+*/
+template <class ObjectType, class StatisticsPolicy>
+void SpearmanDistance<ObjectType, StatisticsPolicy>::computeRanks(ObjectType &obj, std::vector<double> &ranks){
+
+    size_t n = obj.size();
+    size_t first, last;
+    double rank;
+    std::vector<size_t> order(n);
+
+    ranks.resize(n);
+    for (size_t i = 0; i < n; i++){
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(),
+            [&obj](size_t a, size_t b){ return obj[a] < obj[b]; });
+
+    for (first = 0; first < n; first = last){
+        // The run of equal values
+        for (last = first + 1; (last < n) && (obj[order[last]] == obj[order[first]]); last++);
+        rank = (((first + 1) * 2) + (last - first) - 1) / (double) 2;
+        for (size_t i = first; i < last; i++){
+            ranks[order[i]] = rank;
+        }
+    }
+}
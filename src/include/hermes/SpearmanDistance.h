@@ -22,25 +22,49 @@
 #define SPEARMANDISTANCE_HPP
 
 #include "DistanceFunction.h"
+#include <algorithm>
 #include <cmath>
+#include <stdexcept>
+#include <vector>
 
 /**
 * Class to obtain the Spearman's Rank Correlacion
 *
+* <P>The ranks of a query sample may be computed once by prepareQuery() and
+* reused by every distance to it.
+*
 * @brief Spearman's Rank Correlacion class.
 * @author 011.
 * @version 1.0.
 */
-template <class ObjectType>
-class SpearmanDistance : public DistanceFunction <ObjectType>{
+template <class ObjectType, class StatisticsPolicy = DistanceFunctionStatistics>
+class SpearmanDistance final : public DistanceFunction<ObjectType, StatisticsPolicy>{
+
+    private:
+        void computeRanks(ObjectType &obj, std::vector<double> &ranks);
+        double getCorrelation(const std::vector<double> &xrank, const std::vector<double> &yrank);
 
     public:
+        /**
+        * The data of a query sample computed by prepareQuery().
+        */
+        class PreparedQuery{
+            public:
+                //The ranks of the query sample
+                std::vector<double> ranks;
+        };
 
         SpearmanDistance();
         ~SpearmanDistance();
 
-        double GetDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error);
-        double getDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error);
+        double GetDistance(ObjectType &obj1, ObjectType &obj2);
+        double getDistance(ObjectType &obj1, ObjectType &obj2);
+
+        void PrepareQuery(ObjectType &query, PreparedQuery &prepared);
+        void prepareQuery(ObjectType &query, PreparedQuery &prepared);
+
+        double GetDistance(ObjectType &obj, PreparedQuery &query);
+        double getDistance(ObjectType &obj, PreparedQuery &query);
 };
 
 #include "SpearmanDistance-inl.h"
@@ -13,22 +13,22 @@
 /**
 * Constructor.
 */
-template <class ObjectType>
-SquaredChordDistance<ObjectType>::SquaredChordDistance(){
+template <class ObjectType, class StatisticsPolicy>
+SquaredChordDistance<ObjectType, StatisticsPolicy>::SquaredChordDistance(){
 }
 
 /**
 * Destructor.
 */
-template <class ObjectType>
-SquaredChordDistance<ObjectType>::~SquaredChordDistance(){
+template <class ObjectType, class StatisticsPolicy>
+SquaredChordDistance<ObjectType, StatisticsPolicy>::~SquaredChordDistance(){
 }
 
 /**
 * @copydoc DistanceFunction::GetDistance()
 */
-template <class ObjectType>
-double SquaredChordDistance<ObjectType>::GetDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error){
+template <class ObjectType, class StatisticsPolicy>
+double SquaredChordDistance<ObjectType, StatisticsPolicy>::GetDistance(ObjectType &obj1, ObjectType &obj2){
 
     return getDistance(obj1, obj2);
 }
@@ -36,12 +36,21 @@ double SquaredChordDistance<ObjectType>::GetDistance(ObjectType &obj1, ObjectTyp
 /**
 * @copydoc DistanceFunction::getDistance()
 */
-template <class ObjectType>
-double SquaredChordDistance<ObjectType>::getDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error){
+template <class ObjectType, class StatisticsPolicy>
+double SquaredChordDistance<ObjectType, StatisticsPolicy>::getDistance(ObjectType &obj1, ObjectType &obj2){
 
     if (obj1.size() != obj2.size())
         throw std::length_error("The feature vectors do not have the same size.");
 
+    if constexpr (HistogramKernelTraits<ObjectType, ObjectType>::Supported){
+        double d = LpKernels<double>::sumSquaredDifferences(obj1.getSqrtData(), obj2.getSqrtData(), obj1.size());
+
+        // Statistic support
+        this->updateDistanceCount();
+
+        return d;
+    }
+
     double d;
     double tmp;
 
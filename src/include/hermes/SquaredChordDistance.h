@@ -22,6 +22,7 @@
 #define SQUAREDCHORDDISTANCE_H
 
 #include "DistanceFunction.h"
+#include "HistogramKernels.h"
 #include <cmath>
 #include <stdexcept>
 
@@ -32,16 +33,16 @@
 * @author 006.
 * @warning Both objects must have the same number of entries.
 */
-template <class ObjectType>
-class SquaredChordDistance: public DistanceFunction<ObjectType>{
+template <class ObjectType, class StatisticsPolicy = DistanceFunctionStatistics>
+class SquaredChordDistance final : public DistanceFunction<ObjectType, StatisticsPolicy>{
 
     public:
 
         SquaredChordDistance();
         virtual ~SquaredChordDistance();
 
-        double GetDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error);
-        double getDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error);
+        double GetDistance(ObjectType &obj1, ObjectType &obj2);
+        double getDistance(ObjectType &obj1, ObjectType &obj2);
 };
 
 #include "SquaredChordDistance-inl.h"
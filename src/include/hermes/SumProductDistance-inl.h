@@ -10,18 +10,18 @@
 * 
 * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
-template <class ObjectType>
-SumProductDistance<ObjectType>::SumProductDistance() {
+template <class ObjectType, class StatisticsPolicy>
+SumProductDistance<ObjectType, StatisticsPolicy>::SumProductDistance() {
     numEval = 0;
 }
 
-template <class ObjectType>
-SumProductDistance<ObjectType>::~SumProductDistance() {
+template <class ObjectType, class StatisticsPolicy>
+SumProductDistance<ObjectType, StatisticsPolicy>::~SumProductDistance() {
     clear();
 }
 
-template <class ObjectType>
-void SumProductDistance<ObjectType>::clear(){
+template <class ObjectType, class StatisticsPolicy>
+void SumProductDistance<ObjectType, StatisticsPolicy>::clear(){
 
     for (size_t i = 0; i < numEval; i++) {
         delete Evaluator[i];
@@ -30,8 +30,8 @@ void SumProductDistance<ObjectType>::clear(){
     numEval = 0;
 }
 
-template <class ObjectType>
-void SumProductDistance<ObjectType>::addEval(myDistance *e, double w) {
+template <class ObjectType, class StatisticsPolicy>
+void SumProductDistance<ObjectType, StatisticsPolicy>::addEval(myDistance *e, double w) {
 
     Evaluator.insert(Evaluator.end(), e);
     max.insert(max.end(), 0);
@@ -39,8 +39,8 @@ void SumProductDistance<ObjectType>::addEval(myDistance *e, double w) {
     numEval++;
 }
 
-template <class ObjectType>
-double SumProductDistance<ObjectType>::getPartialDistance(ObjectType &o1, ObjectType &o2, u_int32_t i) {
+template <class ObjectType, class StatisticsPolicy>
+double SumProductDistance<ObjectType, StatisticsPolicy>::getPartialDistance(ObjectType &o1, ObjectType &o2, u_int32_t i) {
 
     double tmp;
     double sum = 0;
@@ -58,8 +58,8 @@ double SumProductDistance<ObjectType>::getPartialDistance(ObjectType &o1, Object
 /**
 * @copydoc DistanceFunction::getDistance().
 */
-template <class ObjectType>
-double SumProductDistance<ObjectType>::GetDistance(ObjectType &o1, ObjectType &o2) {
+template <class ObjectType, class StatisticsPolicy>
+double SumProductDistance<ObjectType, StatisticsPolicy>::GetDistance(ObjectType &o1, ObjectType &o2) {
 
     return getDistance(o1, o2);
 }
@@ -67,8 +67,8 @@ double SumProductDistance<ObjectType>::GetDistance(ObjectType &o1, ObjectType &o
 /**
 * @copydoc DistanceFunction::getDistance().
 */
-template <class ObjectType>
-double SumProductDistance<ObjectType>::getDistance(ObjectType &o1, ObjectType &o2) {
+template <class ObjectType, class StatisticsPolicy>
+double SumProductDistance<ObjectType, StatisticsPolicy>::getDistance(ObjectType &o1, ObjectType &o2) {
 
     double sum = 0.0;
     double tmp = 0.0;
@@ -92,8 +92,8 @@ double SumProductDistance<ObjectType>::getDistance(ObjectType &o1, ObjectType &o
 *
 * @return The maximum distance.
 */
-template <class ObjectType>
-double SumProductDistance<ObjectType>::getMax(size_t i){
+template <class ObjectType, class StatisticsPolicy>
+double SumProductDistance<ObjectType, StatisticsPolicy>::getMax(size_t i){
 
     return max[i];
 }
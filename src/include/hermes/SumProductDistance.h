@@ -27,8 +27,8 @@
 #include <stdexcept>
 
 
-template <class ObjectType>
-class SumProductDistance : public DistanceFunction <ObjectType>{
+template <class ObjectType, class StatisticsPolicy = DistanceFunctionStatistics>
+class SumProductDistance final : public DistanceFunction<ObjectType, StatisticsPolicy>{
 
     private:
         typedef DistanceFunction<ObjectType> myDistance;
@@ -13,15 +13,15 @@
 /**
 * Constructor.
 */
-template <class ObjectType>
-WarpDistance<ObjectType>::WarpDistance(){
+template <class ObjectType, class StatisticsPolicy>
+WarpDistance<ObjectType, StatisticsPolicy>::WarpDistance(){
 }
 
 /**
 * Destructor.
 */
-template <class ObjectType>
-WarpDistance<ObjectType>::~WarpDistance(){
+template <class ObjectType, class StatisticsPolicy>
+WarpDistance<ObjectType, StatisticsPolicy>::~WarpDistance(){
 }
 
 /**
@@ -29,8 +29,8 @@ WarpDistance<ObjectType>::~WarpDistance(){
 *
 * @copydoc getDistance(ObjectType &obj1, ObjectType &obj2) .
 */
-template <class ObjectType>
-double WarpDistance<ObjectType>::GetDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error){
+template <class ObjectType, class StatisticsPolicy>
+double WarpDistance<ObjectType, StatisticsPolicy>::GetDistance(ObjectType &obj1, ObjectType &obj2){
 
     return getDistance(obj1, obj2);
 }
@@ -43,8 +43,8 @@ double WarpDistance<ObjectType>::GetDistance(ObjectType &obj1, ObjectType &obj2)
 * @param obj2: The second feature vector.
 * @return The warp distance between feature vector 1 and feature vector 2.
 */
-template <class ObjectType>
-double WarpDistance<ObjectType>::getDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error){
+template <class ObjectType, class StatisticsPolicy>
+double WarpDistance<ObjectType, StatisticsPolicy>::getDistance(ObjectType &obj1, ObjectType &obj2){
 
     double *new_obj1_value = new double[(obj1.size()/2)];
     double *new_obj2_value = new double[(obj2.size()/2)];
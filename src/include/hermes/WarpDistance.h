@@ -30,15 +30,15 @@
 * @author 006.
 * @version 1.0.
 */
-template <class ObjectType>
-class WarpDistance : public DistanceFunction <ObjectType>  {
+template <class ObjectType, class StatisticsPolicy = DistanceFunctionStatistics>
+class WarpDistance final : public DistanceFunction<ObjectType, StatisticsPolicy>{
 
     public:
         WarpDistance();
         virtual ~WarpDistance();
 
-        double GetDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error);
-        double getDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error);
+        double GetDistance(ObjectType &obj1, ObjectType &obj2);
+        double getDistance(ObjectType &obj1, ObjectType &obj2);
 };
 
 #include "WarpDistance-inl.h"
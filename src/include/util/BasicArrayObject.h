@@ -19,6 +19,8 @@
 #include <iostream>
 #include <vector>
 
+#include "BasicArrayObjectView.h"
+
 /**
 * This class implements a very important object for similarity search: just a single and simple
 * feature vector that can make your life easier when talking about using arboretum resources. Be-
@@ -49,6 +51,12 @@ class BasicArrayObject{
 
     public:
 
+        /**
+        * The read-only view of a serialized instance of this class. The trees
+        * use it to evaluate distances without unserializing each entry.
+        */
+        typedef BasicArrayObjectView<DType> ViewType;
+
         /**
         * Constructor Method.
         * Sets data and size to empty and 0, respectively.
@@ -214,6 +222,16 @@ class BasicArrayObject{
             return data;
         }
 
+        /**
+        * Gets the first byte of the stored values. It is used by the
+        * vectorized distance kernels (see LpKernels).
+        * @return The first byte of the feature vector.
+        */
+        const u_char *getVectorData() const{
+
+            return (const u_char *) data.data();
+        }
+
         /**
         * Overloaded operator allowing modifications.
         * @param idx The index to be queried.
@@ -0,0 +1,180 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef BASICARRAYOBJECTVIEW_H
+#define BASICARRAYOBJECTVIEW_H
+
+#include <cstdlib>
+#include <cstring>
+#include <sys/types.h>
+
+/**
+* This class is a read-only view of a serialized BasicArrayObject. It does not
+* copy the feature vector: it reads the values directly from the serialized
+* bytes (usually the node page of a tree), so a query may evaluate a distance
+* without rebuilding the object.
+*
+* The serialized layout is the one produced by BasicArrayObject::serialize():
+* +-----+------+------------------+
+* | OID | Size | Vector Data []   |
+* +-----+------+------------------+
+*
+* The view does not own the bytes and is valid only while they are. The
+* vector data is not aligned inside the page, so values are read with
+* memcpy().
+*
+* @brief Zero-copy view of a serialized feature vector.
+* @version 1.0
+* @arg DType The data type stored by each position of the feature vector
+* @see BasicArrayObject
+*/
+template <class DType>
+class BasicArrayObjectView{
+
+    private:
+        //The serialized object
+        const u_char *serialized;
+        //The size of the serialized object in bytes
+        size_t serializedSize;
+
+    public:
+
+        /**
+        * Constructor Method.
+        * Creates an empty view.
+        */
+        BasicArrayObjectView(){
+            serialized = NULL;
+            serializedSize = 0;
+        }
+
+        /**
+        * Constructor Method.
+        * Creates a view of a serialized object.
+        * @param dataIn The byte vector.
+        * @param dataSize The byte vector size.
+        */
+        BasicArrayObjectView(const u_char *dataIn, size_t dataSize){
+            wrap(dataIn, dataSize);
+        }
+
+        /**
+        * Points this view to another serialized object.
+        * @param dataIn The byte vector.
+        * @param dataSize The byte vector size.
+        */
+        void wrap(const u_char *dataIn, size_t dataSize){
+            serialized = dataIn;
+            serializedSize = dataSize;
+        }
+
+        /**
+        * @copydoc wrap(const u_char *dataIn, size_t dataSize).
+        */
+        void Wrap(const u_char *dataIn, size_t dataSize){
+            wrap(dataIn, dataSize);
+        }
+
+        /**
+        * Gets the feature vector OID.
+        * @return The feature vector OID.
+        */
+        u_int32_t getOID() const{
+            u_int32_t OID;
+
+            memcpy(&OID, serialized, sizeof(u_int32_t));
+            return OID;
+        }
+
+        /**
+        * @copydoc getOID().
+        */
+        u_int32_t GetOID() const{
+            return getOID();
+        }
+
+        /**
+        * Gets the number of elements in the feature vector.
+        * @return The number of elements of the feature vector.
+        */
+        size_t getSize() const{
+            return (serializedSize - sizeof(u_int32_t) - sizeof(size_t)) / sizeof(DType);
+        }
+
+        /**
+        * @copydoc getSize().
+        */
+        size_t size() const{
+            return getSize();
+        }
+
+        /**
+        * @copydoc getSize().
+        */
+        size_t GetSize() const{
+            return getSize();
+        }
+
+        /**
+        * Gets a value of the feature vector.
+        * @param idx The index to be queried.
+        * @return The value of the position idx.
+        */
+        DType operator[] (size_t idx) const{
+            DType value;
+
+            memcpy(&value, serialized + sizeof(u_int32_t) + sizeof(size_t) +
+                  (sizeof(DType) * idx), sizeof(DType));
+            return value;
+        }
+
+        /**
+        * Gets the first byte of the serialized values. It is used by the
+        * vectorized distance kernels (see LpKernels).
+        * @return The first byte of the feature vector.
+        */
+        const u_char *getVectorData() const{
+            return serialized + sizeof(u_int32_t) + sizeof(size_t);
+        }
+
+        /**
+        * Gets the size of the byte vector.
+        * @return The size of the bytes vector.
+        */
+        u_int32_t getSerializedSize() const{
+            return serializedSize;
+        }
+
+        /**
+        * @copydoc getSerializedSize().
+        */
+        u_int32_t GetSerializedSize() const{
+            return getSerializedSize();
+        }
+
+        /**
+        * Gets the byte vector this view points to.
+        * @return The byte vector.
+        */
+        const u_char *serialize() const{
+            return serialized;
+        }
+
+        /**
+        * @copydoc serialize().
+        */
+        const u_char *Serialize() const{
+            return serialize();
+        }
+};
+
+#endif
@@ -0,0 +1,336 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef FIXEDARRAYOBJECT_H
+#define FIXEDARRAYOBJECT_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+#include <sys/types.h>
+
+#include "FixedArrayObjectView.h"
+
+/**
+* This class implements a feature vector whose dimension is fixed at compile
+* time. It has the same interface of BasicArrayObject, so it may be indexed by
+* every tree and used with the hermes distance functions, but it does not
+* allocate memory and its serialized form is designed to be read in place.
+*
+* The serialized layout is:
+* +------------------+-----+---------+
+* | Vector Data []   | OID | Padding |
+* +------------------+-----+---------+
+*
+* There is no size prefix and the vector comes first. The padding rounds the
+* serialized size up to a multiple of 8 bytes and is always zero. Since the
+* nodes of the trees store their objects packed from the end of the page, a
+* node filled with objects of the same size keeps all vectors aligned.
+*
+* The object itself is its own serialized image, so serialize() and
+* unserialize() are a single pointer return and a single memcpy().
+*
+* @brief This class implements a fixed-dimension feature vector
+* @version 1.0
+* @arg DType The data type stored by each position of the feature vector
+* @arg Dim The number of positions of the feature vector
+* @see BasicArrayObject
+*/
+template <class DType, size_t Dim>
+class FixedArrayObject{
+
+    private:
+        /**
+        * The serialized image of the object.
+        */
+        struct alignas(8) tImage{
+            //The feature vector
+            DType Data[Dim];
+            //The OID that identifies the feature vector
+            u_int32_t OID;
+        };
+
+        //The object
+        tImage image;
+
+        static_assert(offsetof(tImage, OID) == FixedArrayObjectView<DType, Dim>::OIDOffset,
+              "Unexpected layout of FixedArrayObject.");
+
+    public:
+
+        /**
+        * The read-only view of a serialized instance of this class.
+        */
+        typedef FixedArrayObjectView<DType, Dim> ViewType;
+
+        /**
+        * Constructor Method.
+        * Sets the OID and all values to 0.
+        */
+        FixedArrayObject(){
+            memset(&image, 0, sizeof(tImage));
+        }
+
+        /**
+        * Constructor Method.
+        * Sets the values of the vector to current.
+        * @param OID The OID of the feature vector.
+        * @param data The Dim values of the feature vector.
+        */
+        FixedArrayObject(const u_int32_t OID, const DType *data){
+            memset(&image, 0, sizeof(tImage));
+            image.OID = OID;
+            memcpy(image.Data, data, sizeof(DType) * Dim);
+        }
+
+        /**
+        * Constructor Method.
+        * Sets the values of the vector to current.
+        * @param OID The OID of the feature vector.
+        * @param data The values of the feature vector.
+        * @throw std::length_error If data does not have Dim values.
+        */
+        FixedArrayObject(const u_int32_t OID, const std::vector<DType> &data){
+            if (data.size() != Dim){
+                throw std::length_error("The feature vector does not have the expected size.");
+            }
+            memset(&image, 0, sizeof(tImage));
+            image.OID = OID;
+            for (size_t x = 0; x < Dim; x++){
+                image.Data[x] = data[x];
+            }
+        }
+
+        /**
+        * @deprecated
+        * @copydoc setOID(u_int32_t OID).
+        */
+        void SetOID(u_int32_t OID){
+            setOID(OID);
+        }
+
+        /**
+        * Sets the feature vector OID.
+        * @param OID The OID of the feature vector.
+        * Caution: The OID is not checked as unique.
+        */
+        void setOID(u_int32_t OID){
+            image.OID = OID;
+        }
+
+        /**
+        * Gets the feature vector OID.
+        * @return The feature vector OID.
+        */
+        u_int32_t getOID() const{
+            return image.OID;
+        }
+
+        /**
+        * @deprecated This method is deprecated. Use getOID() instead.
+        * @copydoc getOID().
+        */
+        u_int32_t GetOID() const{
+            return getOID();
+        }
+
+        /**
+        * @deprecated
+        * @copydoc set(size_t pos, DType value).
+        */
+        void Set(size_t pos, DType value){
+            set(pos, value);
+        }
+
+        /**
+        * Sets a specific value in a specific position.
+        * @param pos The position. It must be lower than Dim.
+        * @param value The value to be set.
+        */
+        void set(size_t pos, DType value){
+            image.Data[pos] = value;
+        }
+
+        /**
+        * Gets the entire stored data.
+        * @return The entire stored data.
+        */
+        std::vector<DType> getData() const{
+            return std::vector<DType>(image.Data, image.Data + Dim);
+        }
+
+        /**
+        * Gets the first byte of the stored values. It is used by the
+        * vectorized distance kernels (see LpKernels).
+        * @return The first byte of the feature vector.
+        */
+        const u_char *getVectorData() const{
+            return (const u_char *) image.Data;
+        }
+
+        /**
+        * Overloaded operator allowing modifications.
+        * @param idx The index to be queried.
+        */
+        DType& operator[] (size_t idx){
+            return image.Data[idx];
+        }
+
+        /**
+        * Overloaded operator that not allows modifications.
+        * @param idx The index to be queried.
+        */
+        const DType& operator[] (size_t idx) const{
+            return image.Data[idx];
+        }
+
+        /**
+        * Get a value in a specific position.
+        * @param idx The position value to be retrieved.
+        * @return The value of the position idx.
+        */
+        DType *get(size_t idx){
+            return &image.Data[idx];
+        }
+
+        /**
+        * @deprecated This method is deprecated. Use get(size_t idx) instead.
+        * @copydoc get(size_t idx).
+        */
+        DType *Get(size_t idx){
+            return get(idx);
+        }
+
+        /**
+        * Gets the number of elements in the feature vector.
+        * @return Dim.
+        */
+        size_t getSize() const{
+            return Dim;
+        }
+
+        /**
+        * @copydoc getSize().
+        */
+        size_t size() const{
+            return Dim;
+        }
+
+        /**
+        * @deprecated This method is deprecated. Use getSize() instead.
+        * @copydoc getSize().
+        */
+        size_t GetSize() const{
+            return Dim;
+        }
+
+        /**
+        * Gets an instantied copy of the object.
+        * @return A copy of the object.
+        */
+        FixedArrayObject<DType, Dim> *clone(){
+            return new FixedArrayObject<DType, Dim>(*this);
+        }
+
+        /**
+        * @deprecated This method is deprecated. Use clone() instead.
+        * @copydoc clone().
+        */
+        FixedArrayObject<DType, Dim> *Clone(){
+            return clone();
+        }
+
+        /**
+        * Check if the obj is equal to the current object.
+        * @param obj The object to be compared.
+        * @return True if the objects are equal, else otherwise.
+        */
+        bool isEqual(FixedArrayObject<DType, Dim> *obj){
+            if (getOID() != obj->getOID())
+                return false;
+
+            for (size_t x = 0; x < Dim; x++)
+                if (image.Data[x] != obj->image.Data[x])
+                    return false;
+
+            return true;
+        }
+
+        /**
+        * @deprecated This method is deprecated. Use isEqual() instead.
+        * @copydoc isEqual(FixedArrayObject<DType, Dim> *obj).
+        */
+        bool IsEqual(FixedArrayObject<DType, Dim> *obj){
+            return isEqual(obj);
+        }
+
+        /**
+        * Gets the size of the byte vector. It is a multiple of 8.
+        * @return The size of the bytes vector.
+        */
+        u_int32_t getSerializedSize() const{
+            return sizeof(tImage);
+        }
+
+        /**
+        * @deprecated This method is deprecated. Use getSerializedSize() instead.
+        * @copydoc getSerializedSize().
+        */
+        u_int32_t GetSerializedSize() const{
+            return getSerializedSize();
+        }
+
+        /**
+        * Gets the equivalent byte vector of the object. It is valid while the
+        * object is not modified or destroyed.
+        * @return The equivalent byte vector of the object.
+        */
+        const u_char *serialize() const{
+            return (const u_char *) &image;
+        }
+
+        /**
+        * @deprecated This method is deprecated. Use serialize() instead.
+        * @copydoc serialize().
+        */
+        const u_char *Serialize() const{
+            return serialize();
+        }
+
+        /**
+        * Transform a byte vector into an object.
+        * @param dataIn The byte vector.
+        * @param dataSize The byte vector size. Use 0 when it is not known,
+        * since the serialized size is fixed.
+        * @throw std::length_error If dataSize is neither 0 nor the serialized
+        * size.
+        */
+        void unserialize(const u_char *dataIn, size_t dataSize = 0){
+            if ((dataSize != 0) && (dataSize != sizeof(tImage))){
+                throw std::length_error("The byte vector does not have the expected size.");
+            }
+            memcpy(&image, dataIn, sizeof(tImage));
+        }
+
+        /**
+        * @deprecated This method is deprecated.
+        * Use unserialize(const u_char *dataIn, size_t dataSize) instead.
+        * @copydoc unserialize(const u_char *dataIn, size_t dataSize).
+        */
+        void Unserialize(const u_char *dataIn, size_t dataSize = 0){
+            unserialize(dataIn, dataSize);
+        }
+};
+
+#endif
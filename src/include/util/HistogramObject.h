@@ -0,0 +1,334 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+* 
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+* 
+* 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+* 
+* 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+* 
+* 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef HISTOGRAMOBJECT_H
+#define HISTOGRAMOBJECT_H
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+/**
+* This class implements a histogram (a feature vector of non-negative bins)
+* that keeps the transforms of its bins used by the histogram divergences:
+* the bins as double, their logarithms, their square roots and their sum.
+* The transforms are computed when the object is built or unserialized, so
+* the distance functions (see HistogramKernels) do not evaluate log() or
+* sqrt() for each bin of each distance.
+*
+* The serialized form is the same of BasicArrayObject:
+* +-----+------+------------------+
+* | OID | Size | Vector Data []   |
+* +-----+------+------------------+
+*
+* The bins can only be changed by set(), which updates the transforms.
+* The logarithm of an empty bin is stored as 0.
+*
+* @brief Histogram with precomputed transforms.
+* @version 1.0
+* @arg DType The data type stored by each bin.
+* @see BasicArrayObject
+*/
+template <class DType>
+class HistogramObject{
+
+    private:
+        //The bins
+        std::vector<DType> data;
+        //The bins as double
+        std::vector<double> values;
+        //The logarithms of the bins
+        std::vector<double> logs;
+        //The square roots of the bins
+        std::vector<double> roots;
+        //The sum of the bins
+        double sum;
+        //The OID that identifies the histogram
+        u_int32_t OID;
+        //The serialized form, built on demand
+        std::vector<u_char> serialized;
+
+        /**
+        * Computes the transforms of a bin.
+        * @param idx The bin.
+        */
+        void transform(size_t idx){
+            values[idx] = data[idx];
+            logs[idx] = (values[idx] > 0.0) ? log(values[idx]) : 0.0;
+            roots[idx] = sqrt(values[idx]);
+        }
+
+        /**
+        * Computes the transforms of all bins.
+        */
+        void transformAll(){
+            values.resize(data.size());
+            logs.resize(data.size());
+            roots.resize(data.size());
+            sum = 0.0;
+            for (size_t x = 0; x < data.size(); x++){
+                transform(x);
+                sum += values[x];
+            }
+            serialized.clear();
+        }
+
+    public:
+
+        /**
+        * Empty constructor.
+        */
+        HistogramObject(){
+            OID = 0;
+            sum = 0.0;
+        }
+
+        /**
+        * Creates a histogram.
+        * @param OID The OID of the histogram.
+        * @param data The bins.
+        */
+        HistogramObject(const u_int32_t OID, const std::vector<DType> &data){
+            this->OID = OID;
+            this->data = data;
+            transformAll();
+        }
+
+        /**
+        * Sets the histogram OID.
+        * @param OID The OID of the histogram.
+        */
+        void setOID(u_int32_t OID){
+            this->OID = OID;
+            serialized.clear();
+        }
+
+        /**
+        * @copydoc setOID(u_int32_t OID).
+        */
+        void SetOID(u_int32_t OID){
+            setOID(OID);
+        }
+
+        /**
+        * Gets the histogram OID.
+        * @return The histogram OID.
+        */
+        u_int32_t getOID() const{
+            return OID;
+        }
+
+        /**
+        * @copydoc getOID().
+        */
+        u_int32_t GetOID() const{
+            return getOID();
+        }
+
+        /**
+        * Sets a bin and updates its transforms.
+        * @param pos The bin, it must exist.
+        * @param value The new value.
+        */
+        void set(size_t pos, DType value){
+            sum -= values[pos];
+            data[pos] = value;
+            transform(pos);
+            sum += values[pos];
+            serialized.clear();
+        }
+
+        /**
+        * @copydoc set(size_t pos, DType value).
+        */
+        void Set(size_t pos, DType value){
+            set(pos, value);
+        }
+
+        /**
+        * Gets a bin.
+        * @param idx The bin.
+        * @return The value of the bin.
+        */
+        DType operator[] (size_t idx) const{
+            return data[idx];
+        }
+
+        /**
+        * Gets all bins.
+        * @return The bins.
+        */
+        std::vector<DType> getData() const{
+            return data;
+        }
+
+        /**
+        * Gets the bins as double.
+        * @return The first bin.
+        */
+        const double *getValueData() const{
+            return values.data();
+        }
+
+        /**
+        * Gets the logarithms of the bins (0 for the empty bins).
+        * @return The logarithm of the first bin.
+        */
+        const double *getLogData() const{
+            return logs.data();
+        }
+
+        /**
+        * Gets the square roots of the bins.
+        * @return The square root of the first bin.
+        */
+        const double *getSqrtData() const{
+            return roots.data();
+        }
+
+        /**
+        * Gets the sum of the bins.
+        * @return The sum of the bins.
+        */
+        double getSum() const{
+            return sum;
+        }
+
+        /**
+        * Gets the number of bins.
+        * @return The number of bins.
+        */
+        size_t getSize() const{
+            return data.size();
+        }
+
+        /**
+        * @copydoc getSize().
+        */
+        size_t size() const{
+            return getSize();
+        }
+
+        /**
+        * @copydoc getSize().
+        */
+        size_t GetSize() const{
+            return getSize();
+        }
+
+        /**
+        * Gets an instantied copy of the object.
+        * @return A copy of the object.
+        */
+        HistogramObject<DType> *clone(){
+            return new HistogramObject<DType>(*this);
+        }
+
+        /**
+        * @copydoc clone().
+        */
+        HistogramObject<DType> *Clone(){
+            return clone();
+        }
+
+        /**
+        * Check if the obj is equal to the current object.
+        * @param obj The object to be compared.
+        * @return True if the objects are equal, else otherwise.
+        */
+        bool isEqual(HistogramObject<DType> *obj){
+            return (getOID() == obj->getOID()) && (data == obj->data);
+        }
+
+        /**
+        * @copydoc isEqual(HistogramObject<DType> *obj).
+        */
+        bool IsEqual(HistogramObject<DType> *obj){
+            return isEqual(obj);
+        }
+
+        /**
+        * Gets the size of the byte vector.
+        * @return The size of the bytes vector.
+        */
+        u_int32_t getSerializedSize() const{
+            return (sizeof(u_int32_t) + sizeof(size_t) + (sizeof(DType) * data.size()));
+        }
+
+        /**
+        * @copydoc getSerializedSize().
+        */
+        u_int32_t GetSerializedSize() const{
+            return getSerializedSize();
+        }
+
+        /**
+        * Gets the equivalent byte vector of the object.
+        * @return The equivalent byte vector of the object.
+        */
+        const u_char *serialize(){
+            if (serialized.empty()){
+                size_t size = data.size();
+
+                serialized.resize(getSerializedSize());
+                memcpy(serialized.data(), &OID, sizeof(u_int32_t));
+                memcpy(serialized.data() + sizeof(u_int32_t), &size, sizeof(size_t));
+                if (size > 0){
+                    memcpy(serialized.data() + sizeof(u_int32_t) + sizeof(size_t),
+                           data.data(), sizeof(DType) * size);
+                }
+            }
+            return serialized.data();
+        }
+
+        /**
+        * @copydoc serialize().
+        */
+        const u_char *Serialize(){
+            return serialize();
+        }
+
+        /**
+        * Transform a byte vector into an object and computes the transforms
+        * of its bins.
+        * @param dataIn The byte vector.
+        * @param dataSize The byte vector size.
+        */
+        void unserialize(const u_char *dataIn, size_t dataSize = 0){
+            size_t size;
+
+            memcpy(&OID, dataIn, sizeof(u_int32_t));
+            if (dataSize != 0){
+                size = (dataSize - sizeof(u_int32_t) - sizeof(size_t)) / sizeof(DType);
+            }else{
+                memcpy(&size, dataIn + sizeof(u_int32_t), sizeof(size_t));
+            }
+            data.resize(size);
+            if (size > 0){
+                memcpy(data.data(), dataIn + sizeof(u_int32_t) + sizeof(size_t),
+                       sizeof(DType) * size);
+            }
+            transformAll();
+        }
+
+        /**
+        * @copydoc unserialize(const u_char *dataIn, size_t dataSize).
+        */
+        void Unserialize(const u_char *dataIn, size_t dataSize = 0){
+            unserialize(dataIn, dataSize);
+        }
+};
+
+#endif